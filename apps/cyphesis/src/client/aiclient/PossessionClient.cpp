@@ -26,6 +26,7 @@
 
 #include "common/debug.h"
 #include "common/CommSocket.h"
+#include "rules/python/PythonScriptBatches.h"
 
 #include <Atlas/Objects/Entity.h>
 
@@ -173,6 +174,7 @@ void PossessionClient::scheduleDispatch() {
 			//process at least one op
 			auto currentTime = getTime();
 			m_operationsDispatcher.processUntil(currentTime, std::chrono::microseconds(100));
+			PythonScriptBatches::instance().flush();
 			scheduleDispatch();
 		}
 	});
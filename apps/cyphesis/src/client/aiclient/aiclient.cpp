@@ -151,6 +151,8 @@ STRING_OPTION(account, "", "aiclient", "account", "Account name to use to authen
 
 STRING_OPTION(password, "", "aiclient", "password", "Password to use to authenticate to the server")
 
+INT_OPTION(navmesh_threads, 2, "aiclient", "navmeshthreads", "Number of threads used for building navmesh tiles. If 0 they are built on the main thread.")
+
 
 int main(int argc, char** argv) {
 	spdlog::set_pattern("[%Y-%m-%d %H:%M:%S.%e] [AI] [%^%l%$] %v");
@@ -212,7 +214,14 @@ int main(int argc, char** argv) {
 			boost::asio::io_context io_context;
 			boost::asio::thread_pool httpThreadPool {1};
 			HttpHandling httpCache(monitors, io_context);
-			AwareMindFactory mindFactory(typeStore);
+			//Rasterizing navmesh tiles is the heaviest work the minds do, so it's shared out on a pool of threads.
+			auto navmeshThreads = std::max(navmesh_threads, 0);
+			boost::asio::thread_pool navmeshThreadPool(std::max(navmeshThreads, 1));
+			std::function<void(std::function<void()>)> navmeshExecutor;
+			if (navmeshThreads > 0) {
+				navmeshExecutor = [&navmeshThreadPool](std::function<void()> task) { boost::asio::post(navmeshThreadPool, std::move(task)); };
+			}
+			AwareMindFactory mindFactory(typeStore, navmeshExecutor, static_cast<size_t>(navmeshThreads));
 
 			AssetsManager assets_manager(std::make_unique<FileSystemObserver>(io_context));
 
@@ -25,12 +25,14 @@
 #include <Atlas/Objects/Decoder.h>
 #include <Atlas/Objects/ObjectsFwd.h>
 #include <Atlas/Codec.h>
+#include <Atlas/Filter.h>
 #include <Atlas/Negotiate.h>
 
 #include <boost/asio.hpp>
 #include <boost/asio/buffer.hpp>
 #include <boost/asio/steady_timer.hpp>
 
+#include <atomic>
 #include <memory>
 #include <sstream>
 #include <deque>
@@ -78,9 +80,26 @@ public:
          */
         void setMaxThrottledOps(std::size_t limit) { m_maxThrottledOps = limit; }
 
+	/**
+	 * Sets whether outgoing ops should be encoded on the io threads rather than on the thread calling "send".
+	 *
+	 * When enabled the Link hands each op over to this client's strand, where it's encoded and written.
+	 * The calling thread thus only needs to route the ops. This must be set before negotiation has completed.
+	 * Encoding is always offloaded if a filter is negotiated.
+	 * @param offloadEncoding
+	 */
+	void setOffloadEncoding(bool offloadEncoding) {
+		mOffloadEncoding = offloadEncoding;
+	}
+
 protected:
 	typename ProtocolT::socket mSocket;
 
+	/**
+	 * All socket handlers, as well as any offloaded encoding, are run through this strand.
+	 */
+	boost::asio::strand<boost::asio::io_context::executor_type> mStrand;
+
 	boost::asio::streambuf mReadBuffer;
 	/**
 	 * A buffer into which any outgoing data is written. This is always attached to mOutStream,
@@ -94,6 +113,16 @@ protected:
 	 */
 	std::unique_ptr<boost::asio::streambuf> mSendBuffer;
 
+	/**
+	 * If a filter has been negotiated, received data is decoded into this buffer before being read by the codec.
+	 */
+	boost::asio::streambuf mPlainReadBuffer;
+
+	/**
+	 * If a filter has been negotiated, the codec writes to this buffer, which is encoded into mWriteBuffer when flushing.
+	 */
+	boost::asio::streambuf mPlainWriteBuffer;
+
 	/**
 	 * The stream onto which data is received.
 	 */
@@ -125,6 +154,12 @@ protected:
 	 */
         bool mAutoFlush;
 
+	/**
+	 * If "true", outgoing ops are encoded on the strand instead of by the sending thread.
+	 * Set on the strand if a filter is negotiated, and read by the sending thread.
+	 */
+	std::atomic<bool> mOffloadEncoding;
+
         /**
          * Queue of operations that couldn't immediately be processed by the link.
          * These will be retried with exponential backoff when the link signals
@@ -166,6 +201,8 @@ protected:
 	std::unique_ptr<Atlas::Codec> m_codec;
 	/// \brief high level encoder passes data to the codec for transmission.
 	std::unique_ptr<Atlas::Objects::ObjectsEncoder> m_encoder;
+	/// \brief Optional filter (such as compression) negotiated with the client.
+	std::unique_ptr<Atlas::Filter> m_filter;
 	/// \brief Atlas negotiator for handling codec negotiation.
 	std::unique_ptr<Atlas::Negotiate> m_negotiate;
 	/// \brief Server side object for handling connection level operations.
@@ -177,6 +214,15 @@ protected:
 
 	void write();
 
+	/// \brief Decodes all received data through the filter.
+	void filterIncoming();
+
+	/// \brief Encodes all written data through the filter.
+	void filterOutgoing();
+
+	/// \brief Encodes the op on the strand.
+	void sendOffloaded(const Atlas::Objects::Operation::RootOperation& op);
+
 	void startNegotiation();
 
 	/// \brief Handle socket data related to codec negotiation.
@@ -44,6 +44,7 @@ CommAsioClient<ProtocolT>::CommAsioClient(std::string name,
 		ObjectsDecoder(factories),
 		CommSocket(io_context),
 		mSocket(io_context),
+		mStrand(boost::asio::make_strand(io_context)),
 		mWriteBuffer(std::make_unique<boost::asio::streambuf>()),
 		mSendBuffer(std::make_unique<boost::asio::streambuf>()),
 		mInStream(&mReadBuffer),
@@ -52,6 +53,7 @@ CommAsioClient<ProtocolT>::CommAsioClient(std::string name,
                 mIsSending(false),
                 mShouldSend(false),
                 mAutoFlush(false),
+                mOffloadEncoding(false),
                 m_throttleTimer(io_context),
                 m_maxThrottledOps(256),
                 m_initialBackoff(std::chrono::milliseconds(50)),
@@ -103,10 +105,19 @@ template<class ProtocolT>
 void CommAsioClient<ProtocolT>::do_read() {
 	auto self(this->shared_from_this());
 	mSocket.async_read_some(mReadBuffer.prepare(read_buffer_size),
-							[this, self](boost::system::error_code ec, std::size_t length) {
+							boost::asio::bind_executor(mStrand, [this, self](boost::system::error_code ec, std::size_t length) {
 								if (!ec) {
 									rmt_ScopedCPUSample(read, 0)
 									mReadBuffer.commit(length);
+									if (m_filter) {
+										try {
+											this->filterIncoming();
+										} catch (const std::exception& e) {
+											//By not reading any more the instance will be deleted.
+											spdlog::warn("Could not decode data from '{}': {}", socketName(mSocket), e.what());
+											return;
+										}
+									}
 									m_codec->poll();
 									if (m_active) {
 										//By calling do_read again we make sure that the instance
@@ -130,11 +141,14 @@ void CommAsioClient<ProtocolT>::do_read() {
 										spdlog::log(level, ss.str());
 									}
 								}
-							});
+							}));
 }
 
 template<class ProtocolT>
 void CommAsioClient<ProtocolT>::write() {
+	if (m_filter) {
+		filterOutgoing();
+	}
 	if (mWriteBuffer->size() != 0) {
 		if (mIsSending) {
 			//We're already sending in the background.
@@ -149,11 +163,14 @@ void CommAsioClient<ProtocolT>::write() {
 		auto self(this->shared_from_this());
 		//Swap places between writing buffer and sending buffer, and attach new write buffer to the out stream.
 		std::swap(mWriteBuffer, mSendBuffer);
-		mOutStream.rdbuf(mWriteBuffer.get());
+		//If there's a filter the codec instead writes to the plain buffer.
+		if (!m_filter) {
+			mOutStream.rdbuf(mWriteBuffer.get());
+		}
 		mIsSending = true;
 
 		boost::asio::async_write(mSocket, *mSendBuffer,
-								 [this, self](boost::system::error_code ec, std::size_t length) {
+								 boost::asio::bind_executor(mStrand, [this, self](boost::system::error_code ec, std::size_t length) {
 									 mIsSending = false;
 									 if (!ec) {
 										 rmt_ScopedCPUSample(write, 0)
@@ -178,7 +195,29 @@ void CommAsioClient<ProtocolT>::write() {
 										 }
 
 									 }
-								 });
+								 }));
+	}
+}
+
+template<class ProtocolT>
+void CommAsioClient<ProtocolT>::filterIncoming() {
+	if (mReadBuffer.size() != 0) {
+		auto data = mReadBuffer.data();
+		auto decoded = m_filter->decode(std::string(boost::asio::buffers_begin(data), boost::asio::buffers_end(data)));
+		mReadBuffer.consume(mReadBuffer.size());
+		mPlainReadBuffer.commit(boost::asio::buffer_copy(mPlainReadBuffer.prepare(decoded.size()), boost::asio::buffer(decoded)));
+	}
+}
+
+template<class ProtocolT>
+void CommAsioClient<ProtocolT>::filterOutgoing() {
+	if (mPlainWriteBuffer.size() != 0) {
+		rmt_ScopedCPUSample(filter, 0)
+		//Everything written since last flush is encoded in one go, which also flushes the filter.
+		auto data = mPlainWriteBuffer.data();
+		auto encoded = m_filter->encode(std::string(boost::asio::buffers_begin(data), boost::asio::buffers_end(data)));
+		mPlainWriteBuffer.consume(mPlainWriteBuffer.size());
+		mWriteBuffer->commit(boost::asio::buffer_copy(mWriteBuffer->prepare(encoded.size()), boost::asio::buffer(encoded)));
 	}
 }
 
@@ -186,7 +225,7 @@ template<class ProtocolT>
 void CommAsioClient<ProtocolT>::negotiate_read() {
 	auto self(this->shared_from_this());
 	mSocket.async_read_some(mReadBuffer.prepare(read_buffer_size),
-							[this, self](boost::system::error_code ec, std::size_t length) {
+							boost::asio::bind_executor(mStrand, [this, self](boost::system::error_code ec, std::size_t length) {
 								if (!ec && m_active) {
 									mReadBuffer.commit(length);
 									if (length > 0) {
@@ -210,7 +249,7 @@ void CommAsioClient<ProtocolT>::negotiate_read() {
 									m_negotiate.reset();
 									mNegotiateTimer.cancel();
 								}
-							});
+							}));
 }
 
 template<class ProtocolT>
@@ -219,18 +258,23 @@ void CommAsioClient<ProtocolT>::negotiate_write() {
 
 	if (mWriteBuffer->size() != 0) {
 		boost::asio::async_write(mSocket, mWriteBuffer->data(),
-								 [this, self](boost::system::error_code ec, std::size_t length) {
+								 boost::asio::bind_executor(mStrand, [this, self](boost::system::error_code ec, std::size_t length) {
 									 if (!ec && m_active) {
 										 mWriteBuffer->consume(length);
 									 }
-								 });
+								 }));
 	}
 }
 
 template<class ProtocolT>
 void CommAsioClient<ProtocolT>::startAccept(std::unique_ptr<Link> connection) {
 	// Create the server side negotiator
-	m_negotiate = std::make_unique<Atlas::Net::StreamAccept>("cyphesis " + mName, mInStream, mOutStream);
+	auto negotiate = std::make_unique<Atlas::Net::StreamAccept>("cyphesis " + mName, mInStream, mOutStream);
+	//There's no point in compressing data sent over local sockets.
+	if constexpr (std::is_same_v<ProtocolT, boost::asio::local::stream_protocol>) {
+		negotiate->setFiltersEnabled(false);
+	}
+	m_negotiate = std::move(negotiate);
 
 	m_link = std::move(connection);
 
@@ -240,7 +284,11 @@ void CommAsioClient<ProtocolT>::startAccept(std::unique_ptr<Link> connection) {
 template<class ProtocolT>
 void CommAsioClient<ProtocolT>::startConnect(std::unique_ptr<Link> connection) {
 	// Create the client side negotiator
-	m_negotiate = std::make_unique<Atlas::Net::StreamConnect>("cyphesis " + mName, mInStream, mOutStream);
+	auto negotiate = std::make_unique<Atlas::Net::StreamConnect>("cyphesis " + mName, mInStream, mOutStream);
+	if constexpr (std::is_same_v<ProtocolT, boost::asio::local::stream_protocol>) {
+		negotiate->setFiltersEnabled(false);
+	}
+	m_negotiate = std::move(negotiate);
 
 	m_link = std::move(connection);
 
@@ -288,6 +336,7 @@ int CommAsioClient<ProtocolT>::negotiate() {
 
 	// Get the codec that negotiation established
 	m_codec = m_negotiate->getCodec(*this);
+	m_filter = m_negotiate->getFilter();
 
 	// Acceptor is now finished with
 	m_negotiate.reset();
@@ -296,11 +345,36 @@ int CommAsioClient<ProtocolT>::negotiate() {
 		spdlog::debug("Could not create codec during negotiation with '{}'.", socketName(mSocket));
 		return -1;
 	}
+
+	if (m_filter) {
+		try {
+			m_filter->begin();
+			//From now on the codec reads and writes plain data, which is passed through the filter.
+			mInStream.rdbuf(&mPlainReadBuffer);
+			mOutStream.rdbuf(&mPlainWriteBuffer);
+			//Any data already received after the negotiation is filtered.
+			filterIncoming();
+		} catch (const std::exception& e) {
+			spdlog::warn("Could not set up filter for '{}': {}", socketName(mSocket), e.what());
+			return -1;
+		}
+		spdlog::debug("Using filter for connection with '{}'.", socketName(mSocket));
+	}
 	// Create a new encoder to send high level objects to the codec
 	m_encoder = std::make_unique<Atlas::Objects::ObjectsEncoder>(*m_codec);
 
 	assert(m_link != 0);
 	m_link->setEncoder(m_encoder.get());
+	//The filter and its buffers are also used when a write completes on the strand, so with a filter
+	//all encoding and writing must happen on the strand.
+	if (m_filter) {
+		mOffloadEncoding = true;
+	}
+	if (mOffloadEncoding) {
+		m_link->setOpSender([this](const Atlas::Objects::Operation::RootOperation& op) {
+			this->sendOffloaded(op);
+		});
+	}
 
 	// This should always be sent at the beginning of a session
 	m_codec->streamBegin();
@@ -418,7 +492,11 @@ int CommAsioClient<ProtocolT>::send(const Atlas::Objects::Operation::RootOperati
 		std::cerr << "sending: " << debugStream.str() << std::endl;
 	}
 
-	m_encoder->streamObjectsMessage(op);
+	if (mOffloadEncoding) {
+		sendOffloaded(op);
+	} else {
+		m_encoder->streamObjectsMessage(op);
+	}
 
 	if (mAutoFlush) {
 		return flush();
@@ -427,6 +505,21 @@ int CommAsioClient<ProtocolT>::send(const Atlas::Objects::Operation::RootOperati
 	}
 }
 
+template<class ProtocolT>
+void CommAsioClient<ProtocolT>::sendOffloaded(const Atlas::Objects::Operation::RootOperation& op) {
+	//Callers may alter or resend the op after this returns (setting "to", "stamp" and so on),
+	//so encode a copy taken on the calling thread rather than the shared op. This only copies the op's
+	//own attributes; the arguments are shared, as senders never alter them.
+	Atlas::Objects::Operation::RootOperation copy = op.copy();
+	auto self(this->shared_from_this());
+	boost::asio::post(mStrand, [this, self, op = std::move(copy)]() {
+		if (m_active && m_encoder) {
+			rmt_ScopedCPUSample(encode, 0)
+			m_encoder->streamObjectsMessage(op);
+		}
+	});
+}
+
 template<class ProtocolT>
 void CommAsioClient<ProtocolT>::disconnect() {
 	m_active = false;
@@ -437,7 +530,15 @@ void CommAsioClient<ProtocolT>::disconnect() {
 
 template<class ProtocolT>
 int CommAsioClient<ProtocolT>::flush() {
-	write();
+	if (mOffloadEncoding) {
+		//Any ops posted before this will have been encoded when the write is performed.
+		auto self(this->shared_from_this());
+		boost::asio::post(mStrand, [this, self]() {
+			this->write();
+		});
+	} else {
+		write();
+	}
 	return 0;
 }
 
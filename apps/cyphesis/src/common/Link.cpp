@@ -37,28 +37,22 @@ Link::Link(CommSocket& socket, RouterId id) :
 Link::~Link() = default;
 
 void Link::send(const Operation& op) const {
-	if (m_encoder) {
-		if (debug_flag) {
-			std::cerr << "sending: ";
-			debug_dump(op, std::cerr);
-			std::cerr << std::endl;
-		}
+	if (debug_flag) {
+		std::cerr << "sending: ";
+		debug_dump(op, std::cerr);
+		std::cerr << std::endl;
+	}
 
+	if (m_opSender) {
+		m_opSender(op);
+	} else if (m_encoder) {
 		m_encoder->streamObjectsMessage(op);
 	}
 }
 
 void Link::send(const OpVector& opVector) const {
-	if (m_encoder) {
-		for (const auto& op: opVector) {
-			if (debug_flag) {
-				std::cerr << "sending: ";
-				debug_dump(op, std::cerr);
-				std::cerr << std::endl;
-			}
-
-			m_encoder->streamObjectsMessage(op);
-		}
+	for (const auto& op: opVector) {
+		send(op);
 	}
 }
 
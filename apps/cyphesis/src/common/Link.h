@@ -21,6 +21,8 @@
 
 #include "common/Router.h"
 
+#include <functional>
+
 class CommSocket;
 
 namespace Atlas {
@@ -38,6 +40,8 @@ class Link : public Router, public ExternalRouter {
 protected:
 	/// \brief The Atlas encoder used to send objects over this link
 	Atlas::Objects::ObjectsEncoder* m_encoder;
+	/// \brief If set, outgoing ops are handed to this instead of being encoded directly.
+	std::function<void(const Operation&)> m_opSender;
 public:
 	CommSocket& m_commSocket;
 
@@ -49,6 +53,17 @@ public:
 		m_encoder = e;
 	}
 
+	/**
+	 * Sets a function which takes over the encoding of outgoing ops.
+	 *
+	 * This allows the socket to encode ops on another thread than the one routing them.
+	 * The sender must then copy the op before returning, as callers may alter and resend it.
+	 * @param sender A function which will receive all outgoing ops, or an empty function to encode directly.
+	 */
+	void setOpSender(std::function<void(const Operation&)> sender) {
+		m_opSender = std::move(sender);
+	}
+
 	/**
 	 * Sends an op and flushes the socket.
 	 *
@@ -139,6 +139,9 @@ void MainLoop::run(bool daemon,
                 {
                         rmt_ScopedCPUSample(processOps, 0)
                         operationsHandler.processUntil(time, max_wall_time);
+                        if (callbacks.operationsProcessed) {
+                                callbacks.operationsProcessed();
+                        }
                 }
 		if (soft_exit_in_progress) {
 			//If we're in soft exit mode and either the deadline has been exceeded
@@ -32,6 +32,10 @@ struct MainLoop {
 		std::function<bool()> softExitPoll;
 		std::function<void()> softExitTimeout;
 		std::function<void()> dispatchOperations;
+		/**
+		 * Called after the operations of each frame have been processed. Optional.
+		 */
+		std::function<void()> operationsProcessed;
 	};
 
         static void run(bool daemon,
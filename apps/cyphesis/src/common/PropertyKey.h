@@ -0,0 +1,188 @@
+/*
+ Copyright (C) 2026 Erik Ogenvik
+
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#ifndef CYPHESIS_PROPERTYKEY_H
+#define CYPHESIS_PROPERTYKEY_H
+
+#include <spdlog/fmt/fmt.h>
+
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <ostream>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+/**
+ * An interned property name.
+ *
+ * All property names are registered once in a global table and are from then on identified by a small integer.
+ * Comparing two keys is thus a single integer comparison, and a key only takes up the space of a pointer and an int.
+ *
+ * The interned names are never released, which is fine since the set of property names is bound by the rules.
+ * Keys can be converted to "const std::string&", so they can be passed anywhere a property name is expected.
+ */
+class PropertyKey {
+public:
+	/**
+	 * Creates an empty key, with the id 0. No interned name will ever get this id.
+	 */
+	PropertyKey() noexcept
+			: m_name(&emptyName()),
+			  m_id(0) {
+	}
+
+	/**
+	 * Interns the name, if not already interned, and creates a key for it.
+	 */
+	explicit PropertyKey(std::string_view name);
+
+	/**
+	 * Looks up an already interned name, without interning it.
+	 * @return A key, or an empty optional if the name has never been interned (and thus can't be found in any property map).
+	 */
+	static std::optional<PropertyKey> lookup(std::string_view name);
+
+	/**
+	 * @return The number of interned names.
+	 */
+	static std::size_t internedCount();
+
+	std::uint32_t id() const noexcept {
+		return m_id;
+	}
+
+	bool empty() const noexcept {
+		return m_id == 0;
+	}
+
+	const std::string& str() const noexcept {
+		return *m_name;
+	}
+
+	operator const std::string&() const noexcept {
+		return *m_name;
+	}
+
+	friend bool operator==(const PropertyKey& lhs, const PropertyKey& rhs) noexcept {
+		return lhs.m_id == rhs.m_id;
+	}
+
+	friend bool operator==(const PropertyKey& lhs, std::string_view rhs) noexcept {
+		return *lhs.m_name == rhs;
+	}
+
+	friend std::ostream& operator<<(std::ostream& os, const PropertyKey& key) {
+		return os << *key.m_name;
+	}
+
+private:
+	struct Table {
+		std::shared_mutex mutex;
+		/**
+		 * The keys point into "names".
+		 */
+		std::unordered_map<std::string_view, std::uint32_t> ids;
+		/**
+		 * A deque is used since it doesn't move its elements when growing, allowing keys to keep pointers to them.
+		 * The first entry is the empty name, used for id 0.
+		 */
+		std::deque<std::string> names{std::string()};
+	};
+
+	static Table& table() {
+		static Table instance;
+		return instance;
+	}
+
+	static const std::string& emptyName() {
+		return table().names.front();
+	}
+
+	PropertyKey(const std::string* name, std::uint32_t id) noexcept
+			: m_name(name),
+			  m_id(id) {
+	}
+
+	const std::string* m_name;
+	std::uint32_t m_id;
+};
+
+inline PropertyKey::PropertyKey(std::string_view name)
+		: PropertyKey() {
+	if (name.empty()) {
+		return;
+	}
+	if (auto existing = lookup(name)) {
+		*this = *existing;
+		return;
+	}
+	auto& instance = table();
+	std::unique_lock lock(instance.mutex);
+	//Check again, since another thread might have interned it after we released the shared lock.
+	auto I = instance.ids.find(name);
+	if (I != instance.ids.end()) {
+		m_name = &instance.names[I->second];
+		m_id = I->second;
+	} else {
+		auto id = static_cast<std::uint32_t>(instance.names.size());
+		auto& interned = instance.names.emplace_back(name);
+		instance.ids.emplace(interned, id);
+		m_name = &interned;
+		m_id = id;
+	}
+}
+
+inline std::optional<PropertyKey> PropertyKey::lookup(std::string_view name) {
+	if (name.empty()) {
+		return PropertyKey();
+	}
+	auto& instance = table();
+	std::shared_lock lock(instance.mutex);
+	auto I = instance.ids.find(name);
+	if (I == instance.ids.end()) {
+		return std::nullopt;
+	}
+	return PropertyKey(&instance.names[I->second], I->second);
+}
+
+inline std::size_t PropertyKey::internedCount() {
+	auto& instance = table();
+	std::shared_lock lock(instance.mutex);
+	return instance.ids.size();
+}
+
+template<>
+struct std::hash<PropertyKey> {
+	std::size_t operator()(const PropertyKey& key) const noexcept {
+		return key.id();
+	}
+};
+
+template<>
+struct fmt::formatter<PropertyKey> : fmt::formatter<std::string_view> {
+	template<typename FormatContext>
+	auto format(const PropertyKey& key, FormatContext& ctx) const {
+		return fmt::formatter<std::string_view>::format(key.str(), ctx);
+	}
+};
+
+#endif //CYPHESIS_PROPERTYKEY_H
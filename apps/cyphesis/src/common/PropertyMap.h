@@ -0,0 +1,279 @@
+/*
+ Copyright (C) 2026 Erik Ogenvik
+
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#ifndef CYPHESIS_PROPERTYMAP_H
+#define CYPHESIS_PROPERTYMAP_H
+
+#include "PropertyKey.h"
+
+#include <algorithm>
+#include <deque>
+#include <iterator>
+#include <limits>
+#include <utility>
+#include <vector>
+
+/**
+ * A flat map of properties, keyed by interned property names.
+ *
+ * Entries are looked up by scanning a contiguous array of key ids, which for the number of properties an entity or
+ * type normally has is faster than walking a tree, and the key strings aren't duplicated for every instance.
+ *
+ * The interface mirrors the parts of std::map that are used for properties, with one important difference in that
+ * the entries aren't ordered by name. Just like with std::map though, references and iterators are kept valid
+ * when other entries are added or removed. This is needed since installing properties often leads to more
+ * properties being added while iterating.
+ * Removed entries leave a free slot which is reused by later insertions.
+ *
+ * Lookups with a string which has never been interned never allocate; only inserting does.
+ */
+template<typename T>
+class PropertyMap {
+public:
+	using key_type = PropertyKey;
+	using mapped_type = T;
+	using value_type = std::pair<PropertyKey, T>;
+	using size_type = std::size_t;
+
+	template<bool IsConst>
+	class Iterator {
+	public:
+		using iterator_category = std::forward_iterator_tag;
+		using value_type = PropertyMap::value_type;
+		using difference_type = std::ptrdiff_t;
+		using pointer = std::conditional_t<IsConst, const value_type*, value_type*>;
+		using reference = std::conditional_t<IsConst, const value_type&, value_type&>;
+		using map_pointer = std::conditional_t<IsConst, const PropertyMap*, PropertyMap*>;
+
+		Iterator() = default;
+
+		Iterator(map_pointer map, size_type index)
+				: m_map(map),
+				  m_index(index) {
+		}
+
+		/**
+		 * Allow conversion from iterator to const_iterator.
+		 */
+		template<bool OtherConst, typename = std::enable_if_t<IsConst && !OtherConst>>
+		Iterator(const Iterator<OtherConst>& rhs) //NOLINT
+				: m_map(rhs.m_map),
+				  m_index(rhs.m_index) {
+		}
+
+		reference operator*() const {
+			return m_map->m_entries[m_index];
+		}
+
+		pointer operator->() const {
+			return &m_map->m_entries[m_index];
+		}
+
+		Iterator& operator++() {
+			m_index = m_map->nextUsed(m_index + 1);
+			return *this;
+		}
+
+		Iterator operator++(int) {
+			auto copy = *this;
+			++(*this);
+			return copy;
+		}
+
+		/**
+		 * Any position past the last slot is treated as "end", since the end iterator of a range based for loop
+		 * is taken before the loop starts and entries might be added while iterating.
+		 */
+		friend bool operator==(const Iterator& lhs, const Iterator& rhs) {
+			return lhs.position() == rhs.position();
+		}
+
+	private:
+		friend class PropertyMap;
+
+		template<bool>
+		friend
+		class Iterator;
+
+		size_type position() const {
+			return m_map ? std::min(m_index, m_map->m_ids.size()) : 0;
+		}
+
+		map_pointer m_map = nullptr;
+		size_type m_index = 0;
+	};
+
+	using iterator = Iterator<false>;
+	using const_iterator = Iterator<true>;
+
+	iterator begin() {
+		return {this, nextUsed(0)};
+	}
+
+	iterator end() {
+		return {this, npos};
+	}
+
+	const_iterator begin() const {
+		return {this, nextUsed(0)};
+	}
+
+	const_iterator end() const {
+		return {this, npos};
+	}
+
+	size_type size() const {
+		return m_size;
+	}
+
+	bool empty() const {
+		return m_size == 0;
+	}
+
+	iterator find(const PropertyKey& key) {
+		return {this, indexOf(key.id())};
+	}
+
+	const_iterator find(const PropertyKey& key) const {
+		return {this, indexOf(key.id())};
+	}
+
+	iterator find(std::string_view name) {
+		auto key = PropertyKey::lookup(name);
+		return key ? find(*key) : end();
+	}
+
+	const_iterator find(std::string_view name) const {
+		auto key = PropertyKey::lookup(name);
+		return key ? find(*key) : end();
+	}
+
+	bool contains(const PropertyKey& key) const {
+		return indexOf(key.id()) != npos;
+	}
+
+	bool contains(std::string_view name) const {
+		return find(name) != end();
+	}
+
+	T& operator[](const PropertyKey& key) {
+		return emplace(key).first->second;
+	}
+
+	T& operator[](std::string_view name) {
+		return operator[](PropertyKey(name));
+	}
+
+	/**
+	 * Inserts a new entry, unless there already is one with the same key.
+	 * @return An iterator to the entry with the key, and a flag which is true if it was inserted.
+	 */
+	template<typename... Args>
+	std::pair<iterator, bool> emplace(const PropertyKey& key, Args&& ... args) {
+		auto existing = indexOf(key.id());
+		if (existing != npos) {
+			return {iterator{this, existing}, false};
+		}
+		size_type index;
+		if (m_size < m_ids.size()) {
+			index = static_cast<size_type>(std::find(m_ids.begin(), m_ids.end(), free_slot) - m_ids.begin());
+			m_entries[index].first = key;
+			m_entries[index].second = T(std::forward<Args>(args)...);
+			m_ids[index] = key.id();
+		} else {
+			index = m_ids.size();
+			m_entries.emplace_back(std::piecewise_construct, std::forward_as_tuple(key), std::forward_as_tuple(std::forward<Args>(args)...));
+			m_ids.push_back(key.id());
+		}
+		m_size++;
+		return {iterator{this, index}, true};
+	}
+
+	template<typename... Args>
+	std::pair<iterator, bool> emplace(std::string_view name, Args&& ... args) {
+		return emplace(PropertyKey(name), std::forward<Args>(args)...);
+	}
+
+	/**
+	 * Removes the entry. Other iterators, including the supplied one, remain valid.
+	 * @return An iterator to the next entry.
+	 */
+	iterator erase(const_iterator I) {
+		auto index = I.m_index;
+		m_ids[index] = free_slot;
+		//Release whatever the value holds straight away.
+		m_entries[index] = value_type();
+		m_size--;
+		return {this, nextUsed(index + 1)};
+	}
+
+	iterator erase(iterator I) {
+		return erase(const_iterator(I));
+	}
+
+	size_type erase(const PropertyKey& key) {
+		auto index = indexOf(key.id());
+		if (index == npos) {
+			return 0;
+		}
+		erase(const_iterator{this, index});
+		return 1;
+	}
+
+	size_type erase(std::string_view name) {
+		auto key = PropertyKey::lookup(name);
+		return key ? erase(*key) : 0;
+	}
+
+	void clear() {
+		m_ids.clear();
+		m_entries.clear();
+		m_size = 0;
+	}
+
+private:
+	static constexpr size_type npos = std::numeric_limits<size_type>::max();
+	static constexpr std::uint32_t free_slot = std::numeric_limits<std::uint32_t>::max();
+
+	/**
+	 * The ids of the keys of the entries, kept separate so lookups can scan a small contiguous array.
+	 * Removed entries are marked with "free_slot".
+	 */
+	std::vector<std::uint32_t> m_ids;
+
+	/**
+	 * A deque doesn't move its elements when growing, which keeps references valid.
+	 */
+	std::deque<value_type> m_entries;
+
+	size_type m_size = 0;
+
+	size_type indexOf(std::uint32_t id) const {
+		auto I = std::find(m_ids.begin(), m_ids.end(), id);
+		return I == m_ids.end() ? npos : static_cast<size_type>(I - m_ids.begin());
+	}
+
+	size_type nextUsed(size_type index) const {
+		while (index < m_ids.size() && m_ids[index] == free_slot) {
+			++index;
+		}
+		return index;
+	}
+};
+
+#endif //CYPHESIS_PROPERTYMAP_H
@@ -21,6 +21,7 @@
 
 #include "Visibility.h"
 #include "PropertyManager.h"
+#include "PropertyMap.h"
 
 #include <Atlas/Objects/Root.h>
 #include <Atlas/Objects/SmartPtr.h>
@@ -39,8 +40,8 @@ protected:
 	/// \brief name
 	const std::string m_name;
 
-	/// \brief property defaults
-	std::map<std::string, std::unique_ptr<PropertyCore<EntityT>>> m_defaults;
+	/// \brief property defaults, keyed by interned property names
+	PropertyMap<std::unique_ptr<PropertyCore<EntityT>>> m_defaults;
 
 	/// \brief type description, complete
 	Atlas::Objects::Root m_privateDescription;
@@ -64,6 +65,10 @@ public:
 		std::set<std::string> newProps;
 		std::set<std::string> removedProps;
 		std::set<std::string> changedProps;
+
+		bool empty() const {
+			return newProps.empty() && removedProps.empty() && changedProps.empty();
+		}
 	};
 
 
@@ -94,7 +99,7 @@ public:
 	}
 
 	/// \brief const accessor for property defaults
-	const std::map<std::string, std::unique_ptr<PropertyCore<EntityT>>>& defaults() const {
+	const PropertyMap<std::unique_ptr<PropertyCore<EntityT>>>& defaults() const {
 		return m_defaults;
 	}
 
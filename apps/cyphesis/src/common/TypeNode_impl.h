@@ -158,8 +158,7 @@ TypeNode<EntityT>::PropertiesUpdate TypeNode<EntityT>::updateProperties(const Ma
 	// Remove the class properties for the default attributes that
 	// no longer exist
 	for (auto& entry: propertiesUpdate.removedProps) {
-		auto M = m_defaults.find(entry);
-		m_defaults.erase(M);
+		m_defaults.erase(entry);
 	}
 
 
@@ -16,6 +16,18 @@
 // Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
 
 #include "CommHttpClient.h"
+#include "common/log.h"
+
+#ifdef __linux__
+#include <sys/sendfile.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#else
+#include <fstream>
+#include <vector>
+#include <algorithm>
+#endif
 
 static constexpr auto debug_flag = false;
 
@@ -49,14 +61,94 @@ boost::asio::awaitable<void> CommHttpClient::do_read() {
 }
 
 boost::asio::awaitable<void> CommHttpClient::write() {
-	co_await m_requestProcessor.processQuery(mStream, m_headers);
+	std::optional<HttpFileBody> fileBody;
+	co_await m_requestProcessor.processQuery(mStream, m_headers, fileBody);
 	mStream << std::flush;
 	boost::system::error_code ec;
 	co_await boost::asio::async_write(mSocket, mBuffer.data(), boost::asio::redirect_error(boost::asio::use_awaitable, ec));
+	if (!ec && fileBody && fileBody->length > 0) {
+		co_await sendFile(*fileBody);
+	}
 	//Ignore any errors
 	mSocket.close();
 }
 
+#ifdef __linux__
+
+namespace {
+struct FileDescriptor {
+	int fd;
+
+	~FileDescriptor() {
+		if (fd != -1) {
+			::close(fd);
+		}
+	}
+};
+}
+
+boost::asio::awaitable<void> CommHttpClient::sendFile(const HttpFileBody& fileBody) {
+	FileDescriptor file{::open(fileBody.path.c_str(), O_RDONLY | O_CLOEXEC)};
+	if (file.fd == -1) {
+		spdlog::warn("Could not open '{}' for sending.", fileBody.path.generic_string());
+		co_return;
+	}
+
+	//Let the kernel copy the file to the socket, waiting for the socket to become writable whenever its buffer is full.
+	mSocket.non_blocking(true);
+	auto offset = static_cast<off_t>(fileBody.offset);
+	auto remaining = fileBody.length;
+	while (remaining > 0) {
+		auto sent = ::sendfile(mSocket.native_handle(), file.fd, &offset, remaining);
+		if (sent > 0) {
+			remaining -= static_cast<std::uint64_t>(sent);
+		} else if (sent == 0) {
+			//The file has been truncated since the headers were written.
+			spdlog::warn("File '{}' ended before all data could be sent.", fileBody.path.generic_string());
+			co_return;
+		} else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+			boost::system::error_code ec;
+			co_await mSocket.async_wait(boost::asio::ip::tcp::socket::wait_write, boost::asio::redirect_error(boost::asio::use_awaitable, ec));
+			if (ec) {
+				co_return;
+			}
+		} else if (errno != EINTR) {
+			//Most likely the client has closed the connection.
+			co_return;
+		}
+	}
+}
+
+#else
+
+boost::asio::awaitable<void> CommHttpClient::sendFile(const HttpFileBody& fileBody) {
+	std::ifstream is{fileBody.path, std::ios::binary};
+	if (!is) {
+		spdlog::warn("Could not open '{}' for sending.", fileBody.path.generic_string());
+		co_return;
+	}
+	is.seekg(static_cast<std::streamoff>(fileBody.offset));
+
+	//No zero copy support here, but at least the socket is written to asynchronously.
+	std::vector<char> buffer(64 * 1024);
+	auto remaining = fileBody.length;
+	while (remaining > 0 && is) {
+		is.read(buffer.data(), static_cast<std::streamsize>(std::min<std::uint64_t>(buffer.size(), remaining)));
+		auto readSize = static_cast<std::size_t>(is.gcount());
+		if (readSize == 0) {
+			co_return;
+		}
+		boost::system::error_code ec;
+		co_await boost::asio::async_write(mSocket, boost::asio::buffer(buffer.data(), readSize), boost::asio::redirect_error(boost::asio::use_awaitable, ec));
+		if (ec) {
+			co_return;
+		}
+		remaining -= readSize;
+	}
+}
+
+#endif
+
 bool CommHttpClient::read() {
 
 	std::streamsize count;
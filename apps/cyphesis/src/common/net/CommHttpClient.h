@@ -20,14 +20,29 @@
 
 #include <boost/asio.hpp>
 
+#include <cstdint>
+#include <filesystem>
 #include <list>
+#include <optional>
 #include <string>
 #include <memory>
 #include <Atlas/Objects/Factories.h>
 #include "saf/saf.hpp"
 
+/**
+ * A region of a file to send after what has been written to the body stream.
+ * This allows files to be sent straight from the file system to the socket, without being copied through user space.
+ */
+struct HttpFileBody {
+	std::filesystem::path path;
+	std::uint64_t offset;
+	std::uint64_t length;
+};
+
 struct HttpRequestProcessor {
-	virtual boost::asio::awaitable<void> processQuery(std::ostream& body, const std::list<std::string>& headers) = 0;
+	virtual boost::asio::awaitable<void> processQuery(std::ostream& body,
+													  const std::list<std::string>& headers,
+													  std::optional<HttpFileBody>& fileBody) = 0;
 };
 
 /// \brief Handle an internet socket connected to a remote web browser.
@@ -52,6 +67,8 @@ protected:
 
 	boost::asio::awaitable<void> write();
 
+	boost::asio::awaitable<void> sendFile(const HttpFileBody& fileBody);
+
 public:
 	CommHttpClient(const std::string& name,
 				   boost::asio::thread_pool& io_context,
@@ -24,6 +24,8 @@
 #include "common/log.h"
 
 #include <varconf/config.h>
+#include <algorithm>
+#include <cctype>
 #include <fstream>
 
 HttpHandling::HttpHandling(const Monitors& monitors, boost::asio::io_context& contextMain)
@@ -86,8 +88,29 @@ void HttpHandling::reportBadRequest(std::ostream& io,
 	   << "</h1></body></html>\n";
 }
 
+std::optional<std::string_view> HttpHandling::findHeader(const std::list<std::string>& headers, std::string_view name) {
+	if (headers.empty()) {
+		return std::nullopt;
+	}
+	//The first line is the request.
+	for (auto I = std::next(headers.begin()); I != headers.end(); ++I) {
+		std::string_view header = *I;
+		if (header.size() > name.size() && header[name.size()] == ':' &&
+			std::equal(name.begin(), name.end(), header.begin(), [](unsigned char a, unsigned char b) { return std::tolower(a) == std::tolower(b); })) {
+			auto value = header.substr(name.size() + 1);
+			auto start = value.find_first_not_of(" \t");
+			if (start == std::string_view::npos) {
+				return std::string_view{};
+			}
+			return value.substr(start, value.find_last_not_of(" \t") - start + 1);
+		}
+	}
+	return std::nullopt;
+}
+
 boost::asio::awaitable<void> HttpHandling::processQuery(std::ostream& io,
-														const std::list<std::string>& headers) {
+														const std::list<std::string>& headers,
+														std::optional<HttpFileBody>& fileBody) {
 	if (headers.empty()) {
 		reportBadRequest(io);
 		co_return;
@@ -112,7 +135,7 @@ boost::asio::awaitable<void> HttpHandling::processQuery(std::ostream& io,
 	}
 
 	for (auto& handler: mHandlers) {
-		auto result = co_await handler({.io=io, .headers=headers, .path=path});
+		auto result = co_await handler({.io=io, .headers=headers, .path=path, .fileBody=fileBody});
 		if (result == HandleResult::Handled) {
 			co_return;
 		}
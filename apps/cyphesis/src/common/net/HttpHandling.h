@@ -21,6 +21,8 @@
 
 #include <list>
 #include <string>
+#include <string_view>
+#include <optional>
 #include <filesystem>
 #include "common/Monitors.h"
 #include "CommHttpClient.h"
@@ -30,6 +32,10 @@ struct HttpHandleContext {
 	std::ostream& io;
 	const std::list<std::string>& headers;
 	const std::string& path;
+	/**
+	 * Set by handlers which want a file to be sent after what's been written to "io".
+	 */
+	std::optional<HttpFileBody>& fileBody;
 };
 
 
@@ -45,7 +51,7 @@ public:
 
 	explicit HttpHandling(const Monitors& monitors, boost::asio::io_context& contextMain);
 
-	boost::asio::awaitable<void> processQuery(std::ostream&, const std::list<std::string>&) override;
+	boost::asio::awaitable<void> processQuery(std::ostream&, const std::list<std::string>&, std::optional<HttpFileBody>&) override;
 
 	std::vector<HttpHandler> mHandlers;
 
@@ -59,6 +65,11 @@ public:
 								 int status = 400,
 								 const std::string& mesg = "Bad Request");
 
+	/**
+	 * Finds the value of a header, matching the name without regard to case.
+	 */
+	static std::optional<std::string_view> findHeader(const std::list<std::string>& headers, std::string_view name);
+
 private:
 	const Monitors& m_monitors;
 	boost::asio::io_context& m_contextMain;
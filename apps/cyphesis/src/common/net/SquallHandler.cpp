@@ -20,40 +20,272 @@
 #include "common/log.h"
 #include "bytesize/bytesize.hh"
 
+#include <algorithm>
+#include <cctype>
+#include <charconv>
 #include <filesystem>
 #include <fstream>
+#include <list>
+#include <mutex>
+#include <unordered_map>
 
-HttpHandling::HttpHandler buildSquallHandler(std::filesystem::path repositoryDataPath) {
-	return [repositoryDataPath = std::move(repositoryDataPath)](HttpHandleContext context) ->boost::asio::awaitable< HttpHandling::HandleResult> {
+namespace {
+
+/**
+ * Only allowing alphanumeric characters also makes sure that no path outside the repository can be reached.
+ */
+bool isValidSignature(std::string_view signature) {
+	return !signature.empty() && signature.size() <= 64 && std::all_of(signature.begin(), signature.end(), [](unsigned char c) { return std::isalnum(c); });
+}
+
+/**
+ * Extracts the signature from a path in the form used in the repository, i.e. "<first two characters>/<remaining characters>".
+ */
+std::optional<std::string> parseSignature(std::string_view segment) {
+	if (segment.size() < 4 || segment[2] != '/') {
+		return std::nullopt;
+	}
+	std::string signature;
+	signature.reserve(segment.size() - 1);
+	signature.append(segment.substr(0, 2)).append(segment.substr(3));
+	if (!isValidSignature(signature)) {
+		return std::nullopt;
+	}
+	return signature;
+}
+
+/**
+ * Extracts the signatures from a delta path, i.e. "<base signature>/<target signature>".
+ */
+std::optional<std::pair<std::string, std::string>> parseDeltaSignatures(std::string_view segment) {
+	auto slash = segment.find('/');
+	if (slash == std::string_view::npos) {
+		return std::nullopt;
+	}
+	auto base = segment.substr(0, slash);
+	auto target = segment.substr(slash + 1);
+	if (!isValidSignature(base) || !isValidSignature(target)) {
+		return std::nullopt;
+	}
+	return std::make_pair(std::string(base), std::string(target));
+}
+
+std::optional<std::uint64_t> parseNumber(std::string_view value) {
+	std::uint64_t number;
+	auto result = std::from_chars(value.data(), value.data() + value.size(), number);
+	if (result.ec != std::errc() || result.ptr != value.data() + value.size()) {
+		return std::nullopt;
+	}
+	return number;
+}
+
+struct ByteRange {
+	enum class Type {
+		Full, Partial, Unsatisfiable
+	};
+	Type type;
+	std::uint64_t offset;
+	std::uint64_t length;
+};
+
+/**
+ * Parses the value of a "Range" header.
+ * Only single ranges are supported; if multiple ranges are requested, or if the header can't be parsed, the whole file
+ * is sent, which is allowed by RFC 9110.
+ */
+ByteRange parseRange(std::string_view value, std::uint64_t size) {
+	ByteRange full{.type=ByteRange::Type::Full, .offset=0, .length=size};
+	if (!value.starts_with("bytes=") || value.find(',') != std::string_view::npos) {
+		return full;
+	}
+	value.remove_prefix(6);
+	auto dash = value.find('-');
+	if (dash == std::string_view::npos) {
+		return full;
+	}
+	auto firstValue = value.substr(0, dash);
+	auto lastValue = value.substr(dash + 1);
+	if (firstValue.empty()) {
+		//A suffix range, i.e. the last bytes of the file.
+		auto suffixLength = parseNumber(lastValue);
+		if (!suffixLength) {
+			return full;
+		}
+		if (*suffixLength == 0 || size == 0) {
+			return {.type=ByteRange::Type::Unsatisfiable};
+		}
+		auto length = std::min(*suffixLength, size);
+		return {.type=ByteRange::Type::Partial, .offset=size - length, .length=length};
+	}
+	auto first = parseNumber(firstValue);
+	if (!first) {
+		return full;
+	}
+	auto last = size == 0 ? 0 : size - 1;
+	if (!lastValue.empty()) {
+		auto requestedLast = parseNumber(lastValue);
+		if (!requestedLast || *requestedLast < *first) {
+			return full;
+		}
+		last = std::min(*requestedLast, last);
+	}
+	if (*first >= size) {
+		return {.type=ByteRange::Type::Unsatisfiable};
+	}
+	return {.type=ByteRange::Type::Partial, .offset=*first, .length=last - *first + 1};
+}
+
+bool matchesETag(std::string_view ifNoneMatch, std::string_view etag) {
+	return ifNoneMatch == "*" || ifNoneMatch.find(etag) != std::string_view::npos;
+}
+
+/**
+ * Keeps the content of small files in memory.
+ * When a client syncs it first fetches all manifests, so whenever a new version of the assets is published, the same
+ * (small) manifest files will be requested by every client. Since files are addressed by signature they never change,
+ * so entries never need to be invalidated.
+ */
+class HotFileCache {
+public:
+	static constexpr std::uint64_t maxFileSize = 64 * 1024;
+	static constexpr std::uint64_t maxSize = 8 * 1024 * 1024;
+
+	std::shared_ptr<const std::string> get(const std::string& signature) {
+		std::lock_guard lock(mMutex);
+		auto I = mIndex.find(signature);
+		if (I == mIndex.end()) {
+			return {};
+		}
+		//Move to front, as the most recently used.
+		mEntries.splice(mEntries.begin(), mEntries, I->second);
+		return I->second->second;
+	}
+
+	void put(const std::string& signature, std::shared_ptr<const std::string> content) {
+		std::lock_guard lock(mMutex);
+		if (mIndex.contains(signature)) {
+			return;
+		}
+		mSize += content->size();
+		mEntries.emplace_front(signature, std::move(content));
+		mIndex.emplace(signature, mEntries.begin());
+		while (mSize > maxSize) {
+			auto& last = mEntries.back();
+			mSize -= last.second->size();
+			mIndex.erase(last.first);
+			mEntries.pop_back();
+		}
+	}
+
+private:
+	std::mutex mMutex;
+	std::list<std::pair<std::string, std::shared_ptr<const std::string>>> mEntries;
+	std::unordered_map<std::string, decltype(mEntries)::iterator> mIndex;
+	std::uint64_t mSize = 0;
+};
+
+std::shared_ptr<const std::string> readFile(const std::filesystem::path& path, std::uint64_t offset, std::uint64_t size) {
+	std::ifstream is{path, std::ios::binary};
+	if (!is) {
+		return {};
+	}
+	is.seekg(static_cast<std::streamoff>(offset));
+	std::string content(size, '\0');
+	is.read(content.data(), static_cast<std::streamsize>(size));
+	if (static_cast<std::uint64_t>(is.gcount()) != size) {
+		return {};
+	}
+	return std::make_shared<const std::string>(std::move(content));
+}
+
+}
+
+HttpHandling::HttpHandler buildSquallHandler(Squall::Repository repository) {
+	auto cache = std::make_shared<HotFileCache>();
+	return [repository = std::move(repository), cache](HttpHandleContext context) -> boost::asio::awaitable<HttpHandling::HandleResult> {
 		if (context.path.starts_with("/squall/")) {
-			auto squallPathSegment = context.path.substr(8);
-			auto squallPath = repositoryDataPath / squallPathSegment;
-			auto absolutePath = std::filesystem::absolute(squallPath);
-			auto relative = std::filesystem::relative(absolutePath, repositoryDataPath);
-			if (relative.empty()) {
-				spdlog::warn("Requested path {} is not relative to squall root path. Someone is trying to compromise the system.", context.path);
+			auto squallPathSegment = std::string_view(context.path).substr(8);
+			//Deltas between two versions of a file are addressed by both signatures.
+			std::optional<std::pair<std::string, std::string>> deltaSignatures;
+			std::optional<std::string> signature;
+			if (squallPathSegment.starts_with("deltas/")) {
+				deltaSignatures = parseDeltaSignatures(squallPathSegment.substr(7));
+				if (deltaSignatures) {
+					signature = deltaSignatures->first + "/" + deltaSignatures->second;
+				}
+			} else {
+				signature = parseSignature(squallPathSegment);
+			}
+			if (!signature) {
+				spdlog::warn("Requested path {} is not a valid squall path. Someone is trying to compromise the system.", context.path);
 				HttpHandling::reportBadRequest(context.io, 401, "Invalid request");
+				co_return HttpHandling::HandleResult::Handled;
+			}
+
+			//Files are addressed by their signatures, so they can be cached forever by clients.
+			auto etag = fmt::format("\"{}\"", *signature);
+			std::vector<std::string> cacheHeaders{fmt::format("ETag: {}", etag), "Cache-Control: public, max-age=31536000, immutable"};
+
+			auto content = cache->get(*signature);
+			Squall::FetchResult fetchResult{};
+			std::uint64_t size;
+			if (content) {
+				size = content->size();
 			} else {
-				if (!std::filesystem::exists(absolutePath)) {
+				fetchResult = deltaSignatures ? repository.fetchDelta(deltaSignatures->first, deltaSignatures->second) : repository.fetch(*signature);
+				std::error_code ec;
+				size = fetchResult.packLocation ? fetchResult.packLocation->size : std::filesystem::file_size(fetchResult.localPath, ec);
+				if (fetchResult.status != Squall::FetchStatus::SUCCESS || ec) {
 					spdlog::debug("Squall path '{}'not found.", context.path);
 					HttpHandling::reportBadRequest(context.io, 404, "Not Found");
-				} else {
-					if (std::ifstream is{absolutePath, std::ios::binary | std::ios::ate}) {
-						auto size = is.tellg();
-						spdlog::debug("Serving up '{}', with size of {}.", absolutePath.generic_string(), bytesize::bytesize(size));
-						is.seekg(0, std::ios::beg);
-						HttpHandling::sendHeaders(context.io, 200, "application/octet-stream", "OK", {fmt::format("Content-Length: {}", std::to_string(size))});
-
-						//Blocking write here, should be improved
-						std::array<char, 2028> buffer{};
-						while (is) {
-							is.read(buffer.data(), buffer.size());
-							auto readSize = is.gcount();
-							context.io.write(buffer.data(), readSize);
-						}
-					}
+					co_return HttpHandling::HandleResult::Handled;
 				}
 			}
+			//Data stored in a pack is found at an offset into the pack file.
+			auto baseOffset = fetchResult.packLocation ? fetchResult.packLocation->offset : 0;
+
+			auto ifNoneMatch = HttpHandling::findHeader(context.headers, "If-None-Match");
+			if (ifNoneMatch && matchesETag(*ifNoneMatch, etag)) {
+				HttpHandling::sendHeaders(context.io, 304, "application/octet-stream", "Not Modified", std::move(cacheHeaders));
+				co_return HttpHandling::HandleResult::Handled;
+			}
+
+			ByteRange range{.type=ByteRange::Type::Full, .offset=0, .length=size};
+			if (auto rangeHeader = HttpHandling::findHeader(context.headers, "Range")) {
+				range = parseRange(*rangeHeader, size);
+			}
+
+			auto headers = std::move(cacheHeaders);
+			headers.emplace_back("Accept-Ranges: bytes");
+			if (range.type == ByteRange::Type::Unsatisfiable) {
+				headers.emplace_back(fmt::format("Content-Range: bytes */{}", size));
+				headers.emplace_back("Content-Length: 0");
+				HttpHandling::sendHeaders(context.io, 416, "application/octet-stream", "Range Not Satisfiable", std::move(headers));
+				co_return HttpHandling::HandleResult::Handled;
+			}
+
+			if (!content && size <= HotFileCache::maxFileSize) {
+				content = readFile(fetchResult.localPath, baseOffset, size);
+				if (content) {
+					cache->put(*signature, content);
+				}
+			}
+
+			spdlog::debug("Serving up '{}', with size of {}.", *signature, bytesize::bytesize(range.length));
+			headers.emplace_back(fmt::format("Content-Length: {}", range.length));
+			if (range.type == ByteRange::Type::Partial) {
+				headers.emplace_back(fmt::format("Content-Range: bytes {}-{}/{}", range.offset, range.offset + range.length - 1, size));
+				HttpHandling::sendHeaders(context.io, 206, "application/octet-stream", "Partial Content", std::move(headers));
+			} else {
+				HttpHandling::sendHeaders(context.io, 200, "application/octet-stream", "OK", std::move(headers));
+			}
+
+			if (content) {
+				context.io.write(content->data() + range.offset, static_cast<std::streamsize>(range.length));
+			} else {
+				//Let the connection send the file straight to the socket.
+				context.fileBody = HttpFileBody{.path=fetchResult.localPath, .offset=baseOffset + range.offset, .length=range.length};
+			}
 			co_return HttpHandling::HandleResult::Handled;
 		} else {
 			co_return HttpHandling::HandleResult::Ignored;
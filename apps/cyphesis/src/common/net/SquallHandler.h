@@ -20,8 +20,13 @@
 #define CYPHESIS_SQUALLHANDLER_H
 
 #include "HttpHandling.h"
+#include <squall/core/Repository.h>
 
-HttpHandling::HttpHandler buildSquallHandler(std::filesystem::path repositoryDataPath);
+/**
+ * Builds a handler which serves data from the repository, whether stored as loose files or in packs.
+ * Packs written to the repository later on, for example by "squall pack", are picked up as they appear.
+ */
+HttpHandling::HttpHandler buildSquallHandler(Squall::Repository repository);
 
 
 #endif //CYPHESIS_SQUALLHANDLER_H
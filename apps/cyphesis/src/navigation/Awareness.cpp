@@ -84,6 +84,7 @@
 #include <boost/multi_index/identity.hpp>
 #include <boost/multi_index/sequenced_index.hpp>
 
+#include <atomic>
 #include <cmath>
 #include <vector>
 #include <cstring>
@@ -167,6 +168,46 @@ protected:
 
 };
 
+/**
+ * Everything needed to rasterize a tile. All data is copied, so that rasterization can happen on another thread.
+ */
+struct TileRasterizationInput {
+	int tx;
+	int ty;
+	/**
+	 * The configuration, adjusted to the bounds of the tile.
+	 */
+	rcConfig cfg;
+	int heightsXMin;
+	int heightsYMin;
+	int sizeX;
+	int sizeY;
+	/**
+	 * Terrain heights with 1 meter interval, covering the tile.
+	 */
+	std::vector<float> heights;
+	std::vector<WFMath::RotBox<2>> entityAreas;
+};
+
+/**
+ * A tile which is being rasterized on another thread.
+ */
+struct TileBuild {
+	/**
+	 * Set by the rasterizing thread once "tiles" and "ntiles" have been filled in.
+	 */
+	std::atomic<bool> done{false};
+	TileCacheData tiles[MAX_LAYERS]{};
+	int ntiles = 0;
+
+	~TileBuild() {
+		//Free any data which never was handed over to the tile cache.
+		for (int i = 0; i < ntiles; ++i) {
+			dtFree(tiles[i].data);
+		}
+	}
+};
+
 Awareness::Awareness(long domainEntityId,
 					 float agentRadius,
 					 float agentHeight,
@@ -190,7 +231,8 @@ Awareness::Awareness(long domainEntityId,
 		mNavQuery(dtAllocNavMeshQuery()),
 		mFilter(new dtQueryFilter()),
 		mActiveTileList(new MRUList<std::pair<int, int>>()),
-		mObserverCount(0) {
+		mObserverCount(0),
+		mMaxConcurrentBuilds(0) {
 	auto validExtent = extent;
 	if (!extent.isValid()) {
 		::spdlog::warn("No valid extent, will default to small area");
@@ -707,19 +749,23 @@ void Awareness::markTilesAsDirty(int tileMinXIndex, int tileMaxXIndex, int tileM
 	}
 }
 
+void Awareness::setExecutor(Executor executor, size_t maxConcurrentBuilds) {
+	mExecutor = std::move(executor);
+	mMaxConcurrentBuilds = std::max<size_t>(maxConcurrentBuilds, 1);
+}
+
 size_t Awareness::rebuildDirtyTile() {
+	if (mExecutor) {
+		return rebuildDirtyTilesConcurrently();
+	}
 	if (!mDirtyAwareTiles.empty()) {
 		cy_debug_print("Rebuilding aware tiles. Number of dirty aware tiles: " << mDirtyAwareTiles.size())
 		rmt_ScopedCPUSample(rebuildDirtyTile, 0)
 		const auto tileIndexI = mDirtyAwareOrderedTiles.begin();
 		const auto& tileIndex = *tileIndexI;
 
-		float tilesize = mCfg.tileSize * mCfg.cs;
-		WFMath::AxisBox<2> adjustedArea(WFMath::Point<2>(mCfg.bmin[0] + (tileIndex.first * tilesize), mCfg.bmin[2] + (tileIndex.second * tilesize)),
-										WFMath::Point<2>(mCfg.bmin[0] + ((tileIndex.first + 1) * tilesize), mCfg.bmin[2] + ((tileIndex.second + 1) * tilesize)));
-
 		std::vector<WFMath::RotBox<2>> entityAreas;
-            mEntityTracker.findEntityAreas(adjustedArea, entityAreas);
+		mEntityTracker.findEntityAreas(getTileArea(tileIndex.first, tileIndex.second), entityAreas);
 
 		rebuildTile(tileIndex.first, tileIndex.second, entityAreas);
 		mDirtyAwareTiles.erase(tileIndex);
@@ -728,6 +774,64 @@ size_t Awareness::rebuildDirtyTile() {
 	return mDirtyAwareTiles.size();
 }
 
+size_t Awareness::rebuildDirtyTilesConcurrently() {
+	rmt_ScopedCPUSample(rebuildDirtyTilesConcurrently, 0)
+	//First add any tiles which are done.
+	for (auto I = mTileBuilds.begin(); I != mTileBuilds.end();) {
+		auto& build = *I->second;
+		if (!build.done.load(std::memory_order_acquire)) {
+			++I;
+			continue;
+		}
+		//If the tile has been marked as dirty again while it was rasterized the result is already outdated.
+		if (mDirtyAwareTiles.find(I->first) == mDirtyAwareTiles.end()) {
+			if (mAwareTiles.find(I->first) == mAwareTiles.end()) {
+				//No one is aware of the tile anymore; treat it as any other unaware tile that's out of date.
+				mDirtyUnwareTiles.insert(I->first);
+			} else {
+				addTileLayers(I->first.first, I->first.second, build.tiles, build.ntiles);
+				//The tile cache now owns the data.
+				build.ntiles = 0;
+			}
+		}
+		I = mTileBuilds.erase(I);
+	}
+
+	//Then start rasterizing dirty tiles, in order of precedence.
+	for (auto I = mDirtyAwareOrderedTiles.begin(); I != mDirtyAwareOrderedTiles.end() && mTileBuilds.size() < mMaxConcurrentBuilds;) {
+		auto tileIndex = *I;
+		//Wait for any earlier rasterization of the same tile to be done, so that they are added in order.
+		if (mTileBuilds.find(tileIndex) != mTileBuilds.end()) {
+			++I;
+			continue;
+		}
+		cy_debug_print("Rasterizing aware tile in background. Number of dirty aware tiles: " << mDirtyAwareTiles.size())
+
+		std::vector<WFMath::RotBox<2>> entityAreas;
+		mEntityTracker.findEntityAreas(getTileArea(tileIndex.first, tileIndex.second), entityAreas);
+
+		auto input = std::make_shared<TileRasterizationInput>(prepareTileRasterization(tileIndex.first, tileIndex.second, std::move(entityAreas)));
+		auto build = std::make_shared<TileBuild>();
+		mTileBuilds.emplace(tileIndex, build);
+		mExecutor([input, build]() {
+			AwarenessContext ctx;
+			build->ntiles = rasterizeTileLayers(ctx, *input, build->tiles, MAX_LAYERS);
+			build->done.store(true, std::memory_order_release);
+		});
+
+		mDirtyAwareTiles.erase(tileIndex);
+		I = mDirtyAwareOrderedTiles.erase(I);
+	}
+
+	return mDirtyAwareTiles.size() + mTileBuilds.size();
+}
+
+WFMath::AxisBox<2> Awareness::getTileArea(int tx, int ty) const {
+	float tilesize = mCfg.tileSize * mCfg.cs;
+	return {WFMath::Point<2>(mCfg.bmin[0] + (tx * tilesize), mCfg.bmin[2] + (ty * tilesize)),
+			WFMath::Point<2>(mCfg.bmin[0] + ((tx + 1) * tilesize), mCfg.bmin[2] + ((ty + 1) * tilesize))};
+}
+
 void Awareness::pruneTiles() {
 	//remove any tiles that aren't used
 	if (mActiveTileList->size() > mAwareTiles.size()) {
@@ -1064,8 +1168,12 @@ void Awareness::rebuildTile(int tx, int ty, const std::vector<WFMath::RotBox<2>>
 	TileCacheData tiles[MAX_LAYERS];
 	memset(tiles, 0, sizeof(tiles));
 
-	int ntiles = rasterizeTileLayers(entityAreas, tx, ty, tiles, MAX_LAYERS);
+	int ntiles = rasterizeTileLayers(*mCtx, prepareTileRasterization(tx, ty, entityAreas), tiles, MAX_LAYERS);
 
+	addTileLayers(tx, ty, tiles, ntiles);
+}
+
+void Awareness::addTileLayers(int tx, int ty, TileCacheData* tiles, int ntiles) {
 	for (int j = 0; j < ntiles; ++j) {
 		TileCacheData* tile = &tiles[j];
 
@@ -1095,18 +1203,18 @@ void Awareness::rebuildTile(int tx, int ty, const std::vector<WFMath::RotBox<2>>
 
 }
 
-int Awareness::rasterizeTileLayers(const std::vector<WFMath::RotBox<2>>& entityAreas, int tx, int ty, TileCacheData* tiles, int maxTiles) {
-	rmt_ScopedCPUSample(rasterizeTileLayers, 0)
-	std::vector<float> vertsVector;
-	std::vector<int> trisVector;
-
-	FastLZCompressor comp;
-	RasterizationContext rc;
+TileRasterizationInput Awareness::prepareTileRasterization(int tx, int ty, std::vector<WFMath::RotBox<2>> entityAreas) {
+	TileRasterizationInput input{
+			.tx = tx,
+			.ty = ty,
+			.cfg = mCfg,
+			.entityAreas = std::move(entityAreas)
+	};
 
 // Tile bounds.
 	const float tcs = mCfg.tileSize * mCfg.cs;
 
-	rcConfig tcfg = mCfg;
+	rcConfig& tcfg = input.cfg;
 
 	tcfg.bmin[0] = mCfg.bmin[0] + tx * tcs;
 	tcfg.bmin[1] = mCfg.bmin[1];
@@ -1124,17 +1232,39 @@ int Awareness::rasterizeTileLayers(const std::vector<WFMath::RotBox<2>>& entityA
 	int heightsXMax = static_cast<int>(std::ceil(tcfg.bmax[0]) + 1);
 	int heightsYMin = static_cast<int>(std::floor(tcfg.bmin[2]) - 1);
 	int heightsYMax = static_cast<int>(std::ceil(tcfg.bmax[2]) + 1);
-	int sizeX = heightsXMax - heightsXMin;
-	int sizeY = heightsYMax - heightsYMin;
+	input.heightsXMin = heightsXMin;
+	input.heightsYMin = heightsYMin;
+	input.sizeX = heightsXMax - heightsXMin;
+	input.sizeY = heightsYMax - heightsYMin;
 
-	//Blit height values with 1 meter interval
-	std::vector<float> heights(sizeX * sizeY);
+	//Blit height values with 1 meter interval. This is done here, since the height provider only can be accessed from the main thread.
+	input.heights.resize(input.sizeX * input.sizeY);
 	{
 		rmt_ScopedCPUSample(blitHeights, 0)
-		mHeightProvider.blitHeights(heightsXMin, heightsXMax, heightsYMin, heightsYMax, heights);
-		float* heightData = heights.data();
-		for (int y = heightsYMin; y < heightsYMax; ++y) {
-			for (int x = heightsXMin; x < heightsXMax; ++x) {
+		mHeightProvider.blitHeights(heightsXMin, heightsXMax, heightsYMin, heightsYMax, input.heights);
+	}
+	return input;
+}
+
+int Awareness::rasterizeTileLayers(rcContext& ctx, const TileRasterizationInput& input, TileCacheData* tiles, int maxTiles) {
+	rmt_ScopedCPUSample(rasterizeTileLayers, 0)
+	std::vector<float> vertsVector;
+	std::vector<int> trisVector;
+
+	FastLZCompressor comp;
+	RasterizationContext rc;
+
+	auto& tcfg = input.cfg;
+	auto& entityAreas = input.entityAreas;
+	int tx = input.tx;
+	int ty = input.ty;
+	int sizeX = input.sizeX;
+	int sizeY = input.sizeY;
+
+	{
+		const float* heightData = input.heights.data();
+		for (int y = input.heightsYMin; y < input.heightsYMin + sizeY; ++y) {
+			for (int x = input.heightsXMin; x < input.heightsXMin + sizeX; ++x) {
 				vertsVector.push_back(x);
 				vertsVector.push_back(*heightData);
 				vertsVector.push_back(y);
@@ -1165,13 +1295,13 @@ int Awareness::rasterizeTileLayers(const std::vector<WFMath::RotBox<2>>& entityA
 // Allocate voxel heightfield where we rasterize our input data to.
 	rc.solid = rcAllocHeightfield();
 	if (!rc.solid) {
-		mCtx->log(RC_LOG_ERROR, "buildNavigation: Out of memory 'solid'.");
+		ctx.log(RC_LOG_ERROR, "buildNavigation: Out of memory 'solid'.");
 		return 0;
 	}
 	{
 		rmt_ScopedCPUSample(rcCreateHeightfield, 0)
-		if (!rcCreateHeightfield(mCtx.get(), *rc.solid, tcfg.width, tcfg.height, tcfg.bmin, tcfg.bmax, tcfg.cs, tcfg.ch)) {
-			mCtx->log(RC_LOG_ERROR, "buildNavigation: Could not create solid heightfield.");
+		if (!rcCreateHeightfield(&ctx, *rc.solid, tcfg.width, tcfg.height, tcfg.bmin, tcfg.bmax, tcfg.cs, tcfg.ch)) {
+			ctx.log(RC_LOG_ERROR, "buildNavigation: Could not create solid heightfield.");
 			return 0;
 		}
 	}
@@ -1179,18 +1309,18 @@ int Awareness::rasterizeTileLayers(const std::vector<WFMath::RotBox<2>>& entityA
 // Allocate array that can hold triangle flags.
 	rc.triareas = new unsigned char[ntris];
 	if (!rc.triareas) {
-		mCtx->log(RC_LOG_ERROR, "buildNavigation: Out of memory 'm_triareas' (%d).", ntris / 3);
+		ctx.log(RC_LOG_ERROR, "buildNavigation: Out of memory 'm_triareas' (%d).", ntris / 3);
 		return 0;
 	}
 
 	memset(rc.triareas, 0, ntris * sizeof(unsigned char));
 	{
 		rmt_ScopedCPUSample(rcMarkWalkableTriangles, 0)
-                rcMarkWalkableTriangles(mCtx.get(), tcfg.walkableSlopeAngle, verts, tris, ntris, rc.triareas);
+                rcMarkWalkableTriangles(&ctx, tcfg.walkableSlopeAngle, verts, tris, ntris, rc.triareas);
 	}
 	{
 		rmt_ScopedCPUSample(rcRasterizeTriangles, 0)
-                rcRasterizeTriangles(mCtx.get(), verts, tris, rc.triareas, ntris, *rc.solid, tcfg.walkableClimb);
+                rcRasterizeTriangles(&ctx, verts, tris, rc.triareas, ntris, *rc.solid, tcfg.walkableClimb);
 	}
 // Once all geometry is rasterized, we do initial pass of filtering to
 // remove unwanted overhangs caused by the conservative rasterization
@@ -1204,13 +1334,13 @@ int Awareness::rasterizeTileLayers(const std::vector<WFMath::RotBox<2>>& entityA
 
 	rc.chf = rcAllocCompactHeightfield();
 	if (!rc.chf) {
-		mCtx->log(RC_LOG_ERROR, "buildNavigation: Out of memory 'chf'.");
+		ctx.log(RC_LOG_ERROR, "buildNavigation: Out of memory 'chf'.");
 		return 0;
 	}
 	{
 		rmt_ScopedCPUSample(rcBuildCompactHeightfield, 0)
-		if (!rcBuildCompactHeightfield(mCtx.get(), tcfg.walkableHeight, tcfg.walkableClimb, *rc.solid, *rc.chf)) {
-			mCtx->log(RC_LOG_ERROR, "buildNavigation: Could not build compact data.");
+		if (!rcBuildCompactHeightfield(&ctx, tcfg.walkableHeight, tcfg.walkableClimb, *rc.solid, *rc.chf)) {
+			ctx.log(RC_LOG_ERROR, "buildNavigation: Could not build compact data.");
 			return 0;
 		}
 	}
@@ -1219,8 +1349,8 @@ int Awareness::rasterizeTileLayers(const std::vector<WFMath::RotBox<2>>& entityA
 	{
 		rmt_ScopedCPUSample(rcErodeWalkableArea, 0)
 
-		if (!rcErodeWalkableArea(mCtx.get(), tcfg.walkableRadius, *rc.chf)) {
-			mCtx->log(RC_LOG_ERROR, "buildNavigation: Could not erode.");
+		if (!rcErodeWalkableArea(&ctx, tcfg.walkableRadius, *rc.chf)) {
+			ctx.log(RC_LOG_ERROR, "buildNavigation: Could not erode.");
 			return 0;
 		}
 	}
@@ -1247,18 +1377,18 @@ int Awareness::rasterizeTileLayers(const std::vector<WFMath::RotBox<2>>& entityA
 			areaVerts[10] = 0;
 			areaVerts[11] = rotbox.getCorner(0).y();
 
-			rcMarkConvexPolyArea(mCtx.get(), areaVerts, 4, tcfg.bmin[1], tcfg.bmax[1], DT_TILECACHE_NULL_AREA, *rc.chf);
+			rcMarkConvexPolyArea(&ctx, areaVerts, 4, tcfg.bmin[1], tcfg.bmax[1], DT_TILECACHE_NULL_AREA, *rc.chf);
 		}
 	}
 	rc.lset = rcAllocHeightfieldLayerSet();
 	if (!rc.lset) {
-		mCtx->log(RC_LOG_ERROR, "buildNavigation: Out of memory 'lset'.");
+		ctx.log(RC_LOG_ERROR, "buildNavigation: Out of memory 'lset'.");
 		return 0;
 	}
 	{
 		rmt_ScopedCPUSample(rcBuildHeightfieldLayers, 0)
-		if (!rcBuildHeightfieldLayers(mCtx.get(), *rc.chf, tcfg.borderSize, tcfg.walkableHeight, *rc.lset)) {
-			mCtx->log(RC_LOG_ERROR, "buildNavigation: Could not build heighfield layers.");
+		if (!rcBuildHeightfieldLayers(&ctx, *rc.chf, tcfg.borderSize, tcfg.walkableHeight, *rc.lset)) {
+			ctx.log(RC_LOG_ERROR, "buildNavigation: Could not build heighfield layers.");
 			return 0;
 		}
 	}
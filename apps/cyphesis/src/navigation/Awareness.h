@@ -70,6 +70,8 @@ class MRUList;
 
 struct TileCacheData;
 struct InputGeometry;
+struct TileRasterizationInput;
+struct TileBuild;
 
 enum PolyAreas {
 	POLYAREA_GROUND, POLYAREA_WATER, POLYAREA_ROAD, POLYAREA_DOOR, POLYAREA_GRASS, POLYAREA_JUMP,
@@ -140,9 +142,26 @@ public:
 
 	size_t unawareTilesInArea(const std::string& areaId) const;
 
+	/**
+	 * @brief Runs a task, possibly on another thread.
+	 */
+	typedef std::function<void(std::function<void()>)> Executor;
+
+	/**
+	 * @brief Sets an executor to use for rasterizing tiles.
+	 *
+	 * When set, the costly rasterization of tiles is done through the executor, leaving only the
+	 * gathering of input data and the adding of the finished tiles to the calling thread.
+	 * @param executor An executor, or an empty function to rasterize on the calling thread.
+	 * @param maxConcurrentBuilds The max number of tiles to rasterize at the same time.
+	 */
+	void setExecutor(Executor executor, size_t maxConcurrentBuilds);
+
 	/**
 	 * @brief Rebuilds a dirty tile if any such exists.
-	 * @return The number of dirty tiles remaining.
+	 *
+	 * If an executor is set, finished tiles are added and new dirty tiles are sent off for rasterization instead.
+	 * @return The number of dirty tiles remaining, including those being rasterized.
 	 */
 	size_t rebuildDirtyTile();
 
@@ -425,6 +444,18 @@ protected:
 	 */
 	size_t mObserverCount;
 
+	/**
+	 * @brief Used for rasterizing tiles on other threads, if set.
+	 */
+	Executor mExecutor;
+
+	size_t mMaxConcurrentBuilds;
+
+	/**
+	 * @brief Tiles that are being rasterized through the executor.
+	 */
+	std::map<std::pair<int, int>, std::shared_ptr<TileBuild>> mTileBuilds;
+
 	/**
 	 * Processes updates to an entity, and reacts if the position changed.
 	 * @param entry
@@ -444,15 +475,44 @@ protected:
         void rebuildTile(int tx, int ty, const std::vector<WFMath::RotBox<2>>& entityAreas);
 
 	/**
-	 * @brief Rasterizes the tile at the specified index.
-	 * @param entityAreas The entity areas that affects the tile.
+	 * @brief Adds newly rasterized tile layers to the tile cache, and rebuilds the nav mesh tile.
 	 * @param tx X index.
 	 * @param ty Y index.
+	 * @param tiles The tile layers. Ownership of the data is transferred to the tile cache.
+	 * @param ntiles The number of tile layers.
+	 */
+	void addTileLayers(int tx, int ty, TileCacheData* tiles, int ntiles);
+
+	/**
+	 * @brief Sends dirty tiles off to the executor, and adds those that are done.
+	 * @return The number of dirty tiles remaining, including those being rasterized.
+	 */
+	size_t rebuildDirtyTilesConcurrently();
+
+	/**
+	 * @brief Gets the area covered by a tile, without borders.
+	 */
+	WFMath::AxisBox<2> getTileArea(int tx, int ty) const;
+
+	/**
+	 * @brief Gathers all data needed for rasterizing the tile at the specified index.
+	 * @param tx X index.
+	 * @param ty Y index.
+	 * @param entityAreas The entity areas that affects the tile.
+	 */
+	TileRasterizationInput prepareTileRasterization(int tx, int ty, std::vector<WFMath::RotBox<2>> entityAreas);
+
+	/**
+	 * @brief Rasterizes a tile.
+	 *
+	 * This only uses the supplied data, so it's safe to call from any thread.
+	 * @param ctx A Recast context.
+	 * @param input The data gathered for the tile.
 	 * @param tiles Out parameter for the tiles.
 	 * @param maxTiles The maximum number of tile layers to create.
 	 * @return The number of tile layers that were created.
 	 */
-	int rasterizeTileLayers(const std::vector<WFMath::RotBox<2>>& entityAreas, int tx, int ty, TileCacheData* tiles, int maxTiles);
+	static int rasterizeTileLayers(rcContext& ctx, const TileRasterizationInput& input, TileCacheData* tiles, int maxTiles);
 
 	/**
 	 * @brief Applies the supplied processor on the supplied tiles.
@@ -0,0 +1,169 @@
+/*
+ Copyright (C) 2026 Erik Ogenvik
+
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#include "ScriptProfiler.h"
+
+#include <Python.h>
+#include <sstream>
+
+namespace {
+/**
+ * Delegates to the allocator which was installed before, counting allocations on the way.
+ */
+struct AllocatorHook {
+	PyMemAllocatorDomain domain;
+	PyMemAllocatorEx original{};
+	bool installed = false;
+};
+
+AllocatorHook memHook{PYMEM_DOMAIN_MEM};
+AllocatorHook objHook{PYMEM_DOMAIN_OBJ};
+
+//These are only touched when holding the GIL.
+std::uint64_t allocationCount = 0;
+std::uint64_t allocatedBytes = 0;
+
+void* Hook_Malloc(void* ctx, size_t size) {
+	auto hook = static_cast<AllocatorHook*>(ctx);
+	allocationCount++;
+	allocatedBytes += size;
+	return hook->original.malloc(hook->original.ctx, size);
+}
+
+void* Hook_Calloc(void* ctx, size_t nelem, size_t elsize) {
+	auto hook = static_cast<AllocatorHook*>(ctx);
+	allocationCount++;
+	allocatedBytes += nelem * elsize;
+	return hook->original.calloc(hook->original.ctx, nelem, elsize);
+}
+
+void* Hook_Realloc(void* ctx, void* ptr, size_t size) {
+	auto hook = static_cast<AllocatorHook*>(ctx);
+	allocationCount++;
+	allocatedBytes += size;
+	return hook->original.realloc(hook->original.ctx, ptr, size);
+}
+
+void Hook_Free(void* ctx, void* ptr) {
+	auto hook = static_cast<AllocatorHook*>(ctx);
+	hook->original.free(hook->original.ctx, ptr);
+}
+
+void installHook(AllocatorHook& hook) {
+	if (!hook.installed) {
+		PyMem_GetAllocator(hook.domain, &hook.original);
+		PyMemAllocatorEx alloc = {&hook, Hook_Malloc, Hook_Calloc, Hook_Realloc, Hook_Free};
+		PyMem_SetAllocator(hook.domain, &alloc);
+		hook.installed = true;
+	}
+}
+
+void uninstallHook(AllocatorHook& hook) {
+	if (hook.installed) {
+		PyMem_SetAllocator(hook.domain, &hook.original);
+		hook.installed = false;
+	}
+}
+}
+
+ScriptProfiler& ScriptProfiler::instance() {
+	static ScriptProfiler profiler;
+	return profiler;
+}
+
+void ScriptProfiler::setEnabled(bool enabled) {
+	if (enabled == m_enabled) {
+		return;
+	}
+	m_enabled = enabled;
+	//Memory allocated by a hook can safely be freed after the hook is removed, since the hook just delegates.
+	if (enabled) {
+		installHook(memHook);
+		installHook(objHook);
+	} else {
+		uninstallHook(objHook);
+		uninstallHook(memHook);
+	}
+}
+
+void ScriptProfiler::clear() {
+	m_samples.clear();
+}
+
+void ScriptProfiler::push(std::string frame) {
+	std::string stack;
+	if (m_activeCalls.empty()) {
+		stack = std::move(frame);
+	} else {
+		stack = m_activeCalls.back().stack + ";" + frame;
+	}
+	m_activeCalls.push_back(ActiveCall{std::move(stack), std::chrono::steady_clock::now(), allocationCount, allocatedBytes, {}});
+}
+
+void ScriptProfiler::pop() {
+	//The profiler might have been disabled and cleared while the call was active; the call is still recorded.
+	if (m_activeCalls.empty()) {
+		return;
+	}
+	auto call = std::move(m_activeCalls.back());
+	m_activeCalls.pop_back();
+
+	Sample total{std::chrono::steady_clock::now() - call.start,
+				 allocationCount - call.allocationsAtStart,
+				 allocatedBytes - call.allocatedBytesAtStart,
+				 1};
+
+	auto& sample = m_samples[call.stack];
+	sample.time += total.time - call.nested.time;
+	sample.allocations += total.allocations - call.nested.allocations;
+	sample.allocatedBytes += total.allocatedBytes - call.nested.allocatedBytes;
+	sample.calls++;
+
+	if (!m_activeCalls.empty()) {
+		auto& parent = m_activeCalls.back().nested;
+		parent.time += total.time;
+		parent.allocations += total.allocations;
+		parent.allocatedBytes += total.allocatedBytes;
+	}
+}
+
+void ScriptProfiler::writeFolded(std::ostream& stream, Metric metric) const {
+	for (auto& entry: m_samples) {
+		std::uint64_t value = 0;
+		switch (metric) {
+			case Metric::Time:
+				value = static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(entry.second.time).count());
+				break;
+			case Metric::Allocations:
+				value = entry.second.allocations;
+				break;
+			case Metric::AllocatedBytes:
+				value = entry.second.allocatedBytes;
+				break;
+		}
+		if (value != 0) {
+			stream << entry.first << " " << value << "\n";
+		}
+	}
+}
+
+std::string ScriptProfiler::getFolded(Metric metric) const {
+	std::stringstream ss;
+	writeFolded(ss, metric);
+	return ss.str();
+}
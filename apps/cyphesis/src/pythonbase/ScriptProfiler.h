@@ -0,0 +1,146 @@
+/*
+ Copyright (C) 2026 Erik Ogenvik
+
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#ifndef CYPHESIS_SCRIPTPROFILER_H
+#define CYPHESIS_SCRIPTPROFILER_H
+
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <ostream>
+#include <string>
+#include <vector>
+
+/**
+ * Attributes wall time and Python allocations to the script handlers which are called from C++.
+ *
+ * Each call into a script is recorded as a stack of frames (for example "entity type;script class;op handler"),
+ * and calls made into scripts while another call is active are nested under that call. Only the time spent in a
+ * frame itself (i.e. not in any nested call) is attributed to it, which means that the result can be written out
+ * in the "folded stacks" format understood by flamegraph tools.
+ *
+ * Allocations are counted by hooking into the Python memory allocators while the profiler is enabled.
+ *
+ * When disabled the only overhead is a check of a flag.
+ * The profiler is only meant to be used from the thread holding the GIL.
+ */
+class ScriptProfiler {
+public:
+	struct Sample {
+		std::chrono::nanoseconds time{};
+		std::uint64_t allocations = 0;
+		std::uint64_t allocatedBytes = 0;
+		std::uint64_t calls = 0;
+	};
+
+	enum class Metric {
+		/**
+		 * Wall time, in microseconds.
+		 */
+		Time,
+		Allocations,
+		AllocatedBytes
+	};
+
+	/**
+	 * Records a call into a script for as long as it's alive.
+	 */
+	class Scope {
+	public:
+		/**
+		 * @param frameFn A function producing the name of the frame. It's only called if the profiler is enabled.
+		 */
+		template<typename FrameFn>
+		explicit Scope(FrameFn&& frameFn) {
+			auto& profiler = ScriptProfiler::instance();
+			if (profiler.isEnabled()) {
+				profiler.push(frameFn());
+				m_profiler = &profiler;
+			}
+		}
+
+		~Scope() {
+			if (m_profiler) {
+				m_profiler->pop();
+			}
+		}
+
+		Scope(const Scope&) = delete;
+
+		Scope& operator=(const Scope&) = delete;
+
+	private:
+		ScriptProfiler* m_profiler = nullptr;
+	};
+
+	static ScriptProfiler& instance();
+
+	bool isEnabled() const {
+		return m_enabled;
+	}
+
+	/**
+	 * Enables or disables profiling. Samples are kept when disabled.
+	 * Python must be initialized when enabling, since that installs the allocation hooks.
+	 */
+	void setEnabled(bool enabled);
+
+	/**
+	 * Removes all samples.
+	 */
+	void clear();
+
+	/**
+	 * @return All samples, keyed by their frames joined with ";".
+	 */
+	const std::map<std::string, Sample>& getSamples() const {
+		return m_samples;
+	}
+
+	/**
+	 * Writes the samples in the folded stacks format, i.e. one line per stack with the frames separated by ";"
+	 * followed by the value. Stacks with a value of zero are omitted.
+	 */
+	void writeFolded(std::ostream& stream, Metric metric) const;
+
+	std::string getFolded(Metric metric) const;
+
+private:
+	struct ActiveCall {
+		std::string stack;
+		std::chrono::steady_clock::time_point start;
+		std::uint64_t allocationsAtStart;
+		std::uint64_t allocatedBytesAtStart;
+		/**
+		 * Totals of all nested calls, which are subtracted from the totals of this call.
+		 */
+		Sample nested;
+	};
+
+	bool m_enabled = false;
+
+	std::vector<ActiveCall> m_activeCalls;
+
+	std::map<std::string, Sample> m_samples;
+
+	void push(std::string frame);
+
+	void pop();
+};
+
+#endif //CYPHESIS_SCRIPTPROFILER_H
@@ -20,10 +20,12 @@
 #include "AwareMind.h"
 
 
-AwareMindFactory::AwareMindFactory(TypeStore<MemEntity>& typeStore)
+AwareMindFactory::AwareMindFactory(TypeStore<MemEntity>& typeStore,
+								   std::function<void(std::function<void()>)> navmeshExecutor,
+								   size_t maxConcurrentNavmeshBuilds)
 		: mTypeStore(typeStore),
 		  mSharedTerrain(new SharedTerrain()),
-		  mAwarenessStoreProvider(new AwarenessStoreProvider(*mSharedTerrain)) {
+		  mAwarenessStoreProvider(new AwarenessStoreProvider(*mSharedTerrain, std::move(navmeshExecutor), maxConcurrentNavmeshBuilds)) {
 
 }
 
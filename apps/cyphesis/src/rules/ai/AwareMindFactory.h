@@ -31,7 +31,14 @@ class AwarenessStore;
 
 class AwareMindFactory : public MindKit {
 public:
-	explicit AwareMindFactory(TypeStore<MemEntity>& typeStore);
+	/**
+	 * @param typeStore The store of types, shared by all minds.
+	 * @param navmeshExecutor If set, navmesh tiles are rasterized through this, allowing it to happen on other threads.
+	 * @param maxConcurrentNavmeshBuilds The max number of tiles each awareness will rasterize at the same time.
+	 */
+	explicit AwareMindFactory(TypeStore<MemEntity>& typeStore,
+							  std::function<void(std::function<void()>)> navmeshExecutor = {},
+							  size_t maxConcurrentNavmeshBuilds = 1);
 
 	~AwareMindFactory() override = default;
 
@@ -22,12 +22,15 @@
 
 #include "AwarenessStore.h"
 
-AwarenessStore::AwarenessStore(float agentRadius, float agentHeight, float stepHeight, IHeightProvider& heightProvider, int tileSize) :
+AwarenessStore::AwarenessStore(float agentRadius, float agentHeight, float stepHeight, IHeightProvider& heightProvider, int tileSize,
+							   std::function<void(std::function<void()>)> executor, size_t maxConcurrentBuilds) :
 		mAgentRadius(agentRadius),
 		mAgentHeight(agentHeight),
 		mStepHeight(stepHeight),
 		mHeightProvider(heightProvider),
-		mTileSize(tileSize) {
+		mTileSize(tileSize),
+		mExecutor(std::move(executor)),
+		mMaxConcurrentBuilds(maxConcurrentBuilds) {
 }
 
 std::shared_ptr<Awareness> AwarenessStore::requestAwareness(const MemEntity& domainEntity) {
@@ -46,6 +49,9 @@ std::shared_ptr<Awareness> AwarenessStore::requestAwareness(const MemEntity& dom
 	auto bbox = bboxProp ? bboxProp->data() : WFMath::AxisBox<3>{};
 
 	auto awareness = std::make_shared<Awareness>(domainEntity.getIdAsInt(), mAgentRadius, mAgentHeight, mStepHeight, mHeightProvider, bbox, mTileSize);
+	if (mExecutor) {
+		awareness->setExecutor(mExecutor, mMaxConcurrentBuilds);
+	}
 	m_awarenesses.emplace(domainEntity.getIdAsInt(), std::weak_ptr<Awareness>(awareness));
 	return awareness;
 }
@@ -21,6 +21,7 @@
 #include <wfmath/axisbox.h>
 #include <wfmath/point.h>
 
+#include <functional>
 #include <string>
 #include <unordered_map>
 #include <memory>
@@ -37,7 +38,9 @@ public:
 				   float agentHeight,
 				   float stepHeight,
 				   IHeightProvider& heightProvider,
-				   int tileSize = 64);
+				   int tileSize = 64,
+				   std::function<void(std::function<void()>)> executor = {},
+				   size_t maxConcurrentBuilds = 1);
 
 	virtual ~AwarenessStore() = default;
 
@@ -56,6 +59,13 @@ private:
 
 	int mTileSize;
 
+	/**
+	 * @brief Used by all awarenesses for rasterizing tiles. If empty, tiles are rasterized on the main thread.
+	 */
+	std::function<void(std::function<void()>)> mExecutor;
+
+	size_t mMaxConcurrentBuilds;
+
 	/**
 	 * @brief A map of existing awarenesses, ordered by the id of the domain entity.
 	 */
@@ -28,8 +28,12 @@
 static constexpr auto debug_flag = false;
 
 
-AwarenessStoreProvider::AwarenessStoreProvider(IHeightProvider& heightProvider)
-		: m_heightProvider(heightProvider) {
+AwarenessStoreProvider::AwarenessStoreProvider(IHeightProvider& heightProvider,
+											   std::function<void(std::function<void()>)> executor,
+											   size_t maxConcurrentBuilds)
+		: m_heightProvider(heightProvider),
+		  m_executor(std::move(executor)),
+		  m_maxConcurrentBuilds(maxConcurrentBuilds) {
 }
 
 AwarenessStore& AwarenessStoreProvider::getStore(const TypeNode<MemEntity>* type, int tileSize) {
@@ -64,7 +68,7 @@ AwarenessStore& AwarenessStoreProvider::getStore(const TypeNode<MemEntity>* type
 		}
 	}
 
-	return m_awarenessStores.emplace(type->name(), AwarenessStore(agentRadius, (float) agentHeight, stepHeight, m_heightProvider, tileSize)).first->second;
+	return m_awarenessStores.emplace(type->name(), AwarenessStore(agentRadius, (float) agentHeight, stepHeight, m_heightProvider, tileSize, m_executor, m_maxConcurrentBuilds)).first->second;
 
 }
 
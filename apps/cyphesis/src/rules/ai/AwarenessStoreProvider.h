@@ -31,7 +31,14 @@ struct IHeightProvider;
 
 class AwarenessStoreProvider {
 public:
-	explicit AwarenessStoreProvider(IHeightProvider& heightProvider);
+	/**
+	 * @param heightProvider Provides terrain heights.
+	 * @param executor If set, used by all awarenesses for rasterizing navmesh tiles on other threads.
+	 * @param maxConcurrentBuilds The max number of tiles each awareness will rasterize at the same time through the executor.
+	 */
+	explicit AwarenessStoreProvider(IHeightProvider& heightProvider,
+									std::function<void(std::function<void()>)> executor = {},
+									size_t maxConcurrentBuilds = 1);
 
 	virtual ~AwarenessStoreProvider() = default;
 
@@ -40,6 +47,8 @@ public:
 protected:
 	std::unordered_map<std::string, AwarenessStore> m_awarenessStores;
 	IHeightProvider& m_heightProvider;
+	std::function<void(std::function<void()>)> m_executor;
+	size_t m_maxConcurrentBuilds;
 
 };
 
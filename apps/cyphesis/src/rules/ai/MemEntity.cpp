@@ -104,22 +104,23 @@ PropertyCore<MemEntity>* MemEntity::setAttr(const std::string& name, const Atlas
 
 	bool propNeedsInstalling = false;
 	PropertyCore<MemEntity>* prop;
+	PropertyKey key(name);
 	// If it is an existing property, just update the value.
-	auto I = m_properties.find(name);
+	auto I = m_properties.find(key);
 	if (I == m_properties.end() || !I->second.property) {
 		//Install a new property.
-		std::map<std::string, std::unique_ptr<PropertyCore<MemEntity>>>::const_iterator J;
-		if (m_type && (J = m_type->defaults().find(name)) != m_type->defaults().end()) {
+		PropertyMap<std::unique_ptr<PropertyCore<MemEntity>>>::const_iterator J;
+		if (m_type && (J = m_type->defaults().find(key)) != m_type->defaults().end()) {
 			prop = J->second->copy();
 			assert(prop != nullptr);
-			m_properties[name].property.reset(prop);
+			m_properties[key].property.reset(prop);
 		} else {
 			// This is an entirely new property, not just a modification of
 			// one in defaults, so we need to install it to this Entity.
 			auto newProp = createProperty(name);
 			assert(newProp != nullptr);
 			prop = newProp.get();
-			m_properties[name].property = std::move(newProp);
+			m_properties[key].property = std::move(newProp);
 			propNeedsInstalling = true;
 		}
 	} else {
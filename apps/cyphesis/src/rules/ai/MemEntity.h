@@ -25,6 +25,7 @@
 #include "common/PropertyManager.h"
 #include "common/log.h"
 #include "common/PropertyUtil.h"
+#include "common/PropertyMap.h"
 #include "rules/EntityLocation.h"
 
 #include <sigc++/signal.h>
@@ -67,7 +68,7 @@ protected:
 	std::unique_ptr<PropertyCore<MemEntity>> createProperty(const std::string& propertyName) const;
 
 
-	std::map<std::string, PropertyEntry> m_properties;
+	PropertyMap<PropertyEntry> m_properties;
 
 	/// Sequence number
 	int m_seq;
@@ -107,7 +108,7 @@ public:
 
 	std::chrono::milliseconds m_lastUpdated;
 
-	const std::map<std::string, PropertyEntry>& getProperties() const { return m_properties; }
+	const PropertyMap<PropertyEntry>& getProperties() const { return m_properties; }
 
 	PropertyCore<MemEntity>* setAttr(const std::string& name, const Atlas::Message::Element& modifier);
 
@@ -174,7 +174,7 @@ void CoordHelper::init(TValue& value, const Py::Tuple& args) {
 				if (item.isNumeric()) {
 					value[i] = Py::Float(item).as_double();
 				} else if (CyPy_ElementList::check(item)) {
-					value.fromAtlas(CyPy_ElementList::value(item));
+					value.fromAtlas(CyPy_ElementList::value(item).get());
 				} else {
 					throw Py::TypeError("Coords must take list of floats, or ints");
 				}
@@ -190,7 +190,7 @@ void CoordHelper::init(TValue& value, const Py::Tuple& args) {
 				if (item.isNumeric()) {
 					value[i] = Py::Float(item).as_double();
 				} else if (CyPy_ElementList::check(item)) {
-					value.fromAtlas(CyPy_ElementList::value(item));
+					value.fromAtlas(CyPy_ElementList::value(item).get());
 				} else {
 					throw Py::TypeError("Coords must take list of floats, or ints");
 				}
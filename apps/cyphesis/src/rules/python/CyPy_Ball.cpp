@@ -46,7 +46,7 @@ void CyPy_Ball::init_type() {
 }
 
 WFMath::Ball<3> CyPy_Ball::parse(const Py::Object& object) {
-	return WFMath::Ball<3>(verifyObject<CyPy_ElementMap>(object));
+	return WFMath::Ball<3>(verifyObject<CyPy_ElementMap>(object).get());
 }
 
 Py::Object CyPy_Ball::repr() {
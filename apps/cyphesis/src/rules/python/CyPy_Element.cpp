@@ -34,25 +34,20 @@ std::vector<std::function<std::optional<Atlas::Message::Element>(const Py::Objec
  * Used when iterating over a List element.
  */
 struct CyPy_ListElementIterator : Py::PythonClass<CyPy_ListElementIterator> {
-	//The owning element. Reference count is incremented at construction and decremented at destruction.
-	CyPy_ElementList* m_element;
-	Atlas::Message::ListType::const_iterator iterator;
+	//Shares the data of the list, which keeps it alive and unaltered while iterating.
+	SharedElementData<ListType> m_data;
+	ListType::const_iterator iterator;
 
 	CyPy_ListElementIterator(Py::PythonClassInstance* self, Py::Tuple& args, Py::Dict& kwds)
-			: PythonClass(self, args, kwds), m_element(nullptr) {
+			: PythonClass(self, args, kwds) {
 		throw Py::RuntimeError("Can not instantiate directly.");
 	}
 
 
-	CyPy_ListElementIterator(Py::PythonClassInstance* self, CyPy_ElementList* value)
+	CyPy_ListElementIterator(Py::PythonClassInstance* self, SharedElementData<ListType> data)
 			: PythonClass(self),
-			  m_element(value),
-			  iterator(m_element->m_value.begin()) {
-		m_element->self().increment_reference_count();
-	}
-
-	~CyPy_ListElementIterator() override {
-		m_element->self().decrement_reference_count();
+			  m_data(std::move(data)),
+			  iterator(m_data.get().begin()) {
 	}
 
 	Py::Object iter() override {
@@ -60,8 +55,8 @@ struct CyPy_ListElementIterator : Py::PythonClass<CyPy_ListElementIterator> {
 	}
 
 	PyObject* iternext() override {
-		if (iterator != m_element->m_value.end()) {
-			auto wrapper = CyPy_Element::wrap(*iterator);
+		if (iterator != m_data.get().end()) {
+			auto wrapper = CyPy_Element::share(m_data, *iterator);
 			wrapper.increment_reference_count();
 			iterator++;
 			return wrapper.ptr();
@@ -80,9 +75,9 @@ struct CyPy_ListElementIterator : Py::PythonClass<CyPy_ListElementIterator> {
 
 	}
 
-	static Py::PythonClassObject<CyPy_ListElementIterator> wrap(CyPy_ElementList* value) {
+	static Py::PythonClassObject<CyPy_ListElementIterator> wrap(const SharedElementData<ListType>& data) {
 		auto obj = extension_object_new(type_object(), nullptr, nullptr);
-		reinterpret_cast<Py::PythonClassInstance*>(obj)->m_pycxx_object = new CyPy_ListElementIterator(reinterpret_cast<Py::PythonClassInstance*>(obj), value);
+		reinterpret_cast<Py::PythonClassInstance*>(obj)->m_pycxx_object = new CyPy_ListElementIterator(reinterpret_cast<Py::PythonClassInstance*>(obj), data);
 		return Py::PythonClassObject<CyPy_ListElementIterator>(obj, true);
 	}
 
@@ -90,25 +85,28 @@ struct CyPy_ListElementIterator : Py::PythonClass<CyPy_ListElementIterator> {
 };
 
 struct CyPy_MapElementIterator : Py::PythonClass<CyPy_MapElementIterator> {
-	//The owning element. Reference count is incremented at construction and decremented at destruction.
-	CyPy_ElementMap* m_element;
-	Atlas::Message::MapType::const_iterator iterator;
+	enum class Mode {
+		KEYS,
+		VALUES,
+		ITEMS
+	};
+
+	//Shares the data of the map, which keeps it alive and unaltered while iterating.
+	SharedElementData<MapType> m_data;
+	MapType::const_iterator iterator;
+	Mode m_mode;
 
 	CyPy_MapElementIterator(Py::PythonClassInstance* self, Py::Tuple& args, Py::Dict& kwds)
-			: PythonClass(self, args, kwds), m_element(nullptr) {
+			: PythonClass(self, args, kwds), m_mode(Mode::ITEMS) {
 		throw Py::RuntimeError("Can not instantiate directly.");
 	}
 
 
-	CyPy_MapElementIterator(Py::PythonClassInstance* self, CyPy_ElementMap* value)
+	CyPy_MapElementIterator(Py::PythonClassInstance* self, SharedElementData<MapType> data, Mode mode)
 			: PythonClass(self),
-			  m_element(value),
-			  iterator(m_element->m_value.begin()) {
-		m_element->self().increment_reference_count();
-	}
-
-	~CyPy_MapElementIterator() override {
-		m_element->self().decrement_reference_count();
+			  m_data(std::move(data)),
+			  iterator(m_data.get().begin()),
+			  m_mode(mode) {
 	}
 
 	Py::Object iter() override {
@@ -117,15 +115,19 @@ struct CyPy_MapElementIterator : Py::PythonClass<CyPy_MapElementIterator> {
 
 
 	PyObject* iternext() override {
-		if (iterator != m_element->m_value.end()) {
-			auto wrapper = CyPy_Element::wrap(iterator->second);
-			auto key = Py::String(iterator->first);
-
-			Py::TupleN tuple(key, wrapper);
-			tuple.increment_reference_count();
+		if (iterator != m_data.get().end()) {
+			Py::Object result;
+			if (m_mode == Mode::KEYS) {
+				result = Py::String(iterator->first);
+			} else if (m_mode == Mode::VALUES) {
+				result = CyPy_Element::share(m_data, iterator->second);
+			} else {
+				result = Py::TupleN(Py::String(iterator->first), CyPy_Element::share(m_data, iterator->second));
+			}
+			result.increment_reference_count();
 
-			*(iterator)++;
-			return tuple.ptr();
+			iterator++;
+			return result.ptr();
 		} else {
 			return nullptr;
 		}
@@ -139,9 +141,9 @@ struct CyPy_MapElementIterator : Py::PythonClass<CyPy_MapElementIterator> {
 		behaviors().readyType();
 	}
 
-	static Py::PythonClassObject<CyPy_MapElementIterator> wrap(CyPy_ElementMap* value) {
+	static Py::PythonClassObject<CyPy_MapElementIterator> wrap(const SharedElementData<MapType>& data, Mode mode) {
 		auto obj = extension_object_new(type_object(), nullptr, nullptr);
-		reinterpret_cast<Py::PythonClassInstance*>(obj)->m_pycxx_object = new CyPy_MapElementIterator(reinterpret_cast<Py::PythonClassInstance*>(obj), value);
+		reinterpret_cast<Py::PythonClassInstance*>(obj)->m_pycxx_object = new CyPy_MapElementIterator(reinterpret_cast<Py::PythonClassInstance*>(obj), data, mode);
 		return Py::PythonClassObject<CyPy_MapElementIterator>(obj, true);
 	}
 
@@ -150,12 +152,13 @@ struct CyPy_MapElementIterator : Py::PythonClass<CyPy_MapElementIterator> {
 
 CyPy_ElementList::CyPy_ElementList(Py::PythonClassInstance* self, Py::Tuple& args, Py::Dict& kwds) :
 		WrapperBase(self, args, kwds) {
+	auto& list = m_value.mutate();
 	for (auto entry: args) {
-		m_value.push_back(CyPy_Element::asElement(entry));
+		list.push_back(CyPy_Element::asElement(entry));
 	}
 }
 
-CyPy_ElementList::CyPy_ElementList(Py::PythonClassInstance* self, Atlas::Message::ListType element)
+CyPy_ElementList::CyPy_ElementList(Py::PythonClassInstance* self, SharedElementData<Atlas::Message::ListType> element)
 		: WrapperBase(self, std::move(element)) {
 
 }
@@ -173,17 +176,20 @@ void CyPy_ElementList::init_type() {
 									| Py::PythonType::support_sequence_item
 									| Py::PythonType::support_sequence_ass_item
 									| Py::PythonType::support_sequence_repeat
+									| Py::PythonType::support_sequence_concat
 									| Py::PythonType::support_sequence_slice
 									| Py::PythonType::support_sequence_inplace_concat
 									| Py::PythonType::support_sequence_inplace_repeat);
 
+	register_method<&CyPy_ElementList::append>("append");
+
 	behaviors().readyType();
 
 	CyPy_ListElementIterator::init_type();
 }
 
 Py::Object CyPy_ElementList::repr() {
-	return Py::String(fmt::format("<{} object at {}>({})", type_object()->tp_name, fmt::ptr(this), debug_tostring(m_value)));
+	return Py::String(fmt::format("<{} object at {}>({})", type_object()->tp_name, fmt::ptr(this), debug_tostring(m_value.get())));
 }
 
 Py::Object CyPy_ElementList::rich_compare(const Py::Object& other, int op) {
@@ -195,7 +201,10 @@ Py::Object CyPy_ElementList::rich_compare(const Py::Object& other, int op) {
 	bool equal = false;
 
 	if (CyPy_ElementList::check(other)) {
-		equal = m_value == CyPy_ElementList::value(other);
+		equal = m_value.get() == CyPy_ElementList::value(other).get();
+	} else if (other.isList()) {
+		//Nested lists used to be handed out as native lists, so allow comparisons with those.
+		equal = m_value.get() == CyPy_Element::listAsElement(Py::List(other));
 	}
 
 	if ((equal && op == Py_EQ) || (!equal && op == Py_NE)) {
@@ -206,18 +215,18 @@ Py::Object CyPy_ElementList::rich_compare(const Py::Object& other, int op) {
 
 
 Py::Object CyPy_ElementList::iter() {
-	return CyPy_ListElementIterator::wrap(this);
+	return CyPy_ListElementIterator::wrap(m_value);
 }
 
 PyCxx_ssize_t CyPy_ElementList::sequence_length() {
-	return m_value.size();
+	return m_value.get().size();
 }
 
 Py::Object CyPy_ElementList::sequence_repeat(Py_ssize_t count) {
 	Py::List list;
-	for (Py_ssize_t i = 0; i < count; ++count) {
-		for (auto& entry: m_value) {
-			list.append(CyPy_Element::asPyObject(entry, false));
+	for (Py_ssize_t i = 0; i < count; ++i) {
+		for (auto& entry: m_value.get()) {
+			list.append(CyPy_Element::view(m_value, entry));
 		}
 	}
 	return list;
@@ -227,7 +236,7 @@ Py::Object CyPy_ElementList::sequence_repeat(Py_ssize_t count) {
 int CyPy_ElementList::sequence_contains(const Py::Object& object) {
 	auto element = CyPy_Element::asElement(object);
 
-	for (auto& entity: m_value) {
+	for (auto& entity: m_value.get()) {
 		if (entity == element) {
 			return 1;
 		}
@@ -235,48 +244,77 @@ int CyPy_ElementList::sequence_contains(const Py::Object& object) {
 	return 0;
 }
 
-Py::Object CyPy_ElementList::sequence_inplace_repeat(Py_ssize_t) {
-//TODO: implement
+Py::Object CyPy_ElementList::sequence_inplace_repeat(Py_ssize_t count) {
+	auto& list = m_value.mutate();
+	if (count <= 0) {
+		list.clear();
+	} else {
+		auto original = list;
+		list.reserve(original.size() * count);
+		for (Py_ssize_t i = 1; i < count; ++i) {
+			list.insert(list.end(), original.begin(), original.end());
+		}
+	}
 	return self();
 }
 
-Py::Object CyPy_ElementList::sequence_inplace_concat(const Py::Object&) {
-//TODO: implement
+Py::Object CyPy_ElementList::sequence_inplace_concat(const Py::Object& otherValue) {
+	auto other = CyPy_Element::asElement(otherValue);
+	if (!other.isList()) {
+		throw Py::TypeError("Can only concatenate a list to an Element List.");
+	}
+	auto& list = m_value.mutate();
+	list.insert(list.end(), other.List().begin(), other.List().end());
 	return self();
 }
 
 int CyPy_ElementList::sequence_ass_item(Py_ssize_t index, const Py::Object& object) {
-	if (index < static_cast<Py_ssize_t>(m_value.size())) {
-		m_value[index] = CyPy_Element::asElement(object);
-		return 1;
+	if (index < 0 || index >= static_cast<Py_ssize_t>(m_value.get().size())) {
+		throw Py::IndexError("Element List index out of range.");
 	}
-	return -1;
-
+	auto& list = m_value.mutate();
+	//A null object means that the item should be deleted.
+	if (object.isNull()) {
+		list.erase(list.begin() + index);
+	} else {
+		list[static_cast<size_t>(index)] = CyPy_Element::asElement(object);
+	}
+	return 0;
 }
 
 Py::Object CyPy_ElementList::sequence_item(Py_ssize_t index) {
-	if (index < static_cast<Py_ssize_t>(m_value.size())) {
-		return CyPy_Element::asPyObject(m_value.at(static_cast<unsigned long>(index)), false);
+	if (index < 0 || index >= static_cast<Py_ssize_t>(m_value.get().size())) {
+		throw Py::IndexError("Element List index out of range.");
 	}
-	return Py::None();
+	return CyPy_Element::view(m_value, m_value.get()[static_cast<size_t>(index)]);
 }
 
 Py::Object CyPy_ElementList::sequence_concat(const Py::Object& otherValue) {
-	auto element = CyPy_Element::asElement(otherValue);
-	auto list = m_value;
-	list.push_back(element);
-	return wrap(list);
+	auto other = CyPy_Element::asElement(otherValue);
+	if (!other.isList()) {
+		throw Py::TypeError("Can only concatenate a list to an Element List.");
+	}
+	auto list = m_value.get();
+	list.insert(list.end(), other.List().begin(), other.List().end());
+	return wrap(std::move(list));
+}
+
+Py::Object CyPy_ElementList::append(const Py::Tuple& args) {
+	args.verify_length(1);
+	m_value.mutate().push_back(CyPy_Element::asElement(args.front()));
+	return Py::None();
 }
 
 
 CyPy_ElementMap::CyPy_ElementMap(Py::PythonClassInstance* self, Py::Tuple& args, Py::Dict& kwds)
 		: WrapperBase(self, args, kwds) {
+	auto& map = m_value.mutate();
 	for (auto entry: kwds) {
-		m_value.emplace(entry.first.as_string(), CyPy_Element::asElement(entry.second));
+		map.emplace(entry.first.as_string(), CyPy_Element::asElement(entry.second));
 	}
 }
 
-CyPy_ElementMap::CyPy_ElementMap(Py::PythonClassInstance* self, Atlas::Message::MapType element)
+CyPy_ElementMap::CyPy_ElementMap(Py::PythonClassInstance* self, SharedElementData<Atlas::Message::MapType> element)
 		: WrapperBase(self, std::move(element)) {
 }
 
@@ -287,11 +325,16 @@ void CyPy_ElementMap::init_type() {
 	behaviors().supportRepr();
 	behaviors().supportRichCompare();
 
+	behaviors().supportIter(Py::PythonType::support_iter_iter);
 	behaviors().supportMappingType(Py::PythonType::support_mapping_ass_subscript
-								   | Py::PythonType::support_mapping_subscript);
+								   | Py::PythonType::support_mapping_subscript
+								   | Py::PythonType::support_mapping_length);
 	behaviors().supportSequenceType(Py::PythonType::support_sequence_contains);
 
 	register_method<&CyPy_ElementMap::items>("items");
+	register_method<&CyPy_ElementMap::keys>("keys");
+	register_method<&CyPy_ElementMap::values>("values");
+	register_method<&CyPy_ElementMap::get>("get");
 
 	behaviors().readyType();
 
@@ -301,7 +344,7 @@ void CyPy_ElementMap::init_type() {
 
 
 Py::Object CyPy_ElementMap::repr() {
-	return Py::String(fmt::format("<{} object at {}>({})", type_object()->tp_name, fmt::ptr(this), debug_tostring(m_value)));
+	return Py::String(fmt::format("<{} object at {}>({})", type_object()->tp_name, fmt::ptr(this), debug_tostring(m_value.get())));
 }
 
 
@@ -314,7 +357,10 @@ Py::Object CyPy_ElementMap::rich_compare(const Py::Object& other, int op) {
 	bool equal = false;
 
 	if (CyPy_ElementMap::check(other)) {
-		equal = m_value == CyPy_ElementMap::value(other);
+		equal = m_value.get() == CyPy_ElementMap::value(other).get();
+	} else if (other.isDict()) {
+		//Nested maps used to be handed out as native dicts, so allow comparisons with those.
+		equal = m_value.get() == CyPy_Element::dictAsElement(Py::Dict(other));
 	}
 
 	if ((equal && op == Py_EQ) || (!equal && op == Py_NE)) {
@@ -325,41 +371,84 @@ Py::Object CyPy_ElementMap::rich_compare(const Py::Object& other, int op) {
 
 
 Py::Object CyPy_ElementMap::getattro(const Py::String& name) {
-	auto I = m_value.find(name);
-	if (I != m_value.end()) {
-		return CyPy_Element::asPyObject(I->second, false);
+	auto I = m_value.get().find(name);
+	if (I != m_value.get().end()) {
+		return CyPy_Element::view(m_value, I->second);
 	}
 
 	return PythonExtensionBase::getattro(name);
 }
 
 int CyPy_ElementMap::setattro(const Py::String& name, const Py::Object& attr) {
-	m_value.emplace(name.as_string(), CyPy_Element::asElement(attr));
+	m_value.mutate().emplace(name.as_string(), CyPy_Element::asElement(attr));
 
 	return 0;
 }
 
+PyCxx_ssize_t CyPy_ElementMap::mapping_length() {
+	return m_value.get().size();
+}
 
 Py::Object CyPy_ElementMap::mapping_subscript(const Py::Object& key) {
-	auto I = m_value.find(verifyString(key));
-	if (I != m_value.end()) {
-		return CyPy_Element::asPyObject(I->second, false);
+	auto I = m_value.get().find(verifyString(key));
+	if (I != m_value.get().end()) {
+		return CyPy_Element::view(m_value, I->second);
 	}
 	return Py::None();
 }
 
 int CyPy_ElementMap::mapping_ass_subscript(const Py::Object& key, const Py::Object& value) {
-	m_value[verifyString(key)] = CyPy_Element::asElement(value);
+	auto keyStr = verifyString(key);
+	//A null value means that the entry should be deleted.
+	if (value.isNull()) {
+		if (m_value.get().find(keyStr) == m_value.get().end()) {
+			throw Py::KeyError(keyStr);
+		}
+		m_value.mutate().erase(keyStr);
+	} else {
+		m_value.mutate()[keyStr] = CyPy_Element::asElement(value);
+	}
 	return 0;
 }
 
+Py::Object CyPy_ElementMap::iter() {
+	return CyPy_MapElementIterator::wrap(m_value, CyPy_MapElementIterator::Mode::KEYS);
+}
+
 Py::Object CyPy_ElementMap::items() {
-	return CyPy_MapElementIterator::wrap(this);
+	return CyPy_MapElementIterator::wrap(m_value, CyPy_MapElementIterator::Mode::ITEMS);
+}
+
+Py::Object CyPy_ElementMap::keys() {
+	Py::List list;
+	for (auto& entry: m_value.get()) {
+		list.append(Py::String(entry.first));
+	}
+	return list;
+}
+
+Py::Object CyPy_ElementMap::values() {
+	Py::List list;
+	for (auto& entry: m_value.get()) {
+		list.append(CyPy_Element::view(m_value, entry.second));
+	}
+	return list;
+}
+
+Py::Object CyPy_ElementMap::get(const Py::Tuple& args) {
+	if (args.size() != 1 && args.size() != 2) {
+		throw Py::TypeError("get() takes a key and an optional default value.");
+	}
+	auto I = m_value.get().find(verifyString(args.front()));
+	if (I != m_value.get().end()) {
+		return CyPy_Element::view(m_value, I->second);
+	}
+	return args.size() == 2 ? args.getItem(1) : Py::None();
 }
 
 int CyPy_ElementMap::sequence_contains(const Py::Object& key) {
 	auto keyStr = verifyString(key);
-	if (m_value.find(keyStr) != m_value.end()) {
+	if (m_value.get().find(keyStr) != m_value.get().end()) {
 		return 1;
 	}
 	return 0;
@@ -443,10 +532,10 @@ Element CyPy_Element::asElement(const Py::Object& o) {
 		return o.as_string();
 	}
 	if (CyPy_ElementList::check(o)) {
-		return CyPy_ElementList::value(o);
+		return CyPy_ElementList::value(o).get();
 	}
 	if (CyPy_ElementMap::check(o)) {
-		return CyPy_ElementMap::value(o);
+		return CyPy_ElementMap::value(o).get();
 	}
 	if (CyPy_Operation::check(o)) {
 		return CyPy_Operation::value(o)->asMessage();
@@ -499,8 +588,8 @@ Py::Object CyPy_Element::wrap(Atlas::Message::Element value) {
 	} else if (value.isFloat()) {
 		return Py::Float(value.Float());
 	} else if (value.isList()) {
-		return CyPy_ElementList::wrap(value.List());
+		return CyPy_ElementList::wrap(value.moveList());
 	} else {
-		return CyPy_ElementMap::wrap(value.Map());
+		return CyPy_ElementMap::wrap(value.moveMap());
 	}
 }
@@ -27,15 +27,63 @@
 #include <vector>
 #include <optional>
 #include <functional>
+#include <memory>
+
+/**
+ * A copy-on-write handle to an Atlas map or list.
+ *
+ * This allows the Python wrappers to share data instead of copying it. Wrappers for nested elements
+ * point into the data of the wrapper they were accessed through, keeping it alive.
+ * Any handle which is mutated while its data is shared will first get a copy of its own.
+ */
+template<typename T>
+class SharedElementData {
+public:
+	SharedElementData() : m_data(std::make_shared<T>()) {}
+
+	SharedElementData(T data) : m_data(std::make_shared<T>(std::move(data))) {} //NOLINT(google-explicit-constructor)
+
+	explicit SharedElementData(std::shared_ptr<const T> data) : m_data(std::move(data)) {}
+
+	const T& get() const {
+		return *m_data;
+	}
+
+	operator const T&() const { //NOLINT(google-explicit-constructor)
+		return *m_data;
+	}
+
+	/**
+	 * Gets the data for writing, copying it first if it's shared with any other handle.
+	 */
+	T& mutate() {
+		if (m_data.use_count() > 1) {
+			m_data = std::make_shared<T>(*m_data);
+		}
+		//The data is never created as const, so this is safe.
+		return const_cast<T&>(*m_data);
+	}
+
+	/**
+	 * Creates a handle to an element contained in the data, sharing ownership with this handle.
+	 */
+	template<typename U>
+	SharedElementData<U> share(const U& contained) const {
+		return SharedElementData<U>(std::shared_ptr<const U>(m_data, &contained));
+	}
+
+private:
+	std::shared_ptr<const T> m_data;
+};
 
 /**
  * \ingroup PythonWrappers
  */
-class CyPy_ElementList : public WrapperBase<Atlas::Message::ListType, CyPy_ElementList> {
+class CyPy_ElementList : public WrapperBase<SharedElementData<Atlas::Message::ListType>, CyPy_ElementList> {
 public:
 	CyPy_ElementList(Py::PythonClassInstance* self, Py::Tuple& args, Py::Dict& kwds);
 
-	CyPy_ElementList(Py::PythonClassInstance* self, Atlas::Message::ListType element);
+	CyPy_ElementList(Py::PythonClassInstance* self, SharedElementData<Atlas::Message::ListType> element);
 
 	static void init_type();
 
@@ -60,16 +108,18 @@ public:
 	int sequence_contains(const Py::Object&) override;
 
 	Py::Object iter() override;
+
+	Py::Object append(const Py::Tuple& args);
 };
 
 /**
  * \ingroup PythonWrappers
  */
-class CyPy_ElementMap : public WrapperBase<Atlas::Message::MapType, CyPy_ElementMap> {
+class CyPy_ElementMap : public WrapperBase<SharedElementData<Atlas::Message::MapType>, CyPy_ElementMap> {
 public:
 	CyPy_ElementMap(Py::PythonClassInstance* self, Py::Tuple& args, Py::Dict& kwds);
 
-	CyPy_ElementMap(Py::PythonClassInstance* self, Atlas::Message::MapType element);
+	CyPy_ElementMap(Py::PythonClassInstance* self, SharedElementData<Atlas::Message::MapType> element);
 
 	static void init_type();
 
@@ -77,10 +127,14 @@ public:
 
 	Py::Object rich_compare(const Py::Object& other, int op) override;
 
+	PyCxx_ssize_t mapping_length() override;
+
 	Py::Object mapping_subscript(const Py::Object&) override;
 
 	int sequence_contains(const Py::Object&) override;
 
+	Py::Object iter() override;
+
 	int mapping_ass_subscript(const Py::Object&, const Py::Object&) override;
 
 	Py::Object getattro(const Py::String&) override;
@@ -91,6 +145,12 @@ public:
 
 	PYCXX_NOARGS_METHOD_DECL(CyPy_ElementMap, items);
 
+	Py::Object keys();
+
+	Py::Object values();
+
+	Py::Object get(const Py::Tuple& args);
+
 };
 
 /**
@@ -103,6 +163,23 @@ public:
 
 	static Py::Object wrap(Atlas::Message::Element value);
 
+	/**
+	 * Creates a Python object for an element contained in the data of a wrapper.
+	 *
+	 * Maps and lists become native dicts and lists, so that scripts can use them as such.
+	 * Any maps and lists within those are shared, as with share().
+	 */
+	template<typename T>
+	static Py::Object view(const SharedElementData<T>& owner, const Atlas::Message::Element& element);
+
+	/**
+	 * Creates a Python object for an element contained in the data of a wrapper.
+	 *
+	 * Maps and lists are wrapped without being copied, sharing the data with the owner until either is altered.
+	 */
+	template<typename T>
+	static Py::Object share(const SharedElementData<T>& owner, const Atlas::Message::Element& element);
+
 
 	static Py::Object asPyObject(const Atlas::Message::Element& obj, bool useNativePythonType);
 
@@ -125,4 +202,32 @@ protected:
 };
 
 
+template<typename T>
+Py::Object CyPy_Element::view(const SharedElementData<T>& owner, const Atlas::Message::Element& element) {
+	if (element.isMap()) {
+		Py::Dict dict;
+		for (auto& entry: element.Map()) {
+			dict.setItem(entry.first, share(owner, entry.second));
+		}
+		return dict;
+	} else if (element.isList()) {
+		Py::List list;
+		for (auto& entry: element.List()) {
+			list.append(share(owner, entry));
+		}
+		return list;
+	}
+	return asPyObject(element, false);
+}
+
+template<typename T>
+Py::Object CyPy_Element::share(const SharedElementData<T>& owner, const Atlas::Message::Element& element) {
+	if (element.isMap()) {
+		return CyPy_ElementMap::wrap(owner.share(element.Map()));
+	} else if (element.isList()) {
+		return CyPy_ElementList::wrap(owner.share(element.List()));
+	}
+	return asPyObject(element, false);
+}
+
 #endif //CYPHESIS_CYPY_ELEMENT_H
@@ -70,7 +70,7 @@ void CyPy_Operation::addToArgs(std::vector<Root>& args, const Py::Object& arg) {
 	if (arg.isDict()) {
 		args.push_back(AtlasFactories::factories.createObject(CyPy_Element::dictAsElement(Py::Dict(arg))));
 	} else if (CyPy_ElementMap::check(arg)) {
-		args.push_back(AtlasFactories::factories.createObject(CyPy_ElementMap::value(arg)));
+		args.push_back(AtlasFactories::factories.createObject(CyPy_ElementMap::value(arg).get()));
 	} else if (CyPy_Operation::check(arg)) {
 		args.push_back(CyPy_Operation::value(arg));
 	} else if (CyPy_RootEntity::check(arg)) {
@@ -209,7 +209,7 @@ Py::Object CyPy_Operation::setArgs(const Py::Tuple& args) {
 		} else if (item.isDict()) {
 			argslist.push_back(AtlasFactories::factories.createObject(CyPy_Element::dictAsElement(Py::Dict(item))));
 		} else if (CyPy_ElementMap::check(item)) {
-			argslist.push_back(AtlasFactories::factories.createObject(CyPy_ElementMap::value(item)));
+			argslist.push_back(AtlasFactories::factories.createObject(CyPy_ElementMap::value(item).get()));
 		} else if (CyPy_RootEntity::check(item)) {
 			argslist.push_back(CyPy_RootEntity::value(item));
 		} else {
@@ -55,7 +55,7 @@ Py::Object CyPy_Props<EntityT>::getattro(const Py::String& name) {
 			if (element.isNone()) {
 				return Py::None();
 			} else {
-				return CyPy_Element::wrap(element);
+				return CyPy_Element::wrap(std::move(element));
 			}
 		}
 	}
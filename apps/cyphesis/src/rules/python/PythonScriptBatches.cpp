@@ -0,0 +1,131 @@
+/*
+ Copyright (C) 2026 Erik Ogenvik
+
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#include "PythonScriptBatches.h"
+#include "CyPy_Operation.h"
+
+#include "pythonbase/Python_API.h"
+#include "pythonbase/ScriptProfiler.h"
+#include "common/log.h"
+#include "Remotery.h"
+
+PythonScriptBatches& PythonScriptBatches::instance() {
+	static PythonScriptBatches batches;
+	return batches;
+}
+
+std::vector<std::string> PythonScriptBatches::getBatchedOperations(const Py::Object& script) {
+	std::vector<std::string> operations;
+	auto scriptClass = script.type();
+	if (!scriptClass.hasAttr("batch_operations")) {
+		return operations;
+	}
+	auto attr = scriptClass.getAttr("batch_operations");
+	if (!attr.isSequence() || attr.isString()) {
+		spdlog::error("The 'batch_operations' attribute of script {} must be a list of operation types.", scriptClass.as_string());
+		return operations;
+	}
+	for (auto entry: Py::Sequence(attr)) {
+		if (!entry.isString()) {
+			spdlog::error("The 'batch_operations' attribute of script {} must be a list of operation types.", scriptClass.as_string());
+			continue;
+		}
+		auto opType = Py::String(entry).as_string();
+		if (!scriptClass.hasAttr(opType + "_operations")) {
+			spdlog::error("Script {} wants '{}' operations batched, but has no '{}_operations' method.", scriptClass.as_string(), opType, opType);
+			continue;
+		}
+		operations.emplace_back(std::move(opType));
+	}
+	return operations;
+}
+
+void PythonScriptBatches::add(const Py::Object& script,
+							  const std::string& opType,
+							  const Operation& op,
+							  std::weak_ptr<ResultHandler> resultHandler) {
+	auto scriptClass = script.type();
+	auto& batch = m_batches[std::make_pair(scriptClass.ptr(), opType)];
+	if (batch.scriptClass.isNone()) {
+		batch.scriptClass = scriptClass;
+	}
+	batch.entries.emplace_back(Entry{script, op, std::move(resultHandler)});
+}
+
+size_t PythonScriptBatches::flush() {
+	if (m_batches.empty()) {
+		return 0;
+	}
+	rmt_ScopedCPUSample(PythonScriptBatches_flush, 0)
+
+	//Any ops sent by the handlers are queued rather than delivered directly, but swap out the batches to be safe.
+	auto batches = std::move(m_batches);
+	m_batches.clear();
+
+	size_t count = 0;
+	for (auto& entry: batches) {
+		count += deliver(entry.first.second, entry.second);
+	}
+	return count;
+}
+
+size_t PythonScriptBatches::deliver(const std::string& opType, Batch& batch) {
+	auto handlerName = opType + "_operations";
+
+	Py::List scripts;
+	Py::List ops;
+	std::vector<std::shared_ptr<ResultHandler>> resultHandlers;
+	resultHandlers.reserve(batch.entries.size());
+	for (auto& entry: batch.entries) {
+		//Skip entries for scripts which have been destroyed since the operation was added.
+		auto resultHandler = entry.resultHandler.lock();
+		if (resultHandler) {
+			scripts.append(entry.script);
+			ops.append(CyPy_Operation::wrap(entry.op));
+			resultHandlers.emplace_back(std::move(resultHandler));
+		}
+	}
+	if (resultHandlers.empty()) {
+		return 0;
+	}
+
+	ScriptProfiler::Scope profileScope([&]() { return fmt::format("{};{}", batch.scriptClass.as_string(), handlerName); });
+	try {
+		PythonLogGuard logGuard([&]() {
+			return fmt::format("{}, {}: ", batch.scriptClass.as_string(), handlerName);
+		});
+		auto ret = batch.scriptClass.callMemberFunction(handlerName, Py::TupleN(scripts, ops));
+		if (!ret.isNone()) {
+			if (ret.isList() && Py::List(ret).size() == resultHandlers.size()) {
+				Py::List results(ret);
+				for (size_t i = 0; i < resultHandlers.size(); ++i) {
+					(*resultHandlers[i])(handlerName, Py::Object(results[i]));
+				}
+			} else {
+				spdlog::error("Batched handler \"{}\" of {} must return None or a list with one result for each script.",
+							  handlerName, batch.scriptClass.as_string());
+			}
+		}
+	} catch (const Py::BaseException& py_ex) {
+		if (PyErr_Occurred()) {
+			PyErr_Print();
+		}
+		spdlog::error("Python error calling batched handler \"{}\" on {}", handlerName, batch.scriptClass.as_string());
+	}
+	return resultHandlers.size();
+}
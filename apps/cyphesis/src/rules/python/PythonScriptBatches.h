@@ -0,0 +1,96 @@
+/*
+ Copyright (C) 2026 Erik Ogenvik
+
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#ifndef CYPHESIS_PYTHONSCRIPTBATCHES_H
+#define CYPHESIS_PYTHONSCRIPTBATCHES_H
+
+#include "pycxx/CXX/Objects.hxx"
+#include "common/OperationRouter.h"
+
+#include <Atlas/Objects/RootOperation.h>
+
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * Collects operations for script classes which have opted in to receive them in batches, so that they can be
+ * delivered with one call into Python per script class and operation type, instead of one call per entity.
+ *
+ * A script class opts in by listing operation types in a "batch_operations" class attribute, and by providing a
+ * class method named "<op type>_operations". This is called with a list of script instances and a list of the
+ * operations for each of them. It should return either None or a list with one result for each script, where each
+ * result is whatever a regular "<op type>_operation" handler would return.
+ *
+ * Since the operations are handled after they have been dispatched, a batched handler can't block an operation.
+ */
+class PythonScriptBatches {
+public:
+	/**
+	 * Handles the result for one entry. Owned by the script wrapper, so that entries for destroyed scripts are skipped.
+	 */
+	typedef std::function<void(const std::string& handlerName, const Py::Object& result)> ResultHandler;
+
+	static PythonScriptBatches& instance();
+
+	/**
+	 * Reads the operation types which the class of the script wants batched.
+	 */
+	static std::vector<std::string> getBatchedOperations(const Py::Object& script);
+
+	void add(const Py::Object& script,
+			 const std::string& opType,
+			 const Operation& op,
+			 std::weak_ptr<ResultHandler> resultHandler);
+
+	/**
+	 * Calls the batched handlers with all collected operations.
+	 * @return The number of operations which were delivered.
+	 */
+	size_t flush();
+
+	bool empty() const {
+		return m_batches.empty();
+	}
+
+private:
+	struct Entry {
+		Py::Object script;
+		Operation op;
+		std::weak_ptr<ResultHandler> resultHandler;
+	};
+
+	struct Batch {
+		/**
+		 * Kept to make sure the class isn't collected, and its address reused, while there are entries.
+		 */
+		Py::Object scriptClass;
+		std::vector<Entry> entries;
+	};
+
+	/**
+	 * Batches keyed by script class and operation type.
+	 */
+	std::map<std::pair<PyObject*, std::string>, Batch> m_batches;
+
+	size_t deliver(const std::string& opType, Batch& batch);
+};
+
+#endif //CYPHESIS_PYTHONSCRIPTBATCHES_H
@@ -24,6 +24,7 @@
 #include "PythonWrapper_impl.h"
 #include "pythonbase/Python_Script_Utils.h"
 #include "pythonbase/Python_API.h"
+#include "common/TypeNode.h"
 
 
 
@@ -72,7 +73,14 @@ template<typename EntityT, typename ScriptObjectT>
 std::unique_ptr<Script<EntityT>> PythonScriptFactory<EntityT, ScriptObjectT>::createScriptWrapper(ScriptObjectT& entity) const {
 	auto script = createScript(entity);
 	if (!script.isNone() && !script.isNull()) {
-		return std::make_unique<PythonWrapper<EntityT>>(script);
+		//Identify the script by both entity type and script class when profiling, since the same class is often used for multiple types.
+		auto profileName = fmt::format("{}.{}", this->m_package, this->m_type);
+		if constexpr (requires { entity.getType(); }) {
+			if (entity.getType()) {
+				profileName = entity.getType()->name() + ";" + profileName;
+			}
+		}
+		return std::make_unique<PythonWrapper<EntityT>>(script, std::move(profileName));
 	} else {
 		return {};
 	}
@@ -20,6 +20,7 @@
 #define RULESETS_PYTHON_WRAPPER_H
 
 #include "rules/Script.h"
+#include "PythonScriptBatches.h"
 #include "pycxx/CXX/Objects.hxx"
 #include <sigc++/connection.h>
 
@@ -31,8 +32,18 @@ protected:
 	/// \brief Python object that wraps the entity.
 	Py::Object m_wrapper;
 	std::vector<sigc::connection> m_propertyUpdateConnections;
+	/// \brief Frames identifying the script when profiling, separated by ";".
+	std::string m_profileName;
+	/// \brief Operation types which the script class wants delivered in batches.
+	std::vector<std::string> m_batchedOperations;
+	/// \brief Handles results of batched operations. Only set when there's a way to send results.
+	std::shared_ptr<PythonScriptBatches::ResultHandler> m_batchResultHandler;
+
+	std::string profileFrame(const std::string& handler) const;
+
 public:
-	explicit PythonWrapper(const Py::Object& wrapper);
+	/// @param profileName Frames identifying the script when profiling. If empty, the Python type name is used.
+	explicit PythonWrapper(const Py::Object& wrapper, std::string profileName = {});
 
 	~PythonWrapper() override;
 
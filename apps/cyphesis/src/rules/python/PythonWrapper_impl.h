@@ -25,14 +25,17 @@
 #include "common/log.h"
 #include "common/operations/Tick.h"
 #include "pythonbase/Python_API.h"
+#include "pythonbase/ScriptProfiler.h"
 #include "Remotery.h"
 #include <Atlas/Objects/Operation.h>
 #include <boost/algorithm/string.hpp>
 
 /// \brief PythonWrapper constructor
 template<typename EntityT>
-PythonWrapper<EntityT>::PythonWrapper(const Py::Object& wrapper)
-		: m_wrapper(wrapper) {
+PythonWrapper<EntityT>::PythonWrapper(const Py::Object& wrapper, std::string profileName)
+		: m_wrapper(wrapper),
+		  m_profileName(std::move(profileName)),
+		  m_batchedOperations(PythonScriptBatches::getBatchedOperations(wrapper)) {
 }
 
 template<typename EntityT>
@@ -43,6 +46,14 @@ PythonWrapper<EntityT>::~PythonWrapper() {
 }
 
 
+template<typename EntityT>
+std::string PythonWrapper<EntityT>::profileFrame(const std::string& handler) const {
+	if (m_profileName.empty()) {
+		return m_wrapper.type().as_string() + ";" + handler;
+	}
+	return m_profileName + ";" + handler;
+}
+
 template<typename EntityT>
 HandlerResult PythonWrapper<EntityT>::operation(const std::string& op_type,
 												const Operation& op,
@@ -55,11 +66,16 @@ HandlerResult PythonWrapper<EntityT>::operation(const std::string& op_type,
 		//This might be expensive, so check log level first
 		spdlog::trace("Got script {} on object {} for {}", this->m_wrapper.type().as_string(), this->m_wrapper.as_string(), op_name);
 	}
+	if (m_batchResultHandler && std::find(m_batchedOperations.begin(), m_batchedOperations.end(), op_type) != m_batchedOperations.end()) {
+		PythonScriptBatches::instance().add(m_wrapper, op_type, op, m_batchResultHandler);
+		return OPERATION_IGNORED;
+	}
 	if (!m_wrapper.hasAttr(op_name)) {
 		spdlog::trace("No method to be found for {}", op_name);
 		return OPERATION_IGNORED;
 	}
 
+	ScriptProfiler::Scope profileScope([&]() { return profileFrame(op_name); });
 	try {
 		PythonLogGuard logGuard([this, op_type]() {
 			return fmt::format("{}, {}: ", this->m_wrapper.as_string(), op_type);
@@ -88,6 +104,15 @@ HandlerResult PythonWrapper<EntityT>::operation(const std::string& op_type,
 
 template<typename EntityT>
 void PythonWrapper<EntityT>::attachPropertyCallbacks(EntityT& entity, std::function<void(const Atlas::Objects::Operation::RootOperation&)> sendWorldFn) {
+	if (!m_batchedOperations.empty()) {
+		m_batchResultHandler = std::make_shared<PythonScriptBatches::ResultHandler>([sendWorldFn](const std::string& handlerName, const Py::Object& result) {
+			OpVector res;
+			processScriptResult(handlerName, result, res);
+			for (auto& resOp: res) {
+				sendWorldFn(resOp);
+			}
+		});
+	}
 	auto list = m_wrapper.dir();
 	for (auto&& entry: list) {
 		auto fieldName = entry.str().as_string();
@@ -96,6 +121,7 @@ void PythonWrapper<EntityT>::attachPropertyCallbacks(EntityT& entity, std::funct
 			auto propertyName = fieldName.substr(0, fieldName.length() - 16);
 			auto connection = entity.propertyApplied.connect([this, fieldName, propertyName, &entity, sendWorldFn](const std::string& changedPropertyName, const PropertyCore<EntityT>& property) {
 				if (propertyName == changedPropertyName) {
+					ScriptProfiler::Scope profileScope([&]() { return profileFrame(fieldName); });
 					try {
 						PythonLogGuard logGuard([this, fieldName]() {
 							return fmt::format("{}, {}: ", this->m_wrapper.as_string(), fieldName);
@@ -138,6 +164,7 @@ void PythonWrapper<EntityT>::hook(const std::string& function,
 		return;
 	}
 
+	ScriptProfiler::Scope profileScope([&]() { return profileFrame(function); });
 	try {
 		PythonLogGuard logGuard([this]() {
 			return fmt::format("{}: ", this->m_wrapper.as_string());
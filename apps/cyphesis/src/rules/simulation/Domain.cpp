@@ -18,6 +18,8 @@
 
 #include "Domain.h"
 
+#include <wfmath/ball.h>
+
 Domain::Domain(LocatedEntity& entity) : m_entity(entity) {
 }
 
@@ -31,3 +33,21 @@ HandlerResult Domain::operation(LocatedEntity& e, const Operation& op, OpVector&
 }
 
 
+
+std::vector<bool> Domain::areEntitiesReachable(const std::vector<ReachQuery>& queries) const {
+	std::vector<bool> result;
+	result.reserve(queries.size());
+	for (auto& query: queries) {
+		result.push_back(isEntityReachable(query.reachingEntity, query.reach, query.queriedEntity, query.positionOnQueriedEntity));
+	}
+	return result;
+}
+
+std::vector<std::vector<Domain::CollisionEntry>> Domain::queryCollisions(const std::vector<WFMath::Ball<3>>& spheres) const {
+	std::vector<std::vector<CollisionEntry>> result;
+	result.reserve(spheres.size());
+	for (auto& sphere: spheres) {
+		result.emplace_back(queryCollision(sphere));
+	}
+	return result;
+}
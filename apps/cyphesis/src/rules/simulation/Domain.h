@@ -28,6 +28,7 @@
 #include <set>
 #include <optional>
 #include <functional>
+#include <vector>
 
 namespace WFMath {
 template<int>
@@ -82,6 +83,16 @@ public:
 		float distance{};
 	};
 
+	/**
+	 * A query for whether one entity can reach another. See isEntityReachable().
+	 */
+	struct ReachQuery {
+		const LocatedEntity& reachingEntity;
+		double reach;
+		const LocatedEntity& queriedEntity;
+		WFMath::Point<3> positionOnQueriedEntity;
+	};
+
 	explicit Domain(LocatedEntity& entity);
 
 	virtual ~Domain();
@@ -174,6 +185,15 @@ public:
 		return false;
 	}
 
+	/**
+	 * @brief Checks a batch of reach queries at once.
+	 *
+	 * Domains which can share work between the queries should override this; the default just calls isEntityReachable() for each.
+	 * @param queries The queries.
+	 * @return One result per query, in the same order as the queries.
+	 */
+	virtual std::vector<bool> areEntitiesReachable(const std::vector<ReachQuery>& queries) const;
+
 
 	virtual void installDelegates(LocatedEntity& entity, const std::string& propertyName);
 
@@ -183,6 +203,15 @@ public:
 		return std::vector<CollisionEntry>();
 	}
 
+	/**
+	 * Queries collisions for a batch of spheres at once.
+	 *
+	 * Domains which can share work between the queries should override this; the default just calls queryCollision() for each.
+	 * @param spheres The spheres.
+	 * @return The collisions for each sphere, in the same order as the spheres.
+	 */
+	virtual std::vector<std::vector<CollisionEntry>> queryCollisions(const std::vector<WFMath::Ball<3>>& spheres) const;
+
 	virtual std::optional<std::function<void()>> observeCloseness(LocatedEntity& reacher, LocatedEntity& target, double reach, std::function<void()> callback) = 0;
 
 	/**
@@ -31,7 +31,9 @@
 #include <Atlas/Objects/Anonymous.h>
 #include <wfmath/atlasconv.h>
 
+#include <map>
 #include <memory>
+#include <optional>
 #include <sstream>
 #include <common/Link.h>
 #include <common/Monitors.h>
@@ -95,8 +97,8 @@ LocatedEntity::LocatedEntity(RouterId id) :
 	m_flags(0),
 	m_parent(nullptr),
 	m_contains(nullptr) {
-	m_properties[LocationProperty::property_name].property = std::make_unique<LocationProperty>(*this);
-	m_properties[IdProperty::property_name].property = std::make_unique<IdProperty>(m_id);
+	m_properties[propertyKey<LocationProperty>()].property = std::make_unique<LocationProperty>(*this);
+	m_properties[propertyKey<IdProperty>()].property = std::make_unique<IdProperty>(m_id);
 }
 
 LocatedEntity::~LocatedEntity() {
@@ -1053,12 +1055,16 @@ void LocatedEntity::operation(const Operation& op, OpVector& res) {
 HandlerResult LocatedEntity::callDelegate(const std::string& name,
 										  const Operation& op,
 										  OpVector& res) {
+	auto key = PropertyKey::lookup(name);
+	if (!key) {
+		return OPERATION_IGNORED;
+	}
 	PropertyBase* p = nullptr;
-	auto I = m_properties.find(name);
+	auto I = m_properties.find(*key);
 	if (I != m_properties.end()) {
 		p = I->second.property.get();
 	} else if (m_type != nullptr) {
-		auto J = m_type->defaults().find(name);
+		auto J = m_type->defaults().find(*key);
 		if (J != m_type->defaults().end()) {
 			p = J->second.get();
 		}
@@ -1187,12 +1193,17 @@ void LocatedEntity::clearProperties() {
 }
 
 bool LocatedEntity::hasAttr(const std::string& name) const {
-	auto I = m_properties.find(name);
+	//A name which has never been interned can't be present anywhere.
+	auto key = PropertyKey::lookup(name);
+	if (!key) {
+		return false;
+	}
+	auto I = m_properties.find(*key);
 	if (I != m_properties.end()) {
 		return true;
 	}
 	if (m_type != nullptr) {
-		auto J = m_type->defaults().find(name);
+		auto J = m_type->defaults().find(*key);
 		if (J != m_type->defaults().end()) {
 			return true;
 		}
@@ -1202,12 +1213,16 @@ bool LocatedEntity::hasAttr(const std::string& name) const {
 
 int LocatedEntity::getAttr(const std::string& name,
 						   Element& attr) const {
-	auto I = m_properties.find(name);
+	auto key = PropertyKey::lookup(name);
+	if (!key) {
+		return -1;
+	}
+	auto I = m_properties.find(*key);
 	if (I != m_properties.end()) {
 		return I->second.property->get(attr);
 	}
 	if (m_type != nullptr) {
-		auto J = m_type->defaults().find(name);
+		auto J = m_type->defaults().find(*key);
 		if (J != m_type->defaults().end()) {
 			return J->second->get(attr);
 		}
@@ -1230,12 +1245,16 @@ std::optional<Atlas::Message::Element> LocatedEntity::getAttr(const std::string&
 int LocatedEntity::getAttrType(const std::string& name,
 							   Element& attr,
 							   int type) const {
-	auto I = m_properties.find(name);
+	auto key = PropertyKey::lookup(name);
+	if (!key) {
+		return -1;
+	}
+	auto I = m_properties.find(*key);
 	if (I != m_properties.end()) {
 		return I->second.property->get(attr) || (attr.getType() == type ? 0 : 1);
 	}
 	if (m_type != nullptr) {
-		auto J = m_type->defaults().find(name);
+		auto J = m_type->defaults().find(*key);
 		if (J != m_type->defaults().end()) {
 			return J->second->get(attr) || (attr.getType() == type ? 0 : 1);
 		}
@@ -1269,20 +1288,21 @@ PropertyBase* LocatedEntity::setAttr(const std::string& name, const Modifier* mo
 	bool propNeedsInstalling = false;
 	PropertyBase* prop;
 	Atlas::Message::Element attr;
+	PropertyKey key(name);
 	// If it is an existing property, just update the value.
-	auto I = m_properties.find(name);
+	auto I = m_properties.find(key);
 	if (I == m_properties.end() || !I->second.property) {
 		//Install a new property.
-		std::map<std::string, std::unique_ptr<PropertyBase>>::const_iterator J;
-		if (m_type && (J = m_type->defaults().find(name)) != m_type->defaults().end()) {
+		PropertyMap<std::unique_ptr<PropertyBase>>::const_iterator J;
+		if (m_type && (J = m_type->defaults().find(key)) != m_type->defaults().end()) {
 			prop = J->second->copy();
-			m_properties[name].property.reset(prop);
+			m_properties[key].property.reset(prop);
 		} else {
 			// This is an entirely new property, not just a modification of
 			// one in defaults, so we need to install it to this Entity.
 			auto newProp = createProperty(name);
 			prop = newProp.get();
-			m_properties[name].property = std::move(newProp);
+			m_properties[key].property = std::move(newProp);
 			propNeedsInstalling = true;
 		}
 	} else {
@@ -1420,12 +1440,17 @@ void LocatedEntity::removeModifier(const std::string& propertyName, Modifier* mo
 /// @return a pointer to the property, or zero if the attributes does
 /// not exist, or is not stored using a property object.
 const PropertyBase* LocatedEntity::getProperty(const std::string& name) const {
-	auto I = m_properties.find(name);
+	auto key = PropertyKey::lookup(name);
+	return key ? getProperty(*key) : nullptr;
+}
+
+const PropertyBase* LocatedEntity::getProperty(const PropertyKey& key) const {
+	auto I = m_properties.find(key);
 	if (I != m_properties.end()) {
 		return I->second.property.get();
 	}
 	if (m_type != nullptr) {
-		auto J = m_type->defaults().find(name);
+		auto J = m_type->defaults().find(key);
 		if (J != m_type->defaults().end()) {
 			return J->second.get();
 		}
@@ -1434,12 +1459,17 @@ const PropertyBase* LocatedEntity::getProperty(const std::string& name) const {
 }
 
 PropertyBase* LocatedEntity::modProperty(const std::string& name, const Atlas::Message::Element& def_val) {
-	auto I = m_properties.find(name);
+	auto key = PropertyKey::lookup(name);
+	return key ? modProperty(*key, def_val) : nullptr;
+}
+
+PropertyBase* LocatedEntity::modProperty(const PropertyKey& key, const Atlas::Message::Element& def_val) {
+	auto I = m_properties.find(key);
 	if (I != m_properties.end()) {
 		return I->second.property.get();
 	}
 	if (m_type != nullptr) {
-		auto J = m_type->defaults().find(name);
+		auto J = m_type->defaults().find(key);
 		if (J != m_type->defaults().end()) {
 			// We have a default for this property. Create a new instance
 			// property with the same value.
@@ -1447,11 +1477,11 @@ PropertyBase* LocatedEntity::modProperty(const std::string& name, const Atlas::M
 			if (!def_val.isNone()) {
 				new_prop->set(def_val);
 			}
-			J->second->remove(*this, name);
+			J->second->remove(*this, key);
 			new_prop->removeFlags(prop_flag_class);
-			m_properties[name].property.reset(new_prop);
-			new_prop->install(*this, name);
-			applyProperty(name, *new_prop);
+			m_properties[key].property.reset(new_prop);
+			new_prop->install(*this, key);
+			applyProperty(key, *new_prop);
 			return new_prop;
 		}
 	}
@@ -1489,7 +1519,7 @@ void LocatedEntity::setScript(std::unique_ptr<Script<LocatedEntity>> script) {
 void LocatedEntity::makeContainer() {
 	if (!m_contains) {
 		m_contains = std::make_unique<LocatedEntitySet>();
-		m_properties[ContainsProperty::property_name].property = std::make_unique<ContainsProperty>(*m_contains);
+		m_properties[propertyKey<ContainsProperty>()].property = std::make_unique<ContainsProperty>(*m_contains);
 	}
 }
 
@@ -1504,7 +1534,8 @@ void LocatedEntity::changeContainer(const Ref<LocatedEntity>& new_loc) {
 	}
 	new_loc->addChild(*this);
 
-	applyProperty(LocationProperty::property_name, *m_properties[LocationProperty::property_name].property);
+	auto& locationKey = propertyKey<LocationProperty>();
+	applyProperty(locationKey, *m_properties[locationKey].property);
 
 	onContainered(oldLoc);
 }
@@ -1731,33 +1762,39 @@ bool LocatedEntity::isVisibleForOtherEntity(const LocatedEntity& observer) const
 	return true;
 }
 
-bool LocatedEntity::canReach(const EntityLocation<LocatedEntity>& entityLocation, float extraReach) const {
-	auto reachingEntity = this;
+namespace {
+/**
+ * An entity which needs to be reachable within a domain.
+ */
+struct ReachCheck {
+	const Domain* domain;
+	const LocatedEntity* entity;
+};
+
+/**
+ * Works out which domains need to be asked whether an entity can reach a location.
+ * @param checks Filled with the checks which all need to pass for the location to be reachable.
+ * @return The result, if it could be decided without asking any domain.
+ */
+std::optional<bool> collectReachChecks(const LocatedEntity& reachingEntity, const EntityLocation<LocatedEntity>& entityLocation, std::vector<ReachCheck>& checks) {
 	//Are we reaching for our ourselves?
-	if (reachingEntity == entityLocation.m_parent.get()) {
+	if (&reachingEntity == entityLocation.m_parent.get()) {
 		return true;
 	}
 
 	//Is the reaching entity an admin?
-	if (reachingEntity->hasFlags(entity_admin)) {
+	if (reachingEntity.hasFlags(entity_admin)) {
 		return true;
 	}
 
 	//If either reacher or destination is destroyed then nothing can be reached.
-	if (isDestroyed() || entityLocation.m_parent->isDestroyed()) {
+	if (reachingEntity.isDestroyed() || entityLocation.m_parent->isDestroyed()) {
 		return false;
 	}
 
-	double reachDistance = 0;
-	auto reachProp = reachingEntity->getPropertyType<double>("reach");
-	if (reachProp) {
-		reachDistance = reachProp->data();
-	}
-	reachDistance += extraReach;
-
 	//First find the domain which contains the reacher, as well as if the reacher has a domain itself.
-	const LocatedEntity* domainEntity = reachingEntity->m_parent;
-	const LocatedEntity* topReachingEntity = reachingEntity;
+	const LocatedEntity* domainEntity = reachingEntity.m_parent;
+	const LocatedEntity* topReachingEntity = &reachingEntity;
 	const Domain* reacherParentDomain = nullptr;
 	const LocatedEntity* reacherDomainEntity = nullptr; //The entity which contains the reacher's domain
 
@@ -1781,11 +1818,12 @@ bool LocatedEntity::canReach(const EntityLocation<LocatedEntity>& entityLocation
 		if (reacherDomainEntity && ancestorEntity == reacherDomainEntity) {
 			if (ancestorEntity == entityLocation.m_parent) {
 				//We're trying to reach our containing domain entity, handle separately
-				return !(reacherParentDomain && !reacherParentDomain->isEntityReachable(*reachingEntity, reachDistance, *reacherDomainEntity, entityLocation.m_pos));
+				checks.push_back({reacherParentDomain, reacherDomainEntity});
+				return std::nullopt;
 			}
 			break;
 		}
-		if (ancestorEntity == reachingEntity) {
+		if (ancestorEntity == &reachingEntity) {
 			break;
 		}
 
@@ -1805,19 +1843,79 @@ bool LocatedEntity::canReach(const EntityLocation<LocatedEntity>& entityLocation
 		return false;
 	}
 
-	//Now walk back down the toAncestors list, checking if all entities on the way can be reached.
+	//Now walk back down the toAncestors list, collecting the entities which need to be reachable.
 	//Reachability is only checked for the first immediate child of a domain entity, further grandchildren are considered reachable if the top one is, until
 	//another domain is reached.
 	for (auto I = toAncestors.rbegin(); I != toAncestors.rend(); ++I) {
 		const LocatedEntity* ancestor = *I;
 		auto domain = ancestor->m_parent ? ancestor->m_parent->getDomain() : nullptr;
-		if (domain && !domain->isEntityReachable(*reachingEntity, reachDistance, *ancestor, entityLocation.m_pos)) {
+		if (domain) {
+			checks.push_back({domain, ancestor});
+		}
+	}
+	return std::nullopt;
+}
+
+double getReachDistance(const LocatedEntity& reachingEntity, float extraReach) {
+	double reachDistance = 0;
+	auto reachProp = reachingEntity.getPropertyType<double>("reach");
+	if (reachProp) {
+		reachDistance = reachProp->data();
+	}
+	return reachDistance + extraReach;
+}
+}
+
+bool LocatedEntity::canReach(const EntityLocation<LocatedEntity>& entityLocation, float extraReach) const {
+	std::vector<ReachCheck> checks;
+	if (auto result = collectReachChecks(*this, entityLocation, checks)) {
+		return *result;
+	}
+
+	auto reachDistance = getReachDistance(*this, extraReach);
+	for (auto& check: checks) {
+		if (!check.domain->isEntityReachable(*this, reachDistance, *check.entity, entityLocation.m_pos)) {
 			return false;
 		}
 	}
 	return true;
 }
 
+std::vector<bool> LocatedEntity::canReachEach(const std::vector<EntityLocation<LocatedEntity>>& entityLocations, float extraReach) const {
+	std::vector<bool> result(entityLocations.size(), true);
+	auto reachDistance = getReachDistance(*this, extraReach);
+
+	//Gather the queries for each domain, so that every domain gets to check all of its queries in one go.
+	struct DomainQueries {
+		std::vector<Domain::ReachQuery> queries;
+		std::vector<size_t> locationIndices;
+	};
+	std::map<const Domain*, DomainQueries> domainQueries;
+	std::vector<ReachCheck> checks;
+	for (size_t i = 0; i < entityLocations.size(); ++i) {
+		checks.clear();
+		if (auto decided = collectReachChecks(*this, entityLocations[i], checks)) {
+			result[i] = *decided;
+			continue;
+		}
+		for (auto& check: checks) {
+			auto& entry = domainQueries[check.domain];
+			entry.queries.push_back({*this, reachDistance, *check.entity, entityLocations[i].m_pos});
+			entry.locationIndices.push_back(i);
+		}
+	}
+
+	for (auto& [domain, entry]: domainQueries) {
+		auto reachable = domain->areEntitiesReachable(entry.queries);
+		for (size_t i = 0; i < reachable.size(); ++i) {
+			if (!reachable[i]) {
+				result[entry.locationIndices[i]] = false;
+			}
+		}
+	}
+	return result;
+}
+
 /// \brief Read attributes from an Atlas element
 ///
 /// @param ent The Atlas map element containing the attribute values
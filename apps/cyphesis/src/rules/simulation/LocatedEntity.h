@@ -31,6 +31,7 @@
 #include "common/log.h"
 #include "common/Visibility.h"
 #include "common/PropertyUtil.h"
+#include "common/PropertyMap.h"
 #include "common/SynchedState.h"
 
 #include <Atlas/Objects/Operation.h>
@@ -166,7 +167,7 @@ static constexpr std::uint32_t entity_update_broadcast_queued = 1u << 18u;
 
 struct EntityState {
 	/// Map of properties
-	std::map<std::string, ModifiableProperty> m_properties;
+	PropertyMap<ModifiableProperty> m_properties;
 
 	std::map<RouterId, std::set<std::pair<std::string, Modifier*>>> m_activeModifiers;
 
@@ -192,7 +193,7 @@ private:
 
 protected:
 	/// Map of properties
-	std::map<std::string, ModifiableProperty> m_properties;
+	PropertyMap<ModifiableProperty> m_properties;
 
 	std::map<RouterId, std::set<std::pair<std::string, Modifier*>>> m_activeModifiers;
 
@@ -343,8 +344,8 @@ public:
 	const TypeNode<LocatedEntity>* getType() const { return m_type; }
 
 	/// \brief Accessor for properties
-    const std::map<std::string, ModifiableProperty>& getProperties() const { return m_properties; }
-    std::map<std::string, ModifiableProperty>& getProperties() { return m_properties; }
+    const PropertyMap<ModifiableProperty>& getProperties() const { return m_properties; }
+    PropertyMap<ModifiableProperty>& getProperties() { return m_properties; }
 
 	const std::map<RouterId, std::set<std::pair<std::string, Modifier*>>>& getActiveModifiers() const {
 		return m_activeModifiers;
@@ -404,8 +405,14 @@ public:
 
 	const PropertyBase* getProperty(const std::string& name) const;
 
+	/// \brief Get the property object for a given attribute, by its interned key.
+	const PropertyBase* getProperty(const PropertyKey& key) const;
+
 	PropertyBase* modProperty(const std::string& name, const Atlas::Message::Element& def_val = Atlas::Message::Element());
 
+	/// \brief Get a modifiable property object for a given attribute, by its interned key.
+	PropertyBase* modProperty(const PropertyKey& key, const Atlas::Message::Element& def_val = Atlas::Message::Element());
+
 	/// \brief Set the property object for a given attribute
 	///
 	/// @param name name of the attribute for which the property is given
@@ -525,8 +532,26 @@ public:
 	*/
 	bool canReach(const EntityLocation<LocatedEntity>& entityLocation, float extraReach = 0) const;
 
+	/**
+	* @brief Determines which of many locations this entity can reach.
+	*
+	* Gives the same results as calling canReach() for each location, but lets each domain check all of its queries at once.
+	* @param entityLocations Where we want to reach.
+	* @return One result per location, in the same order.
+	*/
+	std::vector<bool> canReachEach(const std::vector<EntityLocation<LocatedEntity>>& entityLocations, float extraReach = 0) const;
+
 	void addModifier(const std::string& propertyName, Modifier* modifier, LocatedEntity* affectingEntity);
 
+	/// \brief Gets the interned key for a property class with a "property_name" trait.
+	///
+	/// The key is only interned once, so looking up fixed properties never needs to hash the name.
+	template<class PropertyT>
+	static const PropertyKey& propertyKey() {
+		static const PropertyKey key(PropertyT::property_name);
+		return key;
+	}
+
 	void removeModifier(const std::string& propertyName, Modifier* modifier);
 
 	/// \brief Get a property that is required to of a given type.
@@ -544,7 +569,11 @@ public:
 	/// The specified class must present the "property_name" trait.
 	template<class PropertyT>
 	const PropertyT* getPropertyClassFixed() const {
-		return this->getPropertyClass<PropertyT>(PropertyT::property_name);
+		const auto* p = getProperty(propertyKey<PropertyT>());
+		if (p != nullptr) {
+			return dynamic_cast<const PropertyT*>(p);
+		}
+		return nullptr;
 	}
 
 	/// \brief Get a property that is a generic property of a given type
@@ -572,7 +601,11 @@ public:
 	/// The specified class must present the "property_name" trait.
 	template<class PropertyT>
 	PropertyT* modPropertyClassFixed() {
-		return this->modPropertyClass<PropertyT>(PropertyT::property_name);
+		auto* p = modProperty(propertyKey<PropertyT>());
+		if (p != nullptr) {
+			return dynamic_cast<PropertyT*>(p);
+		}
+		return nullptr;
 	}
 
 	/// \brief Get a modifiable property that is a generic property of a type
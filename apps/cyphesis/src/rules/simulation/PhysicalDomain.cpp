@@ -53,6 +53,9 @@
 #include <BulletCollision/CollisionShapes/btHeightfieldTerrainShape.h>
 
 #include <algorithm>
+#include <cmath>
+#include <future>
+#include <map>
 #include <memory>
 #include <unordered_set>
 #include <optional>
@@ -67,6 +70,12 @@ INT_OPTION(visibility_broadphase_max_handles,
         "visibility_broadphase_max_handles",
         "Maximum number of handles for the PhysicalDomain visibility broadphase.");
 
+BOOL_OPTION(simulation_tiers,
+	false,
+	CYPHESIS,
+	"simulation_tiers",
+	"Take entities which no one else observes out of the full physics simulation.");
+
 using Atlas::Message::Element;
 using Atlas::Message::MapType;
 using Atlas::Objects::Root;
@@ -168,6 +177,13 @@ void processDifferences(std::vector<T>& newCollection, std::set<T>& previousColl
 	}
 }
 
+/**
+ * Gets the distance to a destination along the ground, as the height is decided by the terrain or the water.
+ */
+double groundDistance(const WFMath::Point<3>& pos, const WFMath::Vector<3>& destination) {
+	return std::hypot(destination.x() - pos.x(), destination.z() - pos.z());
+}
+
 template<typename T>
 bool removeAndShift(std::vector<T>& collection, const T& entry) {
 	for (size_t i = 0; i < collection.size(); ++i) {
@@ -222,6 +238,27 @@ constexpr std::array<double, 10> VISIBILITY_DISTANCE_THRESHOLDS = {10.0, 20, 30,
  */
 constexpr std::chrono::milliseconds TICK_SIZE(66);
 
+/**
+ * How often entities in the Coarse simulation tier are moved.
+ */
+constexpr std::chrono::milliseconds COARSE_SIMULATION_INTERVAL(500);
+
+/**
+ * An entity within this distance of its destination has arrived.
+ */
+constexpr float DESTINATION_ARRIVAL_DISTANCE = 0.1f;
+
+/**
+ * When a terrain page needs a new shape because the heights have grown outside of its range, the range is extended by
+ * this much, so that continued digging or building in the same place doesn't require a new shape each time.
+ */
+constexpr float TERRAIN_HEIGHT_MARGIN = 4.0f;
+
+/**
+ * The size of the cells batched collision queries are sorted into. The broadphase is traversed once per cell.
+ */
+constexpr double COLLISION_QUERY_CELL_SIZE = 32;
+
 /**
  * The base size of the view sphere for a perceptive entity. Everything within this radius will be visible.
  */
@@ -304,7 +341,6 @@ struct PhysicalDomain::PhysicalMotionState : public btMotionState {
 		if (m_bulletEntry.lastTransform != centerOfMassWorldTrans) {
 			m_bulletEntry.lastTransform = centerOfMassWorldTrans;
 
-			LocatedEntity& entity = m_bulletEntry.entity;
 			if (!m_bulletEntry.addedToMovingList) {
 				m_domain.m_movingEntities.emplace_back(&m_bulletEntry);
 				m_bulletEntry.addedToMovingList = true;
@@ -337,33 +373,83 @@ struct PhysicalDomain::PhysicalMotionState : public btMotionState {
 				angular.zero();
 			}
 
-			if (pos != m_bulletEntry.positionProperty.data()) {
-				m_bulletEntry.positionProperty.data() = pos;
-				m_bulletEntry.positionProperty.flags().removeFlags(prop_flag_persistence_clean);
-				m_bulletEntry.entity.applyProperty(m_bulletEntry.positionProperty);
+			//The properties are updated in PhysicalDomain::syncTransforms(), once the simulation step is done.
+			auto& transforms = m_domain.m_transforms;
+			auto index = m_bulletEntry.transformIndex;
+			auto& dirty = transforms.dirty[index];
+			if (pos != transforms.pos[index]) {
+				transforms.pos[index] = pos;
+				dirty |= TransformStore::POSITION;
 			}
-			if (velocity != m_bulletEntry.velocityProperty.data()) {
-				m_bulletEntry.velocityProperty.data() = velocity;
-				m_bulletEntry.velocityProperty.flags().removeFlags(prop_flag_persistence_clean);
-				m_bulletEntry.entity.applyProperty(m_bulletEntry.velocityProperty);
+			if (velocity != transforms.velocity[index]) {
+				transforms.velocity[index] = velocity;
+				dirty |= TransformStore::VELOCITY;
 			}
-			if (angular != m_bulletEntry.angularVelocityProperty.data()) {
-				m_bulletEntry.angularVelocityProperty.data() = angular;
-				m_bulletEntry.angularVelocityProperty.flags().removeFlags(prop_flag_persistence_clean);
-				m_bulletEntry.entity.applyProperty(m_bulletEntry.angularVelocityProperty);
+			if (angular != transforms.angular[index]) {
+				transforms.angular[index] = angular;
+				dirty |= TransformStore::ANGULAR;
 			}
-			if (orientation != m_bulletEntry.orientationProperty.data()) {
-				m_bulletEntry.orientationProperty.data() = orientation;
-				m_bulletEntry.orientationProperty.flags().removeFlags(prop_flag_persistence_clean);
-				m_bulletEntry.entity.applyProperty(m_bulletEntry.orientationProperty);
+			if (orientation != transforms.orientation[index]) {
+				transforms.orientation[index] = orientation;
+				dirty |= TransformStore::ORIENTATION;
 			}
-
-			entity.removeFlags(entity_pos_clean | entity_orient_clean);
 		}
 	}
 
 };
 
+std::uint32_t PhysicalDomain::TransformStore::add(BulletEntry& entry) {
+	std::uint32_t index;
+	if (!freeSlots.empty()) {
+		index = freeSlots.back();
+		freeSlots.pop_back();
+		entries[index] = &entry;
+		sentPos[index] = {};
+		sentVelocity[index] = {};
+		sentAngular[index] = {};
+		sentOrientation[index] = {};
+	} else {
+		index = static_cast<std::uint32_t>(entries.size());
+		entries.emplace_back(&entry);
+		pos.emplace_back();
+		velocity.emplace_back();
+		angular.emplace_back();
+		orientation.emplace_back();
+		sentPos.emplace_back();
+		sentVelocity.emplace_back();
+		sentAngular.emplace_back();
+		sentOrientation.emplace_back();
+		dirty.emplace_back(0);
+	}
+	entry.transformIndex = index;
+	readFromProperties(entry, POSITION | VELOCITY | ANGULAR | ORIENTATION);
+	return index;
+}
+
+void PhysicalDomain::TransformStore::remove(std::uint32_t index) {
+	entries[index]->transformIndex = npos;
+	entries[index] = nullptr;
+	dirty[index] = 0;
+	freeSlots.emplace_back(index);
+}
+
+void PhysicalDomain::TransformStore::readFromProperties(const BulletEntry& entry, std::uint8_t components) {
+	auto index = entry.transformIndex;
+	if (components & POSITION) {
+		pos[index] = entry.positionProperty.data();
+	}
+	if (components & VELOCITY) {
+		velocity[index] = entry.velocityProperty.data();
+	}
+	if (components & ANGULAR) {
+		angular[index] = entry.angularVelocityProperty.data();
+	}
+	if (components & ORIENTATION) {
+		orientation[index] = entry.orientationProperty.data();
+	}
+	dirty[index] &= static_cast<std::uint8_t>(~components);
+}
+
 struct PhysicalDomain::WaterCollisionCallback : public btOverlappingPairCallback {
 	PhysicalDomain* m_domain = nullptr;
 
@@ -499,6 +585,7 @@ PhysicalDomain::PhysicalDomain(LocatedEntity& entity, std::optional<unsigned int
 		m_visibilityBroadphase.get(),
 		m_collisionConfiguration.get())),
 	m_visibilityCheckCountdown(0),
+	m_simulationTiersEnabled(simulation_tiers),
 	mContainingEntityEntry{
 		.entity = entity,
 		.positionProperty = mFakeProperties.positionProperty,
@@ -648,6 +735,11 @@ PhysicalDomain::PhysicalDomain(LocatedEntity& entity, std::optional<unsigned int
 }
 
 PhysicalDomain::~PhysicalDomain() {
+	//The sampling thread might be using the terrain, which is owned by the entity.
+	if (m_terrainSampling.valid()) {
+		m_terrainSampling.wait();
+	}
+
 	for (auto& planeBody: m_borderPlanes) {
 		m_dynamicsWorld->removeCollisionObject(planeBody.first.get());
 	}
@@ -776,29 +868,31 @@ PhysicalDomain::TerrainEntry& PhysicalDomain::buildTerrainPage(Mercator::Segment
 	if (!terrainEntry.data) {
 		terrainEntry.data = std::make_unique<std::array<btScalar, 65 * 65>>();
 	}
-	if (terrainEntry.rigidBody) {
-		m_dynamicsWorld->removeRigidBody(terrainEntry.rigidBody.get());
-		terrainEntry.rigidBody.reset();
-		terrainEntry.shape.reset();
-	}
 	auto* data = terrainEntry.data->data();
 	const auto* mercatorData = segment.getPoints();
 	float min = segment.getMin();
 	float max = segment.getMax();
+	//If the page already exists the heights have moved outside of its range; leave some room for further changes.
+	if (terrainEntry.rigidBody) {
+		min -= TERRAIN_HEIGHT_MARGIN;
+		max += TERRAIN_HEIGHT_MARGIN;
+	}
+	terrainEntry.minHeight = min;
+	terrainEntry.maxHeight = max;
 
 	//Even though the API seems to allow various types of data to be specified in the ctor for btHeightfieldTerrainShape it seems that when using doubles as btScalar we must also supply doubles.
 #if defined(BT_USE_DOUBLE_PRECISION)
 	for (size_t i = 0; i < (size_t) (vertexCountOneSide * vertexCountOneSide); ++i) {
 		data[i] = mercatorData[i];
 	}
-	terrainEntry.shape = std::make_unique<btHeightfieldTerrainShape>(vertexCountOneSide, vertexCountOneSide, data, 1.0f, min, max, 1, PHY_DOUBLE, false);
+	auto shape = std::make_unique<btHeightfieldTerrainShape>(vertexCountOneSide, vertexCountOneSide, data, 1.0f, min, max, 1, PHY_DOUBLE, false);
 #else
 	memcpy(data, mercatorData, vertexCountOneSide * vertexCountOneSide * sizeof(float));
-	terrainEntry.shape = std::make_unique<btHeightfieldTerrainShape>(vertexCountOneSide, vertexCountOneSide, data, 1.0f, min, max, 1, PHY_FLOAT, false);
+	auto shape = std::make_unique<btHeightfieldTerrainShape>(vertexCountOneSide, vertexCountOneSide, data, 1.0f, min, max, 1, PHY_FLOAT, false);
 #endif
 
 
-	terrainEntry.shape->setLocalScaling(btVector3(1, 1, 1));
+	shape->setLocalScaling(btVector3(1, 1, 1));
 
 	auto res = segment.getResolution();
 
@@ -809,6 +903,18 @@ PhysicalDomain::TerrainEntry& PhysicalDomain::buildTerrainPage(Mercator::Segment
 	WFMath::Point<3> pos(xPos, yPos, zPos);
 	btVector3 btPos = Convert::toBullet(pos);
 
+	if (terrainEntry.rigidBody) {
+		//Reuse the existing body, only swapping out the shape.
+		terrainEntry.rigidBody->setCollisionShape(shape.get());
+		terrainEntry.rigidBody->setWorldTransform(btTransform(btQuaternion::getIdentity(), btPos));
+		m_dynamicsWorld->updateSingleAabb(terrainEntry.rigidBody.get());
+		m_dynamicsWorld->getBroadphase()->getOverlappingPairCache()->cleanProxyFromPairs(terrainEntry.rigidBody->getBroadphaseHandle(), m_dynamicsWorld->getDispatcher());
+		terrainEntry.shape = std::move(shape);
+		return terrainEntry;
+	}
+
+	terrainEntry.shape = std::move(shape);
+
 	btRigidBody::btRigidBodyConstructionInfo segmentCI(.0f, nullptr, terrainEntry.shape.get());
 	auto segmentBody = std::make_unique<btRigidBody>(segmentCI);
 	segmentBody->setWorldTransform(btTransform(btQuaternion::getIdentity(), btPos));
@@ -822,6 +928,29 @@ PhysicalDomain::TerrainEntry& PhysicalDomain::buildTerrainPage(Mercator::Segment
 	return terrainEntry;
 }
 
+PhysicalDomain::TerrainEntry& PhysicalDomain::applyTerrainSample(const TerrainSample& sample) {
+	auto& segment = *sample.segment;
+	auto I = m_terrainSegments.find(fmt::format("{}:{}", segment.getXRef(), segment.getZRef()));
+	//If there's no page yet, or the heights don't fit within the shape, the whole page needs to be built.
+	if (I == m_terrainSegments.end() || !I->second.rigidBody || segment.getMin() < I->second.minHeight || segment.getMax() > I->second.maxHeight) {
+		return buildTerrainPage(segment);
+	}
+	auto& terrainEntry = I->second;
+
+	//Only copy the rows and columns which have changed.
+	auto size = segment.getSize();
+	auto* data = terrainEntry.data->data();
+	const auto* mercatorData = segment.getPoints();
+	for (int z = sample.lz; z <= sample.hz; ++z) {
+		auto rowStart = z * size;
+		std::copy(mercatorData + rowStart + sample.lx, mercatorData + rowStart + sample.hx + 1, data + rowStart + sample.lx);
+	}
+
+	//Any contacts cached against the old heights are now invalid.
+	m_dynamicsWorld->getBroadphase()->getOverlappingPairCache()->cleanProxyFromPairs(terrainEntry.rigidBody->getBroadphaseHandle(), m_dynamicsWorld->getDispatcher());
+	return terrainEntry;
+}
+
 void PhysicalDomain::createDomainBorders() {
 	auto bbox = ScaleProperty<LocatedEntity>::scaledBbox(m_entity);
 	if (bbox.isValid()) {
@@ -906,7 +1035,7 @@ std::vector<LocatedEntity*> PhysicalDomain::getObservingEntitiesFor(const Locate
 	return entityList;
 }
 
-void PhysicalDomain::updateObserverEntry(BulletEntry& bulletEntry, OpVector& res) const {
+void PhysicalDomain::updateObserverEntry(BulletEntry& bulletEntry, OpVector& res) {
 	if (bulletEntry.viewSphere) {
 		//This entry is an observer; check what it can see after it has moved
 		const auto& viewSphere = bulletEntry.viewSphere;
@@ -926,6 +1055,7 @@ void PhysicalDomain::updateObserverEntry(BulletEntry& bulletEntry, OpVector& res
 			disappearArgs.push_back(std::move(that_ent));
 
 			disappearedEntry->observingThis.erase(&bulletEntry);
+			queueTierUpdate(*disappearedEntry);
 		};
 
 		auto appearFn = [&](BulletEntry* appearedEntry) {
@@ -937,6 +1067,7 @@ void PhysicalDomain::updateObserverEntry(BulletEntry& bulletEntry, OpVector& res
 			appearArgs.push_back(std::move(that_ent));
 
 			appearedEntry->observingThis.insert(&bulletEntry);
+			queueTierUpdate(*appearedEntry);
 		};
 
 		for (auto& entry: bulletEntry.observedByThisChanges) {
@@ -967,7 +1098,7 @@ void PhysicalDomain::updateObserverEntry(BulletEntry& bulletEntry, OpVector& res
 	}
 }
 
-void PhysicalDomain::updateObservedEntry(BulletEntry& bulletEntry, OpVector& res, bool generateOps) const {
+void PhysicalDomain::updateObservedEntry(BulletEntry& bulletEntry, OpVector& res, bool generateOps) {
 	if (bulletEntry.visibilitySphere) {
 		//This entry is an observable; check what can see it after it has moved
 
@@ -1019,6 +1150,9 @@ void PhysicalDomain::updateObservedEntry(BulletEntry& bulletEntry, OpVector& res
 			}
 		}
 
+		if (!bulletEntry.observingThisChanges.empty()) {
+			queueTierUpdate(bulletEntry);
+		}
 		bulletEntry.observingThisChanges.clear();
 	}
 }
@@ -1254,6 +1388,8 @@ void PhysicalDomain::addEntity(LocatedEntity& entity) {
 		}
 	}
 
+	m_transforms.add(entry);
+	queueTierUpdate(entry);
 	entry.propertyUpdatedConnection = entity.propertyApplied.connect([&](const std::string& name, const PropertyBase& property) { childEntityPropertyApplied(name, property, entry); });
 
 	updateTerrainMod(entry, true);
@@ -1366,6 +1502,7 @@ void PhysicalDomain::removeEntity(LocatedEntity& entity) {
 
 	auto modI = m_terrainMods.find(entity.getIdAsInt());
 	if (modI != m_terrainMods.end()) {
+		collectTerrainSampling();
 		m_terrain->updateMod(entity.getIdAsInt(), nullptr);
 		m_terrainMods.erase(modI);
 	}
@@ -1390,11 +1527,18 @@ void PhysicalDomain::removeEntity(LocatedEntity& entity) {
 	}
 	for (BulletEntry* observedEntry: entry->observedByThis) {
 		observedEntry->observingThis.erase(entry.get());
+		if (observedEntry != entry.get()) {
+			queueTierUpdate(*observedEntry);
+		}
 	}
 
 	if (entry->markedForVisibilityRecalculation) {
 		removeAndShift(m_visibilityRecalculateQueue, entry.get());
 	}
+	if (entry->markedForTierUpdate) {
+		removeAndShift(m_tierUpdateQueue, entry.get());
+	}
+	m_coarseEntries.erase(entry.get());
 
 	m_propelUpdateQueue.erase(entry.get());
 	m_directionUpdateQueue.erase(entry.get());
@@ -1419,6 +1563,7 @@ void PhysicalDomain::removeEntity(LocatedEntity& entity) {
 
 	auto closenessObservationsCopy = entry->closenessObservations;
 	for (auto& observation: closenessObservationsCopy) {
+		m_closenessCheckQueue.erase(observation);
 		if (observation->callback) {
 			observation->callback();
 		}
@@ -1440,6 +1585,10 @@ void PhysicalDomain::removeEntity(LocatedEntity& entity) {
 
 	m_steppingEntries.erase(entry.get());
 
+	if (entry->transformIndex != TransformStore::npos) {
+		m_transforms.remove(entry->transformIndex);
+	}
+
 	m_entries.erase(I);
 
 	m_propellingEntries.erase(entity.getIdAsInt());
@@ -1458,6 +1607,7 @@ void PhysicalDomain::removeEntity(LocatedEntity& entity) {
 
 void PhysicalDomain::childEntityPropertyApplied(const std::string& name, const PropertyBase& prop, BulletEntry& bulletEntry) {
 	if (name == "pos") {
+		m_transforms.readFromProperties(bulletEntry, TransformStore::POSITION);
 		//        auto& pos = bulletEntry.positionProperty.data();
 		//        if (pos.isValid()) {
 		//            applyNewPositionForEntity(bulletEntry, pos);
@@ -1489,8 +1639,18 @@ void PhysicalDomain::childEntityPropertyApplied(const std::string& name, const P
 		//                }
 		//            }
 		//        }
+	} else if (name == VelocityProperty<LocatedEntity>::property_name) {
+		m_transforms.readFromProperties(bulletEntry, TransformStore::VELOCITY);
+	} else if (name == AngularVelocityProperty<LocatedEntity>::property_name) {
+		m_transforms.readFromProperties(bulletEntry, TransformStore::ANGULAR);
+	} else if (name == OrientationProperty<LocatedEntity>::property_name) {
+		m_transforms.readFromProperties(bulletEntry, TransformStore::ORIENTATION);
 	} else if (name == PropelProperty::property_name) {
 		bulletEntry.control.propelProperty = dynamic_cast<const PropelProperty*>(&prop);
+		if (bulletEntry.tier == SimulationTier::Coarse) {
+			//Bring the entry up to now with its old velocity, and start using the new propel.
+			advanceCoarseEntry(bulletEntry);
+		}
 		m_propelUpdateQueue.insert(&bulletEntry);
 	} else if (name == "_direction") {
 		bulletEntry.control.directionProperty = dynamic_cast<const QuaternionProperty<LocatedEntity>*>(&prop);
@@ -1501,6 +1661,10 @@ void PhysicalDomain::childEntityPropertyApplied(const std::string& name, const P
 
 			bulletEntry.control.destinationProperty = dynamic_cast<const Vector3Property<LocatedEntity>*>(&prop);
 		}
+		if (bulletEntry.tier == SimulationTier::Coarse) {
+			//Bring the entry up to now, and start steering towards the new destination.
+			advanceCoarseEntry(bulletEntry);
+		}
 
 		//Use the propel update queue for destination too, as they both concern propelling.
 		m_propelUpdateQueue.insert(&bulletEntry);
@@ -1533,6 +1697,9 @@ void PhysicalDomain::childEntityPropertyApplied(const std::string& name, const P
 			auto modeProp = dynamic_cast<const ModeProperty*>(&prop);
 			//Check if the mode change came from "outside", i.e. wasn't made because of the physics simulation (such as being submerged).
 			if (modeProp->getMode() != bulletEntry.mode) {
+				//Let the entity be fully simulated while changing mode, and reconsider the tier afterwards.
+				setSimulationTier(bulletEntry, SimulationTier::Full);
+				queueTierUpdate(bulletEntry);
 				applyNewPositionForEntity(bulletEntry, bulletEntry.positionProperty.data());
 
 				if (auto rigidBody = btRigidBody::upcast(bulletEntry.collisionObject.get())) {
@@ -1749,7 +1916,7 @@ void PhysicalDomain::childEntityPropertyApplied(const std::string& name, const P
 			bulletEntry.step_factor = 0;
 		}
 		auto I = m_steppingEntries.find(&bulletEntry);
-		if (stepFactorProp && stepFactorProp->data() > 0) {
+		if (stepFactorProp && stepFactorProp->data() > 0 && bulletEntry.tier == SimulationTier::Full) {
 			if (I == m_steppingEntries.end()) {
 				m_steppingEntries.emplace(&bulletEntry);
 			}
@@ -1827,6 +1994,7 @@ void PhysicalDomain::updateTerrainMod(const BulletEntry& entry, bool forceUpdate
 						} else {
 							m_terrainMods.erase(entry.entity.getIdAsInt());
 						}
+						collectTerrainSampling();
 						auto oldAreas = m_terrain->updateMod(entry.entity.getIdAsInt(), std::move(modifier));
 						if (oldAreas.isValid()) {
 							terrainAreas.emplace_back(oldAreas);
@@ -1841,6 +2009,7 @@ void PhysicalDomain::updateTerrainMod(const BulletEntry& entry, bool forceUpdate
 			if (I != m_terrainMods.end()) {
 				std::vector<WFMath::AxisBox<2>> terrainAreas;
 				terrainAreas.emplace_back(I->second.area);
+				collectTerrainSampling();
 				m_terrain->updateMod(entry.entity.getIdAsInt(), nullptr);
 				m_terrainMods.erase(I);
 				refreshTerrain(terrainAreas);
@@ -1895,6 +2064,7 @@ void PhysicalDomain::updateTerrainArea(const BulletEntry& entry, bool forceUpdat
 			if (I != m_terrainMods.end()) {
 				std::vector<WFMath::AxisBox<2>> terrainAreas;
 				terrainAreas.emplace_back(I->second.area);
+				collectTerrainSampling();
 				m_terrain->updateMod(entry.entity.getIdAsInt(), nullptr);
 				m_terrainMods.erase(I);
 				refreshTerrain(terrainAreas);
@@ -1972,6 +2142,7 @@ void PhysicalDomain::entityPropertyApplied(const std::string& name, const Proper
 			entry.second.rigidBody->setSpinningFriction(static_cast<btScalar>(frictionSpinningProp->data()));
 		}
 	} else if (name == TerrainProperty::property_name) {
+		collectTerrainSampling();
 		if (m_entity.getPropertyClassFixed<TerrainProperty>()) {
 			m_terrain = &TerrainProperty::getData(m_entity);
 		}
@@ -2277,7 +2448,7 @@ void PhysicalDomain::applyDestination(std::chrono::milliseconds tickSize,
 		//        auto entityRadius = std::max(std::max(entry.bbox.highCorner().x(), entry.bbox.highCorner().z()), std::max(std::abs(entry.bbox.lowCorner().x()), std::abs(entry.bbox.lowCorner().z())));
 
 		//If we're within 0.1 meter we're already there.
-		if (distance < 0.1f) {
+		if (distance < DESTINATION_ARRIVAL_DISTANCE) {
 			return;
 		}
 
@@ -2567,24 +2738,130 @@ void PhysicalDomain::applyTransformInternal(BulletEntry& entry,
 void PhysicalDomain::refreshTerrain(const std::vector<WFMath::AxisBox<2>>& areas) {
 	//Schedule dirty terrain areas for update in processDirtyTerrainAreas() which is called for each tick.
 	m_dirtyTerrainSegmentAreas.insert(m_dirtyTerrainSegmentAreas.end(), areas.begin(), areas.end());
+	//Start sampling the new heights right away, so that it's done by the end of the tick.
+	dispatchTerrainSampling();
+}
+
+std::vector<PhysicalDomain::TerrainSample> PhysicalDomain::prepareTerrainSamples() {
+	std::map<Mercator::Segment*, TerrainSample> samples;
+	for (auto& area: m_dirtyTerrainSegmentAreas) {
+		m_terrain->processSegments(area, [&](Mercator::Segment& s, int, int) {
+			auto localArea = area;
+			localArea.shift(WFMath::Vector<2>(-s.getXRef(), -s.getZRef()));
+			int lx, hx, lz, hz;
+			if (!s.clipToSegment(localArea, lx, hx, lz, hz)) {
+				return;
+			}
+			//Areas are rounded to the nearest point, so include one more point on each side.
+			lx = std::max(lx - 1, 0);
+			lz = std::max(lz - 1, 0);
+			hx = std::min(hx + 1, s.getResolution());
+			hz = std::min(hz + 1, s.getResolution());
+
+			auto [I, inserted] = samples.try_emplace(&s);
+			auto& sample = I->second;
+			if (inserted) {
+				sample.segment = std::make_unique<Mercator::Segment>(s.getXRef(), s.getZRef(), s.getResolution());
+				auto& controlPoints = s.getControlPoints();
+				for (unsigned int x = 0; x < 2; ++x) {
+					for (unsigned int z = 0; z < 2; ++z) {
+						sample.segment->setCornerPoint(x, z, controlPoints(x, z));
+					}
+				}
+				for (auto& [id, mod]: s.getMods()) {
+					sample.segment->updateMod(id, mod);
+				}
+				sample.lx = lx;
+				sample.hx = hx;
+				sample.lz = lz;
+				sample.hz = hz;
+			} else {
+				sample.lx = std::min(sample.lx, lx);
+				sample.hx = std::max(sample.hx, hx);
+				sample.lz = std::min(sample.lz, lz);
+				sample.hz = std::max(sample.hz, hz);
+			}
+		});
+	}
+	m_dirtyTerrainSegmentAreas.clear();
+
+	std::vector<TerrainSample> result;
+	result.reserve(samples.size());
+	for (auto& entry: samples) {
+		result.emplace_back(std::move(entry.second));
+	}
+	return result;
+}
+
+void PhysicalDomain::dispatchTerrainSampling() {
+	//Only one sampling is running at any time; if the previous one is done we can collect it and start a new one.
+	if (m_terrainSampling.valid() && m_terrainSampling.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+		collectTerrainSampling();
+	}
+	if (!m_terrain || m_terrainSampling.valid() || m_dirtyTerrainSegmentAreas.empty()) {
+		return;
+	}
+	auto samples = prepareTerrainSamples();
+	if (samples.empty()) {
+		return;
+	}
+	//The samples only refer to the mods of the terrain, which aren't changed until collectTerrainSampling() has been called.
+	m_terrainSampling = std::async(std::launch::async, [samples = std::move(samples)]() mutable {
+		for (auto& sample: samples) {
+			sample.segment->populate();
+		}
+		return std::move(samples);
+	});
+}
+
+void PhysicalDomain::collectTerrainSampling() {
+	if (m_terrainSampling.valid()) {
+		rmt_ScopedCPUSample(PhysicalDomain_collectTerrainSampling, 0)
+		adoptTerrainSamples(m_terrainSampling.get());
+	}
+}
+
+void PhysicalDomain::adoptTerrainSamples(std::vector<TerrainSample> samples) {
+	for (auto& sample: samples) {
+		//If the real segment hasn't been populated, and hasn't changed since it was sampled, it can use the sampled heights.
+		auto segment = m_terrain ? m_terrain->getSegmentAtPos((float)sample.segment->getXRef(), (float)sample.segment->getZRef()) : nullptr;
+		if (segment && !segment->isValid() && segment->getMods() == sample.segment->getMods()) {
+			auto& controlPoints = segment->getControlPoints();
+			auto& sampledControlPoints = sample.segment->getControlPoints();
+			if (controlPoints(0, 0) == sampledControlPoints(0, 0) && controlPoints(1, 0) == sampledControlPoints(1, 0)
+				&& controlPoints(0, 1) == sampledControlPoints(0, 1) && controlPoints(1, 1) == sampledControlPoints(1, 1)) {
+				segment->copyHeightMap(*sample.segment);
+			}
+		}
+		m_sampledTerrain.emplace_back(std::move(sample));
+	}
 }
 
 void PhysicalDomain::processDirtyTerrainAreas() {
+	collectTerrainSampling();
+
 	if (!m_terrain) {
 		m_dirtyTerrainSegmentAreas.clear();
+		m_sampledTerrain.clear();
 		return;
 	}
 
-	if (m_dirtyTerrainSegmentAreas.empty()) {
+	//Areas which were marked as dirty while sampling was running haven't been sampled yet, so do that now.
+	if (!m_dirtyTerrainSegmentAreas.empty()) {
+		auto samples = prepareTerrainSamples();
+		for (auto& sample: samples) {
+			sample.segment->populate();
+		}
+		adoptTerrainSamples(std::move(samples));
+	}
+
+	if (m_sampledTerrain.empty()) {
 		return;
 	}
 	rmt_ScopedCPUSample(PhysicalDomain_processDirtyTerrainAreas, 0)
 
-	std::set<Mercator::Segment*> dirtySegments;
-	for (auto& area: m_dirtyTerrainSegmentAreas) {
-		m_terrain->processSegments(area, [&](Mercator::Segment& s, int, int) { dirtySegments.insert(&s); });
-	}
-	m_dirtyTerrainSegmentAreas.clear();
+	auto sampledTerrain = std::move(m_sampledTerrain);
+	m_sampledTerrain.clear();
 
 	std::optional<float> friction;
 	auto frictionProp = m_entity.getPropertyType<double>("friction");
@@ -2604,11 +2881,15 @@ void PhysicalDomain::processDirtyTerrainAreas() {
 
 	auto worldHeight = mContainingEntityEntry.bbox.highCorner().y() - mContainingEntityEntry.bbox.lowCorner().y();
 
-	cy_debug_print("dirty segments: " << dirtySegments.size())
-	for (auto& segment: dirtySegments) {
+	//A segment might have been sampled more than once during the tick. All samples are applied in order,
+	//but any entities touching the segment are only looked for once.
+	std::map<std::pair<int, int>, WFMath::AxisBox<2>> changedSegments;
+	cy_debug_print("dirty segments: " << sampledTerrain.size())
+	for (auto& sample: sampledTerrain) {
+		auto& segment = sample.segment;
 		cy_debug_print("rebuilding segment at x: " << segment->getXRef() << " z: " << segment->getZRef())
 
-		auto& terrainEntry = buildTerrainPage(*segment);
+		auto& terrainEntry = applyTerrainSample(sample);
 		if (friction) {
 			terrainEntry.rigidBody->setFriction(*friction);
 		}
@@ -2618,29 +2899,33 @@ void PhysicalDomain::processDirtyTerrainAreas() {
 		if (frictionSpinning) {
 			terrainEntry.rigidBody->setSpinningFriction(*frictionSpinning);
 		}
+		changedSegments.emplace(std::make_pair(segment->getXRef(), segment->getZRef()), segment->getRect());
+	}
 
-		struct : public btCollisionWorld::ContactResultCallback {
-			std::vector<PhysicalDomain::BulletEntry*> m_entries;
+	struct : public btCollisionWorld::ContactResultCallback {
+		std::vector<PhysicalDomain::BulletEntry*> m_entries;
+		std::unordered_set<PhysicalDomain::BulletEntry*> m_seen;
 
-			btScalar addSingleResult(btManifoldPoint& cp,
-									 const btCollisionObjectWrapper* colObj0Wrap,
-									 int partId0,
-									 int index0,
-									 const btCollisionObjectWrapper* colObj1Wrap,
-									 int partId1,
-									 int index1) override {
-				auto* bulletEntry = static_cast<BulletEntry*>(colObj1Wrap->m_collisionObject->getUserPointer());
-				if (bulletEntry && (m_entries.empty() || *m_entries.rbegin() != bulletEntry)) {
-					m_entries.emplace_back(bulletEntry);
-				}
-				return btScalar{1.0};
+		btScalar addSingleResult(btManifoldPoint& cp,
+								 const btCollisionObjectWrapper* colObj0Wrap,
+								 int partId0,
+								 int index0,
+								 const btCollisionObjectWrapper* colObj1Wrap,
+								 int partId1,
+								 int index1) override {
+			auto* bulletEntry = static_cast<BulletEntry*>(colObj1Wrap->m_collisionObject->getUserPointer());
+			//Entities can touch more than one of the segments, but should only be moved once.
+			if (bulletEntry && m_seen.insert(bulletEntry).second) {
+				m_entries.emplace_back(bulletEntry);
 			}
-		} callback;
+			return btScalar{1.0};
+		}
+	} callback;
 
-		callback.m_collisionFilterGroup = COLLISION_MASK_TERRAIN;
-		callback.m_collisionFilterMask = COLLISION_MASK_PHYSICAL | COLLISION_MASK_NON_PHYSICAL | COLLISION_MASK_STATIC;
+	callback.m_collisionFilterGroup = COLLISION_MASK_TERRAIN;
+	callback.m_collisionFilterMask = COLLISION_MASK_PHYSICAL | COLLISION_MASK_NON_PHYSICAL | COLLISION_MASK_STATIC;
 
-		auto area = segment->getRect();
+	for (auto& [segmentPos, area]: changedSegments) {
 		WFMath::Vector<2> size = area.highCorner() - area.lowCorner();
 
 		btBoxShape boxShape(btVector3((float)size.x() * 0.5f, (float)worldHeight, (float)size.y() * 0.5f));
@@ -2649,21 +2934,21 @@ void PhysicalDomain::processDirtyTerrainAreas() {
 		auto center = area.getCenter();
 		collObject.setWorldTransform(btTransform(btQuaternion::getIdentity(), btVector3((float)center.x(), 0, (float)center.y())));
 		m_dynamicsWorld->contactTest(&collObject, callback);
+	}
 
-		cy_debug_print("Matched " << callback.m_entries.size() << " entries")
-		for (BulletEntry* entry: callback.m_entries) {
-			cy_debug_print("Adjusting " << entry->entity.describeEntity())
-			Anonymous anon;
-			anon->setId(entry->entity.getIdAsString());
-			std::vector<double> posList;
-			addToEntity(entry->positionProperty.data(), posList);
-			anon->setPos(posList);
-			Move move;
-			move->setTo(entry->entity.getIdAsString());
-			move->setFrom(entry->entity.getIdAsString());
-			move->setArgs1(anon);
-			entry->entity.sendWorld(move);
-		}
+	cy_debug_print("Matched " << callback.m_entries.size() << " entries")
+	for (BulletEntry* entry: callback.m_entries) {
+		cy_debug_print("Adjusting " << entry->entity.describeEntity())
+		Anonymous anon;
+		anon->setId(entry->entity.getIdAsString());
+		std::vector<double> posList;
+		addToEntity(entry->positionProperty.data(), posList);
+		anon->setPos(posList);
+		Move move;
+		move->setTo(entry->entity.getIdAsString());
+		move->setFrom(entry->entity.getIdAsString());
+		move->setArgs1(anon);
+		entry->entity.sendWorld(move);
 	}
 }
 
@@ -2697,29 +2982,30 @@ void PhysicalDomain::processDirtyTerrainSurfaces() {
 void PhysicalDomain::sendMoveSight(BulletEntry& entry, bool posChange, bool velocityChange, bool orientationChange, bool angularChange, bool modeChange) {
 	if (!entry.observingThis.empty()) {
 		LocatedEntity& entity = entry.entity;
-		auto& lastSentLocation = entry.lastSentLocation;
+		auto& transforms = m_transforms;
+		auto index = entry.transformIndex;
 		bool shouldSendOp = false;
 		Anonymous move_arg;
 		if (velocityChange) {
-			::addToEntity(entry.velocityProperty.data(), move_arg->modifyVelocity());
+			::addToEntity(transforms.velocity[index], move_arg->modifyVelocity());
 			shouldSendOp = true;
-			lastSentLocation.velocity = entry.velocityProperty.data();
+			transforms.sentVelocity[index] = transforms.velocity[index];
 		}
 		if (angularChange) {
-			move_arg->setAttr("angular", entry.angularVelocityProperty.data().toAtlas());
+			move_arg->setAttr("angular", transforms.angular[index].toAtlas());
 			shouldSendOp = true;
-			lastSentLocation.angularVelocity = entry.angularVelocityProperty.data();
+			transforms.sentAngular[index] = transforms.angular[index];
 		}
 		if (orientationChange) {
-			move_arg->setAttr("orientation", entry.orientationProperty.data().toAtlas());
+			move_arg->setAttr("orientation", transforms.orientation[index].toAtlas());
 			shouldSendOp = true;
-			lastSentLocation.orientation = entry.orientationProperty.data();
+			transforms.sentOrientation[index] = transforms.orientation[index];
 		}
 		//If the velocity changes we should also send the position, to make it easier for clients to project position.
 		if (posChange || velocityChange) {
-			::addToEntity(entry.positionProperty.data(), move_arg->modifyPos());
+			::addToEntity(transforms.pos[index], move_arg->modifyPos());
 			shouldSendOp = true;
-			lastSentLocation.pos = entry.positionProperty.data();
+			transforms.sentPos[index] = transforms.pos[index];
 		}
 		if (modeChange) {
 			auto prop = entity.getPropertyClassFixed<ModeProperty>();
@@ -2737,8 +3023,8 @@ void PhysicalDomain::sendMoveSight(BulletEntry& entry, bool posChange, bool velo
 			move_arg->setId(entity.getIdAsString());
 			if (debug_flag) {
 				cy_debug_print("Sending set op for movement.")
-				if (entry.velocityProperty.data().isValid()) {
-					cy_debug_print("new velocity: " << entry.velocityProperty.data() << " " << entry.velocityProperty.data().mag())
+				if (transforms.velocity[index].isValid()) {
+					cy_debug_print("new velocity: " << transforms.velocity[index] << " " << transforms.velocity[index].mag())
 				}
 			}
 
@@ -2763,29 +3049,290 @@ void PhysicalDomain::sendMoveSight(BulletEntry& entry, bool posChange, bool velo
 	}
 }
 
+void PhysicalDomain::syncTransforms() {
+	rmt_ScopedCPUSample(PhysicalDomain_syncTransforms, 0)
+	auto& transforms = m_transforms;
+	//Applying properties can lead to entries being added or removed, so we can't hold on to any references here.
+	for (size_t i = 0; i < transforms.dirty.size(); ++i) {
+		auto dirty = transforms.dirty[i];
+		if (dirty == 0) {
+			continue;
+		}
+		transforms.dirty[i] = 0;
+		auto entityId = transforms.entries[i]->entity.getIdAsInt();
+		//Returns the entry again after a property has been applied, or null if it was removed meanwhile (and the slot possibly reused).
+		auto currentEntry = [&]() -> BulletEntry* {
+			auto entry = transforms.entries[i];
+			return entry && entry->entity.getIdAsInt() == entityId ? entry : nullptr;
+		};
+		auto entry = transforms.entries[i];
+		if (dirty & TransformStore::POSITION) {
+			entry->positionProperty.data() = transforms.pos[i];
+			entry->positionProperty.flags().removeFlags(prop_flag_persistence_clean);
+			entry->entity.applyProperty(entry->positionProperty);
+			if (!(entry = currentEntry())) {
+				continue;
+			}
+		}
+		if (dirty & TransformStore::VELOCITY) {
+			entry->velocityProperty.data() = transforms.velocity[i];
+			entry->velocityProperty.flags().removeFlags(prop_flag_persistence_clean);
+			entry->entity.applyProperty(entry->velocityProperty);
+			if (!(entry = currentEntry())) {
+				continue;
+			}
+		}
+		if (dirty & TransformStore::ANGULAR) {
+			entry->angularVelocityProperty.data() = transforms.angular[i];
+			entry->angularVelocityProperty.flags().removeFlags(prop_flag_persistence_clean);
+			entry->entity.applyProperty(entry->angularVelocityProperty);
+			if (!(entry = currentEntry())) {
+				continue;
+			}
+		}
+		if (dirty & TransformStore::ORIENTATION) {
+			entry->orientationProperty.data() = transforms.orientation[i];
+			entry->orientationProperty.flags().removeFlags(prop_flag_persistence_clean);
+			entry->entity.applyProperty(entry->orientationProperty);
+			if (!(entry = currentEntry())) {
+				continue;
+			}
+		}
+		entry->entity.removeFlags(entity_pos_clean | entity_orient_clean);
+	}
+}
+
+void PhysicalDomain::queueTierUpdate(BulletEntry& entry) {
+	if (m_simulationTiersEnabled && !entry.markedForTierUpdate && &entry != &mContainingEntityEntry) {
+		m_tierUpdateQueue.emplace_back(&entry);
+		entry.markedForTierUpdate = true;
+	}
+}
+
+PhysicalDomain::SimulationTier PhysicalDomain::desiredSimulationTier(const BulletEntry& entry) const {
+	//Only free moving dynamic bodies are taken out of the simulation. Static bodies cost nothing to keep, and projectiles should keep on flying.
+	auto rigidBody = btRigidBody::upcast(entry.collisionObject.get());
+	if (!rigidBody || rigidBody->isStaticOrKinematicObject() || (entry.mode != ModeProperty::Mode::Free && entry.mode != ModeProperty::Mode::Submerged)) {
+		return SimulationTier::Full;
+	}
+	//Perceptive entities observe themselves, which shouldn't count.
+	for (auto observer: entry.observingThis) {
+		if (observer != &entry && observer != &mContainingEntityEntry) {
+			return SimulationTier::Full;
+		}
+	}
+	auto destinationProp = entry.control.destinationProperty;
+	auto propelProp = entry.control.propelProperty;
+	if (destinationProp && destinationProp->data().isValid()) {
+		//The destination decides where to go rather than the propel, and an entity which hasn't arrived yet must keep on moving.
+		if (entry.positionProperty.data().isValid() && groundDistance(entry.positionProperty.data(), destinationProp->data()) >= DESTINATION_ARRIVAL_DISTANCE) {
+			return SimulationTier::Coarse;
+		}
+	} else if (propelProp && propelProp->data().isValid() && (propelProp->data().x() != 0 || propelProp->data().z() != 0)) {
+		return SimulationTier::Coarse;
+	}
+	//Let anything still falling or sliding come to rest first. It will be queued again once it has stopped.
+	if (entry.tier == SimulationTier::Full && entry.addedToMovingList) {
+		return SimulationTier::Full;
+	}
+	return SimulationTier::Sleeping;
+}
+
+void PhysicalDomain::updateSimulationTiers() {
+	rmt_ScopedCPUSample(PhysicalDomain_updateSimulationTiers, 0)
+	//Changing tier can lead to more entries being queued, so don't use iterators.
+	for (size_t i = 0; i < m_tierUpdateQueue.size(); ++i) {
+		auto entry = m_tierUpdateQueue[i];
+		entry->markedForTierUpdate = false;
+		setSimulationTier(*entry, desiredSimulationTier(*entry));
+	}
+	m_tierUpdateQueue.clear();
+}
+
+void PhysicalDomain::setSimulationTier(BulletEntry& entry, SimulationTier tier) {
+	if (entry.tier == tier) {
+		return;
+	}
+	auto previousTier = entry.tier;
+	entry.tier = tier;
+	if (previousTier == SimulationTier::Coarse) {
+		//Catch up with the time passed since the last coarse update, so the entity is where it should be when handed back.
+		//This also stops the entry if it's going to sleep.
+		advanceCoarseEntry(entry);
+		m_coarseEntries.erase(&entry);
+	}
+
+	auto rigidBody = btRigidBody::upcast(entry.collisionObject.get());
+	if (tier == SimulationTier::Full) {
+		if (rigidBody) {
+			rigidBody->forceActivationState(ACTIVE_TAG);
+			rigidBody->activate(true);
+		}
+		if (entry.step_factor > 0) {
+			m_steppingEntries.emplace(&entry);
+		}
+		//The propelling will be restored next tick.
+		if (entry.control.propelProperty) {
+			m_propelUpdateQueue.insert(&entry);
+		}
+	} else {
+		if (previousTier == SimulationTier::Full) {
+			m_propellingEntries.erase(entry.entity.getIdAsInt());
+			m_steppingEntries.erase(&entry);
+			if (rigidBody) {
+				rigidBody->setLinearVelocity(btVector3(0, 0, 0));
+				rigidBody->setAngularVelocity(btVector3(0, 0, 0));
+				rigidBody->forceActivationState(DISABLE_SIMULATION);
+			}
+		}
+		entry.lastSimulated = m_simulationTime;
+		if (tier == SimulationTier::Coarse) {
+			m_coarseEntries.emplace(&entry);
+			//Start moving right away, rather than at the next coarse update.
+			advanceCoarseEntry(entry);
+		}
+	}
+}
+
+void PhysicalDomain::advanceCoarseEntry(BulletEntry& entry) {
+	auto elapsed = m_simulationTime - entry.lastSimulated;
+	entry.lastSimulated = m_simulationTime;
+	auto& pos = entry.positionProperty.data();
+	if (!pos.isValid()) {
+		return;
+	}
+
+	auto destinationProp = entry.control.destinationProperty;
+	auto hasDestination = destinationProp && destinationProp->data().isValid();
+
+	//Any change of propel only applies from now on, so first catch up using the velocity the entry had.
+	if (elapsed.count() > 0 && entry.coarseVelocity != WFMath::Vector<3>::ZERO()) {
+		auto movement = entry.coarseVelocity * to_seconds(elapsed);
+		if (hasDestination && std::hypot(movement.x(), movement.z()) >= groundDistance(pos, destinationProp->data())) {
+			//Stop at the destination rather than overshooting it.
+			movement.x() = destinationProp->data().x() - pos.x();
+			movement.z() = destinationProp->data().z() - pos.z();
+		}
+		auto newPos = pos + movement;
+		//Keep within the domain, since there are no borders to collide with.
+		auto& bounds = mContainingEntityEntry.bbox;
+		if (bounds.isValid()) {
+			newPos.x() = std::clamp(newPos.x(), bounds.lowCorner().x(), bounds.highCorner().x());
+			newPos.z() = std::clamp(newPos.z(), bounds.lowCorner().z(), bounds.highCorner().z());
+		}
+		if (entry.mode == ModeProperty::Mode::Free) {
+			//Just follow the ground, without any of the collision checks done when simulated.
+			auto height = static_cast<float>(newPos.y());
+			if (getTerrainHeight(static_cast<float>(newPos.x()), static_cast<float>(newPos.z()), height)) {
+				newPos.y() = height;
+			}
+		}
+
+		applyNewPositionForEntity(entry, newPos, false);
+		entry.positionProperty.flags().removeFlags(prop_flag_persistence_clean);
+		entry.entity.removeFlags(entity_pos_clean);
+		if (entry.collisionObject) {
+			m_dynamicsWorld->updateSingleAabb(entry.collisionObject.get());
+		}
+	}
+
+	auto velocity = WFMath::Vector<3>::ZERO();
+	auto propelProp = entry.control.propelProperty;
+	if (entry.tier != SimulationTier::Sleeping) {
+		double speed = entry.mode == ModeProperty::Mode::Submerged ? entry.speedWater : entry.speedGround;
+		if (hasDestination) {
+			//Steer straight towards the destination, in the same way as applyDestination() does.
+			WFMath::Vector<3> direction(destinationProp->data().x() - pos.x(), 0, destinationProp->data().z() - pos.z());
+			auto distance = direction.mag();
+			if (distance >= DESTINATION_ARRIVAL_DISTANCE) {
+				double propelSpeed = 1.0;
+				if (propelProp && propelProp->data().isValid() && propelProp->data() != WFMath::Vector<3>::ZERO()) {
+					propelSpeed = propelProp->data().mag();
+				}
+				velocity = direction * (propelSpeed * speed / distance);
+			} else {
+				//Arrived, so let it be put to sleep.
+				queueTierUpdate(entry);
+			}
+		} else if (propelProp && propelProp->data().isValid()) {
+			velocity = propelProp->data() * speed;
+			velocity.y() = 0;
+		}
+	}
+	entry.coarseVelocity = velocity;
+	if (velocity != entry.velocityProperty.data()) {
+		entry.velocityProperty.data() = velocity;
+		entry.velocityProperty.flags().removeFlags(prop_flag_persistence_clean);
+		entry.entity.applyProperty(entry.velocityProperty);
+	}
+
+	//Perceptive entities observe themselves, and their minds need to know where they are.
+	processMovedEntity(entry, elapsed);
+}
+
+void PhysicalDomain::processClosenessChecks() {
+	if (m_closenessCheckQueue.empty()) {
+		return;
+	}
+	rmt_ScopedCPUSample(PhysicalDomain_processClosenessChecks, 0)
+	auto queue = std::move(m_closenessCheckQueue);
+	m_closenessCheckQueue.clear();
+
+	//Since callbacks can remove observations we need to first collect all invalid observations, and then remove them carefully.
+	std::vector<ClosenessObserverEntry*> invalidEntries;
+	for (auto& observation: queue) {
+		if (!isWithinReach(*observation->reacher, *observation->target, (float)observation->reach, {})) {
+			invalidEntries.emplace_back(observation);
+		}
+	}
+
+	for (auto& observation: invalidEntries) {
+		//It's important that we check that the observation still is valid, since it's possible that callbacks alters the collections.
+		auto J = m_closenessObservations.find(observation);
+		if (J != m_closenessObservations.end()) {
+			observation->reacher->closenessObservations.erase(observation);
+			observation->target->closenessObservations.erase(observation);
+
+			//Hold on to an instance while we call callbacks and erase it.
+			auto observerInstance = std::move(J->second);
+			m_closenessObservations.erase(J);
+
+			if (observerInstance->callback) {
+				observerInstance->callback();
+			}
+		}
+	}
+}
+
 void PhysicalDomain::processMovedEntity(BulletEntry& bulletEntry, std::chrono::milliseconds timeSinceLastUpdate) {
-	auto& pos = bulletEntry.positionProperty.data();
-	auto& orientation = bulletEntry.orientationProperty.data();
-	auto& velocity = bulletEntry.velocityProperty.data();
-	auto& angular = bulletEntry.angularVelocityProperty.data();
+	assert(bulletEntry.transformIndex != TransformStore::npos);
+	auto index = bulletEntry.transformIndex;
+	auto& transforms = m_transforms;
+	auto& pos = transforms.pos[index];
+	auto& orientation = transforms.orientation[index];
+	auto& velocity = transforms.velocity[index];
+	auto& angular = transforms.angular[index];
+	auto& sentPos = transforms.sentPos[index];
+	auto& sentVelocity = transforms.sentVelocity[index];
+	auto& sentAngular = transforms.sentAngular[index];
+	auto& sentOrientation = transforms.sentOrientation[index];
 	LocatedEntity& entity = bulletEntry.entity;
-	auto& lastSentLocation = bulletEntry.lastSentLocation;
 	//This should normally not happen, but let's check nonetheless.
 	if (!pos.isValid()) {
 		return;
 	}
 
-	bool orientationChange = orientation.isValid() && (!lastSentLocation.orientation.isValid() || !orientation.isEqualTo(lastSentLocation.orientation, 0.1f));
+	bool orientationChange = orientation.isValid() && (!sentOrientation.isValid() || !orientation.isEqualTo(sentOrientation, 0.1f));
 	bool posChange = false;
-	if (!lastSentLocation.pos.isValid()) {
+	if (!sentPos.isValid()) {
 		posChange = true;
 	} else {
 		//If position differs from last sent position, and there's no velocity, then send position update
-		if (lastSentLocation.pos != pos && (!velocity.isValid() || velocity == WFMath::Vector<3>::ZERO())) {
+		if (sentPos != pos && (!velocity.isValid() || velocity == WFMath::Vector<3>::ZERO())) {
 			posChange = true;
 		} else {
-			if (lastSentLocation.velocity.isValid()) {
-				auto projectedPosition = lastSentLocation.pos + (lastSentLocation.velocity * to_seconds(timeSinceLastUpdate));
+			if (sentVelocity.isValid()) {
+				auto projectedPosition = sentPos + (sentVelocity * to_seconds(timeSinceLastUpdate));
 				if (WFMath::Distance(pos, projectedPosition) > 0.5) {
 					posChange = true;
 				}
@@ -2799,38 +3346,38 @@ void PhysicalDomain::processMovedEntity(BulletEntry& bulletEntry, std::chrono::m
 
 		bool velocityChange = false;
 
-		if (bulletEntry.velocityProperty.data().isValid()) {
-			bool hadValidVelocity = lastSentLocation.velocity.isValid();
+		if (velocity.isValid()) {
+			bool hadValidVelocity = sentVelocity.isValid();
 			//Send an update if either the previous velocity was invalid, or any of the velocity components have changed enough, or if either the new or the old velocity is zero.
 			if (!hadValidVelocity) {
-				cy_debug_print("No previous valid velocity " << entity.describeEntity() << " " << lastSentLocation.velocity)
+				cy_debug_print("No previous valid velocity " << entity.describeEntity() << " " << sentVelocity)
 				velocityChange = true;
-				lastSentLocation.velocity = bulletEntry.velocityProperty.data();
+				sentVelocity = velocity;
 			} else {
-				bool xChange = !fuzzyEquals(velocity.x(), lastSentLocation.velocity.x(), 0.01);
-				bool yChange = !fuzzyEquals(velocity.y(), lastSentLocation.velocity.y(), 0.01);
-				bool zChange = !fuzzyEquals(velocity.z(), lastSentLocation.velocity.z(), 0.01);
-				bool hadZeroVelocity = lastSentLocation.velocity.isEqualTo(WFMath::Vector<3>::ZERO());
+				bool xChange = !fuzzyEquals(velocity.x(), sentVelocity.x(), 0.01);
+				bool yChange = !fuzzyEquals(velocity.y(), sentVelocity.y(), 0.01);
+				bool zChange = !fuzzyEquals(velocity.z(), sentVelocity.z(), 0.01);
+				bool hadZeroVelocity = sentVelocity.isEqualTo(WFMath::Vector<3>::ZERO());
 				if (xChange || yChange || zChange) {
 					cy_debug_print("Velocity changed " << entity.describeEntity() << " " << velocity)
 					velocityChange = true;
-					lastSentLocation.velocity = bulletEntry.velocityProperty.data();
-				} else if (bulletEntry.velocityProperty.data().isEqualTo(WFMath::Vector<3>::ZERO()) && !hadZeroVelocity) {
+					sentVelocity = velocity;
+				} else if (velocity.isEqualTo(WFMath::Vector<3>::ZERO()) && !hadZeroVelocity) {
 					cy_debug_print("Old or new velocity zero " << entity.describeEntity() << " " << velocity)
 					velocityChange = true;
-					lastSentLocation.velocity = bulletEntry.velocityProperty.data();
+					sentVelocity = velocity;
 				}
 			}
 		}
 		bool angularChange = false;
 
-		if (bulletEntry.angularVelocityProperty.data().isValid()) {
-			bool hadZeroAngular = lastSentLocation.angularVelocity.isEqualTo(WFMath::Vector<3>::ZERO());
-			angularChange = !fuzzyEquals(lastSentLocation.angularVelocity, angular, 0.01);
-			if (!angularChange && bulletEntry.angularVelocityProperty.data().isEqualTo(WFMath::Vector<3>::ZERO()) && !hadZeroAngular) {
+		if (angular.isValid()) {
+			bool hadZeroAngular = sentAngular.isEqualTo(WFMath::Vector<3>::ZERO());
+			angularChange = !fuzzyEquals(sentAngular, angular, 0.01);
+			if (!angularChange && angular.isEqualTo(WFMath::Vector<3>::ZERO()) && !hadZeroAngular) {
 				cy_debug_print("Angular changed " << entity.describeEntity() << " " << angular)
 				angularChange = true;
-				lastSentLocation.angularVelocity = bulletEntry.angularVelocityProperty.data();
+				sentAngular = angular;
 			}
 		}
 
@@ -2838,44 +3385,16 @@ void PhysicalDomain::processMovedEntity(BulletEntry& bulletEntry, std::chrono::m
 			//Increase sequence number as properties have changed.
 			entity.increaseSequenceNumber();
 			sendMoveSight(bulletEntry, posChange, velocityChange, orientationChange, angularChange, bulletEntry.modeChanged);
-			lastSentLocation.pos = bulletEntry.positionProperty.data();
+			sentPos = pos;
 			bulletEntry.modeChanged = false;
 		}
 
 	}
 	//If the entity has moved and there are observations attached to it, we need to check if these still are valid (like a character
 	// having opened a chest, and then moving away from it).
+	//This is done at the end of the tick, so that observations where both entities have moved are only checked once.
 	if (posChange && !bulletEntry.closenessObservations.empty()) {
-		//Since callbacks can remove observations we need to first collect att invalid observations, and then remove them carefully.
-		std::vector<ClosenessObserverEntry*> invalidEntries;
-		for (auto& observation: bulletEntry.closenessObservations) {
-			if (!isWithinReach(*observation->reacher, *observation->target, (float)observation->reach, {})) {
-				invalidEntries.emplace_back(observation);
-			}
-		}
-
-
-		for (auto& observation: invalidEntries) {
-			//It's important that we check that the observation still is valid, since it's possible that callbacks alters the collections.
-			auto I = bulletEntry.closenessObservations.find(observation);
-			if (I != bulletEntry.closenessObservations.end()) {
-				if (&bulletEntry == observation->reacher) {
-					observation->target->closenessObservations.erase(observation);
-				} else {
-					observation->reacher->closenessObservations.erase(observation);
-				}
-				bulletEntry.closenessObservations.erase(I);
-
-				auto J = m_closenessObservations.find(observation);
-				//Hold on to an instance while we call callbacks and erase it.
-				auto observerInstance = std::move(J->second);
-				m_closenessObservations.erase(J);
-
-				if (observation->callback) {
-					observation->callback();
-				}
-			}
-		}
+		m_closenessCheckQueue.insert(bulletEntry.closenessObservations.begin(), bulletEntry.closenessObservations.end());
 	}
 	updateTerrainMod(bulletEntry);
 }
@@ -2925,12 +3444,18 @@ void PhysicalDomain::tick(std::chrono::milliseconds tickSize, OpVector& res) {
 		tickSize = std::chrono::milliseconds{(long)((double)tickSize.count() * simulationSpeedProp->data())};
 	}
 	auto tickSizeInSeconds = to_seconds(tickSize);
+	m_simulationTime += tickSize;
 
 	projectileCollisions.clear();
 
 	postDuration = {};
 
 	for (auto& bulletEntry: m_propelUpdateQueue) {
+		//Entries which aren't fully simulated might need to change tier instead; they'll get their propel applied when promoted.
+		if (bulletEntry->tier != SimulationTier::Full) {
+			queueTierUpdate(*bulletEntry);
+			continue;
+		}
 		//We'll use the "m_propelUpdateQueue" also for entities with _destination set, so it's not always they have a "_propel" property.
 		if (bulletEntry->control.propelProperty) {
 			auto propel = bulletEntry->control.propelProperty->data().isValid() ? Convert::toBullet(bulletEntry->control.propelProperty->data()) : btVector3(0, 0, 0);
@@ -2974,12 +3499,16 @@ void PhysicalDomain::tick(std::chrono::milliseconds tickSize, OpVector& res) {
 	m_directionUpdateQueue.clear();
 
 	for (auto& entry: m_entriesWithDestination) {
+		if (entry->tier != SimulationTier::Full) {
+			continue;
+		}
 		applyDestination(tickSize, *entry, entry->control.propelProperty, *entry->control.destinationProperty);
 	}
 
 
 	//Step simulations with 60 hz.
 	m_dynamicsWorld->stepSimulation(tickSizeInSeconds, static_cast<int>(60 * tickSizeInSeconds));
+	syncTransforms();
 	auto interim = std::chrono::steady_clock::now() - start;
 
 	//CProfileManager::dumpAll();
@@ -3032,6 +3561,15 @@ void PhysicalDomain::tick(std::chrono::milliseconds tickSize, OpVector& res) {
 	updateVisibilityOfDirtyEntities(res);
 	auto visDuration = std::chrono::steady_clock::now() - visStart;
 
+	updateSimulationTiers();
+	if (m_simulationTime - m_lastCoarseUpdate >= COARSE_SIMULATION_INTERVAL) {
+		rmt_ScopedCPUSample(PhysicalDomain_coarseEntries, 0)
+		m_lastCoarseUpdate = m_simulationTime;
+		for (auto entry: m_coarseEntries) {
+			advanceCoarseEntry(*entry);
+		}
+	}
+
 	processWaterBodies();
 
 	//We process the vector of moving entities as efficient as possible by not doing
@@ -3046,14 +3584,18 @@ void PhysicalDomain::tick(std::chrono::milliseconds tickSize, OpVector& res) {
 			//Stopped moving
 			if (movedEntry->angularVelocityProperty.data().isValid()) {
 				movedEntry->angularVelocityProperty.data().zero();
+				m_transforms.angular[movedEntry->transformIndex].zero();
 			}
 			if (movedEntry->velocityProperty.data().isValid()) {
 				cy_debug_print("Stopped moving " << movedEntry->entity.describeEntity())
 				movedEntry->velocityProperty.data().zero();
+				m_transforms.velocity[movedEntry->transformIndex].zero();
 			}
 			processMovedEntity(*movedEntry, tickSize);
 			movedEntry->markedAsMovingLastFrame = false;
 			movedEntry->addedToMovingList = false;
+			//Now that it has come to rest it might be put to sleep.
+			queueTierUpdate(*movedEntry);
 
 			//If we're removing the last entry just skip
 			if (i == movingSize - 1) {
@@ -3082,6 +3624,8 @@ void PhysicalDomain::tick(std::chrono::milliseconds tickSize, OpVector& res) {
 		m_movingEntities.resize(movingSize);
 	}
 
+	processClosenessChecks();
+
 	processDirtyTerrainAreas();
 	processDirtyTerrainSurfaces();
 
@@ -3089,14 +3633,15 @@ void PhysicalDomain::tick(std::chrono::milliseconds tickSize, OpVector& res) {
 	auto microseconds = std::chrono::duration_cast<std::chrono::microseconds>(duration);
 	if (debug_flag) {
 		spdlog::log(microseconds.count() > 3000 ? spdlog::level::warn : spdlog::level::info,
-			"Physics took {} μs (just stepSimulation {} μs, visibility {} μs, tick size {} μs, visibility queue: {}, postTick: {} μs, moving count: {}).",
+			"Physics took {} μs (just stepSimulation {} μs, visibility {} μs, tick size {} μs, visibility queue: {}, postTick: {} μs, moving count: {}, coarse count: {}).",
 			microseconds.count(),
 			std::chrono::duration_cast<std::chrono::microseconds>(interim).count(),
 			std::chrono::duration_cast<std::chrono::microseconds>(visDuration).count(),
 			std::chrono::duration_cast<std::chrono::microseconds>(tickSize).count(),
 			m_visibilityRecalculateQueue.size(),
 			std::chrono::duration_cast<std::chrono::microseconds>(postDuration).count(),
-			movingSize
+			movingSize,
+			m_coarseEntries.size()
 		);
 	}
 	s_processTimeUs += microseconds.count();
@@ -3364,6 +3909,44 @@ bool PhysicalDomain::isEntityReachable(const LocatedEntity& reachingEntity, doub
 	return false;
 }
 
+std::vector<bool> PhysicalDomain::areEntitiesReachable(const std::vector<ReachQuery>& queries) const {
+	rmt_ScopedCPUSample(PhysicalDomain_areEntitiesReachable, 0)
+	std::vector<bool> result(queries.size(), false);
+
+	//The same reaching entity is often checked against many targets, so only look up each entity once.
+	std::unordered_map<const LocatedEntity*, BulletEntry*> entries;
+	auto lookupEntry = [&](const LocatedEntity& entity) -> BulletEntry* {
+		auto [I, inserted] = entries.try_emplace(&entity, nullptr);
+		if (inserted) {
+			auto J = m_entries.find(entity.getIdAsInt());
+			if (J != m_entries.end() && J->second->positionProperty.data().isValid()) {
+				I->second = J->second.get();
+			}
+		}
+		return I->second;
+	};
+
+	//Queries between two contained entities might need ray tests; these are done last, sorted by target.
+	std::vector<std::pair<BulletEntry*, size_t>> entryQueries;
+	for (size_t i = 0; i < queries.size(); ++i) {
+		auto& query = queries[i];
+		if (&query.reachingEntity == &m_entity || &query.queriedEntity == &m_entity) {
+			result[i] = isEntityReachable(query.reachingEntity, query.reach, query.queriedEntity, query.positionOnQueriedEntity);
+		} else if (query.reach != 0 && lookupEntry(query.reachingEntity)) {
+			if (auto targetEntry = lookupEntry(query.queriedEntity)) {
+				entryQueries.emplace_back(targetEntry, i);
+			}
+		}
+	}
+
+	std::sort(entryQueries.begin(), entryQueries.end());
+	for (auto& [targetEntry, index]: entryQueries) {
+		auto& query = queries[index];
+		result[index] = isWithinReach(*entries[&query.reachingEntity], *targetEntry, (float)query.reach, query.positionOnQueriedEntity);
+	}
+	return result;
+}
+
 bool PhysicalDomain::isWithinReach(BulletEntry& reacherEntry, BulletEntry& targetEntry, float reach, const WFMath::Point<3>& positionOnQueriedEntity) {
 
 
@@ -3414,6 +3997,11 @@ bool PhysicalDomain::isWithinReach(BulletEntry& reacherEntry, BulletEntry& targe
 }
 
 std::vector<Domain::CollisionEntry> PhysicalDomain::queryCollision(const WFMath::Ball<3>& sphere) const {
+	return std::move(queryCollisions({sphere}).front());
+}
+
+std::vector<std::vector<Domain::CollisionEntry>> PhysicalDomain::queryCollisions(const std::vector<WFMath::Ball<3>>& spheres) const {
+	rmt_ScopedCPUSample(PhysicalDomain_queryCollisions, 0)
 	struct : btCollisionWorld::ContactResultCallback {
 		std::map<BulletEntry*, btManifoldPoint> m_entries;
 
@@ -3432,25 +4020,70 @@ std::vector<Domain::CollisionEntry> PhysicalDomain::queryCollision(const WFMath:
 
 	} callback;
 
-	btTransform pos(btQuaternion::getIdentity(), Convert::toBullet(sphere.center()));
+	struct : btBroadphaseAabbCallback {
+		std::vector<btCollisionObject*> m_objects;
 
-	btSphereShape shape(static_cast<btScalar>(sphere.radius()));
+		bool process(const btBroadphaseProxy* proxy) override {
+			m_objects.emplace_back(static_cast<btCollisionObject*>(proxy->m_clientObject));
+			return true;
+		}
+	} candidates;
+
+	std::vector<std::vector<Domain::CollisionEntry>> result(spheres.size());
 
-	btCollisionObject collisionObject;
-	collisionObject.setCollisionShape(&shape);
-	collisionObject.setWorldTransform(pos);
+	//Sort the spheres into cells, so that nearby queries can share one traversal of the broadphase.
+	std::map<std::pair<long, long>, std::vector<size_t>> cells;
+	for (size_t i = 0; i < spheres.size(); ++i) {
+		auto& center = spheres[i].center();
+		if (center.isValid()) {
+			cells[{std::lround(std::floor(center.x() / COLLISION_QUERY_CELL_SIZE)), std::lround(std::floor(center.z() / COLLISION_QUERY_CELL_SIZE))}].emplace_back(i);
+		}
+	}
 
-	m_dynamicsWorld->contactTest(&collisionObject, callback);
+	for (auto& [cell, indices]: cells) {
+		btVector3 cellMin(BT_LARGE_FLOAT, BT_LARGE_FLOAT, BT_LARGE_FLOAT);
+		btVector3 cellMax(-BT_LARGE_FLOAT, -BT_LARGE_FLOAT, -BT_LARGE_FLOAT);
+		for (auto index: indices) {
+			auto center = Convert::toBullet(spheres[index].center());
+			auto radius = static_cast<btScalar>(spheres[index].radius());
+			cellMin.setMin(center - btVector3(radius, radius, radius));
+			cellMax.setMax(center + btVector3(radius, radius, radius));
+		}
+		candidates.m_objects.clear();
+		m_dynamicsWorld->getBroadphase()->aabbTest(cellMin, cellMax, candidates);
+
+		for (auto index: indices) {
+			auto& sphere = spheres[index];
+			btTransform pos(btQuaternion::getIdentity(), Convert::toBullet(sphere.center()));
+			auto radius = static_cast<btScalar>(sphere.radius());
+			btVector3 aabbMin = pos.getOrigin() - btVector3(radius, radius, radius);
+			btVector3 aabbMax = pos.getOrigin() + btVector3(radius, radius, radius);
+
+			btSphereShape shape(radius);
+
+			btCollisionObject collisionObject;
+			collisionObject.setCollisionShape(&shape);
+			collisionObject.setWorldTransform(pos);
+
+			callback.m_entries.clear();
+			for (auto candidate: candidates.m_objects) {
+				auto proxy = candidate->getBroadphaseHandle();
+				//Same checks as done by btCollisionWorld::contactTest().
+				if (callback.needsCollision(proxy) && TestAabbAgainstAabb2(aabbMin, aabbMax, proxy->m_aabbMin, proxy->m_aabbMax)) {
+					m_dynamicsWorld->contactPairTest(&collisionObject, candidate, callback);
+				}
+			}
 
-	std::vector<Domain::CollisionEntry> result;
-	result.reserve(callback.m_entries.size());
-	for (auto& entry: callback.m_entries) {
-		result.emplace_back(Domain::CollisionEntry{
-			.entity = &entry.first->entity,
-			.collisionPoint = Convert::toWF<WFMath::Point<3>>(entry.second.getPositionWorldOnA()),
-			//                                                   std::abs(entry.second.getDistance())});
-			.distance = (float)entry.second.getPositionWorldOnB().distance(pos.getOrigin())
-		});
+			auto& collisions = result[index];
+			collisions.reserve(callback.m_entries.size());
+			for (auto& entry: callback.m_entries) {
+				collisions.emplace_back(Domain::CollisionEntry{
+					.entity = &entry.first->entity,
+					.collisionPoint = Convert::toWF<WFMath::Point<3>>(entry.second.getPositionWorldOnA()),
+					.distance = (float)entry.second.getPositionWorldOnB().distance(pos.getOrigin())
+				});
+			}
+		}
 	}
 	return result;
 }
@@ -3469,6 +4102,7 @@ std::optional<std::function<void()>> PhysicalDomain::observeCloseness(LocatedEnt
 			([this, reacherEntry, targetEntry, obs]() {
 				reacherEntry->closenessObservations.erase(obs);
 				targetEntry->closenessObservations.erase(obs);
+				m_closenessCheckQueue.erase(obs);
 				m_closenessObservations.erase(obs);
 			})
 		};
@@ -3477,6 +4111,7 @@ std::optional<std::function<void()>> PhysicalDomain::observeCloseness(LocatedEnt
 }
 
 void PhysicalDomain::removed() {
+	m_closenessCheckQueue.clear();
 	//Copy to allow modifications to the field during callbacks.
 	auto observations = std::move(m_closenessObservations);
 	for (auto& entry: observations) {
@@ -30,10 +30,13 @@
 
 #include <map>
 #include <unordered_map>
+#include <vector>
+#include <limits>
 #include <array>
 #include <set>
 #include <chrono>
 #include <optional>
+#include <future>
 
 namespace Mercator {
 class Segment;
@@ -100,6 +103,8 @@ public:
 
 	bool isEntityReachable(const LocatedEntity& reachingEntity, double reach, const LocatedEntity& queriedEntity, const WFMath::Point<3>& positionOnQueriedEntity) const override;
 
+	std::vector<bool> areEntitiesReachable(const std::vector<ReachQuery>& queries) const override;
+
 	void installDelegates(LocatedEntity& entity, const std::string& propertyName) override;
 
 	HandlerResult operation(LocatedEntity& entity, const Operation& op, OpVector& res) override;
@@ -108,6 +113,8 @@ public:
 
 	std::vector<CollisionEntry> queryCollision(const WFMath::Ball<3>& sphere) const override;
 
+	std::vector<std::vector<CollisionEntry>> queryCollisions(const std::vector<WFMath::Ball<3>>& spheres) const override;
+
 	std::optional<std::function<void()>> observeCloseness(LocatedEntity& entity1, LocatedEntity& entity2, double reach, std::function<void()> callback) override;
 
 	void removed() override;
@@ -122,11 +129,78 @@ protected:
 
 	struct ClosenessObserverEntry;
 
-	struct PhysicalData {
-		Point3D pos{};
-		Vector3D velocity{};
-		Vector3D angularVelocity{};
-		Quaternion orientation{};
+	struct BulletEntry;
+
+	/**
+	 * Transforms and velocities of all children, stored as a struct of arrays indexed by BulletEntry::transformIndex.
+	 *
+	 * The motion states write the simulated values here, and these are then written through to the properties in one
+	 * pass per tick (see syncTransforms()). The values last sent to observers are kept here as well, so that detecting
+	 * which changes to send is done on contiguous arrays instead of by chasing pointers through the properties.
+	 * Whenever any of the properties are applied from outside of the simulation the new value is read back.
+	 */
+	struct TransformStore {
+		static constexpr std::uint32_t npos = std::numeric_limits<std::uint32_t>::max();
+
+		enum Component : std::uint8_t {
+			POSITION = 1u << 0u,
+			VELOCITY = 1u << 1u,
+			ANGULAR = 1u << 2u,
+			ORIENTATION = 1u << 3u
+		};
+
+		std::vector<Point3D> pos;
+		std::vector<Vector3D> velocity;
+		std::vector<Vector3D> angular;
+		std::vector<Quaternion> orientation;
+
+		std::vector<Point3D> sentPos;
+		std::vector<Vector3D> sentVelocity;
+		std::vector<Vector3D> sentAngular;
+		std::vector<Quaternion> sentOrientation;
+
+		/**
+		 * Components changed by the simulation which haven't yet been written to the properties.
+		 */
+		std::vector<std::uint8_t> dirty;
+
+		/**
+		 * The entry owning each slot, or null if the slot is free.
+		 */
+		std::vector<BulletEntry*> entries;
+
+		std::vector<std::uint32_t> freeSlots;
+
+		/**
+		 * Allocates a slot for the entry, filled with the current values of its properties.
+		 */
+		std::uint32_t add(BulletEntry& entry);
+
+		void remove(std::uint32_t index);
+
+		/**
+		 * Reads the values of the entry's properties into its slot, discarding any pending changes.
+		 * @param components The components to read.
+		 */
+		void readFromProperties(const BulletEntry& entry, std::uint8_t components);
+	};
+
+	/**
+	 * Entities which can't be seen by anyone else don't need to be simulated with full fidelity.
+	 */
+	enum class SimulationTier {
+		/**
+		 * Simulated by Bullet each tick.
+		 */
+		Full,
+		/**
+		 * Unobserved but self propelled, or on its way to a destination. Taken out of the simulation and instead moved kinematically at a reduced rate.
+		 */
+		Coarse,
+		/**
+		 * Unobserved and at rest. Taken out of the simulation until observed or propelled.
+		 */
+		Sleeping
 	};
 
 	struct BulletEntry {
@@ -160,7 +234,6 @@ protected:
 		std::unique_ptr<btCollisionObject> collisionObject;
 		sigc::connection propertyUpdatedConnection;
 
-		PhysicalData lastSentLocation;
 		std::unique_ptr<PhysicalMotionState> motionState;
 
 		std::unique_ptr<btCollisionObject> visibilitySphere;
@@ -271,12 +344,54 @@ protected:
 			const Vector3Property<LocatedEntity>* destinationProperty{};
 		} control;
 
+		/**
+		 * Index of the entry's slot in the TransformStore.
+		 */
+		std::uint32_t transformIndex = TransformStore::npos;
+
+		SimulationTier tier = SimulationTier::Full;
+
+		/**
+		 * Set to true if the entry already has been added to m_tierUpdateQueue.
+		 */
+		bool markedForTierUpdate = false;
+
+		/**
+		 * The simulation time up to which an entry which isn't fully simulated has been brought.
+		 */
+		std::chrono::milliseconds lastSimulated{};
+
+		/**
+		 * The velocity an entry in the Coarse tier has been moving with since lastSimulated.
+		 */
+		WFMath::Vector<3> coarseVelocity = WFMath::Vector<3>::ZERO();
+
 	};
 
 	struct TerrainEntry {
 		std::unique_ptr<std::array<btScalar, 65 * 65>> data{};
 		std::unique_ptr<btRigidBody> rigidBody{};
 		std::unique_ptr<btCollisionShape> shape{};
+		/**
+		 * The height range the shape was created for. As long as the heights stay within it the data can be updated in place.
+		 */
+		float minHeight{};
+		float maxHeight{};
+	};
+
+	/**
+	 * Heights sampled for a terrain segment which has changed.
+	 */
+	struct TerrainSample {
+		/**
+		 * A copy of the segment, with the same base points and mods. It's populated on a separate thread, so that the
+		 * real segment isn't touched while the main thread is using the terrain.
+		 */
+		std::unique_ptr<Mercator::Segment> segment;
+		/**
+		 * The changed rectangle, in points local to the segment. Only this needs to be copied into the height field.
+		 */
+		int lx{}, hx{}, lz{}, hz{};
 	};
 
 
@@ -292,10 +407,17 @@ protected:
 
 	std::map<ClosenessObserverEntry*, std::unique_ptr<ClosenessObserverEntry>> m_closenessObservations;
 
+	/**
+	 * Observations where any of the entities have moved, and which should be checked at the end of the tick.
+	 */
+	std::set<ClosenessObserverEntry*> m_closenessCheckQueue;
+
 	std::unordered_map<long, std::unique_ptr<BulletEntry>> m_entries;
 
 	std::vector<BulletEntry*> m_movingEntities;
 
+	TransformStore m_transforms;
+
 	/**
 	 * Contains entities which needs to have their visibility recalculated, either because they moved or they changed size.
 	 */
@@ -314,6 +436,16 @@ protected:
 	std::vector<WFMath::AxisBox<2>> m_dirtyTerrainSegmentAreas;
 	std::vector<WFMath::AxisBox<2>> m_dirtyTerrainSurfaceAreas;
 
+	/**
+	 * Terrain sampling currently running on a separate thread, if any.
+	 */
+	std::future<std::vector<TerrainSample>> m_terrainSampling;
+
+	/**
+	 * Samples which are done, and which should be applied to the height fields at the end of the tick.
+	 */
+	std::vector<TerrainSample> m_sampledTerrain;
+
 	struct TerrainModEntry {
 		WFMath::Point<3> modPos{};
 		WFMath::Quaternion modOrientation{};
@@ -355,6 +487,23 @@ protected:
 	 */
 	std::set<BulletEntry*> m_steppingEntries;
 
+	/**
+	 * Entries which have had their observers or propelling changed, and thus might need to switch simulation tier.
+	 */
+	std::vector<BulletEntry*> m_tierUpdateQueue;
+
+	/**
+	 * Entries in the Coarse simulation tier, which are moved every COARSE_SIMULATION_INTERVAL.
+	 */
+	std::set<BulletEntry*> m_coarseEntries;
+
+	/**
+	 * The total simulated time. Used to know how much time has passed for entries which aren't simulated each tick.
+	 */
+	std::chrono::milliseconds m_simulationTime{};
+
+	std::chrono::milliseconds m_lastCoarseUpdate{};
+
 	/**
 	 * Struct used to pass information on to the tick callbacks.
 	 */
@@ -381,6 +530,11 @@ protected:
 
 	double m_visibilityCheckCountdown;
 
+	/**
+	 * Whether entities no one else observes are moved to lower simulation tiers. Controlled by the "simulation_tiers" option.
+	 */
+	bool m_simulationTiersEnabled;
+
 	struct {
 		PositionProperty<LocatedEntity> positionProperty{};
 		VelocityProperty<LocatedEntity> velocityProperty{};
@@ -450,15 +604,37 @@ protected:
 
 	static void getCollisionFlagsForEntity(const BulletEntry& entry, short& collisionGroup, short& collisionMask) ;
 
-	static void sendMoveSight(BulletEntry& bulletEntry, bool posChange, bool velocityChange, bool orientationChange, bool angularChange, bool modeChanged);
+	void sendMoveSight(BulletEntry& bulletEntry, bool posChange, bool velocityChange, bool orientationChange, bool angularChange, bool modeChanged);
+
+	/**
+	 * Writes all transforms changed by the simulation through to the properties of the entities.
+	 */
+	void syncTransforms();
+
+	void queueTierUpdate(BulletEntry& entry);
+
+	SimulationTier desiredSimulationTier(const BulletEntry& entry) const;
+
+	/**
+	 * Moves all queued entries to the simulation tier matching whether they are observed and propelled.
+	 */
+	void updateSimulationTiers();
+
+	void setSimulationTier(BulletEntry& entry, SimulationTier tier);
+
+	/**
+	 * Moves an entry in the Coarse tier with the velocity it had, for the time passed since it was last simulated.
+	 * The velocity is then updated to steer towards its destination if it has one, and otherwise from its propel vector.
+	 */
+	void advanceCoarseEntry(BulletEntry& entry);
 
 	void processMovedEntity(BulletEntry& bulletEntry, std::chrono::milliseconds timeSinceLastUpdate);
 
 	void updateVisibilityOfDirtyEntities(OpVector& res);
 
-	void updateObservedEntry(BulletEntry& entry, OpVector& res, bool generateOps = true) const;
+	void updateObservedEntry(BulletEntry& entry, OpVector& res, bool generateOps = true);
 
-	void updateObserverEntry(BulletEntry& bulletEntry, OpVector& res) const;
+	void updateObserverEntry(BulletEntry& bulletEntry, OpVector& res);
 
 	void applyNewPositionForEntity(BulletEntry& entry, const WFMath::Point<3>& pos, bool calculatePosition = true);
 
@@ -470,6 +646,33 @@ protected:
 
 	void processDirtyTerrainAreas();
 
+	/**
+	 * Creates samples, not yet populated, for all segments touched by the dirty terrain areas.
+	 */
+	std::vector<TerrainSample> prepareTerrainSamples();
+
+	/**
+	 * Starts sampling the dirty terrain areas on a separate thread, unless sampling already is running.
+	 */
+	void dispatchTerrainSampling();
+
+	/**
+	 * Waits for any running terrain sampling to complete.
+	 * This must be called before any terrain mods are changed, since the sampling thread accesses them.
+	 */
+	void collectTerrainSampling();
+
+	/**
+	 * Stores populated samples for the end of the tick. The heights are also handed to the real segments, if these
+	 * haven't been changed since the samples were taken.
+	 */
+	void adoptTerrainSamples(std::vector<TerrainSample> samples);
+
+	/**
+	 * Copies the sampled heights into the matching terrain page, creating it if needed.
+	 */
+	TerrainEntry& applyTerrainSample(const TerrainSample& sample);
+
 	void processDirtyTerrainSurfaces();
 
 	void applyDestination(std::chrono::milliseconds tickSize, BulletEntry& entry, const PropelProperty* propelProp, const Vector3Property<LocatedEntity>& destinationProp);
@@ -513,6 +716,11 @@ protected:
 
 	static bool isWithinReach(BulletEntry& reacherEntry, BulletEntry& targetEntry, float reach, const WFMath::Point<3>& positionOnQueriedEntity) ;
 
+	/**
+	 * Checks all observations in m_closenessCheckQueue, calling the callbacks of those no longer within reach.
+	 */
+	void processClosenessChecks();
+
 
 	/**
 	 * Calculate the radius of a visibility sphere, taking both any "vis_dist" property as
@@ -60,6 +60,7 @@ WorldRouter::WorldRouter(Ref<LocatedEntity> baseEntity,
 		m_baseEntity(std::move(baseEntity)),
 		m_entityCreator(entityCreator) {
 	m_eobjects[m_baseEntity->getIdAsInt()] = m_baseEntity;
+	m_entitiesByType[m_baseEntity->getType()].insert(m_baseEntity.get());
 	Monitors::instance().watch("entities", std::make_unique<Variable<int>>(m_entityCount));
 
 
@@ -80,6 +81,7 @@ void WorldRouter::shutdown() {
 	//in them.
 	m_operationsDispatcher.clearQueues();
 	m_suspendedQueue = std::queue<OpQueEntry<LocatedEntity>>();
+	m_entitiesByType.clear();
 	m_baseEntity = nullptr;
 	BaseWorld::shutdown();
 }
@@ -96,6 +98,7 @@ void WorldRouter::addEntity(const Ref<LocatedEntity>& ent, const Ref<LocatedEnti
 	assert(ent->getIdAsInt() != 0);
 	assert(m_eobjects.find(ent->getIdAsInt()) == m_eobjects.end());
 	m_eobjects[ent->getIdAsInt()] = ent;
+	m_entitiesByType[ent->getType()].insert(ent.get());
 	++m_entityCount;
 
 	ent->changeContainer(parent);
@@ -168,6 +171,13 @@ void WorldRouter::delEntity(LocatedEntity* ent) {
 		return;
 	}
 	assert(ent->getIdAsInt() != 0);
+	auto I = m_entitiesByType.find(ent->getType());
+	if (I != m_entitiesByType.end()) {
+		I->second.erase(ent);
+		if (I->second.empty()) {
+			m_entitiesByType.erase(I);
+		}
+	}
 	ent->destroy();
 	ent->updated.emit();
 	m_eobjects.erase(ent->getIdAsInt());
@@ -393,14 +403,27 @@ Ref<LocatedEntity> WorldRouter::findByName(const std::string& name) {
 /// @return a pointer to an entity of the type required, or zero if no
 /// instance was found.
 Ref<LocatedEntity> WorldRouter::findByType(const std::string& type) {
-	for (auto& entry: m_eobjects) {
-		if (entry.second->getType()->name() == type) {
-			return entry.second;
+	for (auto& entry: m_entitiesByType) {
+		if (entry.first && entry.first->name() == type && !entry.second.empty()) {
+			//The set is ordered by address, so pick by id to give the same answer every time.
+			auto I = std::min_element(entry.second.begin(), entry.second.end(), [](const LocatedEntity* lhs, const LocatedEntity* rhs) {
+				return lhs->getIdAsInt() < rhs->getIdAsInt();
+			});
+			return *I;
 		}
 	}
 	return nullptr;
 }
 
+const std::set<LocatedEntity*>& WorldRouter::getEntitiesOfType(const TypeNode<LocatedEntity>* type) const {
+	static const std::set<LocatedEntity*> empty;
+	auto I = m_entitiesByType.find(type);
+	if (I == m_entitiesByType.end()) {
+		return empty;
+	}
+	return I->second;
+}
+
 OperationsDispatcher<LocatedEntity>& WorldRouter::getOperationsHandler() {
 	return m_operationsDispatcher;
 }
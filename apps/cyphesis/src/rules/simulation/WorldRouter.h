@@ -25,6 +25,7 @@
 
 
 #include <list>
+#include <map>
 #include <set>
 #include <queue>
 
@@ -53,6 +54,12 @@ private:
 	 */
 	std::set<std::string> m_spawnEntities;
 
+	/**
+	 * All entities in the world, grouped by their type.
+	 * This allows for the entities affected by a type update to be found without looking at every entity.
+	 */
+	std::map<const TypeNode<LocatedEntity>*, std::set<LocatedEntity*>> m_entitiesByType;
+
 	/// \brief The top level in-game entity in the world.
 	Ref<LocatedEntity> m_baseEntity;
 	EntityCreator& m_entityCreator;
@@ -109,6 +116,11 @@ public:
 
 	Ref<LocatedEntity> findByType(const std::string& type) override;
 
+	/**
+	 * @return All entities in the world of exactly the type.
+	 */
+	const std::set<LocatedEntity*>& getEntitiesOfType(const TypeNode<LocatedEntity>* type) const;
+
 	/// \brief Signal that a new Entity has been inserted.
 	sigc::signal<void(LocatedEntity&)> inserted;
 
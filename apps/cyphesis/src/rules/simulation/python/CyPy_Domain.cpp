@@ -48,9 +48,31 @@ void CyPy_Domain::init_type() {
 
 Py::Object CyPy_Domain::query_collisions(const Py::Tuple& args) {
 	args.verify_length(1);
+	auto domain = m_value->getDomain();
+
+	//If a list of spheres is supplied they are all queried at once, and a list of lists is returned.
+	if (args.front().isList()) {
+		auto sphereList = verifyList(args.front());
+		std::vector<WFMath::Ball<3>> spheres;
+		spheres.reserve(sphereList.size());
+		for (auto item: sphereList) {
+			spheres.emplace_back(verifyObject<CyPy_Ball>(item));
+		}
+		//Always return one list per sphere, even if there's no domain.
+		auto collisionLists = domain ? domain->queryCollisions(spheres) : std::vector<std::vector<Domain::CollisionEntry>>(spheres.size());
+		Py::List list;
+		for (auto& collisions: collisionLists) {
+			Py::List collisionList;
+			for (auto& collision: collisions) {
+				collisionList.append(CyPy_CollisionEntry::wrap(collision));
+			}
+			list.append(collisionList);
+		}
+		return list;
+	}
+
 	auto sphere = verifyObject<CyPy_Ball>(args.front());
 	Py::List list;
-	auto domain = m_value->getDomain();
 	if (domain) {
 		auto collisions = domain->queryCollision(sphere);
 		for (auto& collision: collisions) {
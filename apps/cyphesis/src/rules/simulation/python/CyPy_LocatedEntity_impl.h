@@ -196,6 +196,21 @@ Py::Object CyPy_LocatedEntityBase<TValue, TPythonClass>::can_reach(const Py::Tup
 		extraReach = verifyNumeric(args[1]);
 	}
 
+	//If a list of locations is supplied they are all checked at once, and a list of booleans is returned.
+	if (args.front().isList()) {
+		auto locationList = verifyList(args.front());
+		std::vector<EntityLocation<LocatedEntity>> locations;
+		locations.reserve(locationList.size());
+		for (auto item: locationList) {
+			locations.emplace_back(verifyObject<CyPy_EntityLocation<LocatedEntity, CyPy_LocatedEntity>>(item));
+		}
+		Py::List list;
+		for (auto reachable: this->m_value->canReachEach(locations, extraReach)) {
+			list.append(Py::Boolean(reachable));
+		}
+		return list;
+	}
+
 	return Py::Boolean(this->m_value->canReach(verifyObject<CyPy_EntityLocation<LocatedEntity, CyPy_LocatedEntity>>(args.front()), extraReach));
 }
 
@@ -33,6 +33,7 @@
 #include "rules/simulation//Inheritance.h"
 
 #include "common/operations/Monitor.h"
+#include "pythonbase/ScriptProfiler.h"
 
 #include <Atlas/Objects/Anonymous.h>
 
@@ -187,6 +188,16 @@ void Admin::GetOperation(const Operation& op, OpVector& res) {
 						res, getIdAsString());
 			return;
 		}
+	} else if (objtype == "profile" && id == "scripts") {
+		auto& profiler = ScriptProfiler::instance();
+		Anonymous info_arg;
+		info_arg->setId(id);
+		info_arg->setObjtype(objtype);
+		info_arg->setAttr("enabled", profiler.isEnabled() ? 1 : 0);
+		info_arg->setAttr("time", profiler.getFolded(ScriptProfiler::Metric::Time));
+		info_arg->setAttr("allocations", profiler.getFolded(ScriptProfiler::Metric::Allocations));
+		info_arg->setAttr("allocated_bytes", profiler.getFolded(ScriptProfiler::Metric::AllocatedBytes));
+		info->setArgs1(info_arg);
 	} else if (objtype == "class" ||
 			   objtype == "meta" ||
 			   objtype == "op_definition") {
@@ -338,6 +349,17 @@ void Admin::setAttribute(const Root& args) {
 		const Element possessiveElement = args->getAttr("possessive");
 		m_connection->setPossessionEnabled(possessiveElement.isInt() && possessiveElement.asInt() != 0, getIdAsString());
 	}
+	//The attribute "script_profiling" turns profiling of Python scripts on or off. Any earlier samples are cleared when turned on.
+	if (args->hasAttr("script_profiling")) {
+		const Element profilingElement = args->getAttr("script_profiling");
+		bool enabled = profilingElement.isInt() && profilingElement.asInt() != 0;
+		auto& profiler = ScriptProfiler::instance();
+		if (enabled && !profiler.isEnabled()) {
+			profiler.clear();
+		}
+		profiler.setEnabled(enabled);
+		spdlog::info("Script profiling {} by account {}.", enabled ? "enabled" : "disabled", getIdAsString());
+	}
 }
 
 
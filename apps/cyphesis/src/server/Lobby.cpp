@@ -89,6 +89,7 @@ void Lobby::operation(const Operation& op, OpVector& res) {
 	cy_debug_print("Lobby::operation(" << op->getParent());
 	const std::string& to = op->getTo();
 	if (to.empty() || to == getIdAsString()) {
+		//The same op is reused for every recipient; a connection which encodes it later takes its own copy when sent.
 		Operation newop(op.copy());
 		for (auto& entry: m_accounts) {
 			auto c = entry.second->getConnection();
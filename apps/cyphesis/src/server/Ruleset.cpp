@@ -39,6 +39,9 @@
 #include <iostream>
 #include <chrono>
 #include <boost/asio/steady_timer.hpp>
+#include <boost/asio/thread_pool.hpp>
+#include <boost/asio/post.hpp>
+#include <thread>
 
 using Atlas::Message::Element;
 using Atlas::Message::MapType;
@@ -50,6 +53,29 @@ typedef std::map<std::string, Root> RootDict;
 
 static constexpr auto debug_flag = false;
 
+namespace {
+/**
+ * Calls the function for all rules, making sure that any parent of a rule which is in the same set of rules is
+ * called before the rule itself.
+ */
+void forEachInDependencyOrder(const RootDict& rules, const std::function<void(const std::string&, const Root&)>& fn) {
+	std::set<std::string> visited;
+	std::function<void(const std::string&, const Root&)> visit = [&](const std::string& class_name, const Root& class_desc) {
+		if (!visited.insert(class_name).second) {
+			return;
+		}
+		auto I = rules.find(class_desc->getParent());
+		if (I != rules.end()) {
+			visit(I->first, I->second);
+		}
+		fn(class_name, class_desc);
+	};
+	for (auto& entry: rules) {
+		visit(entry.first, entry.second);
+	}
+}
+}
+
 Ruleset::Ruleset(EntityBuilder& eb, boost::asio::io_context& io_context, PropertyManager<LocatedEntity>& propertyManager) :
 		m_entityHandler(new EntityRuleHandler(eb, propertyManager)),
 		m_opHandler(new OpRuleHandler()),
@@ -113,14 +139,8 @@ int Ruleset::installRule(const std::string& class_name,
 	// Possibly we should report some types of failure here.
 	int ret = installRuleInner(class_name, class_desc, dependent, reason, changes);
 
-	if (!changes.empty()) {
-		for (auto& entry: changes) {
-			Inheritance::instance().updateClass(entry.first->name(), entry.first->description(Visibility::PRIVATE));
-			//TODO: write to user writable rule files
-		}
-
-		Inheritance::instance().typesUpdated(changes);
-	}
+	//The parent's description now lists the new class as a child.
+	publishChanges(changes, {class_name, class_desc->getParent()});
 
 	return ret;
 }
@@ -165,6 +185,21 @@ int Ruleset::modifyRule(const std::string& class_name,
 	std::map<const TypeNode<LocatedEntity>*, TypeNode<LocatedEntity>::PropertiesUpdate> changes;
 	auto ret = modifyRuleInner(class_name, class_desc, changes);
 
+	publishChanges(changes, {class_name});
+
+	return ret;
+}
+
+void Ruleset::publishChanges(std::map<const TypeNode<LocatedEntity>*, TypeNode<LocatedEntity>::PropertiesUpdate>& changes,
+							 const std::set<std::string>& updatedClasses) {
+	for (auto I = changes.begin(); I != changes.end();) {
+		if (I->second.empty() && !updatedClasses.contains(I->first->name())) {
+			I = changes.erase(I);
+		} else {
+			++I;
+		}
+	}
+
 	if (!changes.empty()) {
 		for (auto& entry: changes) {
 			Inheritance::instance().updateClass(entry.first->name(), entry.first->description(Visibility::PRIVATE));
@@ -173,8 +208,6 @@ int Ruleset::modifyRule(const std::string& class_name,
 
 		Inheritance::instance().typesUpdated(changes);
 	}
-
-	return ret;
 }
 
 int Ruleset::modifyRuleInner(const std::string& class_name,
@@ -218,42 +251,29 @@ void Ruleset::processChangedRules() {
 	rmt_ScopedCPUSample(processChangedRules, 0)
 	if (!m_changedRules.empty()) {
 		RootDict updatedRules;
-		for (auto& path: m_changedRules) {
-			try {
-				spdlog::debug("Reloading rule file {}", path.string());
-				auto& filename = path.native();
-				AtlasFileLoader f(Inheritance::instance().getFactories(), filename, updatedRules);
-				if (!f.isOpen()) {
-					spdlog::error("Unable to open rule file \"{}\".", filename);
-				} else {
-					spdlog::info("Rule file \"{}\" reloaded.", filename);
-					f.read();
-				}
-			} catch (const std::exception& e) {
-				spdlog::error("Error when reacting to changed file at '{}': {}", path.string(), e.what());
-			}
-		}
+		loadRuleFiles({m_changedRules.begin(), m_changedRules.end()}, updatedRules);
 		if (!updatedRules.empty()) {
 			std::map<const TypeNode<LocatedEntity>*, TypeNode<LocatedEntity>::PropertiesUpdate> changes;
-			for (auto& entry: updatedRules) {
-				auto& class_name = entry.first;
-				auto& class_desc = entry.second;
+			std::set<std::string> updatedClasses;
+			RootDict newRules;
+			//Update existing rules parents first, so that children are updated against their parent's new values.
+			forEachInDependencyOrder(updatedRules, [&](const std::string& class_name, const Root& class_desc) {
 				if (Inheritance::instance().hasClass(class_name)) {
 					spdlog::info("Updating existing rule \"{}\".", class_name);
-					modifyRuleInner(class_name, class_desc, changes);
+					if (modifyRuleInner(class_name, class_desc, changes) == 0) {
+						updatedClasses.insert(class_name);
+					}
 				} else {
-					spdlog::info("Installing new rule \"{}\".", class_name);
-					installItem(class_name, class_desc, changes);
-				}
-			}
-			if (!changes.empty()) {
-				for (auto& entry: changes) {
-					Inheritance::instance().updateClass(entry.first->name(), entry.first->description(Visibility::PRIVATE));
-					//TODO: write to user writable rule files
+					newRules.emplace(class_name, class_desc);
 				}
-
-				Inheritance::instance().typesUpdated(changes);
+			});
+			for (auto& entry: newRules) {
+				spdlog::info("Installing new rule \"{}\".", entry.first);
+				updatedClasses.insert(entry.first);
+				updatedClasses.insert(entry.second->getParent());
 			}
+			installRules(newRules, changes);
+			publishChanges(changes, updatedClasses);
 		}
 		m_changedRules.clear();
 	}
@@ -302,27 +322,78 @@ void Ruleset::getRulesFromFiles(std::filesystem::path directory,
 		std::filesystem::recursive_directory_iterator dir(directory), end;
 		spdlog::info("Trying to load rules from directory '{}'", directory.string());
 
-		int count = 0;
+		std::vector<std::filesystem::path> paths;
 		while (dir != end) {
 			if (std::filesystem::is_regular_file(dir->status())) {
-				auto filename = dir->path().native();
-				AtlasFileLoader f(Inheritance::instance().getFactories(), filename, rules);
-				if (!f.isOpen()) {
-					spdlog::error("Unable to open rule file \"{}\".", filename);
-				} else {
-					f.read();
-					count += f.count();
-				}
+				paths.emplace_back(dir->path());
 			}
 			++dir;
 		}
 
+		auto count = loadRuleFiles(paths, rules);
+
 		spdlog::info("Loaded {} rules.", count);
 	}
 
 
 }
 
+int Ruleset::loadRuleFiles(const std::vector<std::filesystem::path>& paths, RootDict& rules) {
+	rmt_ScopedCPUSample(loadRuleFiles, 0)
+	//Each file is parsed into its own dictionary, which are then merged in order so that the outcome is the same as if
+	//the files had been read one after another.
+	std::vector<RootDict> fileRules(paths.size());
+	std::vector<int> counts(paths.size(), 0);
+	auto loadFile = [&](size_t index) {
+		auto& filename = paths[index].native();
+		try {
+			AtlasFileLoader f(Inheritance::instance().getFactories(), filename, fileRules[index]);
+			if (!f.isOpen()) {
+				spdlog::error("Unable to open rule file \"{}\".", filename);
+			} else {
+				spdlog::debug("Reading rule file {}", filename);
+				f.read();
+				counts[index] = f.count();
+			}
+		} catch (const std::exception& e) {
+			spdlog::error("Error when reading rule file at '{}': {}", filename, e.what());
+		}
+	};
+
+	auto threads = std::min<size_t>(paths.size(), std::max(1u, std::thread::hardware_concurrency()));
+	if (threads <= 1) {
+		for (size_t i = 0; i < paths.size(); ++i) {
+			loadFile(i);
+		}
+	} else {
+		boost::asio::thread_pool pool(threads);
+		for (size_t i = 0; i < paths.size(); ++i) {
+			boost::asio::post(pool, [&loadFile, i]() { loadFile(i); });
+		}
+		pool.join();
+	}
+
+	int count = 0;
+	for (size_t i = 0; i < paths.size(); ++i) {
+		for (auto& entry: fileRules[i]) {
+			auto result = rules.insert_or_assign(entry.first, std::move(entry.second));
+			if (!result.second) {
+				spdlog::warn("Duplicate object ID \"{}\" loaded from file {}.", entry.first, paths[i].string());
+			}
+		}
+		count += counts[i];
+	}
+	return count;
+}
+
+void Ruleset::installRules(const RootDict& rules,
+						   std::map<const TypeNode<LocatedEntity>*, TypeNode<LocatedEntity>::PropertiesUpdate>& changes) {
+	//Installing parents first means that rules seldom have to be put on the waiting list.
+	forEachInDependencyOrder(rules, [&](const std::string& class_name, const Root& class_desc) {
+		installItem(class_name, class_desc, changes);
+	});
+}
+
 void Ruleset::loadRules(const std::string& ruleset) {
 	std::filesystem::path shared_rules_directory = std::filesystem::path(share_directory) / "cyphesis" / "rulesets/" / ruleset / "rules";
 	std::filesystem::path var_rules_directory = std::filesystem::path(var_directory) / "lib" / "cyphesis" / "rulesets" / ruleset / "rules";
@@ -345,11 +416,7 @@ void Ruleset::loadRules(const std::string& ruleset) {
 	//Just ignore any changes, since this happens at startup before any clients are connected.
 	std::map<const TypeNode<LocatedEntity>*, TypeNode<LocatedEntity>::PropertiesUpdate> changes;
 
-	for (auto& entry: ruleTable) {
-		const std::string& class_name = entry.first;
-		const Root& class_desc = entry.second;
-		installItem(class_name, class_desc, changes);
-	}
+	installRules(ruleTable, changes);
 	// Report on the non-cleared rules.
 	// Perhaps we can keep them too?
 	// m_waitingRules.clear();
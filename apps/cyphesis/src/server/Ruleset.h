@@ -32,6 +32,7 @@
 
 #include <memory>
 #include <set>
+#include <vector>
 
 
 class EntityBuilder;
@@ -97,6 +98,32 @@ protected:
 	void getRulesFromFiles(std::filesystem::path directory,
 						   std::map<std::string, Atlas::Objects::Root>&);
 
+	/**
+	 * Parses the rule files, in parallel if there are many.
+	 * Rules in later files take precedence over rules in earlier files.
+	 * @return The number of rules read.
+	 */
+	static int loadRuleFiles(const std::vector<std::filesystem::path>& paths,
+							 std::map<std::string, Atlas::Objects::Root>& rules);
+
+	/**
+	 * Installs rules with their parents first, if these are part of the same set of rules.
+	 */
+	void installRules(const std::map<std::string, Atlas::Objects::Root>& rules,
+					  std::map<const TypeNode<LocatedEntity>*, TypeNode<LocatedEntity>::PropertiesUpdate>& changes);
+
+	/**
+	 * Updates the descriptions of all changed types, and emits the "typesUpdated" signal.
+	 *
+	 * When a type is updated, all of its descendants are included in the changes, even if none of their
+	 * properties were affected. These are skipped, so that they don't need to be sent to clients or looked at
+	 * when updating entities.
+	 * @param updatedClasses The classes which were explicitly updated, which will always be kept. This should include
+	 * the parents of newly installed classes, as their descriptions now list the new children.
+	 */
+	static void publishChanges(std::map<const TypeNode<LocatedEntity>*, TypeNode<LocatedEntity>::PropertiesUpdate>& changes,
+							   const std::set<std::string>& updatedClasses);
+
 	void waitForRule(const std::string& class_name,
 					 const Atlas::Objects::Root& class_desc,
 					 const std::string& dependent,
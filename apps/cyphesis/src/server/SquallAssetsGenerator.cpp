@@ -20,6 +20,10 @@
 
 #include <utility>
 #include "squall/core/Generator.h"
+#include "squall/core/Delta.h"
+#include "squall/core/Difference.h"
+#include <spdlog/spdlog.h>
+#include "bytesize/bytesize.hh"
 
 SquallAssetsGenerator::SquallAssetsGenerator(Squall::Repository repository, std::filesystem::path assetsPath)
         : mRepository(std::move(repository)),
@@ -47,6 +51,22 @@ std::optional<Squall::Signature> SquallAssetsGenerator::generateFromAssets(const
         auto& lastEntry = *(--result.processedFiles.end());
         auto signature = lastEntry.fileEntry.signature;
         mRepository.storeRoot(rootName, Squall::Root{.signature = signature});
+        if (root && root->signature != signature) {
+            generateDeltas(root->signature, signature);
+        }
         return {signature};
     }
 }
+
+void SquallAssetsGenerator::generateDeltas(const Squall::Signature& previousRootSignature, const Squall::Signature& rootSignature) {
+    auto previousManifest = mRepository.fetchManifest(previousRootSignature);
+    auto manifest = mRepository.fetchManifest(rootSignature);
+    if (!previousManifest.manifest || !manifest.manifest) {
+        return;
+    }
+    auto changes = Squall::resolveDifferences(mRepository, {.oldManifest = *previousManifest.manifest, .newManifest = *manifest.manifest});
+    auto result = Squall::Delta::generate(mRepository, changes);
+    if (result.createdDeltas > 0) {
+        spdlog::info("Created {} deltas for altered assets, saving clients {} when updating.", result.createdDeltas, bytesize::bytesize(result.savedBytes));
+    }
+}
@@ -25,11 +25,17 @@ class SquallAssetsGenerator {
 public:
     SquallAssetsGenerator(Squall::Repository repository, std::filesystem::path assetsPath);
 
+    /**
+     * Generates a new root from the assets.
+     * If the root already existed, deltas are created for altered files so that clients which have the previous version can update cheaply.
+     */
     std::optional<Squall::Signature> generateFromAssets(const std::string& rootName);
 
 private:
     Squall::Repository mRepository;
     std::filesystem::path mAssetsPath;
+
+    void generateDeltas(const Squall::Signature& previousRootSignature, const Squall::Signature& rootSignature);
 };
 
 
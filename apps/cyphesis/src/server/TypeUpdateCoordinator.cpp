@@ -31,7 +31,7 @@ TypeUpdateCoordinator::TypeUpdateCoordinator(Inheritance& inheritance, WorldRout
     /**
         * When types are updated we will send an "change" op to all connected clients.
         */
-    inheritance.typesUpdated.connect([&](const std::map<const TypeNode<LocatedEntity>*, TypeNode<LocatedEntity>::PropertiesUpdate> typeNodes) {
+    inheritance.typesUpdated.connect([&](const std::map<const TypeNode<LocatedEntity>*, TypeNode<LocatedEntity>::PropertiesUpdate>& typeNodes) {
         //Send Change ops to all clients
         if (!typeNodes.empty()) {
             Atlas::Objects::Operation::Change change;
@@ -55,27 +55,33 @@ TypeUpdateCoordinator::TypeUpdateCoordinator(Inheritance& inheritance, WorldRout
                                 << change->getParent() << ":"
                                 << change->getFrom() << ":" << change->getTo() << "}")
 
-            //Go through all world entities and check if they need to be updated
-            auto& entities = worldRouter.getEntities();
-            for (auto& entry : entities) {
-                auto entity = entry.second;
-                auto I = typeNodes.find(entity->getType());
-                if (I != typeNodes.end()) {
-                    auto typeNode = I->first;
-//                    for (auto& removedPropName : I->second.removedProps) {
+            //Only visit the entities of the types which had properties changed or added.
+            for (auto& entry : typeNodes) {
+                auto typeNode = entry.first;
+                auto& update = entry.second;
+                if (update.changedProps.empty() && update.newProps.empty()) {
+                    continue;
+                }
+                //Copy the entities, since applying properties might lead to entities being removed.
+                std::vector<Ref<LocatedEntity>> entities;
+                for (auto entity : worldRouter.getEntitiesOfType(typeNode)) {
+                    entities.emplace_back(entity);
+                }
+                for (auto& entity : entities) {
+//                    for (auto& removedPropName : update.removedProps) {
 //                        if (entity->getProperties().find(removedPropName) == entity->getProperties().end()) {
 //                            auto prop = typeNode->defaults().find(removedPropName)->second;
 //                            prop->remove(entity, removedPropName);
 //                        }
 //                    }
-                    for (auto& changedPropName : I->second.changedProps) {
+                    for (auto& changedPropName : update.changedProps) {
                         if (entity->getProperties().find(changedPropName) == entity->getProperties().end()) {
                             auto& prop = typeNode->defaults().find(changedPropName)->second;
                             prop->apply(*entity);
                             entity->propertyApplied(changedPropName, *prop);
                         }
                     }
-                    for (auto& newPropName : I->second.changedProps) {
+                    for (auto& newPropName : update.newProps) {
                         if (entity->getProperties().find(newPropName) == entity->getProperties().end()) {
                             auto& prop = typeNode->defaults().find(newPropName)->second;
                             prop->apply(*entity);
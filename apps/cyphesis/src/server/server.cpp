@@ -36,6 +36,7 @@
 #include "common/net/HttpHandling.h"
 
 #include "pythonbase/Python_API.h"
+#include "rules/python/PythonScriptBatches.h"
 #include "rules/simulation/LocatedEntity.h"
 
 #ifdef CYPHESIS_USE_POSTGRES
@@ -118,6 +119,9 @@ INT_OPTION(ai_clients, 1, CYPHESIS, "aiclients",
 INT_OPTION(io_threads, 0, CYPHESIS, "iothreads",
                    "Number of threads running the I/O context (0 = hardware concurrency)")
 
+BOOL_OPTION(offload_encoding, false, CYPHESIS, "offloadencoding",
+			"Flag to control whether outgoing ops are encoded on the I/O threads instead of the main thread")
+
 /**
  * Wraps either a Postgres server connection along with a vacuum socket, or a SQLite connection along with a vacuum task.
  */
@@ -257,6 +261,7 @@ SocketListeners createListeners(io_context& io_context,
 		auto connection_id = newId();
 		//Turn off Nagle's algorithm to increase responsiveness.
 		client.getSocket().set_option(ip::tcp::no_delay(true));
+		client.setOffloadEncoding(offload_encoding);
 		//Listen to both ipv4 and ipv6
 		//client.getSocket().set_option(boost::asio::ip::v6_only(false));
 		client.startAccept(std::make_unique<Connection>(client, serverRouting, "", connection_id));
@@ -326,6 +331,7 @@ SocketListeners createListeners(io_context& io_context,
 	};
 	auto localStarter = [&](CommAsioClient<local::stream_protocol>& client) {
 		auto connection_id = newId();
+		client.setOffloadEncoding(offload_encoding);
 		client.startAccept(std::make_unique<TrustedConnection>(client, serverRouting, "", connection_id));
 	};
 	socketListeners.localListener = std::make_unique<CommAsioListener<local::stream_protocol, CommAsioClient<local::stream_protocol>>>(localCreator,
@@ -530,7 +536,7 @@ int run() {
 
 		//Instantiate at startup
 		HttpHandling httpCache(monitors, *io_context);
-		httpCache.mHandlers.emplace_back(buildSquallHandler(squallRepositoryPath / "data"));
+		httpCache.mHandlers.emplace_back(buildSquallHandler(Squall::Repository(squallRepositoryPath)));
 
 		// This ID is currently generated every time, but should perhaps be
 		// persistent in future.
@@ -674,9 +680,15 @@ int run() {
 			serverRouting.dispatch(5);
 		};
 
+		//Scripts which have opted in to receive operations in batches get them once all operations of a frame have been processed.
+		auto operationsProcessedFn = []() {
+			PythonScriptBatches::instance().flush();
+		};
+
 
 		//Initially there are a couple of pent-up operations we need to run to get up to speed. 10 seconds is a suitable large number.
 		worldRouter.getOperationsHandler().processUntil(time, std::chrono::seconds(10));
+		operationsProcessedFn();
 		//Report to the log when time diff between when an operation should have been handled and when it actually was
 		worldRouter.getOperationsHandler().m_time_diff_report = std::chrono::milliseconds(200);
 
@@ -697,7 +709,7 @@ int run() {
                         if (ioThreadCount == 0) {
                                 ioThreadCount = 1;
                         }
-                        MainLoop::run(daemon_flag, *io_context, worldRouter.getOperationsHandler(), {softExitStart, softExitPoll, softExitTimeout, dispatchOperationsFn}, time, ioThreadCount);
+                        MainLoop::run(daemon_flag, *io_context, worldRouter.getOperationsHandler(), {softExitStart, softExitPoll, softExitTimeout, dispatchOperationsFn, operationsProcessedFn}, time, ioThreadCount);
 			if (metaClient) {
 				metaClient->metaserverTerminate();
 			}
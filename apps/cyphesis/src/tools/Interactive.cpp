@@ -51,6 +51,7 @@ extern "C" {
 #endif
 
 #include <fmt/format.h>
+#include <fstream>
 #include <iostream>
 
 using Atlas::Message::Element;
@@ -133,6 +134,8 @@ struct command commands[] = {
 								  &Interactive::commandUnknown, CMD_DEFAULT, nullptr,},
 		{"reload",       "Reload the script for a type",
 								  &Interactive::commandUnknown, CMD_DEFAULT, nullptr,},
+		{"script_profile", "Profile Python scripts on the server (start|stop|dump <file>)",
+								  &Interactive::commandUnknown, CMD_DEFAULT, nullptr,},
 		{"stat",         "Return current server status",
 								  &Interactive::commandUnknown, CMD_DEFAULT, nullptr,},
 		{"unmonitor",    "Disable in-game op monitoring",
@@ -276,6 +279,20 @@ void Interactive::infoArrived(const Operation& op) {
 			}
 		}
 		m_server_flag = false;
+	} else if (!m_scriptProfileFile.empty() && ent->getObjtype() == "profile") {
+		//Write the samples in the folded stacks format, for use with flamegraph tools.
+		auto writeFolded = [&](const std::string& attr, const std::string& path) {
+			Element folded;
+			if (ent->copyAttr(attr, folded) == 0 && folded.isString()) {
+				std::ofstream stream(path);
+				stream << folded.String();
+				std::cout << "Wrote " << attr << " samples to " << path << std::endl;
+			}
+		};
+		writeFolded("time", m_scriptProfileFile);
+		writeFolded("allocations", m_scriptProfileFile + ".allocations");
+		writeFolded("allocated_bytes", m_scriptProfileFile + ".allocated_bytes");
+		m_scriptProfileFile.clear();
 	} else if (m_currentTask == nullptr && op->isDefaultRefno()) {
 		std::cout << "Info(" << std::endl;
 		output(ent);
@@ -611,6 +628,37 @@ void Interactive::exec(const std::string& cmd, const std::string& arg) {
 
 			send(s);
 		}
+	} else if (cmd == "script_profile") {
+		std::vector<std::string> args;
+		tokenize(arg, args);
+
+		if (args.empty() || (args[0] != "start" && args[0] != "stop" && args[0] != "dump")) {
+			reply_expected = false;
+			std::cout << "usage: script_profile start|stop|dump <file>" << std::endl;
+		} else if (args[0] == "dump") {
+			m_scriptProfileFile = args.size() > 1 ? args[1] : "scripts.folded";
+			Get g;
+
+			Anonymous cmap;
+			cmap->setObjtype("profile");
+			cmap->setId("scripts");
+			g->setArgs1(cmap);
+			g->setFrom(m_accountId);
+
+			send(g);
+		} else {
+			Set s;
+
+			Anonymous cmap;
+			cmap->setObjtype("obj");
+			cmap->setId(m_accountId);
+			cmap->setAttr("script_profiling", args[0] == "start" ? 1 : 0);
+			s->setArgs1(cmap);
+			s->setFrom(m_accountId);
+
+			send(s);
+			reply_expected = false;
+		}
 	} else if (cmd == "get") {
 		Get g;
 
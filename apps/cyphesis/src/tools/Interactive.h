@@ -45,6 +45,9 @@ private:
 	ContextMap m_contexts;
 	std::weak_ptr<ObjectContext> m_currentContext;
 
+	/// \brief File to write the script profile to when it arrives.
+	std::string m_scriptProfileFile;
+
 protected:
 	void operation(const Operation&) override;
 
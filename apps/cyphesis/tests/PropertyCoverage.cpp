@@ -141,3 +141,11 @@ const PropertyBase* LocatedEntity::getProperty(const std::string& name) const {
 	}
 	return 0;
 }
+
+const PropertyBase* LocatedEntity::getProperty(const PropertyKey& key) const {
+	auto I = m_properties.find(key);
+	if (I != m_properties.end()) {
+		return I->second.property.get();
+	}
+	return 0;
+}
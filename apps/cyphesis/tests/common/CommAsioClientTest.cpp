@@ -0,0 +1,183 @@
+// Cyphesis Online RPG Server and AI Engine
+// Copyright (C) 2026 Erik Ogenvik
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software Foundation,
+// Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+
+
+#ifdef NDEBUG
+#undef NDEBUG
+#endif
+#ifndef DEBUG
+#define DEBUG
+#endif
+
+#include "../TestBase.h"
+
+#include "common/CommAsioClient_impl.h"
+
+#include <Atlas/Codecs/Packed.h>
+#include <Atlas/Filters/Zstd.h>
+#include <Atlas/Message/DecoderBase.h>
+#include <Atlas/Objects/Factories.h>
+#include <Atlas/Objects/Operation.h>
+
+#include <sstream>
+#include <thread>
+
+namespace {
+
+class TestLink : public Link {
+public:
+	explicit TestLink(CommSocket& socket) : Link(socket, RouterId{1}) {
+	}
+
+	void externalOperation(const Operation&, Link&) override {
+	}
+
+	void operation(const Operation&, OpVector&) override {
+	}
+};
+
+/**
+ * Negotiates the Packed codec and the Zstd filter without talking to the other end.
+ */
+class FilterNegotiate : public Atlas::Negotiate {
+public:
+	FilterNegotiate(std::istream& in, std::ostream& out) : m_in(in), m_out(out) {
+	}
+
+	State getState() override {
+		return SUCCEEDED;
+	}
+
+	std::unique_ptr<Atlas::Codec> getCodec(Atlas::Bridge& bridge) override {
+		return std::make_unique<Atlas::Codecs::Packed>(m_in, m_out, bridge);
+	}
+
+	std::unique_ptr<Atlas::Filter> getFilter() override {
+		return std::make_unique<Atlas::Filters::Zstd>();
+	}
+
+	void poll() override {
+	}
+
+private:
+	std::istream& m_in;
+	std::ostream& m_out;
+};
+
+class TestCommAsioClient : public CommAsioClient<boost::asio::local::stream_protocol> {
+public:
+	TestCommAsioClient(boost::asio::io_context& io_context, const Atlas::Objects::Factories& factories)
+			: CommAsioClient("test", io_context, factories) {
+	}
+
+	int negotiateFilter() {
+		m_link = std::make_unique<TestLink>(*this);
+		m_negotiate = std::make_unique<FilterNegotiate>(mInStream, mOutStream);
+		return negotiate();
+	}
+};
+
+class CountingDecoder : public Atlas::Message::DecoderBase {
+public:
+	size_t count = 0;
+
+protected:
+	void messageArrived(Atlas::Message::MapType) override {
+		++count;
+	}
+};
+
+}
+
+struct CommAsioClienttest : public Cyphesis::TestBase {
+
+	CommAsioClienttest() {
+		ADD_TEST(CommAsioClienttest::test_filterConcurrentFlushes);
+	}
+
+	void setup() override {
+	}
+
+	void teardown() override {
+	}
+
+	/**
+	 * Writes complete on the io threads while other threads keep sending and flushing. With a filter
+	 * all of this must go through the strand even if encoding isn't offloaded, or the stream is corrupted.
+	 */
+	void test_filterConcurrentFlushes() {
+		const size_t opsPerThread = 500;
+		const size_t senderCount = 2;
+
+		boost::asio::io_context io_context;
+		auto work = boost::asio::make_work_guard(io_context);
+		Atlas::Objects::Factories factories;
+
+		auto client = std::make_shared<TestCommAsioClient>(io_context, factories);
+		boost::asio::local::stream_protocol::socket peer(io_context);
+		boost::asio::local::connect_pair(client->getSocket(), peer);
+		ASSERT_EQUAL(client->negotiateFilter(), 0)
+
+		std::vector<std::thread> ioThreads;
+		for (int i = 0; i < 4; ++i) {
+			ioThreads.emplace_back([&io_context]() { io_context.run(); });
+		}
+
+		std::vector<std::thread> senders;
+		for (size_t i = 0; i < senderCount; ++i) {
+			senders.emplace_back([&client, opsPerThread]() {
+				for (size_t j = 0; j < opsPerThread; ++j) {
+					Atlas::Objects::Operation::Sight op;
+					op->setTo(std::to_string(j));
+					client->send(op);
+					client->flush();
+				}
+			});
+		}
+
+		//Decode everything received, which fails if the compressed stream is corrupted.
+		Atlas::Filters::Zstd filter;
+		filter.begin();
+		std::stringstream plain;
+		CountingDecoder decoder;
+		Atlas::Codecs::Packed codec(plain, plain, decoder);
+		std::array<char, 16384> buffer{};
+		while (decoder.count < senderCount * opsPerThread) {
+			auto length = peer.read_some(boost::asio::buffer(buffer));
+			plain << filter.decode(std::string(buffer.data(), length));
+			codec.poll();
+		}
+
+		for (auto& sender: senders) {
+			sender.join();
+		}
+		ASSERT_EQUAL(decoder.count, senderCount * opsPerThread)
+
+		client->disconnect();
+		work.reset();
+		io_context.stop();
+		for (auto& thread: ioThreads) {
+			thread.join();
+		}
+	}
+};
+
+int main() {
+	CommAsioClienttest t;
+
+	return t.run();
+}
@@ -96,6 +96,8 @@ public:
 
 	void test_send_connected();
 
+	void test_send_sender();
+
 	void test_sendError();
 
 	void test_sendError_connected();
@@ -130,6 +132,7 @@ void Linktest::set_CommSocket_disconnect_called() {
 Linktest::Linktest() {
 	ADD_TEST(Linktest::test_send);
 	ADD_TEST(Linktest::test_send_connected);
+	ADD_TEST(Linktest::test_send_sender);
 	ADD_TEST(Linktest::test_sendError);
 	ADD_TEST(Linktest::test_sendError_connected);
 	ADD_TEST(Linktest::test_disconnect);
@@ -172,6 +175,23 @@ void Linktest::test_send_connected() {
 	ASSERT_TRUE(m_bridge->got_data)
 }
 
+void Linktest::test_send_sender() {
+	m_encoder = new Atlas::Objects::ObjectsEncoder(*m_bridge);
+	m_link->setEncoder(m_encoder);
+
+	OpVector sentOps;
+	m_link->setOpSender([&](const Operation& op) { sentOps.push_back(op); });
+
+	Operation op;
+
+	m_link->send(op);
+	m_link->send(OpVector{Operation(), Operation()});
+
+	ASSERT_EQUAL(sentOps.size(), 3u)
+	ASSERT_EQUAL(sentOps.front().get(), op.get())
+	ASSERT_FALSE(m_bridge->got_data)
+}
+
 void Linktest::test_sendError() {
 	CommSocket_flush_called = false;
 
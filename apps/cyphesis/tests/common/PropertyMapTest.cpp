@@ -0,0 +1,148 @@
+/*
+ Copyright (C) 2026 Erik Ogenvik
+
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#ifdef NDEBUG
+#undef NDEBUG
+#endif
+#ifndef DEBUG
+#define DEBUG
+#endif
+
+#include "common/PropertyMap.h"
+
+#include <memory>
+#include <set>
+
+#include <cassert>
+
+struct TestValue {
+	std::unique_ptr<int> value;
+};
+
+int main() {
+	{
+		PropertyKey foo("test_foo");
+		PropertyKey fooAgain(std::string("test_foo"));
+		PropertyKey bar("test_bar");
+		assert(foo == fooAgain);
+		assert(foo.id() == fooAgain.id());
+		assert(&foo.str() == &fooAgain.str());
+		assert(!(foo == bar));
+		assert(foo == "test_foo");
+		assert(foo.str() == "test_foo");
+		assert(fmt::format("{}", foo) == "test_foo");
+
+		auto looked = PropertyKey::lookup("test_bar");
+		assert(looked);
+		assert(*looked == bar);
+
+		auto count = PropertyKey::internedCount();
+		assert(!PropertyKey::lookup("test_never_interned"));
+		assert(PropertyKey::internedCount() == count);
+	}
+
+	{
+		PropertyMap<TestValue> map;
+		assert(map.empty());
+		assert(map.begin() == map.end());
+
+		map["test_a"].value = std::make_unique<int>(1);
+		map[PropertyKey("test_b")].value = std::make_unique<int>(2);
+		auto result = map.emplace("test_c", std::make_unique<int>(3));
+		assert(result.second);
+		assert(*result.first->second.value == 3);
+		result = map.emplace("test_c", std::make_unique<int>(4));
+		assert(!result.second);
+		assert(*result.first->second.value == 3);
+		assert(map.size() == 3);
+
+		assert(map.contains("test_a"));
+		assert(map.contains(PropertyKey("test_b")));
+		assert(!map.contains("test_d"));
+		assert(map.find("test_never_interned") == map.end());
+		assert(*map.find(std::string("test_b"))->second.value == 2);
+
+		const auto& constMap = map;
+		PropertyMap<TestValue>::const_iterator I = map.find("test_a");
+		assert(I != constMap.end());
+		assert(I->first == "test_a");
+
+		std::set<std::string> names;
+		for (auto& entry: map) {
+			names.insert(entry.first);
+		}
+		assert(names == std::set<std::string>({"test_a", "test_b", "test_c"}));
+	}
+
+	// References must be kept valid when adding entries, just as with std::map.
+	{
+		PropertyMap<TestValue> map;
+		auto& first = map["test_first"];
+		first.value = std::make_unique<int>(1);
+		for (int i = 0; i < 1000; ++i) {
+			map[fmt::format("test_{}", i)].value = std::make_unique<int>(i);
+		}
+		assert(&first == &map["test_first"]);
+		assert(*first.value == 1);
+		assert(map.size() == 1001);
+	}
+
+	// Entries can be removed and added while iterating.
+	{
+		PropertyMap<TestValue> map;
+		for (int i = 0; i < 10; ++i) {
+			map[fmt::format("test_{}", i)].value = std::make_unique<int>(i);
+		}
+		auto I = map.begin();
+		while (I != map.end()) {
+			if (*I->second.value % 2 == 0) {
+				map.erase(I++);
+			} else {
+				++I;
+			}
+		}
+		assert(map.size() == 5);
+		assert(!map.contains("test_2"));
+		assert(map.contains("test_3"));
+		assert(map.erase("test_3") == 1);
+		assert(map.erase("test_3") == 0);
+		assert(map.size() == 4);
+
+		//Removed slots are reused.
+		map["test_2"].value = std::make_unique<int>(2);
+		assert(map.size() == 5);
+		assert(*map.find("test_2")->second.value == 2);
+
+		size_t visited = 0;
+		for (auto& entry: map) {
+			if (visited == 0) {
+				map["test_added"];
+			}
+			assert(entry.first != "test_3");
+			visited++;
+		}
+		//The added entry should also have been visited.
+		assert(visited == 6);
+
+		map.clear();
+		assert(map.empty());
+		assert(map.begin() == map.end());
+	}
+
+	return 0;
+}
@@ -0,0 +1,136 @@
+/*
+ Copyright (C) 2026 Erik Ogenvik
+
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#ifdef NDEBUG
+#undef NDEBUG
+#endif
+#ifndef DEBUG
+#define DEBUG
+#endif
+
+#include "common/net/SquallHandler.h"
+#include "common/net/CommHttpClient.h"
+#include "common/Monitors.h"
+#include "common/log.h"
+
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <thread>
+
+using boost::asio::ip::tcp;
+
+namespace {
+
+/**
+ * Fetches a path, returning the number of bytes received (including headers).
+ */
+std::size_t fetch(const tcp::endpoint& endpoint, const std::string& path) {
+	boost::asio::io_context context;
+	tcp::socket socket(context);
+	socket.connect(endpoint);
+	auto request = fmt::format("GET {} HTTP/1.1\r\nHost: localhost\r\n\r\n", path);
+	boost::asio::write(socket, boost::asio::buffer(request));
+
+	std::array<char, 64 * 1024> buffer{};
+	std::size_t received = 0;
+	boost::system::error_code ec;
+	while (!ec) {
+		received += socket.read_some(boost::asio::buffer(buffer), ec);
+	}
+	return received;
+}
+
+void run(const tcp::endpoint& endpoint, const std::string& name, const std::string& path, std::size_t expectedSize, int clients, int requestsPerClient) {
+	auto start = std::chrono::steady_clock::now();
+	std::vector<std::thread> threads;
+	std::atomic<std::size_t> received = 0;
+	for (int i = 0; i < clients; ++i) {
+		threads.emplace_back([&]() {
+			for (int j = 0; j < requestsPerClient; ++j) {
+				auto size = fetch(endpoint, path);
+				assert(size > expectedSize);
+				received += size;
+			}
+		});
+	}
+	for (auto& thread: threads) {
+		thread.join();
+	}
+	auto seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	auto requests = clients * requestsPerClient;
+	std::cout << fmt::format("{}, {} clients: {:.0f} requests/s, {:.1f} MB/s",
+							 name, clients, requests / seconds, (static_cast<double>(received) / (1024 * 1024)) / seconds) << std::endl;
+}
+
+}
+
+/**
+ * Measures throughput of the Squall HTTP route when many clients sync at the same time, as happens when new assets
+ * have been published.
+ */
+int main() {
+	auto repositoryPath = std::filesystem::temp_directory_path() / "cyphesis-squallhandler-benchmark";
+	std::filesystem::remove_all(repositoryPath);
+	auto dataPath = repositoryPath / "data";
+	std::filesystem::create_directories(dataPath / "ab");
+
+	//Something resembling a manifest, and a larger asset such as a texture.
+	std::string manifest = "1\n";
+	for (int i = 0; i < 200; ++i) {
+		manifest += fmt::format("{:064} {} file_{}.png\n", i, i * 1000, i);
+	}
+	std::ofstream(dataPath / "ab" / "manifest") << manifest;
+	std::string asset(4 * 1024 * 1024, 'x');
+	std::ofstream(dataPath / "ab" / "asset") << asset;
+
+	Monitors monitors;
+	boost::asio::io_context contextMain;
+	HttpHandling httpHandling(monitors, contextMain);
+	httpHandling.mHandlers.emplace_back(buildSquallHandler(Squall::Repository(repositoryPath)));
+
+	boost::asio::thread_pool pool(4);
+	tcp::acceptor acceptor(pool, tcp::endpoint(boost::asio::ip::address_v4::loopback(), 0));
+	auto endpoint = acceptor.local_endpoint();
+
+	boost::asio::co_spawn(pool, [&]() -> boost::asio::awaitable<void> {
+		while (true) {
+			auto client = std::make_shared<CommHttpClient>("benchmark", pool, httpHandling);
+			boost::system::error_code ec;
+			co_await acceptor.async_accept(client->getSocket(), boost::asio::redirect_error(boost::asio::use_awaitable, ec));
+			if (ec) {
+				co_return;
+			}
+			client->serveRequest();
+		}
+	}, boost::asio::detached);
+
+	for (auto clients: {1, 8, 32}) {
+		run(endpoint, "Manifest", "/squall/ab/manifest", manifest.size(), clients, 200);
+	}
+	for (auto clients: {1, 8, 32}) {
+		run(endpoint, "Asset", "/squall/ab/asset", asset.size(), clients, 10);
+	}
+
+	boost::asio::post(pool, [&]() { acceptor.close(); });
+	pool.join();
+	std::filesystem::remove_all(repositoryPath);
+	return 0;
+}
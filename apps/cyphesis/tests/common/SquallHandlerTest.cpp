@@ -0,0 +1,227 @@
+/*
+ Copyright (C) 2026 Erik Ogenvik
+
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#ifdef NDEBUG
+#undef NDEBUG
+#endif
+#ifndef DEBUG
+#define DEBUG
+#endif
+
+#include "common/net/SquallHandler.h"
+#include "common/log.h"
+
+#include <cassert>
+#include <fstream>
+#include <sstream>
+
+namespace {
+
+struct Response {
+	HttpHandling::HandleResult result;
+	std::string output;
+	std::optional<HttpFileBody> fileBody;
+
+	bool hasStatus(int status) const {
+		return output.starts_with(fmt::format("HTTP/1.1 {} ", status));
+	}
+
+	bool hasHeader(const std::string& header) const {
+		return output.find("\n" + header + "\n") != std::string::npos;
+	}
+
+	std::string body() const {
+		return output.substr(output.find("\n\n") + 2);
+	}
+};
+
+Response request(const HttpHandling::HttpHandler& handler, const std::string& path, std::list<std::string> headers = {}) {
+	headers.push_front(fmt::format("GET {} HTTP/1.1", path));
+	Response response{};
+	std::stringstream ss;
+	boost::asio::io_context context;
+	boost::asio::co_spawn(context, [&]() -> boost::asio::awaitable<void> {
+		response.result = co_await handler({.io=ss, .headers=headers, .path=path, .fileBody=response.fileBody});
+	}, boost::asio::detached);
+	context.run();
+	response.output = ss.str();
+	return response;
+}
+
+}
+
+int main() {
+	auto repositoryPath = std::filesystem::temp_directory_path() / "cyphesis-squallhandler-test";
+	std::filesystem::remove_all(repositoryPath);
+	auto dataPath = repositoryPath / "data";
+	std::filesystem::create_directories(dataPath / "ab");
+
+	std::string smallContent = "1\nsmall file content\n";
+	std::ofstream(dataPath / "ab" / "cdef") << smallContent;
+	std::string largeContent(100 * 1024, 'x');
+	std::ofstream(dataPath / "ab" / "large") << largeContent;
+
+	auto handler = buildSquallHandler(Squall::Repository(repositoryPath));
+
+	{
+		auto response = request(handler, "/other");
+		assert(response.result == HttpHandling::HandleResult::Ignored);
+	}
+
+	{
+		auto response = request(handler, "/squall/ab/../../etc");
+		assert(response.result == HttpHandling::HandleResult::Handled);
+		assert(response.hasStatus(401));
+	}
+
+	{
+		auto response = request(handler, "/squall/ab/missing");
+		assert(response.hasStatus(404));
+	}
+
+	//Small files are served from memory.
+	{
+		auto response = request(handler, "/squall/ab/cdef");
+		assert(response.hasStatus(200));
+		assert(response.hasHeader("ETag: \"abcdef\""));
+		assert(response.hasHeader(fmt::format("Content-Length: {}", smallContent.size())));
+		assert(response.body() == smallContent);
+		assert(!response.fileBody);
+	}
+
+	//The cached content is used even when the file is gone, since files never change.
+	{
+		std::filesystem::remove(dataPath / "ab" / "cdef");
+		auto response = request(handler, "/squall/ab/cdef");
+		assert(response.hasStatus(200));
+		assert(response.body() == smallContent);
+	}
+
+	//Larger files are sent by the connection.
+	{
+		auto response = request(handler, "/squall/ab/large");
+		assert(response.hasStatus(200));
+		assert(response.hasHeader(fmt::format("Content-Length: {}", largeContent.size())));
+		assert(response.body().empty());
+		assert(response.fileBody);
+		assert(response.fileBody->path == dataPath / "ab" / "large");
+		assert(response.fileBody->offset == 0);
+		assert(response.fileBody->length == largeContent.size());
+	}
+
+	{
+		auto response = request(handler, "/squall/ab/large", {"If-None-Match: \"ablarge\""});
+		assert(response.hasStatus(304));
+		assert(!response.fileBody);
+	}
+
+	{
+		auto response = request(handler, "/squall/ab/large", {"If-None-Match: \"other\""});
+		assert(response.hasStatus(200));
+	}
+
+	{
+		auto response = request(handler, "/squall/ab/large", {"Range: bytes=100-199"});
+		assert(response.hasStatus(206));
+		assert(response.hasHeader("Content-Length: 100"));
+		assert(response.hasHeader(fmt::format("Content-Range: bytes 100-199/{}", largeContent.size())));
+		assert(response.fileBody->offset == 100);
+		assert(response.fileBody->length == 100);
+	}
+
+	{
+		auto response = request(handler, "/squall/ab/large", {"Range: bytes=1000-"});
+		assert(response.hasStatus(206));
+		assert(response.fileBody->offset == 1000);
+		assert(response.fileBody->length == largeContent.size() - 1000);
+	}
+
+	{
+		auto response = request(handler, "/squall/ab/large", {"Range: bytes=-10"});
+		assert(response.hasStatus(206));
+		assert(response.fileBody->offset == largeContent.size() - 10);
+		assert(response.fileBody->length == 10);
+	}
+
+	{
+		auto response = request(handler, "/squall/ab/cdef", {"Range: bytes=2-6"});
+		assert(response.hasStatus(206));
+		assert(response.body() == smallContent.substr(2, 5));
+	}
+
+	{
+		auto response = request(handler, "/squall/ab/large", {fmt::format("Range: bytes={}-", largeContent.size())});
+		assert(response.hasStatus(416));
+		assert(!response.fileBody);
+	}
+
+	//Multiple ranges aren't supported, so the whole file is sent.
+	{
+		auto response = request(handler, "/squall/ab/large", {"Range: bytes=0-10,20-30"});
+		assert(response.hasStatus(200));
+		assert(response.fileBody->length == largeContent.size());
+	}
+
+	//Data in packs is served from its location in the pack file.
+	{
+		Squall::PackWriter writer(repositoryPath / "packs" / "test.pack");
+		std::istringstream smallStream(smallContent);
+		writer.add("cdpacked", smallStream, smallContent.size());
+		std::istringstream largeStream(largeContent);
+		writer.add("efpacked", largeStream, largeContent.size());
+		assert(writer.finish());
+
+		auto packedHandler = buildSquallHandler(Squall::Repository(repositoryPath));
+		{
+			auto response = request(packedHandler, "/squall/cd/packed");
+			assert(response.hasStatus(200));
+			assert(response.body() == smallContent);
+		}
+		{
+			auto response = request(packedHandler, "/squall/ef/packed", {"Range: bytes=100-199"});
+			assert(response.hasStatus(206));
+			assert(response.hasHeader(fmt::format("Content-Range: bytes 100-199/{}", largeContent.size())));
+			assert(response.fileBody->path == repositoryPath / "packs" / "test.pack");
+			assert(response.fileBody->offset == smallContent.size() + 100);
+			assert(response.fileBody->length == 100);
+		}
+	}
+
+	//Deltas are addressed by the signatures of both versions.
+	{
+		std::string deltaContent = "delta content";
+		Squall::Repository(repositoryPath).storeDelta("abcdef", "abcdeg", std::vector<char>(deltaContent.begin(), deltaContent.end()));
+		{
+			auto response = request(handler, "/squall/deltas/abcdef/abcdeg");
+			assert(response.hasStatus(200));
+			assert(response.hasHeader("ETag: \"abcdef/abcdeg\""));
+			assert(response.body() == deltaContent);
+		}
+		{
+			auto response = request(handler, "/squall/deltas/abcdef/missing");
+			assert(response.hasStatus(404));
+		}
+		{
+			auto response = request(handler, "/squall/deltas/abcdef/../../etc");
+			assert(response.hasStatus(401));
+		}
+	}
+
+	std::filesystem::remove_all(repositoryPath);
+	return 0;
+}
@@ -26,6 +26,7 @@
 #include "../TestWorld.h"
 #include "rules/EntityLocation_impl.h"
 #include <vector>
+#include <thread>
 
 extern int walkableSlopeAngle;
 
@@ -100,6 +101,7 @@ struct SteeringIntegration : public Cyphesis::TestBase {
                 ADD_TEST(SteeringIntegration::test_query_destination_static);
                 ADD_TEST(SteeringIntegration::test_walkableSlopeAngle);
                 ADD_TEST(SteeringIntegration::test_path_refresh_on_entity_move);
+                ADD_TEST(SteeringIntegration::test_executor);
         }
 
 	void setup() {
@@ -772,6 +774,56 @@ struct SteeringIntegration : public Cyphesis::TestBase {
                 ASSERT_EQUAL(to2D(destEntity->requirePropertyClassFixed<PositionProperty<MemEntity>>().data()), to2D(steering.getPath()[0]));
         }
 
+        void test_executor() {
+                Ref<MemEntity> worldEntity(new MemEntityExt(0));
+                Ref<MemEntity> avatarEntity(new MemEntityExt(1));
+                avatarEntity->requirePropertyClassFixed<PositionProperty<MemEntity>>().data() = {0, 0, 0};
+                avatarEntity->requirePropertyClassFixed<BBoxProperty<MemEntity>>().data() = {{-1, 0, -1}, {1, 1, 1}};
+                avatarEntity->requirePropertyClassFixed<OrientationProperty<MemEntity>>().data() = WFMath::Quaternion::IDENTITY();
+
+                Ref<MemEntity> obstacleEntity(new MemEntityExt(2));
+                obstacleEntity->requirePropertyClassFixed<PositionProperty<MemEntity>>().data() = {5, 0, 0};
+                obstacleEntity->requirePropertyClassFixed<BBoxProperty<MemEntity>>().data() = {{-1, 0, -4}, {1, 2, 4}};
+                obstacleEntity->requirePropertyClassFixed<OrientationProperty<MemEntity>>().data() = WFMath::Quaternion::IDENTITY();
+
+                worldEntity->addChild(*avatarEntity);
+                worldEntity->addChild(*obstacleEntity);
+
+                WFMath::AxisBox<3> extent = {{-64, -64, -64}, {64, 64, 64}};
+                static int tileSize3 = 16;
+                struct : public IHeightProvider {
+                        void blitHeights(int xMin, int xMax, int yMin, int yMax, std::vector<float>& heights) const override {
+                                heights.resize((xMax - xMin) * (yMax - yMin), 0);
+                        }
+                } heightProvider3;
+
+                std::vector<std::thread> threads;
+                size_t tasks = 0;
+
+                Awareness awareness(worldEntity->getIdAsInt(), 1, 2, 0.5, heightProvider3, extent, tileSize3);
+                awareness.setExecutor([&](std::function<void()> task) {
+                        tasks++;
+                        threads.emplace_back(std::move(task));
+                }, 4);
+                Steering steering(*avatarEntity);
+                steering.setAwareness(&awareness);
+                awareness.addEntity(*avatarEntity, *avatarEntity, true);
+                awareness.addEntity(*avatarEntity, *obstacleEntity, false);
+
+                steering.setDestination({{EntityLocation<MemEntity>(worldEntity, {10, 0, 0})}, Steering::MeasureType::CENTER, Steering::MeasureType::CENTER, 0.5}, 0ms);
+                while (awareness.rebuildDirtyTile() != 0) {
+                        std::this_thread::yield();
+                }
+                for (auto& thread: threads) {
+                        thread.join();
+                }
+                ASSERT_TRUE(tasks > 1);
+
+                //The path should go around the obstacle, just as if the tiles were built on the main thread.
+                auto result = steering.updatePath(0ms);
+                ASSERT_TRUE(result > 1);
+        }
+
 };
 
 int main() {
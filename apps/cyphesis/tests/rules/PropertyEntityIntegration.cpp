@@ -42,17 +42,6 @@ using Atlas::Message::Element;
 using Atlas::Message::MapType;
 using Atlas::Message::ListType;
 
-std::ostream& operator<<(std::ostream& os,
-						 const std::map<std::string, ModifiableProperty>::const_iterator&) {
-	os << "[iterator]";
-	return os;
-}
-
-namespace std {
-auto format_as(const std::map<std::string, ModifiableProperty>::const_iterator&) {
-	return "[iterator]";
-}
-}
 
 template<typename T>
 class test_values {
@@ -133,7 +122,7 @@ std::unique_ptr<PropertyBase> TestPropertyManager::addProperty(const std::string
 struct TestEntity : LocatedEntity {
 	explicit TestEntity(RouterId id) : LocatedEntity(id) {}
 
-	std::map<std::string, ModifiableProperty>& modProperties() { return m_properties; }
+	PropertyMap<ModifiableProperty>& modProperties() { return m_properties; }
 
 	void sendWorld(Operation op) override {
 		//no-op
@@ -426,8 +415,8 @@ struct PropertyEntityIntegration : public Cyphesis::TestBaseWithContext<TestCont
 		ASSERT_TRUE(dflt->flags().m_flags & prop_flag_class);
 
 		// The entity instance should not have a property by this name
-		ASSERT_EQUAL(context.m_entity->getProperties().find(test_values<T>::name),
-					 context.m_entity->getProperties().end());
+		ASSERT_TRUE(context.m_entity->getProperties().find(test_values<T>::name) ==
+					context.m_entity->getProperties().end());
 
 		PropertyBase* p = context.m_entity->modProperty(test_values<T>::name);
 		ASSERT_NOT_NULL(p);
@@ -447,8 +436,8 @@ struct PropertyEntityIntegration : public Cyphesis::TestBaseWithContext<TestCont
 		ASSERT_TRUE(dflt->flags().m_flags & prop_flag_class);
 
 		// The entity instance should not have a property by this name
-		ASSERT_EQUAL(context.m_entity->getProperties().find(test_values<T>::name),
-					 context.m_entity->getProperties().end());
+		ASSERT_TRUE(context.m_entity->getProperties().find(test_values<T>::name) ==
+					context.m_entity->getProperties().end());
 
 		auto p = context.m_entity->modPropertyClass<Property<T, LocatedEntity>>(
 				test_values<T>::name
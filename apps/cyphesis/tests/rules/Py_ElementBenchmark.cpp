@@ -0,0 +1,134 @@
+/*
+ Copyright (C) 2026 Erik Ogenvik
+
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#ifdef NDEBUG
+#undef NDEBUG
+#endif
+#ifndef DEBUG
+#define DEBUG
+#endif
+
+#include <Python.h>
+
+#include "../python_testers.h"
+
+#include "pythonbase/Python_API.h"
+
+#include <cassert>
+#include <rules/python/CyPy_Atlas.h>
+#include <rules/python/CyPy_Physics.h>
+#include <rules/python/CyPy_Rules_impl.h>
+#include <rules/python/CyPy_Common.h>
+#include <rules/python/CyPy_Element.h>
+#include <Atlas/Objects/Factories.h>
+#include <rules/simulation/Inheritance.h>
+#include "pythonbase/PythonMalloc.h"
+#include "rules/simulation/python/CyPy_LocatedEntity_impl.h"
+
+using Atlas::Message::Element;
+using Atlas::Message::MapType;
+using Atlas::Message::ListType;
+
+/**
+ * Measures the access patterns typically found in mind scripts, where properties containing maps and lists
+ * are read in loops.
+ */
+int main() {
+	Atlas::Objects::Factories factories;
+	Inheritance inheritance;
+
+	setupPythonMalloc();
+	class Test : public Py::ExtensionModule<Test> {
+	public:
+		/**
+		 * Creates something resembling the "_goals" or "knowledge" properties of a mind.
+		 */
+		Py::Object create_knowledge(const Py::Tuple& args) {
+			MapType knowledge;
+			for (int i = 0; i < 50; ++i) {
+				ListType points;
+				for (int j = 0; j < 10; ++j) {
+					points.emplace_back(ListType{static_cast<double>(i), static_cast<double>(j), 0.0});
+				}
+				knowledge.emplace(fmt::format("location_{}", i), MapType{{"points", std::move(points)},
+																		 {"name",   fmt::format("place {}", i)},
+																		 {"weight", i}});
+			}
+			return CyPy_Element::wrap(std::move(knowledge));
+		}
+
+		Test() : ExtensionModule("test") {
+			add_varargs_method("create_knowledge", &Test::create_knowledge, "");
+			initialize("test");
+		}
+	};
+
+	{
+		PyImport_AppendInittab("test", []() {
+			static Test testModule;
+			return testModule.module().ptr();
+		});
+
+		init_python_api({&CyPy_Rules<LocatedEntity, CyPy_LocatedEntity>::init,
+						 &CyPy_Atlas::init,
+						 &CyPy_Physics::init,
+						 &CyPy_Common::init});
+
+		run_python_string("import time");
+		run_python_string("from test import create_knowledge");
+		run_python_string("knowledge = create_knowledge()");
+		run_python_string("def bench(name, fn, iterations=200):\n"
+						  "    fn()\n"
+						  "    start = time.perf_counter()\n"
+						  "    for _ in range(iterations):\n"
+						  "        fn()\n"
+						  "    print('{}: {:.3f} ms'.format(name, (time.perf_counter() - start) * 1000 / iterations))");
+
+		//Looking up a single value deep in the structure.
+		run_python_string("def lookup():\n"
+						  "    for _ in range(100):\n"
+						  "        knowledge['location_25']['points'][5]\n"
+						  "bench('Nested lookup', lookup)");
+
+		//Iterating over all entries, reading values.
+		run_python_string("def iterate():\n"
+						  "    total = 0\n"
+						  "    for key, entry in knowledge.items():\n"
+						  "        total += entry['weight']\n"
+						  "        for point in entry['points']:\n"
+						  "            total += point[0]\n"
+						  "    return total\n"
+						  "bench('Iterate all', iterate)");
+
+		//Filtering on values, as is common in goals.
+		run_python_string("def find():\n"
+						  "    return [entry['name'] for entry in knowledge.values() if entry['weight'] > 40]\n"
+						  "bench('Find by value', find)");
+
+		//Altering a nested value, which will copy only what's altered.
+		run_python_string("def alter():\n"
+						  "    entry = knowledge['location_10']\n"
+						  "    entry['weight'] = 100\n"
+						  "bench('Alter nested', alter)");
+
+		run_python_string("assert knowledge['location_10']['weight'] == 10");
+	}
+
+	shutdown_python_api();
+	return 0;
+}
@@ -124,6 +124,72 @@ int main() {
 		run_python_string("for key, value in aMap.items(): anotherMap[key] = value")
 		run_python_string("assert anotherMap == {'foo': 'bar', 'foz': 1}")
 
+		//Nested maps and lists are native containers, holding views which share the data of their owner.
+		run_python_string("aMap = ElementMap(foo=ElementMap(bar=[1, 2]), baz=1)")
+		run_python_string("assert len(aMap) == 2")
+		run_python_string("assert sorted(aMap.keys()) == ['baz', 'foo']")
+		run_python_string("assert sorted([key for key in aMap]) == ['baz', 'foo']")
+		run_python_string("assert aMap.get('baz') == 1")
+		run_python_string("assert aMap.get('nope', 3) == 3")
+		run_python_string("assert aMap.get('nope') == None")
+		run_python_string("nested = aMap['foo']")
+		run_python_string("assert isinstance(nested, dict)")
+		run_python_string("assert isinstance(aMap.foo, dict)")
+		run_python_string("assert isinstance(aMap.values()[1], dict)")
+		run_python_string("assert nested == {'bar': [1, 2]}")
+		run_python_string("nested.update({'baz': 2})")
+		run_python_string("assert nested.setdefault('baz', 3) == 2")
+		run_python_string("assert nested.pop('baz') == 2")
+		run_python_string("nested['biz'] = 3")
+		run_python_string("del nested['biz']")
+		run_python_string("assert nested == {'bar': [1, 2]}")
+		run_python_string("nested['bar'] = 3")
+		run_python_string("assert aMap['foo'] == {'bar': [1, 2]}")
+		run_python_string("aList = ElementList([3, 1, 2])[0]")
+		run_python_string("assert isinstance(aList, list)")
+		run_python_string("aList.extend([0])")
+		run_python_string("aList.sort()")
+		run_python_string("assert aList[1:3] == [1, 2]")
+		run_python_string("del aList[0]")
+		run_python_string("assert aList == [1, 2, 3]")
+		//Views are copied when altered, and keep the data alive when their owner is gone.
+		run_python_string("shared = aMap['foo']['bar']")
+		run_python_string("shared.append(3)")
+		run_python_string("assert shared == [1, 2, 3]")
+		run_python_string("assert aMap['foo']['bar'] == [1, 2]")
+		run_python_string("shared = aMap['foo']['bar']")
+		run_python_string("del aMap")
+		run_python_string("assert shared == [1, 2]")
+		run_python_string("anotherList = []")
+		run_python_string("for i in ElementList(ElementMap(a=1), [2]): anotherList.append(i)")
+		run_python_string("assert anotherList == [{'a': 1}, [2]]")
+		run_python_string("aMap = ElementMap(foo=1)")
+		run_python_string("del aMap['foo']")
+		run_python_string("assert aMap == {}")
+		expect_python_error("del aMap['foo']", PyExc_KeyError);
+
+		//Element Lists follow the list protocol.
+		run_python_string("aList = ElementList(1, 2)")
+		run_python_string("assert aList[-1] == 2")
+		expect_python_error("aList[-3]", PyExc_IndexError);
+		expect_python_error("aList[2]", PyExc_IndexError);
+		expect_python_error("aList[-3] = 1", PyExc_IndexError);
+		expect_python_error("aList[2] = 1", PyExc_IndexError);
+		run_python_string("aList[-1] = 5")
+		run_python_string("assert aList == [1, 5]")
+		run_python_string("assert aList + [3, [4]] == [1, 5, 3, [4]]")
+		run_python_string("assert aList + ElementList(3) == [1, 5, 3]")
+		run_python_string("assert aList == [1, 5]")
+		expect_python_error("aList + 3", PyExc_TypeError);
+		run_python_string("aList += [6]")
+		run_python_string("assert aList == [1, 5, 6]")
+		run_python_string("aList *= 2")
+		run_python_string("assert aList == [1, 5, 6, 1, 5, 6]")
+		run_python_string("del aList[0]")
+		run_python_string("assert aList == [5, 6, 1, 5, 6]")
+		run_python_string("aList *= 0")
+		run_python_string("assert aList == []")
+
 	}
 
 	shutdown_python_api();
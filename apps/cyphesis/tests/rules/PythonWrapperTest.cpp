@@ -139,6 +139,63 @@ int main() {
 		script->hook("test_hook", e.get(), res);
 		e = nullptr;
 	}
+
+	// Scripts can opt in to receive operations for all their entities in one call.
+	{
+		run_python_string("batch_calls = []\n"
+						  "class BatchedEntity(server.Thing):\n"
+						  " batch_operations = ['tick']\n"
+						  " def __init__(self, cppthing):\n"
+						  "  self.name = 'batched'\n"
+						  " @classmethod\n"
+						  " def tick_operations(cls, scripts, ops):\n"
+						  "  batch_calls.append(len(scripts))\n"
+						  "  return [Operation('sight') for script in scripts]\n");
+		run_python_string("testmod.BatchedEntity=BatchedEntity");
+
+		PythonScriptFactory<LocatedEntity, LocatedEntity> psf("testmod", "BatchedEntity");
+		int ret = psf.setup();
+		assert(ret == 0);
+
+		std::vector<Operation> sent;
+		std::vector<Ref<LocatedEntity>> entities;
+		for (long i = 2; i < 5; ++i) {
+			Ref<LocatedEntity> entity = new LocatedEntity(i);
+			auto wrapper = psf.createScriptWrapper(*entity);
+			assert(wrapper);
+			wrapper->attachPropertyCallbacks(*entity, [&](const Operation& op) { sent.push_back(op); });
+			entity->m_scripts.emplace_back(std::move(wrapper));
+			entities.emplace_back(entity);
+		}
+
+		for (auto& entity: entities) {
+			OpVector res;
+			Atlas::Objects::Operation::Tick tick;
+			entity->operation(tick, res);
+			assert(res.empty());
+		}
+		// Other operations are still delivered directly.
+		{
+			OpVector res;
+			Atlas::Objects::Operation::Look look;
+			entities.front()->operation(look, res);
+		}
+		assert(sent.empty());
+
+		//Operations for destroyed scripts should be skipped.
+		entities.back()->m_scripts.clear();
+
+		auto delivered = PythonScriptBatches::instance().flush();
+		assert(delivered == 2);
+		assert(sent.size() == 2);
+		assert(PythonScriptBatches::instance().empty());
+		run_python_string("assert batch_calls == [2]");
+
+		assert(PythonScriptBatches::instance().flush() == 0);
+		for (auto& entity: entities) {
+			entity->m_scripts.clear();
+		}
+	}
 	shutdown_python_api();
 	return 0;
 }
@@ -0,0 +1,88 @@
+/*
+ Copyright (C) 2026 Erik Ogenvik
+
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#ifdef NDEBUG
+#undef NDEBUG
+#endif
+#ifndef DEBUG
+#define DEBUG
+#endif
+
+#include <Python.h>
+
+#include "../python_testers.h"
+
+#include "pythonbase/Python_API.h"
+#include "pythonbase/ScriptProfiler.h"
+
+#include <cassert>
+#include <sstream>
+
+int main() {
+	init_python_api({});
+
+	auto& profiler = ScriptProfiler::instance();
+
+	// Nothing should be recorded when disabled.
+	{
+		ScriptProfiler::Scope scope([]() -> std::string {
+			assert(false);
+			return "";
+		});
+		run_python_string("x = [i for i in range(100)]");
+	}
+	assert(profiler.getSamples().empty());
+
+	profiler.setEnabled(true);
+	{
+		ScriptProfiler::Scope outer([]() { return std::string("type;script.Class;tick_operation"); });
+		run_python_string("x = [str(i) for i in range(1000)]");
+		for (int i = 0; i < 2; ++i) {
+			ScriptProfiler::Scope inner([]() { return std::string("hook"); });
+			run_python_string("y = [str(i) for i in range(1000)]");
+		}
+	}
+	profiler.setEnabled(false);
+
+	// Allocations made after disabling shouldn't be counted.
+	run_python_string("z = [str(i) for i in range(1000)]");
+
+	auto& samples = profiler.getSamples();
+	assert(samples.size() == 2);
+	auto& outerSample = samples.at("type;script.Class;tick_operation");
+	auto& innerSample = samples.at("type;script.Class;tick_operation;hook");
+	assert(outerSample.calls == 1);
+	assert(innerSample.calls == 2);
+	assert(outerSample.allocations > 0);
+	// The nested calls did twice the work of the outer call itself.
+	assert(innerSample.allocations > outerSample.allocations);
+	assert(innerSample.allocatedBytes > 0);
+
+	auto folded = profiler.getFolded(ScriptProfiler::Metric::Allocations);
+	std::stringstream expected;
+	expected << "type;script.Class;tick_operation " << outerSample.allocations << "\n"
+			 << "type;script.Class;tick_operation;hook " << innerSample.allocations << "\n";
+	assert(folded == expected.str());
+
+	profiler.clear();
+	assert(profiler.getSamples().empty());
+	assert(profiler.getFolded(ScriptProfiler::Metric::Time).empty());
+
+	shutdown_python_api();
+	return 0;
+}
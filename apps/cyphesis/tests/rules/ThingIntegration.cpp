@@ -866,6 +866,9 @@ struct ThingIntegration : public Cyphesis::TestBaseWithContext<Context>
             ASSERT_FALSE(t3->canReach({t7, {}}));
             // T4 can't reach T5 since T4 isn't a direct child of T2
             ASSERT_FALSE(t4->canReach({t5, {}}));
+
+            // Checking many locations at once gives the same results as checking them one by one.
+            ASSERT_TRUE((t5->canReachEach({{t3, {}}, {t4, {}}, {t5, {}}, {t7, {}}, {t1, {}}}) == std::vector<bool>{true, true, true, false, false}));
         }
 
         /**
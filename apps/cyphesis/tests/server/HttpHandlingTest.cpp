@@ -52,6 +52,7 @@ public:
 int main() {
 	Monitors m;
 	global_conf = varconf::Config::inst();
+	std::optional<HttpFileBody> fileBody;
 
 	{
 		boost::asio::io_context contextMain;
@@ -63,7 +64,7 @@ int main() {
 		boost::asio::io_context contextMain;
 		HttpHandling hc(Monitors::instance(), contextMain);
 
-		hc.processQuery(std::cout, std::list<std::string>());
+		hc.processQuery(std::cout, std::list<std::string>(), fileBody);
 
 	}
 
@@ -75,7 +76,7 @@ int main() {
 		std::list<std::string> headers;
 		headers.push_back("boo");
 
-		hc.processQuery(std::cout, headers);
+		hc.processQuery(std::cout, headers, fileBody);
 
 	}
 
@@ -87,7 +88,7 @@ int main() {
 		std::list<std::string> headers;
 		headers.push_back("GET foo");
 
-		hc.processQuery(std::cout, headers);
+		hc.processQuery(std::cout, headers, fileBody);
 
 	}
 
@@ -99,7 +100,7 @@ int main() {
 		std::list<std::string> headers;
 		headers.push_back("GET foo HTTP/1.0");
 
-		hc.processQuery(std::cout, headers);
+		hc.processQuery(std::cout, headers, fileBody);
 
 	}
 
@@ -111,7 +112,7 @@ int main() {
 		std::list<std::string> headers;
 		headers.push_back("GET /config HTTP/1.0");
 
-		hc.processQuery(std::cout, headers);
+		hc.processQuery(std::cout, headers, fileBody);
 
 	}
 
@@ -125,7 +126,7 @@ int main() {
 		std::list<std::string> headers;
 		headers.push_back("GET /config HTTP/1.0");
 
-		hc.processQuery(std::cout, headers);
+		hc.processQuery(std::cout, headers, fileBody);
 
 	}
 
@@ -137,7 +138,7 @@ int main() {
 		std::list<std::string> headers;
 		headers.push_back("GET /monitors HTTP/1.0");
 
-		hc.processQuery(std::cout, headers);
+		hc.processQuery(std::cout, headers, fileBody);
 
 	}
 
@@ -155,6 +156,18 @@ int main() {
 		hc.test_reportBadRequest(std::cout, 200, "Bad request");
 	}
 
+	// Header lookup
+	{
+		std::list<std::string> headers{"GET /foo HTTP/1.1", "Host: localhost", "if-none-match:  \"abc\" ", "Range:"};
+
+		assert(HttpHandling::findHeader(headers, "Host") == "localhost");
+		assert(HttpHandling::findHeader(headers, "If-None-Match") == "\"abc\"");
+		assert(HttpHandling::findHeader(headers, "Range") == "");
+		assert(!HttpHandling::findHeader(headers, "Hos"));
+		assert(!HttpHandling::findHeader(headers, "GET /foo HTTP/1.1"));
+		assert(!HttpHandling::findHeader({}, "Host"));
+	}
+
 	return 0;
 }
 
@@ -43,6 +43,7 @@
 #include <rules/simulation/GeometryProperty.h>
 #include "rules/simulation/PhysicalWorld.h"
 #include "rules/BBoxProperty_impl.h"
+#include "rules/Vector3Property_impl.h"
 #include "common/Monitors.h"
 #include <BulletCollision/CollisionShapes/btBoxShape.h>
 #include <BulletDynamics/Dynamics/btRigidBody.h>
@@ -52,6 +53,7 @@
 #include <rules/simulation/ModeDataProperty.h>
 #include <rules/simulation/VisibilityDistanceProperty.h>
 #include <optional>
+#include <set>
 
 using namespace std::chrono_literals;
 using Atlas::Message::Element;
@@ -104,6 +106,8 @@ int AssertBase::assertFuzzyEqual(const char* l, const WFMath::Point<3>& lval,
 
 class TestPhysicalDomain : public PhysicalDomain {
 public:
+        using PhysicalDomain::SimulationTier;
+
         explicit TestPhysicalDomain(LocatedEntity& entity, std::optional<unsigned int> visibilityBroadphaseMaxHandles = std::nullopt) :
                 PhysicalDomain(entity, visibilityBroadphaseMaxHandles) {
 
@@ -141,6 +145,8 @@ public:
 
 double epsilon = 0.0001;
 
+extern bool simulation_tiers;
+
 struct TestContext {
 	long m_id_counter;
 
@@ -174,6 +180,10 @@ struct Tested : public Cyphesis::TestBaseWithContext<TestContext> {
                 ADD_TEST(Tested::test_visibility);
                 ADD_TEST(Tested::test_visibilityBroadphaseCapacity);
                 ADD_TEST(Tested::test_stairs);
+                ADD_TEST(Tested::test_simulationTiers);
+                ADD_TEST(Tested::test_simulationTiersPropelChange);
+                ADD_TEST(Tested::test_simulationTiersDestination);
+                ADD_TEST(Tested::test_batchedQueries);
         }
 
 
@@ -1992,6 +2002,273 @@ struct Tested : public Cyphesis::TestBaseWithContext<TestContext> {
 
 	}
 
+	void test_simulationTiers(TestContext& context) {
+		simulation_tiers = true;
+
+		TypeNode<LocatedEntity> rockType("rock");
+		TypeNode<LocatedEntity> humanType("human");
+		Property<double, LocatedEntity> massProp{};
+		massProp.data() = 100;
+		Property<double, LocatedEntity> speedGroundProperty{};
+		speedGroundProperty.data() = 5.0;
+		PropelProperty propelProperty{};
+		propelProperty.data() = WFMath::Vector<3>(0, 0, 1.0 / speedGroundProperty.data());
+		AngularFactorProperty angularZeroFactorProperty;
+		angularZeroFactorProperty.data() = WFMath::Vector<3>::ZERO();
+
+		humanType.injectProperty("speed_ground", std::unique_ptr<PropertyBase>(speedGroundProperty.copy()));
+
+		LocatedEntity rootEntity(context.newId());
+		rootEntity.incRef();
+		rootEntity.requirePropertyClassFixed<PositionProperty<LocatedEntity>>().data() = WFMath::Point<3>::ZERO();
+		rootEntity.requirePropertyClassFixed<BBoxProperty<LocatedEntity>>().data() = WFMath::AxisBox<3>(WFMath::Point<3>(-64, 0, -64), WFMath::Point<3>(64, 64, 64));
+		std::unique_ptr<TestPhysicalDomain> domain(new TestPhysicalDomain(rootEntity));
+		simulation_tiers = false;
+
+		TestWorld testWorld(&rootEntity);
+
+		Ref<LocatedEntity> rock = new LocatedEntity(RouterId{context.newId()});
+		rock->setProperty("mass", std::unique_ptr<PropertyBase>(massProp.copy()));
+		rock->setType(&rockType);
+		rock->requirePropertyClassFixed<PositionProperty<LocatedEntity>>().data() = WFMath::Point<3>(50, 0, 50);
+		rock->requirePropertyClassFixed<BBoxProperty<LocatedEntity>>().data() = WFMath::AxisBox<3>(WFMath::Point<3>(-0.2f, 0, -0.2f), WFMath::Point<3>(0.2, 0.4, 0.2));
+		domain->addEntity(*rock);
+
+		Ref<LocatedEntity> human = new LocatedEntity(RouterId{context.newId()});
+		human->setProperty(AngularFactorProperty::property_name, std::unique_ptr<PropertyBase>(angularZeroFactorProperty.copy()));
+		human->setProperty("mass", std::unique_ptr<PropertyBase>(massProp.copy()));
+		human->setProperty(PropelProperty::property_name, std::unique_ptr<PropertyBase>(propelProperty.copy()));
+		human->setType(&humanType);
+		human->requirePropertyClassFixed<PositionProperty<LocatedEntity>>().data() = WFMath::Point<3>(0, 0, 0);
+		human->requirePropertyClassFixed<BBoxProperty<LocatedEntity>>().data() = WFMath::AxisBox<3>(WFMath::Point<3>(-0.4f, 0, -0.4f), WFMath::Point<3>(0.4, 1.8, 0.4));
+		domain->addEntity(*human);
+
+		OpVector res;
+		domain->tick(100ms, res);
+
+		//Nothing observes either entity, so the propelled one should be coarsely simulated.
+		ASSERT_TRUE(domain->test_getEntry(human->getIdAsInt())->tier == TestPhysicalDomain::SimulationTier::Coarse);
+		ASSERT_EQUAL(DISABLE_SIMULATION, domain->test_getRigidBody(human->getIdAsInt())->getActivationState());
+		auto zBeforeCoarse = human->requirePropertyClassFixed<PositionProperty<LocatedEntity>>().data().z();
+
+		for (int i = 0; i < 20; ++i) {
+			domain->tick(100ms, res);
+		}
+		//The rock should have come to rest and been put to sleep.
+		ASSERT_TRUE(domain->test_getEntry(rock->getIdAsInt())->tier == TestPhysicalDomain::SimulationTier::Sleeping);
+		ASSERT_EQUAL(DISABLE_SIMULATION, domain->test_getRigidBody(rock->getIdAsInt())->getActivationState());
+		//The human moves at 1 m/s, and has been updated up to 2000 ms.
+		ASSERT_FUZZY_EQUAL(zBeforeCoarse + 1.9, human->requirePropertyClassFixed<PositionProperty<LocatedEntity>>().data().z(), 0.01);
+
+		//Once observed it should catch up with the time passed since the last coarse update, and be fully simulated again.
+		Ref<LocatedEntity> observer = new LocatedEntity(RouterId{context.newId()});
+		observer->setType(&humanType);
+		observer->requirePropertyClassFixed<PositionProperty<LocatedEntity>>().data() = WFMath::Point<3>(-2, 0, 2);
+		observer->requirePropertyClassFixed<BBoxProperty<LocatedEntity>>().data() = WFMath::AxisBox<3>(WFMath::Point<3>(-0.2f, 0, -0.2f), WFMath::Point<3>(0.2, 2, 0.2));
+		observer->addFlags(entity_perceptive);
+		domain->addEntity(*observer);
+
+		domain->tick(100ms, res);
+		ASSERT_TRUE(domain->isEntityVisibleFor(*observer, *human));
+		ASSERT_TRUE(domain->test_getEntry(human->getIdAsInt())->tier == TestPhysicalDomain::SimulationTier::Full);
+		ASSERT_NOT_EQUAL(DISABLE_SIMULATION, domain->test_getRigidBody(human->getIdAsInt())->getActivationState());
+		ASSERT_FUZZY_EQUAL(zBeforeCoarse + 2.1, human->requirePropertyClassFixed<PositionProperty<LocatedEntity>>().data().z(), 0.01);
+		//The rock is still out of sight.
+		ASSERT_TRUE(domain->test_getEntry(rock->getIdAsInt())->tier == TestPhysicalDomain::SimulationTier::Sleeping);
+
+		domain->tick(1000ms, res);
+		ASSERT_FUZZY_EQUAL(zBeforeCoarse + 3.1, human->requirePropertyClassFixed<PositionProperty<LocatedEntity>>().data().z(), 0.3);
+	}
+
+	void test_simulationTiersPropelChange(TestContext& context) {
+		simulation_tiers = true;
+
+		TypeNode<LocatedEntity> humanType("human");
+		Property<double, LocatedEntity> massProp{};
+		massProp.data() = 100;
+		Property<double, LocatedEntity> speedGroundProperty{};
+		speedGroundProperty.data() = 5.0;
+		PropelProperty propelProperty{};
+		propelProperty.data() = WFMath::Vector<3>(0, 0, 1.0 / speedGroundProperty.data());
+		AngularFactorProperty angularZeroFactorProperty;
+		angularZeroFactorProperty.data() = WFMath::Vector<3>::ZERO();
+
+		humanType.injectProperty("speed_ground", std::unique_ptr<PropertyBase>(speedGroundProperty.copy()));
+
+		LocatedEntity rootEntity(context.newId());
+		rootEntity.incRef();
+		rootEntity.requirePropertyClassFixed<PositionProperty<LocatedEntity>>().data() = WFMath::Point<3>::ZERO();
+		rootEntity.requirePropertyClassFixed<BBoxProperty<LocatedEntity>>().data() = WFMath::AxisBox<3>(WFMath::Point<3>(-64, 0, -64), WFMath::Point<3>(64, 64, 64));
+		std::unique_ptr<TestPhysicalDomain> domain(new TestPhysicalDomain(rootEntity));
+		simulation_tiers = false;
+
+		TestWorld testWorld(&rootEntity);
+
+		Ref<LocatedEntity> human = new LocatedEntity(RouterId{context.newId()});
+		human->setProperty(AngularFactorProperty::property_name, std::unique_ptr<PropertyBase>(angularZeroFactorProperty.copy()));
+		human->setProperty("mass", std::unique_ptr<PropertyBase>(massProp.copy()));
+		human->setProperty(PropelProperty::property_name, std::unique_ptr<PropertyBase>(propelProperty.copy()));
+		human->setType(&humanType);
+		human->requirePropertyClassFixed<PositionProperty<LocatedEntity>>().data() = WFMath::Point<3>(0, 0, 0);
+		human->requirePropertyClassFixed<BBoxProperty<LocatedEntity>>().data() = WFMath::AxisBox<3>(WFMath::Point<3>(-0.4f, 0, -0.4f), WFMath::Point<3>(0.4, 1.8, 0.4));
+		domain->addEntity(*human);
+
+		OpVector res;
+		domain->tick(100ms, res);
+		ASSERT_TRUE(domain->test_getEntry(human->getIdAsInt())->tier == TestPhysicalDomain::SimulationTier::Coarse);
+		auto zBeforeCoarse = human->requirePropertyClassFixed<PositionProperty<LocatedEntity>>().data().z();
+
+		//Stop between two coarse updates; the time until then should still be moved with the old propel.
+		domain->tick(200ms, res);
+		auto propel = human->modPropertyClassFixed<PropelProperty>();
+		propel->data() = WFMath::Vector<3>::ZERO();
+		human->applyProperty(*propel);
+		ASSERT_FUZZY_EQUAL(zBeforeCoarse + 0.2, human->requirePropertyClassFixed<PositionProperty<LocatedEntity>>().data().z(), 0.01);
+
+		//With nothing propelling it, it should go to sleep and stand still.
+		for (int i = 0; i < 10; ++i) {
+			domain->tick(100ms, res);
+		}
+		ASSERT_TRUE(domain->test_getEntry(human->getIdAsInt())->tier == TestPhysicalDomain::SimulationTier::Sleeping);
+		ASSERT_FUZZY_EQUAL(zBeforeCoarse + 0.2, human->requirePropertyClassFixed<PositionProperty<LocatedEntity>>().data().z(), 0.01);
+		ASSERT_EQUAL(WFMath::Vector<3>::ZERO(), human->requirePropertyClassFixed<VelocityProperty<LocatedEntity>>().data());
+	}
+
+	void test_simulationTiersDestination(TestContext& context) {
+		simulation_tiers = true;
+
+		TypeNode<LocatedEntity> humanType("human");
+		Property<double, LocatedEntity> massProp{};
+		massProp.data() = 100;
+		Property<double, LocatedEntity> speedGroundProperty{};
+		speedGroundProperty.data() = 2.0;
+		AngularFactorProperty angularZeroFactorProperty;
+		angularZeroFactorProperty.data() = WFMath::Vector<3>::ZERO();
+		Vector3Property<LocatedEntity> destinationProperty{};
+		destinationProperty.data() = WFMath::Vector<3>(3, 0, 4);
+
+		humanType.injectProperty("speed_ground", std::unique_ptr<PropertyBase>(speedGroundProperty.copy()));
+
+		LocatedEntity rootEntity(context.newId());
+		rootEntity.incRef();
+		rootEntity.requirePropertyClassFixed<PositionProperty<LocatedEntity>>().data() = WFMath::Point<3>::ZERO();
+		rootEntity.requirePropertyClassFixed<BBoxProperty<LocatedEntity>>().data() = WFMath::AxisBox<3>(WFMath::Point<3>(-64, 0, -64), WFMath::Point<3>(64, 64, 64));
+		std::unique_ptr<TestPhysicalDomain> domain(new TestPhysicalDomain(rootEntity));
+		simulation_tiers = false;
+
+		TestWorld testWorld(&rootEntity);
+
+		//Without any propel it should still move towards the destination, at its full speed.
+		Ref<LocatedEntity> human = new LocatedEntity(RouterId{context.newId()});
+		human->setProperty(AngularFactorProperty::property_name, std::unique_ptr<PropertyBase>(angularZeroFactorProperty.copy()));
+		human->setProperty("mass", std::unique_ptr<PropertyBase>(massProp.copy()));
+		human->setProperty("_destination", std::unique_ptr<PropertyBase>(destinationProperty.copy()));
+		human->setType(&humanType);
+		human->requirePropertyClassFixed<PositionProperty<LocatedEntity>>().data() = WFMath::Point<3>(0, 0, 0);
+		human->requirePropertyClassFixed<BBoxProperty<LocatedEntity>>().data() = WFMath::AxisBox<3>(WFMath::Point<3>(-0.4f, 0, -0.4f), WFMath::Point<3>(0.4, 1.8, 0.4));
+		domain->addEntity(*human);
+
+		OpVector res;
+		domain->tick(100ms, res);
+		ASSERT_TRUE(domain->test_getEntry(human->getIdAsInt())->tier == TestPhysicalDomain::SimulationTier::Coarse);
+		auto& velocity = human->requirePropertyClassFixed<VelocityProperty<LocatedEntity>>().data();
+		ASSERT_FUZZY_EQUAL(1.2, velocity.x(), 0.01);
+		ASSERT_FUZZY_EQUAL(1.6, velocity.z(), 0.01);
+
+		//The destination is 5 meters away, which takes 2.5 seconds. It should then stop there, instead of overshooting.
+		for (int i = 0; i < 40; ++i) {
+			domain->tick(100ms, res);
+		}
+		auto& pos = human->requirePropertyClassFixed<PositionProperty<LocatedEntity>>().data();
+		ASSERT_FUZZY_EQUAL(3.0, pos.x(), 0.1);
+		ASSERT_FUZZY_EQUAL(4.0, pos.z(), 0.1);
+		ASSERT_TRUE(domain->test_getEntry(human->getIdAsInt())->tier == TestPhysicalDomain::SimulationTier::Sleeping);
+		ASSERT_EQUAL(WFMath::Vector<3>::ZERO(), velocity);
+
+		//A new destination should wake it up again.
+		auto destination = human->modPropertyClass<Vector3Property<LocatedEntity>>("_destination");
+		destination->data() = WFMath::Vector<3>(3, 0, 0);
+		human->applyProperty(*destination);
+		for (int i = 0; i < 40; ++i) {
+			domain->tick(100ms, res);
+		}
+		ASSERT_FUZZY_EQUAL(3.0, pos.x(), 0.1);
+		ASSERT_FUZZY_EQUAL(0.0, pos.z(), 0.1);
+		ASSERT_TRUE(domain->test_getEntry(human->getIdAsInt())->tier == TestPhysicalDomain::SimulationTier::Sleeping);
+	}
+
+	void test_batchedQueries(TestContext& context) {
+		TypeNode<LocatedEntity> rockType("rock");
+
+		LocatedEntity rootEntity(context.newId());
+		rootEntity.incRef();
+		rootEntity.requirePropertyClassFixed<PositionProperty<LocatedEntity>>().data() = WFMath::Point<3>::ZERO();
+		rootEntity.requirePropertyClassFixed<BBoxProperty<LocatedEntity>>().data() = WFMath::AxisBox<3>(WFMath::Point<3>(-128, 0, -128), WFMath::Point<3>(128, 64, 128));
+		std::unique_ptr<TestPhysicalDomain> domain(new TestPhysicalDomain(rootEntity));
+
+		TestWorld testWorld(&rootEntity);
+
+		auto createRock = [&](WFMath::Point<3> pos) {
+			Ref<LocatedEntity> rock = new LocatedEntity(RouterId{context.newId()});
+			rock->setType(&rockType);
+			rock->requirePropertyClassFixed<PositionProperty<LocatedEntity>>().data() = pos;
+			rock->requirePropertyClassFixed<BBoxProperty<LocatedEntity>>().data() = WFMath::AxisBox<3>(WFMath::Point<3>(-1, 0, -1), WFMath::Point<3>(1, 1, 1));
+			domain->addEntity(*rock);
+			return rock;
+		};
+
+		auto rock1 = createRock({0, 0, 0});
+		auto rock2 = createRock({3, 0, 0});
+		auto rock3 = createRock({100, 0, 100});
+
+		OpVector res;
+		domain->tick(100ms, res);
+
+		//Spheres spread over multiple cells, some overlapping the same rocks.
+		std::vector<WFMath::Ball<3>> spheres{
+				WFMath::Ball<3>({0, 0.5, 0}, 0.5),
+				WFMath::Ball<3>({1.5, 0.5, 0}, 1),
+				WFMath::Ball<3>({100, 0.5, 100}, 2),
+				WFMath::Ball<3>({50, 0.5, 50}, 2),
+		};
+
+		auto collisionLists = domain->queryCollisions(spheres);
+		ASSERT_EQUAL(spheres.size(), collisionLists.size());
+		auto entitiesFor = [](const std::vector<Domain::CollisionEntry>& collisions) {
+			std::set<const LocatedEntity*> entities;
+			for (auto& collision: collisions) {
+				entities.insert(collision.entity);
+			}
+			return entities;
+		};
+		ASSERT_TRUE(entitiesFor(collisionLists[0]) == std::set<const LocatedEntity*>{rock1.get()});
+		ASSERT_TRUE(entitiesFor(collisionLists[1]) == (std::set<const LocatedEntity*>{rock1.get(), rock2.get()}));
+		ASSERT_TRUE(entitiesFor(collisionLists[2]) == std::set<const LocatedEntity*>{rock3.get()});
+		ASSERT_TRUE(collisionLists[3].empty());
+		//The contact with rock1 is on its surface, within the sphere.
+		ASSERT_EQUAL(1, collisionLists[0].size());
+		ASSERT_TRUE(collisionLists[0].front().distance <= 0.51f);
+		ASSERT_TRUE(entitiesFor(domain->queryCollision(spheres[1])) == (std::set<const LocatedEntity*>{rock1.get(), rock2.get()}));
+
+		//Batched reach queries should give the same results as querying one by one.
+		std::vector<Domain::ReachQuery> reachQueries{
+				{*rock1, 2, *rock2, {}},
+				{*rock1, 0.5, *rock2, {}},
+				{*rock1, 2, *rock3, {}},
+				{*rock2, 2, *rock1, {}},
+				{*rock1, 0, *rock2, {}},
+		};
+		auto reachable = domain->areEntitiesReachable(reachQueries);
+		ASSERT_EQUAL(reachQueries.size(), reachable.size());
+		for (size_t i = 0; i < reachQueries.size(); ++i) {
+			auto& query = reachQueries[i];
+			ASSERT_EQUAL(domain->isEntityReachable(query.reachingEntity, query.reach, query.queriedEntity, query.positionOnQueriedEntity), reachable[i]);
+		}
+		ASSERT_TRUE(reachable[0]);
+		ASSERT_FALSE(reachable[2]);
+		ASSERT_FALSE(reachable[4]);
+	}
+
 	void test_terrainPrecision(TestContext& context) {
 
 		LocatedEntity rootEntity(context.newId());
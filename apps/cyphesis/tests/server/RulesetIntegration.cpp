@@ -220,14 +220,25 @@ struct Rulesetintegration : public Cyphesis::TestBase {
 				custom_inherited_type_description->setParent("custom_type");
 				custom_inherited_type_description->setObjtype("class");
 
+				// The parent gains a child, so it should be published along with the new type.
+				std::set<std::string> updatedTypes;
+				auto connection = Inheritance::instance().typesUpdated.connect([&](const std::map<const TypeNode<LocatedEntity>*, TypeNode<LocatedEntity>::PropertiesUpdate>& changes) {
+					for (auto& entry: changes) {
+						updatedTypes.insert(entry.first->name());
+					}
+				});
+
 				std::string dependent, reason;
 				int ret = test_ruleset.installRule("custom_inherited_type",
 												   "custom",
 												   custom_inherited_type_description);
+				connection.disconnect();
 
 				assert(ret == 0);
 				assert(dependent.empty());
 				assert(reason.empty());
+				assert(updatedTypes.contains("custom_type"));
+				assert(updatedTypes.contains("custom_inherited_type"));
 			}
 
 			// Check that the factory dictionary does contain the factory for
@@ -85,6 +85,8 @@ public:
 
 	void test_delEntity_world();
 
+	void test_getEntitiesOfType();
+
 	Inheritance* m_inheritance;
 	Ref<LocatedEntity> m_rootEntity;
 };
@@ -98,6 +100,7 @@ WorldRoutertest::WorldRoutertest() {
 	ADD_TEST(WorldRoutertest::test_addEntity_tick_get);
 	ADD_TEST(WorldRoutertest::test_delEntity);
 	ADD_TEST(WorldRoutertest::test_delEntity_world);
+	ADD_TEST(WorldRoutertest::test_getEntitiesOfType);
 }
 
 void WorldRoutertest::setup() {
@@ -188,6 +191,25 @@ void WorldRoutertest::test_delEntity_world() {
 	test_world->delEntity(m_rootEntity.get());
 }
 
+void WorldRoutertest::test_getEntitiesOfType() {
+	Anonymous ent;
+	ent->setLoc("0");
+	auto ent1 = test_world->addNewEntity("thing", ent);
+	assert(ent1);
+	auto type = ent1->getType();
+	assert(test_world->getEntitiesOfType(type).count(ent1.get()) == 1);
+
+	// The entity with the lowest id is found, whatever order they are stored in.
+	auto ent2 = test_world->addNewEntity("thing", ent);
+	assert(ent2);
+	auto& lowest = ent1->getIdAsInt() < ent2->getIdAsInt() ? ent1 : ent2;
+	assert(test_world->findByType("thing") == lowest);
+
+	test_world->delEntity(ent2.get());
+	test_world->delEntity(ent1.get());
+	assert(test_world->getEntitiesOfType(type).count(ent1.get()) == 0);
+}
+
 int main() {
 	Monitors m;
 	WorldRoutertest t;
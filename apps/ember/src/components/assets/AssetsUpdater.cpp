@@ -30,6 +30,13 @@ AssetsUpdater::AssetsUpdater(Squall::Repository&& repository)
 
 }
 
+namespace {
+std::string rootNameForHost(std::string hostname) {
+	std::replace(hostname.begin(), hostname.end(), '.', '_');
+	return fmt::format("ember_{}", hostname);
+}
+}
+
 std::future<UpdateResult> AssetsUpdater::syncSquall(std::string remoteBaseUrl, Squall::Signature signature, std::string hostname) {
 	auto I = std::find_if(mActiveSessions.begin(), mActiveSessions.end(),
 						  [&remoteBaseUrl, &signature](const UpdateSession& session) { return session.remoteBaseUrl == remoteBaseUrl && session.signature == signature; });
@@ -38,6 +45,11 @@ std::future<UpdateResult> AssetsUpdater::syncSquall(std::string remoteBaseUrl, S
 				.remoteBaseUrl = remoteBaseUrl,
 				.hostname = std::move(hostname),
 				.signature = signature};
+		//If we've synced with the server before, only deltas of altered files need to be fetched.
+		auto previousRoot = mRepository.readRoot(rootNameForHost(session.hostname));
+		if (previousRoot && previousRoot->signature != signature) {
+			session.resolver.setPreviousRoot(previousRoot->signature);
+		}
 		mActiveSessions.emplace_back(std::move(session));
 		return mActiveSessions.back().callback.get_future();
 	} else {
@@ -52,9 +64,7 @@ size_t AssetsUpdater::poll() {
 		auto& firstSession = mActiveSessions.front();
 		auto resolveResult = firstSession.resolver.poll(10);
 		if (resolveResult.status == Squall::ResolveStatus::COMPLETE) {
-			auto cleanedHostname = firstSession.hostname;
-			std::replace(cleanedHostname.begin(), cleanedHostname.end(), '.', '_');
-			mRepository.storeRoot(fmt::format("ember_{}", cleanedHostname), Squall::Root{.signature =firstSession.signature});
+			mRepository.storeRoot(rootNameForHost(firstSession.hostname), Squall::Root{.signature =firstSession.signature});
 			auto callback = std::move(firstSession.callback);
 			mActiveSessions.erase(mActiveSessions.begin());
 			callback.set_value(UpdateResult::Success);
@@ -535,7 +535,12 @@ std::future<void> EmberOgre::loadAssets(Squall::Signature signature) {
 
 std::optional<std::filesystem::path> EmberOgre::resolveFileInSquallRepository(const std::filesystem::path& virtualPath) const {
 	if (mServerManifest) {
-		return SquallArchive::resolveFile(mRepository, *mServerManifest, virtualPath);
+		auto fetchResult = SquallArchive::resolveFile(mRepository, *mServerManifest, virtualPath);
+		//Data stored in packs doesn't have a file of its own.
+		if (fetchResult && !fetchResult->packLocation) {
+			return fetchResult->localPath;
+		}
+		return {};
 	} else {
 		return {};
 	}
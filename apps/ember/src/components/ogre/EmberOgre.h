@@ -230,6 +230,7 @@ public:
 
 	/**
 	 * Resolve the local file path from the Squall repo, using the path within the virtual Squall filesystem.
+	 * Files which are stored in packs can't be resolved.
 	 * @param virtualPath
 	 * @return
 	 */
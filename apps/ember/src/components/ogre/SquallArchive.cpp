@@ -19,6 +19,8 @@
 #include "SquallArchive.h"
 
 #include <utility>
+#include <fstream>
+#include <OgreDataStream.h>
 #include <boost/algorithm/string/replace.hpp>
 
 
@@ -56,7 +58,7 @@ std::unique_ptr<std::regex> regexFromPattern(const std::string& pattern) {
 
 namespace Ember::OgreView {
 
-std::optional<std::filesystem::path> SquallArchive::resolveFile(const Squall::Repository& repository, Squall::Manifest manifest, const std::filesystem::path& path) {
+std::optional<Squall::FetchResult> SquallArchive::resolveFile(const Squall::Repository& repository, Squall::Manifest manifest, const std::filesystem::path& path) {
 	auto activeManifest = std::move(manifest);
 
 	std::vector<std::string> elements;
@@ -85,7 +87,7 @@ std::optional<std::filesystem::path> SquallArchive::resolveFile(const Squall::Re
 				if (i == elements.size()) {
 					auto fetchResult = repository.fetch(manifestI->signature);
 					if (fetchResult.status == Squall::FetchStatus::SUCCESS) {
-						return {fetchResult.localPath};
+						return fetchResult;
 					} else {
 						return {};
 					}
@@ -125,13 +127,23 @@ Ogre::DataStreamPtr SquallArchive::open(const Ogre::String& filename, bool) cons
 	auto resolvedFile = resolveFile(mRepository, mRootManifest, filename);
 	if (resolvedFile.has_value()) {
 		// Always open in binary mode
-		auto origStream = std::make_unique<std::ifstream>(*resolvedFile, std::ios::in | std::ios::binary);
+		auto origStream = std::make_unique<std::ifstream>(resolvedFile->localPath, std::ios::in | std::ios::binary);
 
 		// Should check ensure open succeeded, in case fail for some reason.
 		if (origStream->fail()) {
 			OGRE_EXCEPT(Ogre::Exception::ERR_FILE_NOT_FOUND, "Cannot open file: " + filename, "SquallArchive::open");
 		}
-		auto size = file_size((*resolvedFile));
+		if (resolvedFile->packLocation) {
+			//Data in a pack is read into memory, since the file stream would expose the whole pack.
+			auto stream = std::make_shared<Ogre::MemoryDataStream>(filename, resolvedFile->packLocation->size, true);
+			origStream->seekg(static_cast<std::streamoff>(resolvedFile->packLocation->offset));
+			origStream->read(reinterpret_cast<char*>(stream->getPtr()), static_cast<std::streamsize>(resolvedFile->packLocation->size));
+			if (static_cast<std::uint64_t>(origStream->gcount()) != resolvedFile->packLocation->size) {
+				OGRE_EXCEPT(Ogre::Exception::ERR_FILE_NOT_FOUND, "Cannot read file: " + filename, "SquallArchive::open");
+			}
+			return stream;
+		}
+		auto size = file_size(resolvedFile->localPath);
 		// Construct return stream, tell it to delete on destroy
 		auto stream = Ogre::DataStreamPtr(new Ogre::FileStreamDataStream(filename, origStream.get(), size, true));
 		origStream.release();
@@ -167,7 +179,7 @@ bool SquallArchive::exists(const Ogre::String& filename) const {
 time_t SquallArchive::getModifiedTime(const Ogre::String& filename) const {
 	auto resolvedFile = resolveFile(mRepository, mRootManifest, filename);
 	if (resolvedFile) {
-		return std::filesystem::last_write_time(*resolvedFile).time_since_epoch().count();
+		return std::filesystem::last_write_time(resolvedFile->localPath).time_since_epoch().count();
 	} else {
 		return 0;
 	}
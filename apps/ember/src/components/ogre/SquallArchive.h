@@ -28,9 +28,9 @@
 namespace Ember::OgreView {
 class SquallArchive : public Ogre::Archive {
 public:
-	static std::optional<std::filesystem::path> resolveFile(const Squall::Repository& repository,
-															Squall::Manifest manifest,
-															const std::filesystem::path& path);
+	static std::optional<Squall::FetchResult> resolveFile(const Squall::Repository& repository,
+														  Squall::Manifest manifest,
+														  const std::filesystem::path& path);
 
 	SquallArchive(Squall::Repository repository, Squall::Signature rootSignature);
 
@@ -255,12 +255,11 @@ Environment::Environment* World::getEnvironment() const {
 }
 
 void World::terrainManager_AfterTerrainUpdate(const std::vector<WFMath::AxisBox<2>>& areas, const std::vector<std::shared_ptr<Terrain::TerrainPageGeometry>>&) {
-        Profiler::start("terrainUpdate");
+        EMBER_PROFILE_SCOPE("terrainUpdate");
         auto* emberEntity = dynamic_cast<EmberEntity*>(mView.getTopLevel());
         if (emberEntity) {
                 updateEntityPosition(emberEntity, areas);
         }
-        Profiler::stop("terrainUpdate");
 }
 
 void World::updateEntityPosition(EmberEntity* entity, const std::vector<WFMath::AxisBox<2>>& areas) {
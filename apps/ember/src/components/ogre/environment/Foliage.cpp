@@ -26,6 +26,7 @@
 #include "ShrubberyFoliage.h"
 
 #include "framework/Tokeniser.h"
+#include "framework/Profiler.h"
 
 #include <wfmath/point.h>
 
@@ -82,6 +83,7 @@ void Foliage::reloadAtPosition(const WFMath::Point<2>& worldPosition) {
 }
 
 bool Foliage::frameStarted(const Ogre::FrameEvent&) {
+	EMBER_PROFILE_SCOPE("foliage");
 	for (auto I = mFoliages.begin(); I != mFoliages.end(); I++) {
 		try {
 			(*I)->frameStarted();
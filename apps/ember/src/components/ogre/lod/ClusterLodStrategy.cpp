@@ -32,7 +32,7 @@ THE SOFTWARE.
 
 #include <OgreViewport.h>
 #include <OgreAny.h>
-#include <functional>
+#include <algorithm>
 
 using namespace Ogre;
 
@@ -41,6 +41,59 @@ Ember::OgreView::Lod::ClusterLodStrategy* Ogre::Singleton<Ember::OgreView::Lod::
 
 
 namespace Ember::OgreView::Lod {
+
+namespace {
+/**
+ * The parts of projecting errors onto the screen which are the same for every cluster,
+ * so that a selection only computes them once.
+ */
+struct ErrorProjection {
+        const Matrix4& transform;
+        Real scale;
+        Vector3 cameraPosition;
+        Real nearDistance;
+        /// Pixels per unit of error, at unit distance for perspective projections.
+        Real pixelsPerUnit;
+        bool perspective;
+
+        ErrorProjection(const Matrix4& transform_, const Camera* camera)
+                        : transform(transform_),
+                          // Spheres only stay spheres under uniform scaling, so use the largest scale.
+                          scale(std::max({Vector3(transform_[0][0], transform_[1][0], transform_[2][0]).length(),
+                                          Vector3(transform_[0][1], transform_[1][1], transform_[2][1]).length(),
+                                          Vector3(transform_[0][2], transform_[1][2], transform_[2][2]).length()})),
+                          cameraPosition(camera->getDerivedPosition()),
+                          nearDistance(camera->getNearClipDistance()),
+                          pixelsPerUnit(0),
+                          perspective(camera->getProjectionType() == PT_PERSPECTIVE) {
+                const Real viewportHeight = static_cast<Real>(camera->getViewport()->getActualHeight());
+                if (perspective) {
+                        pixelsPerUnit = scale * camera->getProjectionMatrix()[1][1] * viewportHeight * 0.5f;
+                } else {
+                        Real orthoHeight = camera->getOrthoWindowHeight();
+                        pixelsPerUnit = orthoHeight <= std::numeric_limits<Real>::epsilon()
+                                        ? std::numeric_limits<Real>::max()
+                                        : scale * viewportHeight / orthoHeight;
+                }
+        }
+
+        Sphere toWorld(const Sphere& bounds) const {
+                return {transform * bounds.getCenter(), bounds.getRadius() * scale};
+        }
+
+        Real project(const Sphere& bounds, Real error) const {
+                if (error >= NaniteFormat::RootParentError)
+                        return std::numeric_limits<Real>::max();
+                if (!perspective)
+                        return error * pixelsPerUnit;
+                auto world = toWorld(bounds);
+                // Use the nearest point of the bounds, so that errors never shrink as bounds grow.
+                Real distance = std::max(world.getCenter().distance(cameraPosition) - world.getRadius(), nearDistance);
+                return error * pixelsPerUnit / distance;
+        }
+};
+}
+
 //-----------------------------------------------------------------------
 
 ClusterLodStrategy* ClusterLodStrategy::getSingletonPtr() { return msSingleton; }
@@ -51,7 +104,10 @@ ClusterLodStrategy& ClusterLodStrategy::getSingleton() {
 }
 
 //-----------------------------------------------------------------------
-ClusterLodStrategy::ClusterLodStrategy() : LodStrategy("ClusterLod") {}
+ClusterLodStrategy::ClusterLodStrategy()
+                : LodStrategy("ClusterLod"),
+                  mCacheDistanceTolerance(0.01f),
+                  mCacheAngleTolerance(Degree(0.1f)) {}
 
 //-----------------------------------------------------------------------
 Real ClusterLodStrategy::getError(const AxisAlignedBox& bounds, const Matrix4& transform, const Camera* camera) const {
@@ -86,6 +142,10 @@ Real ClusterLodStrategy::getError(const AxisAlignedBox& bounds, const Matrix4& t
         }
 }
 
+Real ClusterLodStrategy::getProjectedError(const Sphere& bounds, Real error, const Matrix4& transform, const Camera* camera) const {
+        return ErrorProjection(transform, camera).project(bounds, error);
+}
+
 Real ClusterLodStrategy::getValueImpl(const MovableObject* movableObject, const Camera* camera) const {
         const Any* any = movableObject->getUserObjectBindings().getUserAny("lodClusters");
         const auto* clusters = any ? Ogre::any_cast<const std::vector<NaniteLodDefinition::Cluster>*>(any) : nullptr;
@@ -138,26 +198,75 @@ bool ClusterLodStrategy::isSorted(const Mesh::LodValueList& values) const {
 	return isSortedDescending(values);
 }
 
+void ClusterLodStrategy::setCacheTolerance(Real distance, Radian angle) {
+        mCacheDistanceTolerance = distance;
+        mCacheAngleTolerance = angle;
+}
+
+void ClusterLodStrategy::traverse(const Matrix4& transform,
+                                  const Camera* camera,
+                                  const std::vector<NaniteLodDefinition::Cluster>& clusters,
+                                  Real errorThreshold,
+                                  const std::vector<uint32_t>& roots,
+                                  ClusterTraversal::Scratch& scratch,
+                                  std::vector<size_t>& out) const {
+        ErrorProjection projection(transform, camera);
+        ClusterTraversal::traverse(clusters,
+                                   roots,
+                                   errorThreshold,
+                                   scratch,
+                                   [&](const NaniteLodDefinition::Cluster& c) { return projection.project(c.lodBounds, c.error); },
+                                   [&](const NaniteLodDefinition::Cluster& c) { return camera->isVisible(projection.toWorld(c.lodBounds)); },
+                                   out);
+}
+
 void ClusterLodStrategy::selectClusters(const Matrix4& transform,
                                         const Camera* camera,
                                         const std::vector<NaniteLodDefinition::Cluster>& clusters,
                                         Real errorThreshold,
                                         std::vector<size_t>& out) const {
-        if (clusters.empty())
-                return;
-
-        std::function<void(size_t)> traverse = [&](size_t idx) {
-                const auto& c = clusters[idx];
-                Real err = getError(c.bounds, transform, camera);
-                if (!c.children.empty() && err > errorThreshold) {
-                        for (size_t child : c.children)
-                                traverse(child);
-                } else {
-                        out.push_back(idx);
-                }
-        };
+        ClusterTraversal::Scratch scratch;
+        traverse(transform, camera, clusters, errorThreshold, ClusterTraversal::findRoots(clusters), scratch, out);
+}
+
+bool ClusterLodStrategy::isCacheValid(const ClusterSelectionCache& cache,
+                                      const Matrix4& transform,
+                                      const Camera* camera,
+                                      Real errorThreshold) const {
+        return cache.valid &&
+               cache.errorThreshold == errorThreshold &&
+               cache.transform == transform &&
+               cache.projection == camera->getProjectionMatrix() &&
+               cache.viewportHeight == static_cast<Real>(camera->getViewport()->getActualHeight()) &&
+               cache.cameraPosition.squaredDistance(camera->getDerivedPosition()) <= Math::Sqr(mCacheDistanceTolerance) &&
+               cache.cameraOrientation.equals(camera->getDerivedOrientation(), mCacheAngleTolerance);
+}
+
+const std::vector<size_t>& ClusterLodStrategy::selectClusters(const Matrix4& transform,
+                                                              const Camera* camera,
+                                                              const std::vector<NaniteLodDefinition::Cluster>& clusters,
+                                                              Real errorThreshold,
+                                                              ClusterSelectionCache& cache) const {
+        if (cache.clusters != &clusters || cache.clusterCount != clusters.size()) {
+                cache.clusters = &clusters;
+                cache.clusterCount = clusters.size();
+                cache.roots = ClusterTraversal::findRoots(clusters);
+                cache.valid = false;
+        } else if (isCacheValid(cache, transform, camera, errorThreshold)) {
+                return cache.selected;
+        }
+
+        cache.selected.clear();
+        traverse(transform, camera, clusters, errorThreshold, cache.roots, cache.scratch, cache.selected);
 
-        traverse(0);
+        cache.valid = true;
+        cache.transform = transform;
+        cache.projection = camera->getProjectionMatrix();
+        cache.cameraPosition = camera->getDerivedPosition();
+        cache.cameraOrientation = camera->getDerivedOrientation();
+        cache.viewportHeight = static_cast<Real>(camera->getViewport()->getActualHeight());
+        cache.errorThreshold = errorThreshold;
+        return cache.selected;
 }
 
 } // namespace Ember::OgreView::Lod
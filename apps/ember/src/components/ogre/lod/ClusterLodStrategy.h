@@ -36,12 +36,40 @@ THE SOFTWARE.
 #include <OgreNode.h>
 #include <OgreAxisAlignedBox.h>
 #include <OgreMatrix4.h>
+#include <OgreQuaternion.h>
+#include <OgreSphere.h>
+#include <OgreVector.h>
 
+#include "ClusterTraversal.h"
 #include "NaniteLodDefinition.h"
 
 
 namespace Ember::OgreView::Lod {
 
+/**
+ * @brief Selection state for one cluster graph, kept between frames.
+ *
+ * The previous selection is reused for as long as the view stays within the strategy's
+ * cache tolerances, and the roots and traversal buffers are kept for the next traversal.
+ */
+struct ClusterSelectionCache {
+        /// The clusters selected for the view below.
+        std::vector<size_t> selected;
+
+        const std::vector<NaniteLodDefinition::Cluster>* clusters = nullptr;
+        size_t clusterCount = 0;
+        std::vector<uint32_t> roots;
+        ClusterTraversal::Scratch scratch;
+
+        bool valid = false;
+        Ogre::Matrix4 transform;
+        Ogre::Matrix4 projection;
+        Ogre::Vector3 cameraPosition;
+        Ogre::Quaternion cameraOrientation;
+        Ogre::Real viewportHeight = 0;
+        Ogre::Real errorThreshold = 0;
+};
+
 /**
  * @brief LOD strategy evaluating screen-space error per cluster using hierarchical bounds.
  *
@@ -60,6 +88,12 @@ protected:
                            const Ogre::Matrix4& transform,
                            const Ogre::Camera* camera) const;
 
+        /// Project an object space error at the bounds onto the screen, in pixels
+        Ogre::Real getProjectedError(const Ogre::Sphere& bounds,
+                                     Ogre::Real error,
+                                     const Ogre::Matrix4& transform,
+                                     const Ogre::Camera* camera) const;
+
 public:
         /** Default constructor. */
         explicit ClusterLodStrategy();
@@ -84,13 +118,39 @@ public:
 	/// @copydoc Ogre::LodStrategy::isSorted
         bool isSorted(const Ogre::Mesh::LodValueList& values) const override;
 
-        /// Select visible clusters using hierarchical bounds
+        /**
+         * Select the clusters to draw, given the largest acceptable screen-space error in pixels.
+         *
+         * A cluster is selected when its own projected error is acceptable but its parent's
+         * isn't. As errors and bounds only grow towards the coarser levels, this picks exactly
+         * one level of detail for every part of the mesh, without gaps or overlaps.
+         *
+         * The graph is walked down from the roots, so only the clusters above the selection
+         * are visited, and subtrees outside the camera frustum are skipped.
+         */
         void selectClusters(const Ogre::Matrix4& transform,
                             const Ogre::Camera* camera,
                             const std::vector<NaniteLodDefinition::Cluster>& clusters,
                             Ogre::Real errorThreshold,
                             std::vector<size_t>& out) const;
 
+        /**
+         * Select the clusters to draw, reusing the cached selection if the view hasn't changed
+         * by more than the cache tolerances since it was made.
+         * @return The selection, which stays valid until the cache is next used.
+         */
+        const std::vector<size_t>& selectClusters(const Ogre::Matrix4& transform,
+                                                  const Ogre::Camera* camera,
+                                                  const std::vector<NaniteLodDefinition::Cluster>& clusters,
+                                                  Ogre::Real errorThreshold,
+                                                  ClusterSelectionCache& cache) const;
+
+        /**
+         * Sets how far the camera may move and turn before a cached selection is remade.
+         * Any change of the transform, projection, viewport or threshold always remakes it.
+         */
+        void setCacheTolerance(Ogre::Real distance, Ogre::Radian angle);
+
 	/** Override standard Singleton retrieval.
 	@remarks
 	Why do we do this? Well, it's because the Singleton
@@ -125,6 +185,22 @@ public:
 	*/
         static ClusterLodStrategy* getSingletonPtr();
 
+private:
+        Ogre::Real mCacheDistanceTolerance;
+        Ogre::Radian mCacheAngleTolerance;
+
+        bool isCacheValid(const ClusterSelectionCache& cache,
+                          const Ogre::Matrix4& transform,
+                          const Ogre::Camera* camera,
+                          Ogre::Real errorThreshold) const;
+
+        void traverse(const Ogre::Matrix4& transform,
+                      const Ogre::Camera* camera,
+                      const std::vector<NaniteLodDefinition::Cluster>& clusters,
+                      Ogre::Real errorThreshold,
+                      const std::vector<uint32_t>& roots,
+                      ClusterTraversal::Scratch& scratch,
+                      std::vector<size_t>& out) const;
 };
 /** @} */
 /** @} */
@@ -0,0 +1,100 @@
+#pragma once
+
+#include "NaniteFormat.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief Top-down selection of clusters from a cluster graph.
+ *
+ * This is kept free of Ogre, so that it can be benchmarked without a renderer; the
+ * cluster type only needs `children` and `parentError` members, and the caller
+ * supplies the error projection and visibility test.
+ */
+namespace Ember::OgreView::Lod::ClusterTraversal {
+
+/**
+ * @brief State reused between traversals of the same graph, to avoid allocating.
+ */
+struct Scratch {
+    /// The traversal in which each cluster was last queued.
+    std::vector<uint32_t> visited;
+    uint32_t stamp = 0;
+    std::vector<uint32_t> stack;
+};
+
+/// The clusters which aren't replaced by coarser ones, where traversal starts.
+template<typename Cluster>
+std::vector<uint32_t> findRoots(const std::vector<Cluster>& clusters) {
+    std::vector<uint32_t> roots;
+    for (size_t i = 0; i < clusters.size(); ++i) {
+        if (clusters[i].parentError >= NaniteFormat::RootParentError) {
+            roots.push_back(static_cast<uint32_t>(i));
+        }
+    }
+    return roots;
+}
+
+/**
+ * @brief Selects the clusters to draw by walking down from the roots.
+ *
+ * A cluster whose projected error is acceptable is selected and its subtree skipped;
+ * otherwise its children are visited instead. As errors and bounds only grow towards
+ * the roots, this selects the same clusters as testing every cluster against its
+ * parent, while only visiting the clusters above the selection.
+ *
+ * A cluster's lod bounds enclose all of its descendants, so a cluster which isn't
+ * visible is skipped along with its whole subtree.
+ *
+ * @param projectError Returns the projected error of a cluster's own lod bounds.
+ * @param isVisible Returns whether a cluster's lod bounds may be visible.
+ */
+template<typename Cluster, typename ProjectError, typename IsVisible>
+void traverse(const std::vector<Cluster>& clusters,
+              const std::vector<uint32_t>& roots,
+              float errorThreshold,
+              Scratch& scratch,
+              const ProjectError& projectError,
+              const IsVisible& isVisible,
+              std::vector<size_t>& out) {
+    if (scratch.visited.size() != clusters.size()) {
+        scratch.visited.assign(clusters.size(), 0);
+        scratch.stamp = 0;
+    }
+    if (++scratch.stamp == 0) {
+        std::fill(scratch.visited.begin(), scratch.visited.end(), 0);
+        scratch.stamp = 1;
+    }
+    auto stamp = scratch.stamp;
+
+    auto& stack = scratch.stack;
+    stack.clear();
+    for (auto root : roots) {
+        scratch.visited[root] = stamp;
+        stack.push_back(root);
+    }
+
+    while (!stack.empty()) {
+        auto index = stack.back();
+        stack.pop_back();
+        const auto& cluster = clusters[index];
+        if (!isVisible(cluster)) {
+            continue;
+        }
+        if (cluster.children.empty() || projectError(cluster) <= errorThreshold) {
+            out.push_back(index);
+            continue;
+        }
+        // All clusters simplified from the same group share their children, so only queue each once.
+        for (auto child : cluster.children) {
+            if (scratch.visited[child] != stamp) {
+                scratch.visited[child] = stamp;
+                stack.push_back(child);
+            }
+        }
+    }
+}
+
+} // namespace Ember::OgreView::Lod::ClusterTraversal
@@ -0,0 +1,133 @@
+#pragma once
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <type_traits>
+
+/**
+ * @brief Binary layout of the cluster graphs written by tools/nanite/MeshPreprocessor.
+ *
+ * A file is a FileHeader followed by four arrays: the ClusterRecords, the vertex
+ * positions (three floats each), the triangle indices into the vertex positions and
+ * the child cluster indices. All values are fixed size little endian integers or IEEE
+ * floats, and every array starts at an offset aligned to SectionAlignment, so that a
+ * mapped file can be read in place.
+ *
+ * Clusters are stored finest level first. Each cluster was either cut from the source
+ * mesh (level 0, no children) or simplified from a group of clusters in the level
+ * below, which are then its children. All clusters simplified from the same group
+ * share that group's bounding sphere and error, and so do the children's parent
+ * sphere and error; a cluster should be drawn when its own error is acceptable but
+ * its parent's isn't.
+ *
+ * This header doesn't depend on Ogre, so that the preprocessor can use it.
+ */
+namespace Ember::OgreView::Lod::NaniteFormat {
+
+static_assert(std::endian::native == std::endian::little, "The cluster graph format is read in place, which requires a little endian host.");
+
+constexpr char Magic[4] = {'E', 'N', 'C', 'G'};
+constexpr uint32_t Version = 1;
+constexpr uint64_t SectionAlignment = 16;
+
+/// The parent error of the clusters which are never replaced by coarser ones.
+constexpr float RootParentError = std::numeric_limits<float>::max();
+
+struct FileHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t clusterCount;
+    uint32_t levelCount;
+    uint32_t vertexCount;
+    uint32_t indexCount;
+    uint32_t childCount;
+    uint32_t reserved;
+    uint64_t clustersOffset;
+    uint64_t verticesOffset;
+    uint64_t indicesOffset;
+    uint64_t childrenOffset;
+};
+
+struct ClusterRecord {
+    float boundsMin[3];
+    float boundsMax[3];
+    /// Sphere of the group the cluster was simplified from; its own bounding sphere for level 0.
+    float lodCenter[3];
+    float lodRadius;
+    /// Object space error of the cluster compared to the source mesh; 0 for level 0.
+    float error;
+    float parentLodCenter[3];
+    float parentLodRadius;
+    /// The error of the clusters replacing this one, or RootParentError if there are none.
+    float parentError;
+    uint32_t level;
+    uint32_t indexOffset;
+    uint32_t indexCount;
+    uint32_t childOffset;
+    uint32_t childCount;
+    uint32_t reserved;
+};
+
+static_assert(sizeof(FileHeader) == 64 && std::is_trivially_copyable_v<FileHeader>);
+static_assert(sizeof(ClusterRecord) == 88 && std::is_trivially_copyable_v<ClusterRecord>);
+
+constexpr uint64_t alignSection(uint64_t offset) {
+    return (offset + SectionAlignment - 1) & ~(SectionAlignment - 1);
+}
+
+template<typename T>
+const T* section(const char* data, uint64_t offset) {
+    return reinterpret_cast<const T*>(data + offset);
+}
+
+/**
+ * @brief Checks that the data holds a cluster graph of this version, with every array,
+ * index and child reference in range.
+ * @param data Must be aligned to SectionAlignment, as a mapped file or heap block is.
+ * @return The header, or null if the data isn't valid.
+ */
+inline const FileHeader* validate(const char* data, size_t size) {
+    if (size < sizeof(FileHeader) || reinterpret_cast<uintptr_t>(data) % SectionAlignment != 0) {
+        return nullptr;
+    }
+    auto header = section<FileHeader>(data, 0);
+    if (std::memcmp(header->magic, Magic, sizeof(Magic)) != 0 || header->version != Version) {
+        return nullptr;
+    }
+    auto inBounds = [&](uint64_t offset, uint64_t count, uint64_t elementSize) {
+        return offset % SectionAlignment == 0 && offset <= size && count <= (size - offset) / elementSize;
+    };
+    if (!inBounds(header->clustersOffset, header->clusterCount, sizeof(ClusterRecord)) ||
+        !inBounds(header->verticesOffset, header->vertexCount, sizeof(float) * 3) ||
+        !inBounds(header->indicesOffset, header->indexCount, sizeof(uint32_t)) ||
+        !inBounds(header->childrenOffset, header->childCount, sizeof(uint32_t))) {
+        return nullptr;
+    }
+
+    auto clusters = section<ClusterRecord>(data, header->clustersOffset);
+    auto indices = section<uint32_t>(data, header->indicesOffset);
+    auto children = section<uint32_t>(data, header->childrenOffset);
+    for (uint32_t i = 0; i < header->clusterCount; ++i) {
+        const auto& cluster = clusters[i];
+        if (cluster.indexOffset > header->indexCount || cluster.indexCount > header->indexCount - cluster.indexOffset ||
+            cluster.childOffset > header->childCount || cluster.childCount > header->childCount - cluster.childOffset) {
+            return nullptr;
+        }
+        for (uint32_t j = 0; j < cluster.childCount; ++j) {
+            if (children[cluster.childOffset + j] >= header->clusterCount) {
+                return nullptr;
+            }
+        }
+    }
+    for (uint32_t i = 0; i < header->indexCount; ++i) {
+        if (indices[i] >= header->vertexCount) {
+            return nullptr;
+        }
+    }
+    return header;
+}
+
+} // namespace Ember::OgreView::Lod::NaniteFormat
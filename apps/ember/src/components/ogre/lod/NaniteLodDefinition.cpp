@@ -1,4 +1,6 @@
 #include "NaniteLodDefinition.h"
+#include <OgreException.h>
+#include <OgreResourceGroupManager.h>
 
 namespace Ember::OgreView::Lod {
 
@@ -10,9 +12,53 @@ NaniteLodDefinition::NaniteLodDefinition(Ogre::ResourceManager* creator,
                                          Ogre::ManualResourceLoader* loader)
     : LodDefinition(creator, name, handle, group, isManual, loader) {}
 
+void NaniteLodDefinition::loadImpl() {
+    auto stream = Ogre::ResourceGroupManager::getSingleton().openResource(mName, mGroup, this);
+    std::vector<char> data(stream->size());
+    if (stream->read(data.data(), data.size()) != data.size() || !loadClusterGraph(data.data(), data.size())) {
+        OGRE_EXCEPT(Ogre::Exception::ERR_INVALIDPARAMS, "Not a valid cluster graph: " + mName, "NaniteLodDefinition::loadImpl");
+    }
+}
+
+void NaniteLodDefinition::unloadImpl() {
+    mClusters.clear();
+    mVertices.clear();
+}
+
 void NaniteLodDefinition::addCluster(Cluster cluster) {
     mClusters.push_back(std::move(cluster));
 }
 
-} // namespace Ember::OgreView::Lod
+bool NaniteLodDefinition::loadClusterGraph(const char* data, size_t size) {
+    auto header = NaniteFormat::validate(data, size);
+    if (!header) {
+        return false;
+    }
+    auto records = NaniteFormat::section<NaniteFormat::ClusterRecord>(data, header->clustersOffset);
+    auto positions = NaniteFormat::section<float>(data, header->verticesOffset);
+    auto indices = NaniteFormat::section<uint32_t>(data, header->indicesOffset);
+    auto children = NaniteFormat::section<uint32_t>(data, header->childrenOffset);
 
+    std::vector<Cluster> clusters(header->clusterCount);
+    for (uint32_t i = 0; i < header->clusterCount; ++i) {
+        const auto& record = records[i];
+        auto& cluster = clusters[i];
+        cluster.bounds.setExtents(Ogre::Vector3(record.boundsMin), Ogre::Vector3(record.boundsMax));
+        cluster.indices.assign(indices + record.indexOffset, indices + record.indexOffset + record.indexCount);
+        cluster.children.assign(children + record.childOffset, children + record.childOffset + record.childCount);
+        cluster.lodBounds = Ogre::Sphere(Ogre::Vector3(record.lodCenter), record.lodRadius);
+        cluster.error = record.error;
+        cluster.parentLodBounds = Ogre::Sphere(Ogre::Vector3(record.parentLodCenter), record.parentLodRadius);
+        cluster.parentError = record.parentError;
+        cluster.level = record.level;
+    }
+
+    mVertices.resize(header->vertexCount);
+    for (uint32_t i = 0; i < header->vertexCount; ++i) {
+        mVertices[i] = Ogre::Vector3(positions + i * 3);
+    }
+    mClusters = std::move(clusters);
+    return true;
+}
+
+} // namespace Ember::OgreView::Lod
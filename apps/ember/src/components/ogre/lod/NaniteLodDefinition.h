@@ -1,20 +1,35 @@
 #pragma once
 
 #include "LodDefinition.h"
+#include "NaniteFormat.h"
 #include <OgreAxisAlignedBox.h>
+#include <OgreSphere.h>
+#include <OgreVector3.h>
+#include <cstdint>
 #include <vector>
 
 namespace Ember::OgreView::Lod {
 
 /**
  * @brief LOD definition storing Nanite style cluster hierarchy.
+ *
+ * The hierarchy is a graph of clusters at decreasing levels of detail, as written by
+ * tools/nanite/MeshPreprocessor; see NaniteFormat for how the clusters relate.
  */
 class NaniteLodDefinition : public LodDefinition {
 public:
     struct Cluster {
         Ogre::AxisAlignedBox bounds;
         std::vector<unsigned int> indices;
-        std::vector<size_t> children;
+        std::vector<uint32_t> children;
+        /// Bounds used to project the error to the screen; shared by all clusters simplified from the same group.
+        Ogre::Sphere lodBounds;
+        /// Object space error compared to the source mesh.
+        Ogre::Real error = 0;
+        Ogre::Sphere parentLodBounds;
+        /// Error of the clusters replacing this one, or NaniteFormat::RootParentError if there are none.
+        Ogre::Real parentError = NaniteFormat::RootParentError;
+        uint32_t level = 0;
         Cluster() { bounds.setNull(); }
     };
 
@@ -25,14 +40,29 @@ public:
                         bool isManual = false,
                         Ogre::ManualResourceLoader* loader = nullptr);
 
+    /// Loads the cluster graph from the resource file
+    void loadImpl() override;
+
+    void unloadImpl() override;
+
     /// Add a cluster to the definition
     void addCluster(Cluster cluster);
 
+    /**
+     * @brief Replaces the clusters and vertices with those of a cluster graph.
+     * @return False, leaving the definition unaltered, if the data isn't a valid cluster graph.
+     */
+    bool loadClusterGraph(const char* data, size_t size);
+
     /// Access stored clusters
     const std::vector<Cluster>& getClusters() const;
 
+    /// Vertex positions referred to by the cluster indices
+    const std::vector<Ogre::Vector3>& getVertices() const;
+
 private:
     std::vector<Cluster> mClusters;
+    std::vector<Ogre::Vector3> mVertices;
 };
 
 using NaniteLodDefinitionPtr = Ogre::SharedPtr<NaniteLodDefinition>;
@@ -41,5 +71,9 @@ inline const std::vector<NaniteLodDefinition::Cluster>& NaniteLodDefinition::get
     return mClusters;
 }
 
+inline const std::vector<Ogre::Vector3>& NaniteLodDefinition::getVertices() const {
+    return mVertices;
+}
+
 } // namespace Ember::OgreView::Lod
 
@@ -55,6 +55,11 @@ std::unique_ptr<HeightMapBuffer> HeightMapBufferProvider::checkout() {
 	return std::make_unique<HeightMapBuffer>(*this, std::move(buffer));
 }
 
+size_t HeightMapBufferProvider::getBufferSizeInBytes() const {
+	//The buffers are created with one channel.
+	return sizeof(float) * mBufferResolution * mBufferResolution;
+}
+
 void HeightMapBufferProvider::maintainPool() {
 	std::unique_lock<std::mutex> lock(mMutex);
 
@@ -62,6 +62,12 @@ public:
 	 */
 	std::unique_ptr<HeightMapBuffer> checkout();
 
+	/**
+	 * @brief Gets the memory used by one buffer, in bytes.
+	 * This can be used to estimate how much memory pending terrain work will need.
+	 */
+	size_t getBufferSizeInBytes() const;
+
 private:
 
 	/**
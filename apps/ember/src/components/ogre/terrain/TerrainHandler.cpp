@@ -46,18 +46,27 @@
 
 #include "framework/tasks/TaskQueue.h"
 #include "framework/tasks/TaskExecutionContext.h"
+#include "framework/Profiler.h"
 
 #include <Eris/EventService.h>
 
 #include <Mercator/Terrain.h>
 #include <Mercator/AreaShader.h>
 
+#include <algorithm>
 #include <memory>
 #include <utility>
 
 
 namespace Ember::OgreView::Terrain {
 
+namespace {
+/**
+ * @brief Subtracted from the priority of foliage work, to put it after all page work.
+ */
+const int FOLIAGE_PRIORITY_OFFSET = 1000000;
+}
+
 class BasePointRetrieveTask : public Tasks::TemplateNamedTask<BasePointRetrieveTask> {
 
 private:
@@ -145,6 +154,10 @@ TerrainHandler::TerrainHandler(ITerrainAdapter& terrainAdapter,
 		mHeightMapBufferProvider(std::make_unique<HeightMapBufferProvider>(mTerrain->getResolution() + 1)),
 		mHeightMap(std::make_unique<HeightMap>(8.f, mTerrain->getResolution())),
 		mTaskQueue(std::make_unique<Tasks::TaskQueue>(1, eventService)),
+		mPagesInFlight(0),
+		mStreamingMemoryBudget(4 * 1024 * 1024),
+		mStreamingFocus(0, 0),
+		mStreamingDirection(WFMath::Vector<2>::ZERO()),
 		mHeightMax(std::numeric_limits<Ogre::Real>::min()), mHeightMin(std::numeric_limits<Ogre::Real>::max()),
 		mHasTerrainInfo(false),
 		mTerrainEntity(nullptr),
@@ -166,7 +179,7 @@ void TerrainHandler::shutdown() {
 	mTaskQueue->deactivate();
 }
 
-void TerrainHandler::showTerrain(const WFMath::AxisBox<2>& interactingArea) {
+void TerrainHandler::showTerrain(const WFMath::AxisBox<2>& interactingArea, const WFMath::Vector<2>& viewDirection) {
 
 	auto pageSizeInMeters = getPageMetersSize();
 
@@ -178,6 +191,9 @@ void TerrainHandler::showTerrain(const WFMath::AxisBox<2>& interactingArea) {
 
 	std::set<TerrainIndex> visiblePages;
 
+	mStreamingFocus = interactingArea.getCenter();
+	mStreamingDirection = viewDirection;
+
 	assert(!(xIndexMax < xIndexMin));
 	assert(!(yIndexMax < yIndexMin));
 
@@ -204,12 +220,103 @@ void TerrainHandler::showTerrain(const WFMath::AxisBox<2>& interactingArea) {
 			}
 		}
 	}
+	//Pages which haven't been created yet have never been handed to the terrain adapter, so they can safely be dropped.
+	for (auto& pageIndex: pagesToDestroy) {
+		auto I = mStreamingPages.find(pageIndex);
+		if (I != mStreamingPages.end()) {
+			if (I->second.task) {
+				I->second.task.cancel();
+				mPagesInFlight--;
+			}
+			logger->debug("Dropping terrain page at index [{},{}] before it was created.", pageIndex.first, pageIndex.second);
+			mStreamingPages.erase(I);
+			mPages.erase(pageIndex);
+		}
+	}
 //The Terrain component is unfortunately inherently non-thread safe, as it allows for both random deletion of Terrain instances while at the same time doing LOD calculations
 //in a background thread. These calculations will access any Terrain isntances whenever they like, which will lead to spurious segfaults as the pages might be deleted.
-//The solution for now is to never remove any pages while in the world, while we look for a better approach to rendering terrain.
+//The solution for now is to never remove any created pages while in the world, while we look for a better approach to rendering terrain.
 //	for (auto& pageIndex: pagesToDestroy) {
 //		destroyPage(pageIndex);
 //	}
+
+	dispatchStreamingPages();
+}
+
+void TerrainHandler::setStreamingMemoryBudget(size_t bytes) {
+	mStreamingMemoryBudget = bytes;
+}
+
+void TerrainHandler::dispatchStreamingPages() {
+	//Each segment of a page will need a height map buffer while the page is being created.
+	auto segmentsPerSide = static_cast<size_t>(std::max(1, getPageMetersSize() / mTerrain->getResolution()));
+	auto bytesPerPage = std::max<size_t>(1, segmentsPerSide * segmentsPerSide * mHeightMapBufferProvider->getBufferSizeInBytes());
+	auto maxPagesInFlight = std::max<size_t>(1, mStreamingMemoryBudget / bytesPerPage);
+	if (mPagesInFlight >= maxPagesInFlight) {
+		return;
+	}
+
+	//Pages are ranked anew each time, since the camera might have moved since they were set up.
+	std::vector<std::pair<int, TerrainIndex>> candidates;
+	for (auto& entry: mStreamingPages) {
+		if (!entry.second.task) {
+			auto pageI = mPages.find(entry.first);
+			if (pageI != mPages.end()) {
+				candidates.emplace_back(calculatePagePriority(*pageI->second), entry.first);
+			}
+		}
+	}
+	std::sort(candidates.begin(), candidates.end(), [](const std::pair<int, TerrainIndex>& lhs, const std::pair<int, TerrainIndex>& rhs) {
+		return lhs.first > rhs.first;
+	});
+
+	for (auto& candidate: candidates) {
+		if (mPagesInFlight >= maxPagesInFlight) {
+			break;
+		}
+		auto page = mPages[candidate.second];
+		auto task = mTaskQueue->scheduleTask(std::make_unique<TerrainPageCreationTask>(*this, page, *mHeightMapBufferProvider, *mHeightMap),
+											 {.priority = candidate.first});
+		if (!task) {
+			break;
+		}
+		mStreamingPages[candidate.second].task = std::move(task);
+		mPagesInFlight++;
+	}
+}
+
+int TerrainHandler::calculatePagePriority(const TerrainPage& page) const {
+	auto toPage = page.getWorldExtent().getCenter() - mStreamingFocus;
+	auto distance = toPage.mag();
+	//Pages in front of the camera are more likely to be seen, so treat them as closer.
+	if (mStreamingDirection.isValid() && mStreamingDirection.sqrMag() > 0 && WFMath::Dot(toPage, mStreamingDirection) > 0) {
+		distance *= 0.5;
+	}
+	return -static_cast<int>(distance);
+}
+
+void TerrainHandler::pageCreated(TerrainPage& page,
+								 std::chrono::steady_clock::time_point backgroundStarted,
+								 std::chrono::steady_clock::time_point backgroundEnded) {
+	const auto& index = page.getWFIndex();
+	auto I = mStreamingPages.find(index);
+	if (I == mStreamingPages.end()) {
+		return;
+	}
+	auto pageI = mPages.find(index);
+	if (pageI == mPages.end() || pageI->second.get() != &page) {
+		return;
+	}
+	auto now = std::chrono::steady_clock::now();
+	static const auto queuedScope = Profiler::registerScope("terrainPageQueued");
+	static const auto backgroundScope = Profiler::registerScope("terrainPageBackground");
+	static const auto mainThreadScope = Profiler::registerScope("terrainPageMainThread");
+	Profiler::record(queuedScope, I->second.setUpTime, backgroundStarted);
+	Profiler::record(backgroundScope, backgroundStarted, backgroundEnded);
+	Profiler::record(mainThreadScope, backgroundEnded, now);
+	mStreamingPages.erase(I);
+	mPagesInFlight--;
+	dispatchStreamingPages();
 }
 
 
@@ -217,6 +324,11 @@ void TerrainHandler::setPageSize(int pageSize) {
 	// Wait for all current tasks to finish
 //	mTaskQueue->pollProcessedTasks(TimeFrame(boost::posix_time::seconds(60)));
 	// Delete all page-related data
+	for (auto& entry: mStreamingPages) {
+		entry.second.task.cancel();
+	}
+	mStreamingPages.clear();
+	mPagesInFlight = 0;
 	mPageBridges.clear();
 	mPages.clear();
 
@@ -350,7 +462,9 @@ void TerrainHandler::getPlantsForArea(Foliage::PlantPopulator& populator, PlantA
 	auto yIndex = static_cast<int>(std::floor(wfPos.y() / mTerrain->getResolution()));
 	SegmentRefPtr segmentRef = mSegmentManager->getSegmentReference(xIndex, yIndex);
 	if (segmentRef) {
-		mTaskQueue->enqueueTask(std::make_unique<PlantQueryTask>(segmentRef, populator, query, std::move(asyncCallback)));
+		//Foliage should never hold up the creation of pages, but nearer foliage should still be handled first.
+		mTaskQueue->scheduleTask(std::make_unique<PlantQueryTask>(segmentRef, populator, query, std::move(asyncCallback)),
+								 {.priority = calculatePagePriority(*pageI->second) - FOLIAGE_PRIORITY_OFFSET});
 	}
 }
 
@@ -445,7 +559,8 @@ void TerrainHandler::setUpTerrainPageAtIndex(const TerrainIndex& index) {
 
 			logger->debug("Adding terrain page to TerrainHandler: [{}|{}]", index.first, index.second);
 
-			mTaskQueue->enqueueTask(std::make_unique<TerrainPageCreationTask>(*this, page, *mHeightMapBufferProvider, *mHeightMap));
+			//The page will be created by dispatchStreamingPages(), in order of distance to the camera.
+			mStreamingPages.emplace(index, StreamingPage{{}, std::chrono::steady_clock::now()});
 		} else {
 			logger->warn("Could not insert terrain page at [{}|{}]", index.first, index.second);
 		}
@@ -508,6 +623,11 @@ void TerrainHandler::reloadTerrain(const std::vector<WFMath::AxisBox<2>>& areas)
 		EventBeforeTerrainUpdate(areas, pagesToUpdate);
 		//Spawn a separate task for each page to not bog down processing with all pages at once
 		for (const auto& page: pagesToUpdate) {
+			//Pages waiting to be created will be created from the updated data anyway.
+			auto streamingI = mStreamingPages.find(page->getWFIndex());
+			if (streamingI != mStreamingPages.end() && !streamingI->second.task) {
+				continue;
+			}
 			std::vector<TerrainPageGeometryPtr> geometryToUpdate;
 			geometryToUpdate.emplace_back(std::make_shared<TerrainPageGeometry>(page, *mSegmentManager, getDefaultHeight()));
 			std::vector<TerrainShader> shaders;
@@ -515,12 +635,13 @@ void TerrainHandler::reloadTerrain(const std::vector<WFMath::AxisBox<2>>& areas)
 			for (auto& entry: mShaderMap) {
 				shaders.push_back(TerrainShader{entry.second.layer, *entry.second.shader});
 			}
-			mTaskQueue->enqueueTask(std::make_unique<GeometryUpdateTask>(geometryToUpdate,
-																		 areas,
-																		 *this,
-																		 std::move(shaders),
-																		 *mHeightMapBufferProvider,
-																		 *mHeightMap));
+			mTaskQueue->scheduleTask(std::make_unique<GeometryUpdateTask>(geometryToUpdate,
+																		  areas,
+																		  *this,
+																		  std::move(shaders),
+																		  *mHeightMapBufferProvider,
+																		  *mHeightMap),
+									 {.priority = calculatePagePriority(*page)});
 		}
 	}
 }
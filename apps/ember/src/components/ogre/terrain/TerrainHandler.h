@@ -23,6 +23,7 @@
 #include "domain/IHeightProvider.h"
 #include "TerrainModTranslator.h"
 #include "TerrainShader.h"
+#include "framework/tasks/TaskHandle.h"
 
 #include <wfmath/vector.h>
 
@@ -31,6 +32,7 @@
 
 #include <set>
 #include <memory>
+#include <chrono>
 #include <Eris/ActiveMarker.h>
 #include <Mercator/ShaderFactory.h>
 
@@ -136,7 +138,33 @@ public:
 	 */
 	void shutdown();
 
-	void showTerrain(const WFMath::AxisBox<2>& interactingArea);
+	/**
+	 * @brief Makes sure that the terrain within the supplied area is shown. Call this each frame.
+	 *
+	 * Pages which aren't created yet are streamed in order of how close they are to the camera, with pages
+	 * in front of the camera before those behind it. Pages which haven't been created yet, and which are far
+	 * enough outside the area, are dropped.
+	 * @param interactingArea The area around the camera in which terrain should be shown.
+	 * @param viewDirection The direction of the camera, projected onto the terrain plane. May be zero.
+	 */
+	void showTerrain(const WFMath::AxisBox<2>& interactingArea, const WFMath::Vector<2>& viewDirection = WFMath::Vector<2>::ZERO());
+
+	/**
+	 * @brief Sets how much height map memory pages being created may use at once.
+	 * At least one page will always be created at a time.
+	 * @param bytes The budget, in bytes.
+	 */
+	void setStreamingMemoryBudget(size_t bytes);
+
+	/**
+	 * @brief Called by TerrainPageCreationTask when a page has been created and integrated in the main thread.
+	 * @param page The page.
+	 * @param backgroundStarted When the page started being created in a background thread.
+	 * @param backgroundEnded When the background work was done.
+	 */
+	void pageCreated(TerrainPage& page,
+					 std::chrono::steady_clock::time_point backgroundStarted,
+					 std::chrono::steady_clock::time_point backgroundEnded);
 
 	/**
 	 * @brief Sets the size of the width of one page. This must be a power of two and at least 64.
@@ -425,6 +453,20 @@ public:
 protected:
 
 	typedef std::map<TerrainIndex, std::shared_ptr<ITerrainPageBridge>> PageBridgeStore;
+
+	/**
+	 * @brief A page which has been set up but not yet created.
+	 */
+	struct StreamingPage {
+		/**
+		 * @brief The creation task, if it has been scheduled.
+		 */
+		Tasks::TaskHandle task;
+		/**
+		 * @brief When the page was set up.
+		 */
+		std::chrono::steady_clock::time_point setUpTime;
+	};
 	ITerrainAdapter& mTerrainAdapter;
 	/**
 	 * @brief The size in indices of one side of a page.
@@ -483,6 +525,31 @@ protected:
 	 */
 	std::unique_ptr<Tasks::TaskQueue> mTaskQueue;
 
+	/**
+	 * @brief Pages which have been set up, but which haven't been created yet.
+	 */
+	std::map<TerrainIndex, StreamingPage> mStreamingPages;
+
+	/**
+	 * @brief The number of pages in mStreamingPages whose creation task has been scheduled.
+	 */
+	size_t mPagesInFlight;
+
+	/**
+	 * @brief How much height map memory pages being created may use at once.
+	 */
+	size_t mStreamingMemoryBudget;
+
+	/**
+	 * @brief The center of the area last passed to showTerrain(), used for prioritizing terrain work.
+	 */
+	WFMath::Point<2> mStreamingFocus;
+
+	/**
+	 * @brief The view direction last passed to showTerrain().
+	 */
+	WFMath::Vector<2> mStreamingDirection;
+
 	/**
 	 * @brief We use this to keep track on the terrain shaders used for areas, stored with the layer id as the key.
 	 */
@@ -562,6 +629,18 @@ protected:
 	 */
 	void updateShaders();
 
+	/**
+	 * @brief Schedules creation of the pages closest to the camera, as long as the memory budget allows.
+	 */
+	void dispatchStreamingPages();
+
+	/**
+	 * @brief Calculates the task priority for work on a page, with closer pages getting higher priority.
+	 *
+	 * All priorities are zero or lower, so that terrain data updates, which use the default priority, are always processed first.
+	 */
+	int calculatePagePriority(const TerrainPage& page) const;
+
 	void terrainEnabled(EmberEntity& entity);
 
 	void terrainDisabled();
@@ -320,7 +320,9 @@ TerrainManager::FrameListener::~FrameListener() {
 bool TerrainManager::FrameListener::frameStarted(const FrameEvent& evt) {
 	//Need to wait with requesting terrain until we actually have a terrain entity.
 	if (parent.mHandler->getTerrainHoldingEntity()) {
-		auto cameraPosition = parent.getScene().getMainCamera().getDerivedPosition();
+		auto& camera = parent.getScene().getMainCamera();
+		auto cameraPosition = camera.getDerivedPosition();
+		auto cameraDirection = camera.getDerivedDirection();
 
 		WFMath::AxisBox<2> cameraArea({cameraPosition.x - parent.mLoadRadius,
 									   cameraPosition.z - parent.mLoadRadius},
@@ -328,7 +330,7 @@ bool TerrainManager::FrameListener::frameStarted(const FrameEvent& evt) {
 									   cameraPosition.z + parent.mLoadRadius});
 
 
-		parent.mHandler->showTerrain(cameraArea);
+		parent.mHandler->showTerrain(cameraArea, {cameraDirection.x, cameraDirection.z});
 	}
 
 	return true;
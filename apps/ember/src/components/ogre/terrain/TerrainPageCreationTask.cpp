@@ -43,6 +43,7 @@ TerrainPageCreationTask::TerrainPageCreationTask(TerrainHandler& handler,
 
 
 void TerrainPageCreationTask::executeTaskInBackgroundThread(Tasks::TaskExecutionContext& context) {
+	mBackgroundStarted = std::chrono::steady_clock::now();
 
 	//add the base shaders, this should probably be refactored into a server side thing in the future
 	std::vector<TerrainShader> shaders;
@@ -70,10 +71,12 @@ void TerrainPageCreationTask::executeTaskInBackgroundThread(Tasks::TaskExecution
 															 std::move(shaders),
 															 mHeightMapBufferProvider,
 															 mHeightMap));
-
+	mBackgroundEnded = std::chrono::steady_clock::now();
 }
 
 bool TerrainPageCreationTask::executeTaskInMainThread() {
+	//Any subtasks have been executed in the main thread by now, so the page is ready to be shown.
+	mTerrainHandler.pageCreated(*mPage, mBackgroundStarted, mBackgroundEnded);
 	return true;
 }
 
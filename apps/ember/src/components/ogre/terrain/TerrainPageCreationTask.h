@@ -21,6 +21,7 @@
 
 #include "framework/tasks/TemplateNamedTask.h"
 #include <wfmath/point.h>
+#include <chrono>
 
 
 namespace Ember::OgreView::Terrain {
@@ -55,6 +56,12 @@ private:
 
 	HeightMapBufferProvider& mHeightMapBufferProvider;
 	HeightMap& mHeightMap;
+
+	/**
+	 * @brief When the background work started and ended, for latency reporting.
+	 */
+	std::chrono::steady_clock::time_point mBackgroundStarted;
+	std::chrono::steady_clock::time_point mBackgroundEnded;
 };
 
 }
@@ -0,0 +1,492 @@
+#include "ProfileCapture.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <istream>
+#include <iterator>
+#include <map>
+#include <ostream>
+
+namespace Ember {
+
+namespace {
+
+/**
+ * Just enough of JSON to read trace files.
+ */
+struct JsonValue {
+    enum class Type {
+        Null, Bool, Number, String, Array, Object
+    };
+    Type type = Type::Null;
+    bool boolean = false;
+    double number = 0;
+    std::string string;
+    std::vector<JsonValue> array;
+    std::vector<std::pair<std::string, JsonValue>> object;
+
+    const JsonValue* get(std::string_view key) const {
+        for (auto& entry: object) {
+            if (entry.first == key) {
+                return &entry.second;
+            }
+        }
+        return nullptr;
+    }
+
+    /// The value as text, so that numeric and string ids and thread ids can be compared.
+    std::string asKey() const {
+        if (type == Type::String) {
+            return string;
+        }
+        if (type == Type::Number) {
+            return std::to_string(number);
+        }
+        return {};
+    }
+};
+
+class JsonParser {
+public:
+    explicit JsonParser(std::string_view text) : mText(text) {}
+
+    bool parse(JsonValue& value) {
+        if (!parseValue(value, 0)) {
+            return false;
+        }
+        skipWhitespace();
+        return mPos == mText.size();
+    }
+
+private:
+    static constexpr int MaxDepth = 64;
+
+    std::string_view mText;
+    size_t mPos = 0;
+
+    void skipWhitespace() {
+        while (mPos < mText.size() && (mText[mPos] == ' ' || mText[mPos] == '\t' || mText[mPos] == '\n' || mText[mPos] == '\r')) {
+            mPos++;
+        }
+    }
+
+    bool consume(char c) {
+        skipWhitespace();
+        if (mPos < mText.size() && mText[mPos] == c) {
+            mPos++;
+            return true;
+        }
+        return false;
+    }
+
+    bool consumeLiteral(std::string_view literal) {
+        if (mText.substr(mPos, literal.size()) == literal) {
+            mPos += literal.size();
+            return true;
+        }
+        return false;
+    }
+
+    bool parseValue(JsonValue& value, int depth) {
+        if (depth > MaxDepth) {
+            return false;
+        }
+        skipWhitespace();
+        if (mPos >= mText.size()) {
+            return false;
+        }
+        switch (mText[mPos]) {
+            case '{':
+                mPos++;
+                value.type = JsonValue::Type::Object;
+                if (consume('}')) {
+                    return true;
+                }
+                do {
+                    skipWhitespace();
+                    std::pair<std::string, JsonValue> entry;
+                    if (!parseString(entry.first) || !consume(':') || !parseValue(entry.second, depth + 1)) {
+                        return false;
+                    }
+                    value.object.push_back(std::move(entry));
+                } while (consume(','));
+                return consume('}');
+            case '[':
+                mPos++;
+                value.type = JsonValue::Type::Array;
+                if (consume(']')) {
+                    return true;
+                }
+                do {
+                    value.array.emplace_back();
+                    if (!parseValue(value.array.back(), depth + 1)) {
+                        return false;
+                    }
+                } while (consume(','));
+                return consume(']');
+            case '"':
+                value.type = JsonValue::Type::String;
+                return parseString(value.string);
+            case 't':
+                value.type = JsonValue::Type::Bool;
+                value.boolean = true;
+                return consumeLiteral("true");
+            case 'f':
+                value.type = JsonValue::Type::Bool;
+                return consumeLiteral("false");
+            case 'n':
+                return consumeLiteral("null");
+            default: {
+                value.type = JsonValue::Type::Number;
+                auto begin = mText.data() + mPos;
+                auto result = std::from_chars(begin, mText.data() + mText.size(), value.number);
+                if (result.ec != std::errc() || result.ptr == begin) {
+                    return false;
+                }
+                mPos += result.ptr - begin;
+                return true;
+            }
+        }
+    }
+
+    bool parseString(std::string& out) {
+        if (mPos >= mText.size() || mText[mPos] != '"') {
+            return false;
+        }
+        mPos++;
+        while (mPos < mText.size()) {
+            char c = mText[mPos++];
+            if (c == '"') {
+                return true;
+            }
+            if (c != '\\') {
+                out.push_back(c);
+                continue;
+            }
+            if (mPos >= mText.size()) {
+                return false;
+            }
+            char escaped = mText[mPos++];
+            switch (escaped) {
+                case 'b':
+                    out.push_back('\b');
+                    break;
+                case 'f':
+                    out.push_back('\f');
+                    break;
+                case 'n':
+                    out.push_back('\n');
+                    break;
+                case 'r':
+                    out.push_back('\r');
+                    break;
+                case 't':
+                    out.push_back('\t');
+                    break;
+                case 'u': {
+                    unsigned int codePoint = 0;
+                    auto result = std::from_chars(mText.data() + mPos, mText.data() + std::min(mPos + 4, mText.size()), codePoint, 16);
+                    if (result.ec != std::errc() || result.ptr != mText.data() + mPos + 4) {
+                        return false;
+                    }
+                    mPos += 4;
+                    // Surrogate pairs aren't combined; names in traces are expected to be ASCII.
+                    if (codePoint < 0x80) {
+                        out.push_back(static_cast<char>(codePoint));
+                    } else if (codePoint < 0x800) {
+                        out.push_back(static_cast<char>(0xC0 | (codePoint >> 6)));
+                        out.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+                    } else {
+                        out.push_back(static_cast<char>(0xE0 | (codePoint >> 12)));
+                        out.push_back(static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F)));
+                        out.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+                    }
+                    break;
+                }
+                default:
+                    out.push_back(escaped);
+            }
+        }
+        return false;
+    }
+};
+
+void writeJsonString(std::ostream& stream, std::string_view text) {
+    static const char* hex = "0123456789abcdef";
+    stream << '"';
+    for (char c: text) {
+        if (c == '"' || c == '\\') {
+            stream << '\\' << c;
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            stream << "\\u00" << hex[(c >> 4) & 0xF] << hex[c & 0xF];
+        } else {
+            stream << c;
+        }
+    }
+    stream << '"';
+}
+
+/// Trace timestamps are in microseconds; write them with nanosecond precision.
+void writeMicroseconds(std::ostream& stream, std::int64_t nanoseconds) {
+    if (nanoseconds < 0) {
+        stream << '-';
+        nanoseconds = -nanoseconds;
+    }
+    auto fraction = nanoseconds % 1000;
+    stream << nanoseconds / 1000 << '.' << static_cast<char>('0' + fraction / 100) << static_cast<char>('0' + fraction / 10 % 10) << static_cast<char>('0' + fraction % 10);
+}
+
+std::int64_t toNanoseconds(double microseconds) {
+    return std::llround(microseconds * 1000.0);
+}
+
+double percentile(const std::vector<double>& sorted, double fraction) {
+    if (sorted.empty()) {
+        return 0;
+    }
+    auto rank = static_cast<size_t>(std::ceil(fraction * static_cast<double>(sorted.size())));
+    return sorted[std::clamp<size_t>(rank, 1, sorted.size()) - 1];
+}
+
+}
+
+std::uint32_t ProfileCapture::addName(std::string_view name) {
+    auto result = mNameIndices.emplace(std::string(name), static_cast<std::uint32_t>(mNames.size()));
+    if (result.second) {
+        mNames.emplace_back(name);
+    }
+    return result.first->second;
+}
+
+std::uint32_t ProfileCapture::addThread(std::string name, bool nested) {
+    mThreads.push_back(Thread{std::move(name), nested});
+    return static_cast<std::uint32_t>(mThreads.size() - 1);
+}
+
+std::vector<ProfileCapture::Statistics> ProfileCapture::getStatistics() const {
+    auto frameName = mNameIndices.find(std::string(FrameName));
+    std::vector<std::int64_t> frameStarts;
+    if (frameName != mNameIndices.end()) {
+        for (auto& event: mEvents) {
+            if (event.name == frameName->second) {
+                frameStarts.push_back(event.start);
+            }
+        }
+    }
+    std::sort(frameStarts.begin(), frameStarts.end());
+    size_t frameCount = std::max<size_t>(frameStarts.size(), 1);
+
+    auto frameOf = [&](std::int64_t end) -> std::optional<size_t> {
+        if (frameStarts.empty()) {
+            return 0;
+        }
+        auto I = std::lower_bound(frameStarts.begin(), frameStarts.end(), end);
+        if (I == frameStarts.begin()) {
+            return std::nullopt;
+        }
+        return static_cast<size_t>(std::distance(frameStarts.begin(), I) - 1);
+    };
+
+    struct Accumulator {
+        std::uint64_t calls = 0;
+        std::vector<double> perFrame;
+    };
+    // Keyed by the path's names rather than the joined path, so that scopes always follow their parents.
+    std::map<std::pair<std::uint32_t, std::vector<std::string>>, Accumulator> accumulators;
+
+    std::vector<std::vector<const Event*>> eventsByThread(mThreads.size());
+    for (auto& event: mEvents) {
+        if (event.thread < mThreads.size()) {
+            eventsByThread[event.thread].push_back(&event);
+        }
+    }
+
+    for (std::uint32_t thread = 0; thread < eventsByThread.size(); ++thread) {
+        auto& events = eventsByThread[thread];
+        // Parents start no later and end no earlier than their children, so they come first.
+        std::sort(events.begin(), events.end(), [](const Event* lhs, const Event* rhs) {
+            return lhs->start != rhs->start ? lhs->start < rhs->start : lhs->end > rhs->end;
+        });
+
+        struct Open {
+            std::int64_t end;
+            std::vector<std::string> path;
+        };
+        std::vector<Open> stack;
+        for (auto event: events) {
+            std::vector<std::string> path;
+            if (mThreads[thread].nested) {
+                while (!stack.empty() && (event->start >= stack.back().end || event->end > stack.back().end)) {
+                    stack.pop_back();
+                }
+                if (!stack.empty()) {
+                    path = stack.back().path;
+                }
+            }
+            path.push_back(mNames[event->name]);
+            if (mThreads[thread].nested) {
+                stack.push_back(Open{event->end, path});
+            }
+
+            auto frame = frameOf(event->end);
+            if (!frame) {
+                continue;
+            }
+            auto& accumulator = accumulators[{thread, std::move(path)}];
+            accumulator.calls++;
+            accumulator.perFrame.resize(frameCount);
+            accumulator.perFrame[*frame] += static_cast<double>(event->end - event->start) / 1'000'000.0;
+        }
+    }
+
+    std::vector<Statistics> statistics;
+    statistics.reserve(accumulators.size());
+    for (auto& [key, accumulator]: accumulators) {
+        Statistics entry;
+        entry.thread = mThreads[key.first].name;
+        for (auto& name: key.second) {
+            if (!entry.path.empty()) {
+                entry.path += ';';
+            }
+            entry.path += name;
+        }
+        entry.calls = accumulator.calls;
+        auto& values = accumulator.perFrame;
+        std::sort(values.begin(), values.end());
+        double total = 0;
+        for (auto value: values) {
+            total += value;
+        }
+        entry.mean = total / static_cast<double>(values.size());
+        entry.p50 = percentile(values, 0.50);
+        entry.p95 = percentile(values, 0.95);
+        entry.p99 = percentile(values, 0.99);
+        entry.max = values.back();
+        statistics.push_back(std::move(entry));
+    }
+    return statistics;
+}
+
+void ProfileCapture::writeChromeTrace(std::ostream& stream) const {
+    stream << "{\"traceEvents\":[\n";
+    bool first = true;
+    auto separate = [&]() {
+        if (!first) {
+            stream << ",\n";
+        }
+        first = false;
+    };
+
+    for (size_t i = 0; i < mThreads.size(); ++i) {
+        separate();
+        stream << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << i << ",\"args\":{\"name\":";
+        writeJsonString(stream, mThreads[i].name);
+        stream << "}}";
+    }
+
+    std::uint64_t spanId = 0;
+    for (auto& event: mEvents) {
+        separate();
+        if (mThreads[event.thread].nested) {
+            stream << "{\"name\":";
+            writeJsonString(stream, mNames[event.name]);
+            stream << ",\"cat\":\"ember\",\"ph\":\"X\",\"ts\":";
+            writeMicroseconds(stream, event.start);
+            stream << ",\"dur\":";
+            writeMicroseconds(stream, event.end - event.start);
+            stream << ",\"pid\":1,\"tid\":" << event.thread << "}";
+        } else {
+            // Spans may overlap, which complete events on the same thread can't.
+            for (auto [phase, time]: {std::pair{'b', event.start}, std::pair{'e', event.end}}) {
+                if (phase == 'e') {
+                    stream << ",\n";
+                }
+                stream << "{\"name\":";
+                writeJsonString(stream, mNames[event.name]);
+                stream << ",\"cat\":\"ember\",\"ph\":\"" << phase << "\",\"id\":" << spanId << ",\"ts\":";
+                writeMicroseconds(stream, time);
+                stream << ",\"pid\":1,\"tid\":" << event.thread << "}";
+            }
+            spanId++;
+        }
+    }
+    stream << "\n],\n\"displayTimeUnit\":\"ms\",\n\"otherData\":{\"droppedEvents\":" << droppedEvents << "}}\n";
+}
+
+std::optional<ProfileCapture> ProfileCapture::readChromeTrace(std::istream& stream) {
+    std::string text{std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>()};
+    JsonValue root;
+    if (!JsonParser(text).parse(root)) {
+        return std::nullopt;
+    }
+
+    ProfileCapture capture;
+    const JsonValue* events = &root;
+    if (root.type == JsonValue::Type::Object) {
+        events = root.get("traceEvents");
+        if (auto otherData = root.get("otherData")) {
+            if (auto dropped = otherData->get("droppedEvents"); dropped && dropped->type == JsonValue::Type::Number) {
+                capture.droppedEvents = static_cast<std::uint64_t>(dropped->number);
+            }
+        }
+    }
+    if (!events || events->type != JsonValue::Type::Array) {
+        return std::nullopt;
+    }
+
+    std::map<std::string, std::string> threadNames;
+    for (auto& event: events->array) {
+        auto phase = event.get("ph");
+        auto name = event.get("name");
+        auto args = event.get("args");
+        if (phase && phase->string == "M" && name && name->string == "thread_name" && args) {
+            if (auto threadName = args->get("name")) {
+                auto tid = event.get("tid");
+                threadNames[tid ? tid->asKey() : std::string()] = threadName->string;
+            }
+        }
+    }
+
+    std::map<std::pair<std::string, bool>, std::uint32_t> threads;
+    auto threadOf = [&](const JsonValue& event, bool nested) {
+        auto tid = event.get("tid");
+        auto key = tid ? tid->asKey() : std::string();
+        auto I = threads.find({key, nested});
+        if (I == threads.end()) {
+            auto nameI = threadNames.find(key);
+            auto threadName = nameI != threadNames.end() ? nameI->second : key;
+            I = threads.emplace(std::pair{key, nested}, capture.addThread(threadName, nested)).first;
+        }
+        return I->second;
+    };
+
+    std::map<std::pair<std::string, std::string>, Event> openSpans;
+    for (auto& event: events->array) {
+        auto phase = event.get("ph");
+        auto name = event.get("name");
+        auto ts = event.get("ts");
+        if (!phase || !name || !ts || ts->type != JsonValue::Type::Number) {
+            continue;
+        }
+        auto start = toNanoseconds(ts->number);
+        if (phase->string == "X") {
+            auto dur = event.get("dur");
+            auto duration = dur && dur->type == JsonValue::Type::Number ? toNanoseconds(dur->number) : 0;
+            capture.addEvent({capture.addName(name->string), threadOf(event, true), start, start + duration});
+        } else if (phase->string == "b" || phase->string == "e") {
+            auto id = event.get("id");
+            std::pair<std::string, std::string> key{name->string, id ? id->asKey() : std::string()};
+            if (phase->string == "b") {
+                openSpans[key] = Event{capture.addName(name->string), threadOf(event, false), start, start};
+            } else if (auto I = openSpans.find(key); I != openSpans.end()) {
+                I->second.end = start;
+                capture.addEvent(I->second);
+                openSpans.erase(I);
+            }
+        }
+    }
+    return capture;
+}
+
+} // namespace Ember
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <cstdint>
+#include <iosfwd>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace Ember {
+
+/**
+ * A recording of profiled scopes, as taken from the Profiler or read back from a trace file.
+ *
+ * Events on nested threads are assumed to be properly nested in time, so that scopes
+ * which run within other scopes are aggregated under them. Events on other threads are
+ * spans which may overlap, such as the time a task spent queued, and aren't nested.
+ *
+ * Events are attributed to the frame in which they ended, where frames are the events
+ * named FrameName, so that spans which started long before are still counted.
+ */
+class ProfileCapture {
+public:
+    static constexpr std::string_view FrameName = "frame";
+
+    struct Event {
+        std::uint32_t name;
+        std::uint32_t thread;
+        /// Nanoseconds since an arbitrary point, the same for all events in a capture.
+        std::int64_t start;
+        std::int64_t end;
+    };
+
+    struct Thread {
+        std::string name;
+        bool nested;
+    };
+
+    /**
+     * Time spent in a scope per frame, in milliseconds.
+     */
+    struct Statistics {
+        std::string thread;
+        /// The names of the scope and its enclosing scopes, outermost first, joined with ";".
+        std::string path;
+        std::uint64_t calls = 0;
+        double mean = 0;
+        double p50 = 0;
+        double p95 = 0;
+        double p99 = 0;
+        double max = 0;
+    };
+
+    std::uint32_t addName(std::string_view name);
+
+    std::uint32_t addThread(std::string name, bool nested);
+
+    void addEvent(const Event& event) {
+        mEvents.push_back(event);
+    }
+
+    const std::vector<std::string>& getNames() const {
+        return mNames;
+    }
+
+    const std::vector<Thread>& getThreads() const {
+        return mThreads;
+    }
+
+    const std::vector<Event>& getEvents() const {
+        return mEvents;
+    }
+
+    /// Events which were lost because a thread's buffer was full.
+    std::uint64_t droppedEvents = 0;
+
+    /**
+     * Aggregates the events by thread and path, over all frames.
+     * Frames in which a scope didn't run count as zero. If there are no frames, the whole
+     * capture is treated as one.
+     * @return The statistics, ordered by thread and then path, so that scopes follow their parents.
+     */
+    std::vector<Statistics> getStatistics() const;
+
+    /**
+     * Writes the capture in the Chrome trace event format, as read by chrome://tracing and Perfetto.
+     * Events on nested threads are written as complete events, and others as async spans.
+     */
+    void writeChromeTrace(std::ostream& stream) const;
+
+    /**
+     * Reads a capture written by writeChromeTrace().
+     * Complete and async events are read from other traces too; any other events are ignored.
+     * @return The capture, or nothing if the data isn't a valid trace.
+     */
+    static std::optional<ProfileCapture> readChromeTrace(std::istream& stream);
+
+private:
+    std::vector<std::string> mNames;
+    std::unordered_map<std::string, std::uint32_t> mNameIndices;
+    std::vector<Thread> mThreads;
+    std::vector<Event> mEvents;
+};
+
+} // namespace Ember
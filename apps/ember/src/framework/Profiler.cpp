@@ -1,32 +1,262 @@
 #include "Profiler.h"
 
+#include <algorithm>
+#include <array>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
 namespace Ember {
 
-std::unordered_map<std::string, Profiler::Entry> Profiler::sEntries;
+std::atomic<bool> Profiler::sEnabled{false};
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+/// Must be a power of two. At 16 bytes per scope this is 256 KiB per thread.
+constexpr size_t BufferSize = 1 << 14;
+
+struct Record {
+    std::int64_t start;
+    std::int64_t end;
+    Profiler::ScopeId scope;
+};
+
+/**
+ * Scopes recorded by one thread, which are only written by that thread and only read
+ * by the thread ending frames.
+ */
+struct ThreadBuffer {
+    std::array<Record, BufferSize> records;
+    std::atomic<std::uint64_t> written{0};
+    std::atomic<std::uint64_t> read{0};
+    std::atomic<std::uint64_t> dropped{0};
+    /// Guarded by Registry::mutex.
+    std::string name;
+};
+
+struct Registry {
+    std::mutex mutex;
+    std::vector<std::string> scopeNames;
+    std::unordered_map<std::string, Profiler::ScopeId> scopeIds;
+    std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+};
+
+struct Frame {
+    std::int64_t start;
+    std::int64_t end;
+    size_t thread;
+    /// Scopes with the index of the buffer they came from.
+    std::vector<std::pair<size_t, Record>> scopes;
+    std::vector<Record> spans;
+};
+
+/**
+ * Only accessed by the thread ending frames, apart from spans being recorded.
+ * Always locked before the registry, if both are.
+ */
+struct History {
+    std::mutex mutex;
+    std::deque<Frame> frames;
+    size_t maxFrames = 600;
+    std::int64_t frameStart = 0;
+    std::vector<Record> pendingSpans;
+    std::uint64_t dropped = 0;
+};
+
+const Clock::time_point epoch = Clock::now();
+
+Registry& registry() {
+    static Registry instance;
+    return instance;
+}
+
+History& history() {
+    static History instance;
+    return instance;
+}
 
-void Profiler::start(const std::string& name) {
-    auto& entry = sEntries[name];
-    entry.start = std::chrono::high_resolution_clock::now();
-    entry.running = true;
+std::int64_t toNanoseconds(Clock::time_point time) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(time - epoch).count();
 }
 
-void Profiler::stop(const std::string& name) {
-    auto now = std::chrono::high_resolution_clock::now();
-    auto& entry = sEntries[name];
-    if (entry.running) {
-        entry.total +=
-            std::chrono::duration<double, std::milli>(now - entry.start).count();
-        entry.running = false;
+thread_local ThreadBuffer* currentBuffer = nullptr;
+/// Set through setThreadName() before the thread has a buffer.
+thread_local std::string currentThreadName;
+
+/**
+ * Buffers are only allocated once a thread records something, so that threads never profiled don't hold on to one.
+ */
+ThreadBuffer& threadBuffer() {
+    if (!currentBuffer) {
+        auto buffer = std::make_shared<ThreadBuffer>();
+        auto& reg = registry();
+        std::lock_guard lock(reg.mutex);
+        buffer->name = currentThreadName.empty() ? "thread " + std::to_string(reg.buffers.size()) : std::move(currentThreadName);
+        reg.buffers.push_back(buffer);
+        currentBuffer = buffer.get();
     }
+    return *currentBuffer;
 }
 
-double Profiler::getMilliseconds(const std::string& name) {
-    auto it = sEntries.find(name);
-    if (it == sEntries.end()) {
-        return 0.0;
+/// Must be called with the registry locked.
+void drain(Registry& reg, std::vector<std::pair<size_t, Record>>* out, std::uint64_t& dropped) {
+    for (size_t i = 0; i < reg.buffers.size(); ++i) {
+        auto& buffer = *reg.buffers[i];
+        auto written = buffer.written.load(std::memory_order_acquire);
+        auto read = buffer.read.load(std::memory_order_relaxed);
+        if (out) {
+            for (auto index = read; index < written; ++index) {
+                out->emplace_back(i, buffer.records[index & (BufferSize - 1)]);
+            }
+        }
+        buffer.read.store(written, std::memory_order_release);
+        dropped += buffer.dropped.exchange(0, std::memory_order_relaxed);
     }
-    return it->second.total;
 }
 
-} // namespace Ember
+}
 
+Profiler::ScopeId Profiler::registerScope(std::string_view name) {
+    auto& reg = registry();
+    std::lock_guard lock(reg.mutex);
+    auto I = reg.scopeIds.find(std::string(name));
+    if (I != reg.scopeIds.end()) {
+        return I->second;
+    }
+    auto id = static_cast<ScopeId>(reg.scopeNames.size());
+    reg.scopeNames.emplace_back(name);
+    reg.scopeIds.emplace(std::string(name), id);
+    return id;
+}
+
+void Profiler::setEnabled(bool enabled) {
+    if (enabled && !isEnabled()) {
+        auto& hist = history();
+        std::lock_guard lock(hist.mutex);
+        hist.frameStart = toNanoseconds(Clock::now());
+    }
+    sEnabled.store(enabled, std::memory_order_relaxed);
+}
+
+void Profiler::setThreadName(std::string name) {
+    if (!currentBuffer) {
+        currentThreadName = std::move(name);
+        return;
+    }
+    std::lock_guard lock(registry().mutex);
+    currentBuffer->name = std::move(name);
+}
+
+void Profiler::emit(ScopeId scope, Clock::time_point start, Clock::time_point end) {
+    auto& buffer = threadBuffer();
+    auto written = buffer.written.load(std::memory_order_relaxed);
+    if (written - buffer.read.load(std::memory_order_acquire) >= BufferSize) {
+        buffer.dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    buffer.records[written & (BufferSize - 1)] = Record{toNanoseconds(start), toNanoseconds(end), scope};
+    buffer.written.store(written + 1, std::memory_order_release);
+}
+
+void Profiler::record(ScopeId scope, Clock::time_point start, Clock::time_point end) {
+    if (!isEnabled()) {
+        return;
+    }
+    auto& hist = history();
+    std::lock_guard lock(hist.mutex);
+    hist.pendingSpans.push_back(Record{toNanoseconds(start), toNanoseconds(end), scope});
+}
+
+void Profiler::endFrame() {
+    if (!isEnabled()) {
+        return;
+    }
+    auto& buffer = threadBuffer();
+    auto now = toNanoseconds(Clock::now());
+    auto& hist = history();
+    auto& reg = registry();
+    std::lock_guard historyLock(hist.mutex);
+
+    Frame frame{hist.frameStart, now, 0, {}, {}};
+    {
+        std::lock_guard registryLock(reg.mutex);
+        for (size_t i = 0; i < reg.buffers.size(); ++i) {
+            if (reg.buffers[i].get() == &buffer) {
+                frame.thread = i;
+            }
+        }
+        drain(reg, &frame.scopes, hist.dropped);
+    }
+    frame.spans.swap(hist.pendingSpans);
+
+    hist.frames.push_back(std::move(frame));
+    while (hist.frames.size() > hist.maxFrames) {
+        hist.frames.pop_front();
+    }
+    hist.frameStart = now;
+}
+
+void Profiler::setHistoryFrames(size_t frames) {
+    auto& hist = history();
+    std::lock_guard lock(hist.mutex);
+    hist.maxFrames = std::max<size_t>(frames, 1);
+    while (hist.frames.size() > hist.maxFrames) {
+        hist.frames.pop_front();
+    }
+}
+
+void Profiler::clear() {
+    auto& hist = history();
+    auto& reg = registry();
+    std::lock_guard historyLock(hist.mutex);
+    hist.frames.clear();
+    hist.pendingSpans.clear();
+    hist.dropped = 0;
+    hist.frameStart = toNanoseconds(Clock::now());
+    std::lock_guard registryLock(reg.mutex);
+    drain(reg, nullptr, hist.dropped);
+    hist.dropped = 0;
+}
+
+ProfileCapture Profiler::capture() {
+    auto& hist = history();
+    auto& reg = registry();
+    std::lock_guard historyLock(hist.mutex);
+    std::lock_guard registryLock(reg.mutex);
+
+    ProfileCapture capture;
+    capture.droppedEvents = hist.dropped;
+    std::vector<std::uint32_t> names;
+    names.reserve(reg.scopeNames.size());
+    for (auto& name: reg.scopeNames) {
+        names.push_back(capture.addName(name));
+    }
+    auto frameName = capture.addName(ProfileCapture::FrameName);
+
+    std::vector<std::uint32_t> threads;
+    threads.reserve(reg.buffers.size());
+    for (auto& buffer: reg.buffers) {
+        threads.push_back(capture.addThread(buffer->name, true));
+    }
+    std::optional<std::uint32_t> spanThread;
+
+    for (auto& frame: hist.frames) {
+        capture.addEvent({frameName, threads[frame.thread], frame.start, frame.end});
+        for (auto& [thread, scope]: frame.scopes) {
+            capture.addEvent({names[scope.scope], threads[thread], scope.start, scope.end});
+        }
+        for (auto& span: frame.spans) {
+            if (!spanThread) {
+                spanThread = capture.addThread("spans", false);
+            }
+            capture.addEvent({names[span.scope], *spanThread, span.start, span.end});
+        }
+    }
+    return capture;
+}
+
+} // namespace Ember
@@ -1,35 +1,117 @@
 #pragma once
 
+#include "ProfileCapture.h"
+
+#include <atomic>
 #include <chrono>
+#include <cstddef>
+#include <cstdint>
 #include <string>
-#include <unordered_map>
+#include <string_view>
 
 namespace Ember {
 
 /**
- * Minimal profiling helper used to expose performance metrics.
- * The profiler stores accumulated millisecond timings for named scopes.
+ * Records how long instrumented scopes take, on any thread, for diagnosing slow frames.
+ *
+ * Scopes are identified by ids registered once per call site (see EMBER_PROFILE_SCOPE), so
+ * that recording a scope only reads the clock twice and appends to a buffer owned by the
+ * current thread. The main loop calls endFrame() once per frame, which moves all buffered
+ * scopes into a history of the most recent frames. That history can then be taken as a
+ * ProfileCapture, to be aggregated or written as a trace.
+ *
+ * When disabled the only overhead is a check of a flag.
  */
 class Profiler {
 public:
-    /** Start timing a named scope. */
-    static void start(const std::string& name);
+    using ScopeId = std::uint16_t;
 
-    /** Stop timing a named scope. */
-    static void stop(const std::string& name);
+    /**
+     * Records a scope for as long as it's alive.
+     */
+    class Scope {
+    public:
+        explicit Scope(ScopeId scope) : mScope(scope), mActive(isEnabled()) {
+            if (mActive) {
+                mStart = std::chrono::steady_clock::now();
+            }
+        }
 
-    /** Retrieve the accumulated milliseconds for a scope. */
-    static double getMilliseconds(const std::string& name);
+        ~Scope() {
+            if (mActive) {
+                emit(mScope, mStart, std::chrono::steady_clock::now());
+            }
+        }
 
-private:
-    struct Entry {
-        std::chrono::high_resolution_clock::time_point start;
-        double total{0.0};
-        bool running{false};
+        Scope(const Scope&) = delete;
+
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        ScopeId mScope;
+        bool mActive;
+        std::chrono::steady_clock::time_point mStart;
     };
 
-    static std::unordered_map<std::string, Entry> sEntries;
+    /**
+     * Registers a scope name, returning the same id for every call with the same name.
+     */
+    static ScopeId registerScope(std::string_view name);
+
+    static bool isEnabled() {
+        return sEnabled.load(std::memory_order_relaxed);
+    }
+
+    static void setEnabled(bool enabled);
+
+    /**
+     * Names the current thread in captures. Threads are otherwise numbered.
+     * Only the name is stored until the thread records its first scope.
+     */
+    static void setThreadName(std::string name);
+
+    /**
+     * Records a span measured elsewhere, such as the time a task spent queued.
+     * Spans may overlap, so they're kept apart from the scopes and aren't nested.
+     */
+    static void record(ScopeId scope, std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point end);
+
+    /**
+     * Ends the current frame, collecting the scopes recorded by all threads.
+     * Must only be called from one thread, normally the main loop.
+     */
+    static void endFrame();
+
+    /**
+     * Sets how many frames are kept. Defaults to 600.
+     */
+    static void setHistoryFrames(size_t frames);
+
+    /**
+     * Removes all recorded frames and scopes.
+     */
+    static void clear();
+
+    /**
+     * @return The frames currently kept.
+     */
+    static ProfileCapture capture();
+
+private:
+    static std::atomic<bool> sEnabled;
+
+    static void emit(ScopeId scope, std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point end);
 };
 
 } // namespace Ember
 
+#define EMBER_PROFILE_CONCAT_INNER(a, b) a##b
+#define EMBER_PROFILE_CONCAT(a, b) EMBER_PROFILE_CONCAT_INNER(a, b)
+
+/**
+ * Profiles the rest of the enclosing block as the named scope.
+ * The name is only looked up the first time the block runs.
+ */
+#define EMBER_PROFILE_SCOPE(name) \
+    static const ::Ember::Profiler::ScopeId EMBER_PROFILE_CONCAT(emberProfileScopeId, __LINE__) = ::Ember::Profiler::registerScope(name); \
+    const ::Ember::Profiler::Scope EMBER_PROFILE_CONCAT(emberProfileScope, __LINE__)(EMBER_PROFILE_CONCAT(emberProfileScopeId, __LINE__))
@@ -21,11 +21,13 @@
 #include "TaskExecutionContext.h"
 #include "TaskUnit.h"
 #include "framework/Log.h"
+#include "framework/Profiler.h"
 
 
 namespace Ember::Tasks {
-TaskExecutor::TaskExecutor(TaskQueue& taskQueue) :
+TaskExecutor::TaskExecutor(TaskQueue& taskQueue, size_t index) :
 		mTaskQueue(taskQueue),
+		mIndex(index),
 		mActive(true),
 		mThread([&]() { this->run(); }) {
 }
@@ -38,19 +40,26 @@ void TaskExecutor::run() {
 #elif !defined(_WIN32)
 	pthread_setname_np(pthread_self(), "Task Executor");
 #endif
+	Profiler::setThreadName("task executor " + std::to_string(mIndex));
 	while (mActive) {
-		auto taskUnit = mTaskQueue.fetchNextTask();
+		auto taskUnit = mTaskQueue.fetchNextTask(mIndex);
 		//If the queue returns a null pointer, it means that the queue is being shut down, and this executor is expected to exit its main processing loop.
 		if (taskUnit) {
 			try {
-				TaskExecutionContext context(*this, *taskUnit);
-				taskUnit->executeInBackgroundThread(context);
-				mTaskQueue.addProcessedTask(std::move(taskUnit));
+				if (!taskUnit->isCancelled()) {
+					EMBER_PROFILE_SCOPE("backgroundTask");
+					TaskExecutionContext context(*this, *taskUnit);
+					taskUnit->executeInBackgroundThread(context);
+				}
 			} catch (const std::exception& ex) {
 				logger->critical("Error when executing task in background: {}", ex.what());
 			} catch (...) {
 				logger->critical("Unknown error when executing task in background.");
 			}
+			//Dependent tasks must be released even if this one failed, or they would never be run.
+			//The task is still handed to the main thread, as tasks expect to be deleted there.
+			mTaskQueue.taskExecuted(*taskUnit, mIndex);
+			mTaskQueue.addProcessedTask(std::move(taskUnit));
 		} else {
 			break;
 		}
@@ -20,6 +20,7 @@
 #define TASKEXECUTOR_H_
 
 #include <thread>
+#include <cstddef>
 
 
 namespace Ember::Tasks {
@@ -39,8 +40,9 @@ public:
 	 * @brief Ctor.
 	 * During construction a new thread will be created and executed.
 	 * @param taskQueue The queue to which this executor belongs.
+	 * @param index The index of the executor within the queue, which is also the index of its work queue.
 	 */
-	explicit TaskExecutor(TaskQueue& taskQueue);
+	TaskExecutor(TaskQueue& taskQueue, size_t index);
 
 	/**
 	 * @brief Dtor.
@@ -65,6 +67,11 @@ protected:
 	 */
 	TaskQueue& mTaskQueue;
 
+	/**
+	 * @brief The index of the executor within the queue.
+	 */
+	size_t mIndex;
+
 	/**
 	 * @brief Whether the executor is active or not.
 	 */
@@ -0,0 +1,130 @@
+/*
+ Copyright (C) 2025 Erik Ogenvik
+
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software Foundation,
+ Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef TASKHANDLE_H_
+#define TASKHANDLE_H_
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+
+namespace Ember::Tasks {
+
+class TaskUnit;
+
+/**
+ * @brief Scheduling state shared between a TaskQueue and the handles to an enqueued task.
+ *
+ * All fields except "cancelled" are guarded by the dependency mutex of the owning TaskQueue.
+ */
+struct TaskState {
+	/**
+	 * @brief Set when the task has been cancelled. Checked by the executors before running the task.
+	 */
+	std::atomic<bool> cancelled{false};
+
+	/**
+	 * @brief True once the task has been executed (or skipped) in a background thread.
+	 */
+	bool completed = false;
+
+	/**
+	 * @brief The number of dependencies which haven't completed yet.
+	 */
+	size_t unresolvedDependencies = 0;
+
+	/**
+	 * @brief Tasks waiting for this task to complete.
+	 */
+	std::vector<std::shared_ptr<TaskState>> dependents;
+
+	/**
+	 * @brief Holds the task while it's waiting for its dependencies.
+	 */
+	std::unique_ptr<TaskUnit> blockedTaskUnit;
+
+	int priority = 0;
+};
+
+/**
+ * @author Erik Ogenvik <erik@ogenvik.org>
+ * @brief A handle to a task enqueued through TaskQueue::scheduleTask().
+ *
+ * Use it to cancel a task which has become irrelevant, or to let other tasks depend on it.
+ * An empty handle is returned if the task couldn't be enqueued.
+ */
+class TaskHandle {
+	friend class TaskQueue;
+
+public:
+	TaskHandle() = default;
+
+	/**
+	 * @brief Cancels the task.
+	 *
+	 * If the task hasn't started executing in a background thread it won't be, and it will never be executed in the main thread.
+	 * Any tasks depending on this one will be cancelled too.
+	 * Listeners of cancelled tasks won't be called.
+	 */
+	void cancel() {
+		if (mState) {
+			mState->cancelled = true;
+		}
+	}
+
+	/**
+	 * @brief Returns true if the task has been cancelled.
+	 */
+	bool isCancelled() const {
+		return mState && mState->cancelled;
+	}
+
+	/**
+	 * @brief Returns true if the handle refers to an enqueued task.
+	 */
+	explicit operator bool() const {
+		return mState != nullptr;
+	}
+
+private:
+	explicit TaskHandle(std::shared_ptr<TaskState> state) : mState(std::move(state)) {}
+
+	std::shared_ptr<TaskState> mState;
+};
+
+/**
+ * @brief Options for scheduling a task.
+ */
+struct TaskOptions {
+	/**
+	 * @brief Tasks with a higher priority are executed before those with a lower one. Tasks with the same priority are executed in the order they were enqueued.
+	 */
+	int priority = 0;
+
+	/**
+	 * @brief Tasks which must have been executed in a background thread before this task is started.
+	 * The handles must be from the same queue.
+	 */
+	std::vector<TaskHandle> dependencies;
+};
+
+}
+
+
+#endif /* TASKHANDLE_H_ */
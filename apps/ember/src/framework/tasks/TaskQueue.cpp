@@ -23,15 +23,26 @@
 
 #include "framework/Log.h"
 
+#include <algorithm>
+
 #include <Eris/EventService.h>
 
 namespace Ember::Tasks {
 
 TaskQueue::TaskQueue(unsigned int numberOfExecutors, Eris::EventService& eventService) :
-		mEventService(eventService), mActive(true), mIsQueuedOnMainThread(false) {
+		mEventService(eventService),
+		mPendingTasks(0),
+		mSequence(0),
+		mNextWorkQueue(0),
+		mActive(true),
+		mIsQueuedOnMainThread(false) {
 	logger->debug("Creating task queue with {} executors.", numberOfExecutors);
+	//The work queues must exist before the executors start.
+	for (unsigned int i = 0; i < std::max(1U, numberOfExecutors); ++i) {
+		mWorkQueues.push_back(std::make_unique<WorkQueue>());
+	}
 	for (unsigned int i = 0; i < numberOfExecutors; ++i) {
-		mExecutors.push_back(std::make_unique<TaskExecutor>(*this));
+		mExecutors.push_back(std::make_unique<TaskExecutor>(*this, i));
 	}
 }
 
@@ -59,39 +70,160 @@ void TaskQueue::deactivate() {
 		}
 
 		assert(mProcessedTaskUnits.empty());
-		assert(mUnprocessedTaskUnits.empty());
+		assert(mPendingTasks == 0);
 	}
 }
 
 bool TaskQueue::enqueueTask(std::unique_ptr<ITask> task, ITaskExecutionListener* listener) {
-	std::unique_lock<std::mutex> l(mUnprocessedQueueMutex);
-	if (mActive) {
-		mUnprocessedTaskUnits.emplace(std::make_unique<TaskUnit>(std::move(task), listener));
-		mUnprocessedQueueCond.notify_one();
-		return true;
-	} else {
-		logger->warn("Tried to enqueue the task {} on a task queue which isn't active (i.e. is shutting down).", task->getName());
-		return false;
+	return static_cast<bool>(scheduleTask(std::move(task), {}, listener));
+}
+
+TaskHandle TaskQueue::scheduleTask(std::unique_ptr<ITask> task, TaskOptions options, ITaskExecutionListener* listener) {
+	{
+		std::unique_lock<std::mutex> l(mUnprocessedQueueMutex);
+		if (!mActive) {
+			logger->warn("Tried to enqueue the task {} on a task queue which isn't active (i.e. is shutting down).", task->getName());
+			return {};
+		}
+	}
+
+	auto state = std::make_shared<TaskState>();
+	state->priority = options.priority;
+	auto taskUnit = std::make_unique<TaskUnit>(std::move(task), listener, state);
+
+	if (!options.dependencies.empty()) {
+		std::unique_lock<std::mutex> lock(mDependencyMutex);
+		for (auto& dependency: options.dependencies) {
+			if (!dependency.mState) {
+				continue;
+			}
+			if (dependency.mState->completed) {
+				if (dependency.mState->cancelled) {
+					state->cancelled = true;
+				}
+			} else {
+				dependency.mState->dependents.push_back(state);
+				state->unresolvedDependencies++;
+			}
+		}
+		if (state->unresolvedDependencies > 0) {
+			state->blockedTaskUnit = std::move(taskUnit);
+			return TaskHandle(state);
+		}
+	}
+
+	pushTask(mNextWorkQueue++ % mWorkQueues.size(), options.priority, std::move(taskUnit));
+	return TaskHandle(state);
+}
+
+bool TaskQueue::isLowerPriority(const QueuedTask& lhs, const QueuedTask& rhs) {
+	if (lhs.priority != rhs.priority) {
+		return lhs.priority < rhs.priority;
+	}
+	return lhs.sequence > rhs.sequence;
+}
+
+void TaskQueue::pushTask(size_t workQueueIndex, int priority, std::unique_ptr<TaskUnit> taskUnit) {
+	auto& workQueue = *mWorkQueues[workQueueIndex];
+	//Increase the count before the task is available, so that it never goes below the real number of tasks.
+	mPendingTasks++;
+	{
+		std::unique_lock<std::mutex> lock(workQueue.mutex);
+		workQueue.tasks.push_back(QueuedTask{priority, mSequence++, std::move(taskUnit)});
+		std::push_heap(workQueue.tasks.begin(), workQueue.tasks.end(), isLowerPriority);
+		workQueue.topPriority = workQueue.tasks.front().priority;
+	}
+	{
+		//Lock the mutex so that we don't notify between an executor checking for tasks and starting to wait.
+		std::unique_lock<std::mutex> lock(mUnprocessedQueueMutex);
 	}
+	mUnprocessedQueueCond.notify_one();
+}
 
+std::unique_ptr<TaskUnit> TaskQueue::popTask(WorkQueue& workQueue) {
+	std::unique_lock<std::mutex> lock(workQueue.mutex);
+	if (workQueue.tasks.empty()) {
+		return {};
+	}
+	std::pop_heap(workQueue.tasks.begin(), workQueue.tasks.end(), isLowerPriority);
+	auto taskUnit = std::move(workQueue.tasks.back().taskUnit);
+	workQueue.tasks.pop_back();
+	workQueue.topPriority = workQueue.tasks.empty() ? EMPTY_PRIORITY : workQueue.tasks.front().priority;
+	mPendingTasks--;
+	return taskUnit;
+}
+
+std::unique_ptr<TaskUnit> TaskQueue::takeTask(size_t executorIndex) {
+	auto& ownQueue = *mWorkQueues[executorIndex];
+	auto ownPriority = ownQueue.topPriority.load();
+
+	//Steal from another queue only if it has something more important than our own queue.
+	WorkQueue* victim = nullptr;
+	auto victimPriority = ownPriority;
+	for (auto& workQueue: mWorkQueues) {
+		auto priority = workQueue->topPriority.load();
+		if (workQueue.get() != &ownQueue && priority > victimPriority) {
+			victim = workQueue.get();
+			victimPriority = priority;
+		}
+	}
+	if (victim) {
+		if (auto taskUnit = popTask(*victim)) {
+			return taskUnit;
+		}
+	}
+	if (auto taskUnit = popTask(ownQueue)) {
+		return taskUnit;
+	}
+	//The priorities might have changed while we looked; take whatever is available.
+	for (auto& workQueue: mWorkQueues) {
+		if (auto taskUnit = popTask(*workQueue)) {
+			return taskUnit;
+		}
+	}
+	return {};
 }
 
-std::unique_ptr<TaskUnit> TaskQueue::fetchNextTask() {
+std::unique_ptr<TaskUnit> TaskQueue::fetchNextTask(size_t executorIndex) {
 	//The semantics of this method is that if a null pointer is returned the task executor is
 	// required to exit its main processing loop, since this indicates that the queue is shutting down.
-	std::unique_ptr<TaskUnit> taskUnit;
-	std::unique_lock<std::mutex> lock(mUnprocessedQueueMutex);
-	if (mUnprocessedTaskUnits.empty()) {
-		if (!mActive) {
-			return {};
+	while (true) {
+		auto taskUnit = takeTask(executorIndex);
+		if (taskUnit) {
+			return taskUnit;
+		}
+		std::unique_lock<std::mutex> lock(mUnprocessedQueueMutex);
+		if (mPendingTasks == 0) {
+			if (!mActive) {
+				return {};
+			}
+			mUnprocessedQueueCond.wait(lock, [&]() { return mPendingTasks > 0 || !mActive; });
+		}
+	}
+}
+
+void TaskQueue::taskExecuted(const TaskUnit& taskUnit, size_t executorIndex) {
+	auto& state = taskUnit.getState();
+	if (!state) {
+		return;
+	}
+	std::vector<QueuedTask> releasedTasks;
+	{
+		std::unique_lock<std::mutex> lock(mDependencyMutex);
+		state->completed = true;
+		for (auto& dependent: state->dependents) {
+			if (state->cancelled) {
+				dependent->cancelled = true;
+			}
+			if (--dependent->unresolvedDependencies == 0) {
+				releasedTasks.push_back(QueuedTask{dependent->priority, 0, std::move(dependent->blockedTaskUnit)});
+			}
 		}
-		mUnprocessedQueueCond.wait(lock);
+		state->dependents.clear();
 	}
-	if (!mUnprocessedTaskUnits.empty()) {
-		taskUnit = std::move(mUnprocessedTaskUnits.front());
-		mUnprocessedTaskUnits.pop();
+	for (auto& releasedTask: releasedTasks) {
+		pushTask(executorIndex, releasedTask.priority, std::move(releasedTask.taskUnit));
 	}
-	return taskUnit;
 }
 
 void TaskQueue::addProcessedTask(std::unique_ptr<TaskUnit> taskUnit) {
@@ -119,7 +251,8 @@ void TaskQueue::processCompletedTasks() {
 			taskUnit = mProcessedTaskUnits.front().get();
 		}
 		try {
-			bool result = taskUnit->executeInMainThread();
+			//Cancelled tasks are only deleted here, since tasks expect to be deleted in the main thread.
+			bool result = taskUnit->isCancelled() || taskUnit->executeInMainThread();
 			if (result) {
 				try {
 					std::unique_lock<std::mutex> lock(mProcessedQueueMutex);
@@ -20,10 +20,14 @@
 #define TASKQUEUE_H_
 
 #include "framework/TimeFrame.h"
+#include "TaskHandle.h"
 
 #include <queue>
 
+#include <atomic>
 #include <condition_variable>
+#include <cstdint>
+#include <limits>
 #include <mutex>
 #include <Eris/ActiveMarker.h>
 
@@ -53,6 +57,11 @@ class TaskUnit;
  *
  * Create an instance of this in your main thread, and then call pollProcessedTasks() from the same thread at a regular interval.
  * You must also make sure that you delete this instance in the main thread.
+ *
+ * Each executor has its own queue of tasks, ordered by priority. New tasks are spread over the executor queues, and
+ * an executor which runs out of tasks, or which sees a task with higher priority in another queue, steals from the other queues.
+ * Tasks can depend on other tasks, and can be cancelled through the TaskHandle returned by scheduleTask().
+ * With only one executor and no priorities or dependencies the tasks are executed in the order they were enqueued.
  */
 class TaskQueue {
 	friend class TaskExecutor;
@@ -80,6 +89,17 @@ public:
 	 */
 	bool enqueueTask(std::unique_ptr<ITask> task, ITaskExecutionListener* listener = nullptr);
 
+	/**
+	 * @brief Adds a task to the queue, with a priority and optional dependencies.
+	 * Ownership of the task will be transferred to this queue. Ownership of the optional listener will not be transferred however.
+	 * The task won't be started until all of its dependencies have been executed in a background thread. If any dependency is cancelled, the task is cancelled too.
+	 * @param task The task to add. Note that ownership will be transferred.
+	 * @param options The priority and dependencies of the task.
+	 * @param listener An optional listener. Note that ownership won't be transferred.
+	 * @return A handle to the task, or an empty handle if the task couldn't be enqueued.
+	 */
+	TaskHandle scheduleTask(std::unique_ptr<ITask> task, TaskOptions options, ITaskExecutionListener* listener = nullptr);
+
 	/**
 	 * @brief Deactivates the queue.
 	 *
@@ -103,6 +123,32 @@ protected:
 	 */
 	typedef std::queue<std::unique_ptr<TaskUnit>> TaskUnitQueue;
 
+	static constexpr int EMPTY_PRIORITY = std::numeric_limits<int>::min();
+
+	struct QueuedTask {
+		int priority;
+		/**
+		 * @brief Increases for each task, so that tasks with the same priority are executed in order.
+		 */
+		std::uint64_t sequence;
+		std::unique_ptr<TaskUnit> taskUnit;
+	};
+
+	/**
+	 * @brief The tasks belonging to one executor. Other executors steal from it when they run out of tasks.
+	 */
+	struct WorkQueue {
+		std::mutex mutex;
+		/**
+		 * @brief A heap, ordered by priority and sequence.
+		 */
+		std::vector<QueuedTask> tasks;
+		/**
+		 * @brief The priority of the first task, or EMPTY_PRIORITY. Allows executors to look at other queues without locking them.
+		 */
+		std::atomic<int> topPriority{EMPTY_PRIORITY};
+	};
+
 	/**
 	 * @brief A store of executors.
 	 */
@@ -111,9 +157,21 @@ protected:
 	Eris::EventService& mEventService;
 
 	/**
-	 * @brief A collection of unprocessed task units, which is a tuple of a task and a listener.
+	 * @brief One queue of unprocessed task units per executor.
+	 */
+	std::vector<std::unique_ptr<WorkQueue>> mWorkQueues;
+
+	/**
+	 * @brief The number of tasks in all of the work queues.
 	 */
-	TaskUnitQueue mUnprocessedTaskUnits;
+	std::atomic<size_t> mPendingTasks;
+
+	std::atomic<std::uint64_t> mSequence;
+
+	/**
+	 * @brief Used for spreading tasks enqueued from the main thread over the work queues.
+	 */
+	std::atomic<size_t> mNextWorkQueue;
 
 	/**
 	 * @brief A collection of processed task units. These will need to be executed in the main thread before they can be deleted.
@@ -127,10 +185,15 @@ protected:
 	TaskExecutorStore mExecutors;
 
 	/**
-	 * @brief A mutex used whenever the unprocessed queue is accessed.
+	 * @brief A mutex used for letting executors sleep, and for changing the active state.
 	 */
 	std::mutex mUnprocessedQueueMutex;
 
+	/**
+	 * @brief A mutex used whenever the dependencies of any task are accessed.
+	 */
+	std::mutex mDependencyMutex;
+
 	std::mutex mProcessedQueueMutex;
 
 	/**
@@ -155,9 +218,34 @@ protected:
 	 * @brief Gets the next task to process.
 	 * @note This is normally only called by a TaskExecutor.
 	 * Calling this while there's no current tasks will result in the current thread being put on hold until a new task is enqueued.
+	 * @param executorIndex The index of the executor asking for a task.
 	 * @returns A pointer to a task unit, or a null pointer if the executor is expected to exit its processing loop (i.e. when the queue is being shut down).
 	 */
-	std::unique_ptr<TaskUnit> fetchNextTask();
+	std::unique_ptr<TaskUnit> fetchNextTask(size_t executorIndex);
+
+	/**
+	 * @brief Takes the best task available to an executor, preferring its own queue unless another queue has a task with higher priority.
+	 * @param executorIndex The index of the executor asking for a task.
+	 * @returns A task unit, or null if all queues are empty.
+	 */
+	std::unique_ptr<TaskUnit> takeTask(size_t executorIndex);
+
+	std::unique_ptr<TaskUnit> popTask(WorkQueue& workQueue);
+
+	/**
+	 * @brief Heap ordering for QueuedTask: higher priority first, then lower sequence.
+	 */
+	static bool isLowerPriority(const QueuedTask& lhs, const QueuedTask& rhs);
+
+	void pushTask(size_t workQueueIndex, int priority, std::unique_ptr<TaskUnit> taskUnit);
+
+	/**
+	 * @brief Marks a task as executed in the background thread, releasing any tasks depending on it.
+	 * Released tasks are put on the queue of the executor which completed the task.
+	 * @param taskUnit The task unit which has been executed.
+	 * @param executorIndex The index of the executor which executed it.
+	 */
+	void taskExecuted(const TaskUnit& taskUnit, size_t executorIndex);
 
 	/**
 	 * @brief Adds a processed task back to the queue, to be handled in the main thread and then deleted.
@@ -19,6 +19,7 @@
 #include "TaskUnit.h"
 #include "ITask.h"
 #include "ITaskExecutionListener.h"
+#include "TaskHandle.h"
 
 #include "framework/Log.h"
 
@@ -33,9 +34,10 @@
 
 namespace Ember::Tasks {
 
-TaskUnit::TaskUnit(std::unique_ptr<ITask> task, ITaskExecutionListener* listener) :
+TaskUnit::TaskUnit(std::unique_ptr<ITask> task, ITaskExecutionListener* listener, std::shared_ptr<TaskState> state) :
 		mTask(std::move(task)),
-		mListener(listener) {
+		mListener(listener),
+		mState(std::move(state)) {
 
 }
 
@@ -95,4 +97,12 @@ bool TaskUnit::executeInMainThread() {
 	return mTask->executeTaskInMainThread();
 }
 
+const std::shared_ptr<TaskState>& TaskUnit::getState() const {
+	return mState;
+}
+
+bool TaskUnit::isCancelled() const {
+	return mState && mState->cancelled;
+}
+
 }
@@ -30,6 +30,8 @@ struct ITaskExecutionListener;
 
 class TaskExecutionContext;
 
+struct TaskState;
+
 /**
  * @author Erik Ogenvik <erik@ogenvik.org>
  * @brief Represents both a task, its subtasks, and a listener.
@@ -51,8 +53,9 @@ public:
 	 * @brief Ctor.
 	 * @param task The main task. This will be owned by the unit.
 	 * @param listener An optional listener. This won't be owned by the unit.
+	 * @param state Scheduling state, shared with any TaskHandle. Subtasks don't have any.
 	 */
-	explicit TaskUnit(std::unique_ptr<ITask>, ITaskExecutionListener* listener = nullptr);
+	explicit TaskUnit(std::unique_ptr<ITask>, ITaskExecutionListener* listener = nullptr, std::shared_ptr<TaskState> state = {});
 
 	/**
 	 * @brief Dtor.
@@ -88,6 +91,16 @@ public:
 	 */
 	bool executeInMainThread();
 
+	/**
+	 * @brief Gets the scheduling state, if any.
+	 */
+	const std::shared_ptr<TaskState>& getState() const;
+
+	/**
+	 * @brief Returns true if the task has been cancelled through its TaskHandle.
+	 */
+	bool isCancelled() const;
+
 private:
 
 	/**
@@ -106,6 +119,8 @@ private:
 	 * When the executeInMainThread() method is called these subtasks will be executed before the main task is.
 	 */
 	SubtasksStore mSubtasks;
+
+	std::shared_ptr<TaskState> mState;
 };
 
 }
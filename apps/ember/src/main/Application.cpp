@@ -25,6 +25,7 @@
 #include "framework/TimeFrame.h"
 #include "framework/FileResourceProvider.h"
 #include "framework/StackChecker.h"
+#include "framework/Profiler.h"
 
 #include "components/lua/LuaScriptingProvider.h"
 
@@ -32,6 +33,7 @@
 #include <OgrePlugin.h>
 #include <OgreRenderSystem.h>
 
+#include <fstream>
 #include <future>
 
 #include "services/config/ConfigConsoleCommands.h"
@@ -243,7 +245,9 @@ Application::Application(Input& input,
                 mConsoleInputBinder(std::make_unique<ConsoleInputBinder>(mInput, *mConsoleBackend)),
                 mRayTracingState(std::make_unique<RayTracingState>()),
                 Quit("quit", this, "Quit Ember."),
-                ToggleErisPolling("toggle_erispolling", this, "Switch server polling on and off.") {
+                ToggleErisPolling("toggle_erispolling", this, "Switch server polling on and off."),
+                ProfilerStart("profiler_start", this, "Start recording profiled scopes, discarding any earlier recording."),
+                ProfilerStop("profiler_stop", this, "Stop recording profiled scopes and write the recent frames as a Chrome trace, to the given path or profile.json in the data directory.") {
         mIoServiceThread = std::thread([this]() { mSession->m_io_service.run(); });
 
         // Change working directory
@@ -342,6 +346,7 @@ extern "C" void shutdownHandler(int sig) {
 void Application::mainLoop() {
 	DesiredFpsListener desiredFpsListener;
 	Eris::EventService& eventService = mSession->m_event_service;
+	Profiler::setThreadName("main");
 
 	while (!mShouldQuit) {
 		try {
@@ -358,10 +363,14 @@ void Application::mainLoop() {
 			TimeFrame timeFrame(desiredFpsListener.getTimePerFrame(), currentTime);
 
 			if (mWorldView) {
+				EMBER_PROFILE_SCOPE("worldUpdate");
 				mWorldView->update(currentTime);
 			}
 
-			mInput.processInput(currentTime);
+			{
+				EMBER_PROFILE_SCOPE("input");
+				mInput.processInput(currentTime);
+			}
 			frameActionMask |= MainLoopController::FA_INPUT;
 
 			//mShouldQuit is sometimes set by IO, so we might exit here already
@@ -369,27 +378,35 @@ void Application::mainLoop() {
 				return;
 			}
 
-                        bool updatedRendering = mOgreRoot && mOgreRoot->renderOneFrame();
+                        bool updatedRendering;
+                        {
+                                EMBER_PROFILE_SCOPE("render");
+                                updatedRendering = mOgreRoot && mOgreRoot->renderOneFrame();
+                        }
                         if (updatedRendering) {
 				frameActionMask |= MainLoopController::FA_GRAPHICS;
 			}
 
                         frameActionMask |= MainLoopController::FA_SOUND;
 
-                        //Process any pending handlers from Eris. These mainly deal with assets being loaded, so it's ok if they
-                        //are spread out over multiple frames.
-                        eventService.processOneHandler();
-
-                        //If there's still time left this frame, process any outstanding main thread handlers.
-                        if (timeFrame.isTimeLeft()) {
-                                auto handlersRun = eventService.processOneHandler();
-                                while (handlersRun != 0 && timeFrame.isTimeLeft()) {
-                                        handlersRun = eventService.processOneHandler();
+                        {
+                                EMBER_PROFILE_SCOPE("erisDispatch");
+                                //Process any pending handlers from Eris. These mainly deal with assets being loaded, so it's ok if they
+                                //are spread out over multiple frames.
+                                eventService.processOneHandler();
+
+                                //If there's still time left this frame, process any outstanding main thread handlers.
+                                if (timeFrame.isTimeLeft()) {
+                                        auto handlersRun = eventService.processOneHandler();
+                                        while (handlersRun != 0 && timeFrame.isTimeLeft()) {
+                                                handlersRun = eventService.processOneHandler();
+                                        }
                                 }
                         }
 
                         //Wait for the rest of the frame to maintain target fps.
                         if (timeFrame.isTimeLeft()) {
+                                EMBER_PROFILE_SCOPE("frameWait");
                                 std::this_thread::sleep_until(timeFrame.mEndTime);
                         }
 
@@ -402,6 +419,8 @@ void Application::mainLoop() {
 
 			StackChecker::printBacktraces();
 
+			Profiler::endFrame();
+
 		} catch (const boost::exception& ex) {
 			logger->critical("Got exception, shutting down. {}", boost::diagnostic_information(ex));
 			throw;
@@ -583,6 +602,20 @@ void Application::runCommand(const std::string& command, const std::string& args
                 mShouldQuit = true;
         } else if (ToggleErisPolling == command) {
                 mPollEris = !mPollEris;
+        } else if (ProfilerStart == command) {
+                Profiler::clear();
+                Profiler::setEnabled(true);
+                logger->info("Started profiling.");
+        } else if (ProfilerStop == command) {
+                Profiler::setEnabled(false);
+                auto path = args.empty() ? mConfigService.getHomeDirectory(BaseDirType_DATA) / "profile.json" : std::filesystem::path(args);
+                std::ofstream stream(path);
+                if (stream) {
+                        Profiler::capture().writeChromeTrace(stream);
+                        logger->info("Wrote profile to {}.", path.string());
+                } else {
+                        logger->error("Could not write profile to {}.", path.string());
+                }
         }
 }
 
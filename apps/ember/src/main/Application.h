@@ -264,6 +264,16 @@ private:
 	 */
 	const ConsoleCommandWrapper ToggleErisPolling;
 
+	/**
+	 * @brief Starts recording with the Profiler.
+	 */
+	const ConsoleCommandWrapper ProfilerStart;
+
+	/**
+	 * @brief Stops recording with the Profiler, writing the recorded frames to a trace file.
+	 */
+	const ConsoleCommandWrapper ProfilerStop;
+
 	/**
 	 * @brief Provides resources to the scripting system.
 	 */
@@ -148,6 +148,17 @@ public:
         }
 };
 
+/**
+ * A listener which throws when told about an error, so that the error escapes the task unit.
+ */
+class ThrowingListener : public SimpleListener {
+public:
+	void executionError(const Ember::Exception& exception) override {
+		SimpleListener::executionError(exception);
+		throw std::runtime_error("ThrowingListener");
+	}
+};
+
 class TaskTestCase : public CppUnit::TestFixture {
 	CPPUNIT_TEST_SUITE(TaskTestCase);
 	CPPUNIT_TEST(testSimpleTaskRun);
@@ -160,6 +171,11 @@ class TaskTestCase : public CppUnit::TestFixture {
         CPPUNIT_TEST(testBackgroundExceptionMessage);
 	CPPUNIT_TEST(testTaskOrder);
 	CPPUNIT_TEST(testSubTaskOrder);
+	CPPUNIT_TEST(testPriority);
+	CPPUNIT_TEST(testCancel);
+	CPPUNIT_TEST(testDependencies);
+	CPPUNIT_TEST(testCancelledDependency);
+	CPPUNIT_TEST(testThrowingDependency);
 
 	CPPUNIT_TEST_SUITE_END();
 
@@ -305,6 +321,102 @@ public:
 		CPPUNIT_ASSERT(time1.time < time3.time);
 	}
 
+	void testPriority() {
+		SimpleListener listener1;
+		SimpleListener listener2;
+		SimpleListener listener3;
+		TimeHolder time1;
+		TimeHolder time2;
+		TimeHolder time3;
+		{
+			Eris::EventService es(io_service);
+			Tasks::TaskQueue taskQueue(1, es);
+			//Keep the executor busy so that the other tasks are all queued before any of them is started.
+			int counter = 0;
+			taskQueue.enqueueTask(std::make_unique<CounterTask>(counter, 100));
+			taskQueue.scheduleTask(std::make_unique<TimeTask>(time1), {.priority = 0}, &listener1);
+			taskQueue.scheduleTask(std::make_unique<TimeTask>(time2), {.priority = 10}, &listener2);
+			taskQueue.scheduleTask(std::make_unique<TimeTask>(time3), {.priority = 5}, &listener3);
+		}
+		CPPUNIT_ASSERT(listener2.startedTime < listener3.startedTime);
+		CPPUNIT_ASSERT(listener3.startedTime < listener1.startedTime);
+	}
+
+	void testCancel() {
+		SimpleListener listener;
+		int counter = 0;
+		int cancelledCounter = 0;
+		{
+			Eris::EventService es(io_service);
+			Tasks::TaskQueue taskQueue(1, es);
+			taskQueue.enqueueTask(std::make_unique<CounterTask>(counter, 100));
+			auto handle = taskQueue.scheduleTask(std::make_unique<CounterTask>(cancelledCounter), {}, &listener);
+			CPPUNIT_ASSERT(handle);
+			handle.cancel();
+			CPPUNIT_ASSERT(handle.isCancelled());
+		}
+		CPPUNIT_ASSERT(counter == 0);
+		//Neither the background nor the main thread part should have been run.
+		CPPUNIT_ASSERT(cancelledCounter == 2);
+		CPPUNIT_ASSERT(!listener.started);
+	}
+
+	void testDependencies() {
+		SimpleListener listener1;
+		SimpleListener listener2;
+		SimpleListener listener3;
+		TimeHolder time1;
+		TimeHolder time2;
+		TimeHolder time3;
+		{
+			Eris::EventService es(io_service);
+			Tasks::TaskQueue taskQueue(2, es);
+			auto handle1 = taskQueue.scheduleTask(std::make_unique<TimeTask>(time1), {}, &listener1);
+			auto handle2 = taskQueue.scheduleTask(std::make_unique<TimeTask>(time2), {.dependencies = {handle1}}, &listener2);
+			//Even with a higher priority this should wait for both of the other tasks.
+			taskQueue.scheduleTask(std::make_unique<TimeTask>(time3), {.priority = 10, .dependencies = {handle1, handle2}}, &listener3);
+		}
+		CPPUNIT_ASSERT(listener1.endedTime < listener2.startedTime);
+		CPPUNIT_ASSERT(listener2.endedTime < listener3.startedTime);
+	}
+
+	void testCancelledDependency() {
+		SimpleListener listener1;
+		SimpleListener listener2;
+		int counter1 = 0;
+		int counter2 = 0;
+		int counter3 = 0;
+		{
+			Eris::EventService es(io_service);
+			Tasks::TaskQueue taskQueue(1, es);
+			taskQueue.enqueueTask(std::make_unique<CounterTask>(counter1, 100));
+			auto handle1 = taskQueue.scheduleTask(std::make_unique<CounterTask>(counter2), {}, &listener1);
+			taskQueue.scheduleTask(std::make_unique<CounterTask>(counter3), {.dependencies = {handle1}}, &listener2);
+			handle1.cancel();
+		}
+		CPPUNIT_ASSERT(counter1 == 0);
+		CPPUNIT_ASSERT(counter2 == 2);
+		CPPUNIT_ASSERT(counter3 == 2);
+		CPPUNIT_ASSERT(!listener2.started);
+	}
+
+	void testThrowingDependency() {
+		ThrowingListener listener1;
+		SimpleListener listener2;
+		int counter1 = 0;
+		int counter2 = 0;
+		{
+			Eris::EventService es(io_service);
+			Tasks::TaskQueue taskQueue(1, es);
+			auto handle1 = taskQueue.scheduleTask(std::make_unique<CounterTaskBackgroundException>(counter1), {}, &listener1);
+			taskQueue.scheduleTask(std::make_unique<CounterTask>(counter2), {.dependencies = {handle1}}, &listener2);
+		}
+		CPPUNIT_ASSERT(listener1.error);
+		//The dependent task must still be run, even though the error escaped the first task.
+		CPPUNIT_ASSERT(listener2.ended);
+		CPPUNIT_ASSERT(counter2 == 0);
+	}
+
 
 };
 
@@ -70,6 +70,23 @@ MetaServerPacket::MetaServerPacket(const std::array<char, MAX_PACKET_BYTES>& pl,
 
 MetaServerPacket::~MetaServerPacket() = default;
 
+void
+MetaServerPacket::reset() {
+	m_packetType = NMT_NULL;
+	m_AddressInt = 0;
+	m_AddressStr.clear();
+	m_Port = 0;
+	m_Bytes = 0;
+	m_packetPayload.fill(0);
+	m_needFree = true;
+	m_outBound = false;
+	m_Sequence = 0;
+	m_TimeOffset = 0;
+	m_readPtr = m_packetPayload.data();
+	m_headPtr = m_packetPayload.data();
+	m_writePtr = m_packetPayload.data();
+}
+
 void
 MetaServerPacket::setPacketType(const NetMsgType& nmt) {
 
@@ -96,6 +96,11 @@ public:
 
 	~MetaServerPacket();
 
+	/**
+	 * Returns the packet to the state of a newly constructed empty packet, so that it can be reused.
+	 */
+	void reset();
+
 	NetMsgType getPacketType() const { return m_packetType; }
 
 	void setPacketType(const NetMsgType& nmt);
@@ -55,9 +55,12 @@ auto expireEntries(MapType& container, unsigned int expiry,
 }
 } // namespace
 
-DataObject::DataObject() {
-        m_serverData.clear();
-        m_clientData.clear();
+/*
+ * Latency changes with every keep alive, so it's not worth indexing.
+ */
+DataObject::DataObject()
+        : m_servers(true, {"latency"}),
+          m_clients(false) {
         m_clientFilterData.clear();
         m_handshakeQueue.clear();
         m_serverListreq.clear();
@@ -73,7 +76,7 @@ DataObject::addServerAttribute(const std::string& sessionid, const std::string&
 	 * Can not have empty values for required keys, value *can* be an empty string
 	 */
 	if (!sessionid.empty() && !sessionid.empty() && !name.empty() && !name.empty()) {
-		m_serverData[sessionid][name] = value;
+		m_servers.setAttribute(sessionid, name, value);
 		spdlog::trace("  AddServerAttribute: {}:{}:{}", sessionid, name, value);
 		return true;
 	}
@@ -89,22 +92,21 @@ DataObject::removeServerAttribute(const std::string& sessionid, const std::strin
 	 * 	port
 	 * 	expiry
 	 */
-	if (m_serverData.find(sessionid) != m_serverData.end()) {
-		if (name != "ip" && name != "expiry" && name != "port") {
-			m_serverData[sessionid].erase(name);
-		}
-
+	if (name != "ip" && name != "expiry" && name != "port") {
+		m_servers.removeAttribute(sessionid, name);
 	}
 }
 
 std::string
 DataObject::getServerAttribute(const std::string& sessionid, const std::string& key) {
-	if (m_serverData.find(sessionid) != m_serverData.end()) {
-		if (m_serverData[sessionid].find(key) != m_serverData[sessionid].end()) {
-			return m_serverData[sessionid][key];
-		}
-	}
-	return "";
+	auto value = m_servers.getAttribute(sessionid, key);
+	return value ? *value : "";
+}
+
+std::string
+DataObject::getServerAttribute(const SessionStore::Entry& entry, const std::string& key) const {
+	auto value = m_servers.getAttribute(entry, key);
+	return value ? *value : "";
 }
 
 bool
@@ -113,7 +115,7 @@ DataObject::addClientAttribute(const std::string& sessionid, const std::string&
 	 * Can not have empty values for required keys, value *can* be an empty string
 	 */
 	if (!sessionid.empty() && !sessionid.empty() && !name.empty() && !name.empty()) {
-		m_clientData[sessionid][name] = value;
+		m_clients.setAttribute(sessionid, name, value);
 		return true;
 	}
 	return false;
@@ -128,22 +130,15 @@ DataObject::removeClientAttribute(const std::string& sessionid, const std::strin
 	 * 	port
 	 * 	expiry
 	 */
-	if (m_clientData.find(sessionid) != m_clientData.end()) {
-		if (name != "ip" && name != "expiry" && name != "port") {
-			m_clientData[sessionid].erase(name);
-		}
-
+	if (name != "ip" && name != "expiry" && name != "port") {
+		m_clients.removeAttribute(sessionid, name);
 	}
 }
 
 std::string
 DataObject::getClientAttribute(const std::string& sessionid, const std::string& key) {
-	if (m_clientData.find(sessionid) != m_clientData.end()) {
-		if (m_clientData[sessionid].find(key) != m_clientData[sessionid].end()) {
-			return m_clientData[sessionid][key];
-		}
-	}
-	return "";
+	auto value = m_clients.getAttribute(sessionid, key);
+	return value ? *value : "";
 }
 
 bool
@@ -152,7 +147,7 @@ DataObject::addClientFilter(const std::string& sessionid, const std::string& nam
 	 * Can not have empty values for required keys, value *can* be an empty string
 	 */
 	if (!sessionid.empty() && !sessionid.empty() && !name.empty() && !name.empty()) {
-		if (keyExists<std::string>(m_clientData, sessionid)) {
+		if (m_clients.exists(sessionid)) {
 			/**
 			 * This serves as both a create and update.  In order to prevent DOS
 			 * style attack on MS, make establishing a session is a requirement
@@ -169,7 +164,7 @@ DataObject::addClientFilter(const std::string& sessionid, const std::string& nam
 std::map<std::string, std::string>
 DataObject::getClientFilter(const std::string& sessionid) {
         if (keyExists<std::string>(m_clientFilterData, sessionid) &&
-                keyExists<std::string>(m_clientData, sessionid)) {
+                m_clients.exists(sessionid)) {
                 return m_clientFilterData[sessionid];
         }
         return {};
@@ -181,7 +176,7 @@ DataObject::getClientFilter(const std::string& sessionid, const std::string& key
 
 	if (m_clientFilterData.find(sessionid) != m_clientFilterData.end() &&
 		m_clientFilterData[sessionid].find(key) != m_clientFilterData[sessionid].end() &&
-		m_clientData.find(sessionid) != m_clientData.end()) {
+		m_clients.exists(sessionid)) {
 		return m_clientFilterData[sessionid][key];
 	}
 
@@ -202,7 +197,7 @@ DataObject::addServerSession(const std::string& sessionid) {
 	/*
 	 *  If the server session does not exist, create it
 	 */
-	if (!keyExists<std::string>(m_serverData, sessionid)) {
+	if (!m_servers.exists(sessionid)) {
 		addServerAttribute(sessionid, "ip", sessionid);
 		ret = true;
 	}
@@ -211,7 +206,7 @@ DataObject::addServerSession(const std::string& sessionid) {
 	 *  If a new structure, this will create the expiry, if existing it will just
 	 *  refresh the timeout
 	 */
-	addServerAttribute(sessionid, "expiry", getNowStr());
+	m_servers.touch(sessionid, getNow());
 
 
 	return ret;
@@ -224,7 +219,7 @@ DataObject::removeServerSession(const std::string& sessionid) {
 	/*
 	 * Erase from main data
 	 */
-	m_serverData.erase(sessionid);
+	m_servers.remove(sessionid);
 
 	/*
 	 * If we remove a session, blast out the default cache and let it
@@ -235,14 +230,12 @@ DataObject::removeServerSession(const std::string& sessionid) {
 
 bool
 DataObject::serverSessionExists(const std::string& sessionid) {
-	return keyExists<std::string>(m_serverData, sessionid);
+	return m_servers.exists(sessionid);
 }
 
 std::map<std::string, std::string>
 DataObject::getServerSession(const std::string& sessionid) {
-        if (keyExists<std::string>(m_serverData, sessionid))
-                return m_serverData[sessionid];
-        return {};
+        return m_servers.getAttributes(sessionid);
 }
 
 bool DataObject::addClientSession(const std::string& sessionid) {
@@ -250,7 +243,7 @@ bool DataObject::addClientSession(const std::string& sessionid) {
 	/*
 	 *  If the client session does not exist, create it, and add+uniq the listresp
 	 */
-	if (!keyExists<std::string>(m_clientData, sessionid)) {
+	if (!m_clients.exists(sessionid)) {
 		addClientAttribute(sessionid, "ip", sessionid);
 		ret = true;
 	}
@@ -259,7 +252,7 @@ bool DataObject::addClientSession(const std::string& sessionid) {
 	 *  If a new structure, this will create the expiry, if existing it will just
 	 *  refresh the timeout
 	 */
-	addClientAttribute(sessionid, "expiry", getNowStr());
+	m_clients.touch(sessionid, getNow());
 
 	return ret;
 }
@@ -268,9 +261,7 @@ bool DataObject::addClientSession(const std::string& sessionid) {
 void
 DataObject::removeClientSession(const std::string& sessionid) {
 	m_clientFilterData.erase(sessionid);
-	if (m_clientData.erase(sessionid) == 1) {
-		// logging if any
-	}
+	m_clients.remove(sessionid);
 	/*
 	 * If we have an listresp cache, remove it as well
 	 */
@@ -289,37 +280,31 @@ DataObject::removeClientSession(const std::string& sessionid) {
 
 bool
 DataObject::clientSessionExists(const std::string& sessionid) {
-	return keyExists<std::string>(m_clientData, sessionid);
+	return m_clients.exists(sessionid);
 }
 
 std::list<std::string>
 DataObject::getClientSessionList() {
-	std::list<std::string> cslist;
-	cslist.clear();
-
-	std::map<std::string, std::map<std::string, std::string> >::iterator it;
-
-	for (it = m_clientData.begin(); it != m_clientData.end(); it++) {
-		cslist.push_back(it->first);
-	}
-
-	return cslist;
+	auto ids = m_clients.ids();
+	return {ids.begin(), ids.end()};
 }
 
 std::list<std::string>
 DataObject::getServerSessionList(uint32_t start_idx, uint32_t max_items, std::string sessionid) {
+	auto page = getServerSessionPage(start_idx, max_items, sessionid);
 	std::list<std::string> ss_slice;
-	std::vector<std::string>::iterator ss_itr;
-
-	ss_slice.clear();
-
-	spdlog::trace("pre - start_idx: {} -- max_items:{} -- ss_slice:{} -- serverData: {}", start_idx, max_items, ss_slice.size(), m_serverData.size());
-
+	for (auto& entry: page.entries) {
+		ss_slice.push_back(entry.id);
+	}
+	return ss_slice;
+}
 
+ServerSessionPage
+DataObject::getServerSessionPage(uint32_t start_idx, uint32_t max_items, const std::string& sessionid) {
 	/*
 	 * in the event of no session specified, just use the "default" list
 	 */
-	spdlog::trace("getServerSessionList({})", sessionid);
+	spdlog::trace("getServerSessionPage({}, {}, {})", start_idx, max_items, sessionid);
 
 	/*
 	 * If we're doing the default list and it doesn't match with the current data
@@ -330,138 +315,57 @@ DataObject::getServerSessionList(uint32_t start_idx, uint32_t max_items, std::st
 		createServerSessionListresp("default");
 	}
 
-	/*
-	 * Lets see how things are looking
-	 */
-	spdlog::trace("FULL m_serverData     : {}", m_serverData.size());
-	spdlog::trace("m_serverDataList[{}] : {}", sessionid, getServerSessionCount(sessionid));
+	auto I = m_serverListreq.find(sessionid);
+	if (I == m_serverListreq.end()) {
+		return {};
+	}
 
 	/*
 	 * If we're empty or going out of bounds, just return the big bubkis
 	 */
-	if (getServerSessionCount(sessionid) == 0 || start_idx >= getServerSessionCount(sessionid)) {
-		return ss_slice;
-	}
-
-	for (ss_itr = m_serverListreq[sessionid].begin() + start_idx; ss_itr != m_serverListreq[sessionid].end(); ++ss_itr) {
-
-		/*
-		 * Early bail out
-		 */
-		if (ss_slice.size() >= max_items) {
-			spdlog::trace("ss_slice size({}) is greater than max_items ({})", ss_slice.size(), max_items);
-			break;
-		}
-		ss_slice.push_back(*ss_itr);
-		spdlog::trace("   I({}): {}", ss_slice.size(), *ss_itr);
-
+	auto& list = I->second;
+	if (start_idx >= list->size()) {
+		return {};
 	}
 
-	spdlog::trace("   M: {}", ss_slice.size());
-	ss_slice.unique();
-	spdlog::trace("   N: {}", ss_slice.size());
-	return ss_slice;
+	auto count = std::min<size_t>(max_items, list->size() - start_idx);
+	return {.list = list, .entries = std::span<const SessionStore::Entry>(*list).subspan(start_idx, count)};
 }
 
 std::vector<std::string>
 DataObject::expireServerSessions(unsigned int expiry) {
-        boost::posix_time::ptime now = getNow();
-        return expireEntries(m_serverData, expiry, now,
-                             [this](const std::string& key) {
-                                     /*
-                                      * This also remove listreq cache items as well as the default cache
-                                      */
-                                     removeServerSession(key);
-                             },
-                             [this](const auto&, const std::string& key) {
-                                     std::string k = key;
-                                     auto iso = getServerExpiryIso(k);
-                                     spdlog::trace("  from_iso_string ({}: {}", key, iso);
-                                     return iso;
-                             });
+        std::vector<std::string> expired = m_servers.expire(getNow() - boost::posix_time::seconds(expiry));
+        if (!expired.empty()) {
+                /*
+                 * Like removeServerSession, blast out the default cache
+                 */
+                m_serverListreq.erase("default");
+        }
+        return expired;
 }
 
 std::list<std::string>
 DataObject::searchServerSessionByAttribute(const std::string& attr_name, const std::string& attr_val) {
-	std::list<std::string> matched;
-
-	matched.clear();
-
-	/*
-	 * Loop through all servers
-	 */
-	for (auto& vv: m_serverData) {
-
-		/*
-		 * Returns an empty string
-		 */
-		std::string vattr = getServerAttribute(vv.first, attr_name);
-
-		/*
-		 * If the session has the attribute, and the value matches, push it on list
-		 */
-		if (boost::iequals(vattr, attr_val))
-			matched.push_back(vv.first);
-
-	}
-	return matched;
+	auto matched = m_servers.find(attr_name, attr_val);
+	return {matched.begin(), matched.end()};
 }
 
 std::map<std::string, std::string>
 DataObject::getClientSession(const std::string& sessionid) {
-        if (keyExists<std::string>(m_clientData, sessionid))
-                return m_clientData[sessionid];
-        return {};
+        return m_clients.getAttributes(sessionid);
 }
 
 std::vector<std::string>
 DataObject::expireClientSessions(unsigned int expiry) {
-	std::vector<std::string> expiredCS;
-	expiredCS.clear();
-
-	boost::posix_time::ptime now = getNow();
-	boost::posix_time::ptime etime;
-
 	/*
 	 * Option 1: etime = 0.  The end time becomes now + 0, thus guaranteed expiry.
 	 * Option 2: etime = expiry(sec). End time becomes now + expiry.
 	 *           a) expiry>0 : all entries that are older that m_handshakeExpirySeconds are removed
 	 *           b) expiry<=0 : immediate expiry by making the etime less than now.
 	 */
-	std::map<std::string, std::map<std::string, std::string> >::iterator itr;
-	for (itr = m_clientData.begin(); itr != m_clientData.end();) {
-		std::string key = itr->first;
-		std::string et = itr->second["expiry"];
-
-		if (et.empty()) {
-			/*
-			 * arbitrary iso string for conversion
-			 */
-			et = "20000101T010000.000000";
-		}
-
-
-		spdlog::trace("  from_iso_string: {}", et);
-		etime = boost::posix_time::from_iso_string(et) +
-				boost::posix_time::seconds(expiry);
-
-		/**
-		 * We need to make a copy of the iterator if we modify the
-		 * underlying container because the iterator becomes invalid
-		 */
-		if (now > etime) {
-			auto itr_copy = itr;
-			++itr_copy;
-			removeClientSession(key);
-			itr = itr_copy;
-			expiredCS.push_back(key);
-		} else {
-			/**
-			 * We are not modifying, just increment normally.
-			 */
-			++itr;
-		}
-
+	std::vector<std::string> expiredCS = m_clients.expire(getNow() - boost::posix_time::seconds(expiry));
+	for (auto& key: expiredCS) {
+		m_clientFilterData.erase(key);
 	}
 	return expiredCS;
 
@@ -590,8 +494,8 @@ DataObject::getServerSessionCount(std::string s) {
 		/*
 		 * Called with the default argument
 		 */
-		spdlog::trace("  default m_serverData.size() count");
-		return m_serverData.size();
+		spdlog::trace("  default m_servers.size() count");
+		return m_servers.size();
 
 	} else {
 
@@ -599,8 +503,8 @@ DataObject::getServerSessionCount(std::string s) {
 			/*
 			 * We've got a custom list defined already, give a count
 			 */
-			spdlog::trace("  m_serverListreq[{}] found of size : {}", s, m_serverListreq[s].size());
-			return m_serverListreq[s].size();
+			spdlog::trace("  m_serverListreq[{}] found of size : {}", s, m_serverListreq[s]->size());
+			return m_serverListreq[s]->size();
 		}
 
 		/*
@@ -614,7 +518,7 @@ DataObject::getServerSessionCount(std::string s) {
 
 uint32_t
 DataObject::getClientSessionCount() {
-	return m_clientData.size();
+	return m_clients.size();
 }
 
 boost::posix_time::ptime
@@ -641,25 +545,11 @@ DataObject::getLatency(boost::posix_time::ptime& t1, boost::posix_time::ptime& t
 
 uint32_t
 DataObject::createServerSessionListresp(std::string ip) {
-	std::list<std::string> ip_list;
-	std::vector<std::string> ip_vec;
-
-	/*
-	 * zero out list
-	 */
-	ip_list.clear();
-	ip_vec.clear();
-
 	spdlog::trace("createServerSessionListresp({})", ip);
-	spdlog::trace("m_serverData({})", m_serverData.size());
-	/*
-	 * Check if cache exists ... if so erase it
-	 */
-	if (m_serverListreq.find(ip) != m_serverListreq.end()) {
-		spdlog::trace("  m_serverListreq[{}] exists, erasing", ip);
-		m_serverListreq.erase(ip);
-//		m_serverListreq[ip].clear();
-	}
+	spdlog::trace("m_servers({})", m_servers.size());
+
+	m_servers.publish();
+	auto snapshot = m_servers.snapshot();
 
        // Gather client specific filters and sorting preferences before we
        // build the list of server session ids. This allows us to apply the
@@ -669,63 +559,64 @@ DataObject::createServerSessionListresp(std::string ip) {
        auto sf = clientFilters.find("sortby");
        if (sf != clientFilters.end()) {
                sortKey = sf->second;
+               clientFilters.erase(sf);
        }
 
-       // Lambda which determines whether a server should be included based on
-       // the client's filter set. The special key "sortby" is ignored as it is
-       // used solely for ordering.
-       auto passesFilter = [this, &clientFilters](const std::string& sid) {
-               for (const auto& f : clientFilters) {
-                       if (f.first == "sortby") {
-                               continue;
+       std::shared_ptr<const SessionStore::Snapshot> list;
+       if (clientFilters.empty() && sortKey.empty()) {
+               /*
+                * Nothing to filter or sort by, so the snapshot (which is sorted by
+                * session id) can be shared as it is.
+                */
+               list = snapshot;
+       } else {
+               // Lambda which determines whether a server should be included based on
+               // the client's filter set.
+               auto passesFilter = [this, &clientFilters](const SessionStore::Entry& entry) {
+                       for (const auto& f : clientFilters) {
+                               if (getServerAttribute(entry, f.first) != f.second) {
+                                       return false;
+                               }
                        }
-                       if (getServerAttribute(sid, f.first) != f.second) {
-                               return false;
+                       return true;
+               };
+
+               auto filtered = std::make_shared<SessionStore::Snapshot>();
+               if (clientFilters.empty()) {
+                       *filtered = *snapshot;
+               } else {
+                       /*
+                        * Use the index to only look at servers matching the first filter.
+                        * The index ignores case, so the filters still need to be checked.
+                        */
+                       auto candidates = m_servers.find(clientFilters.begin()->first, clientFilters.begin()->second);
+                       for (auto& sid: candidates) {
+                               auto entry = std::lower_bound(snapshot->begin(), snapshot->end(), sid,
+                                                             [](const SessionStore::Entry& lhs, const std::string& rhs) { return lhs.id < rhs; });
+                               if (entry != snapshot->end() && entry->id == sid && passesFilter(*entry)) {
+                                       spdlog::trace("    Temp Cache[{}] = {}", ip, sid);
+                                       filtered->push_back(*entry);
+                               }
                        }
                }
-               return true;
-       };
-
-       // Comparator lambda to perform custom client aware sorting of the
-       // server list. If the client specified a sort key we order based on the
-       // value of that server attribute, otherwise we default to lexicographic
-       // ordering of the session ids.
-       auto sortLambda = [this, &sortKey](const std::string& lhs, const std::string& rhs) {
-               if (!sortKey.empty()) {
-                       std::string lhsAttr = getServerAttribute(lhs, sortKey);
-                       std::string rhsAttr = getServerAttribute(rhs, sortKey);
-                       if (lhsAttr != rhsAttr) {
-                               return lhsAttr < rhsAttr;
-                       }
-               }
-               return lhs < rhs;
-       };
 
-       for (auto& foo: m_serverData) {
-               if (passesFilter(foo.first)) {
-                       spdlog::trace("    Temp Cache[{}] = {}", ip, foo.first);
-                       ip_list.push_back(foo.first);
+               // If the client specified a sort key we order based on the value of that
+               // server attribute, otherwise the servers stay ordered by session id.
+               if (!sortKey.empty()) {
+                       std::stable_sort(filtered->begin(), filtered->end(), [this, &sortKey](const SessionStore::Entry& lhs, const SessionStore::Entry& rhs) {
+                               return getServerAttribute(lhs, sortKey) < getServerAttribute(rhs, sortKey);
+                       });
                }
-       }
-
-       /*
-        * Just put in the list to make preventing duplicates easier
-        */
-       ip_list.unique();
-       ip_list.sort(sortLambda);
-
-       for (auto& bar: ip_list) {
-               spdlog::trace("    Packing vector ({})", bar);
-               ip_vec.push_back(bar);
+               list = std::move(filtered);
        }
 
 	/*
 	 *  Place list into cache
 	 */
-	m_serverListreq[ip] = ip_vec;
+	m_serverListreq[ip] = list;
 	m_listreqExpiry[ip] = getNowStr();
 
-	return ip_vec.size();
+	return list->size();
 }
 
 std::list<std::string>
@@ -746,7 +637,7 @@ DataObject::getServerExpiryIso(std::string& sessionid) {
         std::string et;
         const std::string fallback = getNowStr();
 
-        if (m_serverData.find(sessionid) == m_serverData.end()) {
+        if (!m_servers.exists(sessionid)) {
                 /*
                  * We don't have a session
                  * Option 1: some list somewhere is iterating over the list and it's
@@ -760,8 +651,9 @@ DataObject::getServerExpiryIso(std::string& sessionid) {
                  * found session, check expiry
                  *
                  */
-                if (m_serverData[sessionid].find("expiry") != m_serverData[sessionid].end()) {
-                        et = m_serverData[sessionid]["expiry"];
+                auto expiry = m_servers.getAttribute(sessionid, SessionStore::expiryAttribute);
+                if (expiry) {
+                        et = *expiry;
                 } else {
                         spdlog::trace("session({}) does not contain expiry attribute", sessionid);
                         et = fallback;
@@ -792,8 +684,8 @@ DataObject::getServerExpiryIso(std::string& sessionid) {
                  */
                 spdlog::warn("expiry time '{}' for session({}) is invalid; using {}", et, sessionid, fallback);
                 et = fallback;
-                if (m_serverData.find(sessionid) != m_serverData.end()) {
-                        m_serverData[sessionid]["expiry"] = fallback;
+                if (m_servers.exists(sessionid)) {
+                        m_servers.setAttribute(sessionid, SessionStore::expiryAttribute, fallback);
                 }
         }
 
@@ -25,6 +25,7 @@
 /*
  * Local Includes
  */
+#include "SessionStore.hpp"
 
 /*
  * System Includes
@@ -37,6 +38,16 @@
 #include <boost/date_time/posix_time/posix_time.hpp>
 #include <boost/algorithm/string.hpp>
 #include <algorithm>
+#include <span>
+
+/**
+ * A page of a server list, as returned by DataObject::getServerSessionPage().
+ * The entries point into the list, which is kept alive by the page.
+ */
+struct ServerSessionPage {
+	std::shared_ptr<const SessionStore::Snapshot> list;
+	std::span<const SessionStore::Entry> entries;
+};
 
 class DataObject {
 
@@ -83,6 +94,17 @@ public:
 
 	std::list<std::string> getServerSessionList(uint32_t start_idx, uint32_t max_items, std::string sessionid = "default");
 
+	/**
+	 * Gets a page of a server list, without copying it.
+	 * Like getServerSessionList(), the "default" list is refreshed when the first page is requested.
+	 */
+	ServerSessionPage getServerSessionPage(uint32_t start_idx, uint32_t max_items, const std::string& sessionid = "default");
+
+	/**
+	 * Gets an attribute of a server in a server list, as it was when the list was created.
+	 */
+	std::string getServerAttribute(const SessionStore::Entry& entry, const std::string& key) const;
+
 	std::map<std::string, std::string> getServerSession(const std::string& sessionid);
 
 	std::vector<std::string> expireServerSessions(unsigned int expiry = 0);
@@ -126,7 +148,7 @@ public:
 
 private:
 	/**
-	 *  Example Data Structure ( m_serverData )
+	 *  Example Data Structure ( m_servers )
 	 *  "192.168.1.200" => {
 	 *  	"serverVersion" => "0.5.20",
 	 *  	"serverType" => "cyphesis",
@@ -136,9 +158,11 @@ private:
 	 *  	"latency" => "200"
 	 *  }
 	 *
-	 *  m_serverDataList contains an ordered representation of
-	 *  m_serverData keys so that multiple LISTREQ requests can be
-	 *  done and avoid duplicate servers packet responses.
+	 *  m_serverListreq contains an ordered, immutable representation of
+	 *  the servers (per client, if it has filters) so that multiple LISTREQ
+	 *  requests can be done and avoid duplicate servers packet responses.
+	 *  When a client has no filters the published snapshot of m_servers is
+	 *  used as it is.
 	 */
 
 	template<class T>
@@ -150,11 +174,11 @@ private:
 		return false;
 	}
 
-	std::map<std::string, std::map<std::string, std::string> > m_serverData;
-	std::map<std::string, std::vector<std::string> > m_serverListreq;
+	SessionStore m_servers;
+	std::map<std::string, std::shared_ptr<const SessionStore::Snapshot> > m_serverListreq;
 	std::map<std::string, std::string> m_listreqExpiry;
 
-        std::map<std::string, std::map<std::string, std::string> > m_clientData;
+        SessionStore m_clients;
         std::map<std::string, std::map<std::string, std::string> > m_clientFilterData;
 
         std::map<unsigned int, std::map<std::string, std::string> > m_handshakeQueue;
@@ -128,7 +128,14 @@ MetaServer::~MetaServer() {
 }
 
 void
-MetaServer::expiry_timer(const boost::system::error_code&) {
+MetaServer::expiry_timer(const boost::system::error_code& ec) {
+	/*
+	 * The timer was replaced by initTimers, which sets up a new wait
+	 */
+	if (ec == boost::asio::error::operation_aborted) {
+		return;
+	}
+	std::lock_guard<std::mutex> lock(m_mutex);
 
 	spdlog::trace("Tick expiry_timer");
 
@@ -252,7 +259,14 @@ MetaServer::expiry_timer(const boost::system::error_code&) {
 }
 
 void
-MetaServer::update_timer(const boost::system::error_code&) {
+MetaServer::update_timer(const boost::system::error_code& ec) {
+	/*
+	 * The timer was replaced by initTimers, which sets up a new wait
+	 */
+	if (ec == boost::asio::error::operation_aborted) {
+		return;
+	}
+	std::lock_guard<std::mutex> lock(m_mutex);
 
 	spdlog::trace("Tick update_timer");
 
@@ -300,6 +314,7 @@ MetaServer::update_timer(const boost::system::error_code&) {
 
 void
 MetaServer::score_timer(const boost::system::error_code&) {
+	std::lock_guard<std::mutex> lock(m_mutex);
 //	spdlog::trace("Tick score_timer({})", m_scoreDelayMilliseconds);
 //
 //	if(!error)
@@ -494,6 +509,7 @@ MetaServer::score_timer(const boost::system::error_code&) {
  */
 void
 MetaServer::processMetaserverPacket(MetaServerPacket& msp, MetaServerPacket& rsp) {
+	std::lock_guard<std::mutex> lock(m_mutex);
 
 	/*
 	 * Packet Sequence: store this so that we can replay the packets in the
@@ -777,12 +793,14 @@ MetaServer::processLISTREQ(const MetaServerPacket& in, MetaServerPacket& out) {
 	 * We hide the craziness of what goes on here inside the single method.
 	 * The goal, is to get the list of servers constrained by packed_max
 	 */
-	std::list<std::string> sess_list = msdo.getServerSessionList(server_index, packed_max, ip_str);
-	std::list<std::string>::iterator list_itr;
+	/*
+	 * The page refers directly into the (immutable) server list, so nothing is copied.
+	 */
+	ServerSessionPage sess_page = msdo.getServerSessionPage(server_index, packed_max, ip_str);
 
-	spdlog::trace("server_index:{} ** total: {} ** packed_max: {} ** sess_list: {}", server_index, total, packed_max, sess_list.size());
+	spdlog::trace("server_index:{} ** total: {} ** packed_max: {} ** sess_list: {}", server_index, total, packed_max, sess_page.entries.size());
 
-	for (list_itr = sess_list.begin(); list_itr != sess_list.end(); list_itr++) {
+	for (auto& entry: sess_page.entries) {
 		/*
 		 * Defensive to make sure we're not going to exceed our max
 		 */
@@ -797,14 +815,15 @@ MetaServer::processLISTREQ(const MetaServerPacket& in, MetaServerPacket& out) {
 		 * Thus we can iterate over as much of the server list as we need to
 		 * and dead items won't count, only those added to the response packet.
 		 */
-		if (msdo.serverSessionExists(*list_itr)) {
+		if (msdo.serverSessionExists(entry.id)) {
 			/*
 			 * Pack the int IP
 			 */
-			std::istringstream(msdo.getServerSession(*list_itr)["ip_int"]) >> temp_int;
+			std::string ip_int = msdo.getServerAttribute(entry, "ip_int");
+			std::istringstream(ip_int) >> temp_int;
 
 			spdlog::trace("Packing Session Itr[{}] Session Int[{}] Session IP[{}] SS Int[{}]",
-						  *list_itr, msdo.getServerSession(*list_itr)["ip_int"], msdo.getServerSession(*list_itr)["ip"], temp_int);
+						  entry.id, ip_int, msdo.getServerAttribute(entry, "ip"), temp_int);
 			resp_list.push_back(temp_int);
 
 			//resp_list.push_back( atoi( msdo.getServerSession(*list_itr)["ip_int"].c_str() ) );
@@ -1354,6 +1373,11 @@ void
 MetaServer::initTimers(boost::asio::io_context& ios) {
 	spdlog::info("Timer initiation");
 
+	/*
+	 * The timer handlers run on any of the threads, and use the timers while holding the lock
+	 */
+	std::lock_guard<std::mutex> lock(m_mutex);
+
 	if (m_expiryTimer) {
 		spdlog::warn("Purging m_expiryTimer");
 		m_expiryTimer->cancel();
@@ -36,7 +36,9 @@
 #include <boost/enable_shared_from_this.hpp>
 #include <boost/asio/io_context.hpp>
 #include <boost/asio/deadline_timer.hpp>
+#include <atomic>
 #include <filesystem>
+#include <mutex>
 
 #include <set>
 #include <random>
@@ -129,7 +131,7 @@ private:
 	unsigned long long m_PacketSequence;
 	std::string m_Logfile;
 	std::string m_PacketLogfile;
-	bool m_isShutdown;
+	std::atomic<bool> m_isShutdown;
 	std::filesystem::path m_pidFile;
 	std::filesystem::path m_scoreServer;
 	std::filesystem::path m_scoreClient;
@@ -143,6 +145,12 @@ private:
 	unsigned int m_serverClientCacheExpirySeconds;
 	std::default_random_engine mRandomEngine;
 
+	/**
+	 * Packets may be processed on several threads at once (see server.threads), while the timers
+	 * run on any of them; this serialises all access to the sessions.
+	 */
+	std::mutex m_mutex;
+
 };
 
 #endif
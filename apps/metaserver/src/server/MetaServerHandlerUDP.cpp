@@ -32,27 +32,70 @@
 #include <boost/bind.hpp>
 #include <boost/asio/placeholders.hpp>
 #include <boost/asio/error.hpp>
+#include <boost/exception/diagnostic_information.hpp>
 #include <spdlog/spdlog.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
 #include <memory>
 
+namespace {
+/**
+ * Bounds the time spent on one socket before other handlers get to run.
+ */
+const unsigned int MAX_BATCHES_PER_WAKEUP = 16;
+
+#ifdef __linux__
+typedef boost::asio::detail::socket_option::boolean<SOL_SOCKET, SO_REUSEPORT> reuse_port;
+#endif
+}
+
 MetaServerHandlerUDP::MetaServerHandlerUDP(MetaServer& ms,
 										   boost::asio::io_context& ios,
 										   const std::string& address,
-										   unsigned int port)
-		: m_Socket(ios, boost::asio::ip::udp::udp::endpoint(boost::asio::ip::make_address(address), port)),
-		  m_recvBuffer{},
-//     m_Socket(ios, boost::asio::ip::udp::udp::endpoint(boost::asio::ip::udp::udp::v6(),port)),
+										   unsigned int port,
+										   unsigned int sockets)
+		: m_packetPool(std::make_shared<PacketPool>(BATCH_SIZE * std::max(sockets, 1U) * 2)),
 		  m_outboundTimer(std::make_unique<boost::asio::steady_timer>(ios, std::chrono::seconds(1))),
 		  m_outboundMaxInterval(100),
 		  m_outboundTick(0),
 		  m_Address(address),
 		  m_Port(port),
 		  m_msRef(ms) {
+#ifndef __linux__
+	if (sockets > 1) {
+		spdlog::warn("MetaServerHandlerUDP() Multiple sockets require SO_REUSEPORT load balancing, which is only available on Linux; using one.");
+		sockets = 1;
+	}
+#endif
+	sockets = std::max(sockets, 1U);
+
+	boost::asio::ip::udp::endpoint endpoint(boost::asio::ip::make_address(address), port);
+	for (unsigned int i = 0; i < sockets; ++i) {
+		auto listener = std::make_unique<Listener>(ios);
+		listener->socket.open(endpoint.protocol());
+#ifdef __linux__
+		if (sockets > 1) {
+			listener->socket.set_option(reuse_port(true));
+		}
+#endif
+		/*
+		 * Not being allowed a larger buffer isn't fatal, so ignore any error.
+		 */
+		boost::system::error_code ec;
+		listener->socket.set_option(boost::asio::socket_base::receive_buffer_size(RECEIVE_BUFFER_BYTES), ec);
+		listener->socket.bind(endpoint);
+		listener->responses.reserve(BATCH_SIZE);
+		m_listeners.push_back(std::move(listener));
+	}
+
 	m_outboundTimer->async_wait([this](const boost::system::error_code& error) { this->process_outbound(error); });
 
-	spdlog::info("MetaServerHandlerUDP() Startup : {},{}", m_Address, m_Port);
+	spdlog::info("MetaServerHandlerUDP() Startup : {},{} with {} socket(s)", m_Address, m_Port, m_listeners.size());
 
-	start_receive();
+	for (auto& listener: m_listeners) {
+		start_receive(*listener);
+	}
 }
 
 MetaServerHandlerUDP::~MetaServerHandlerUDP() {
@@ -60,66 +103,178 @@ MetaServerHandlerUDP::~MetaServerHandlerUDP() {
 }
 
 void
-MetaServerHandlerUDP::start_receive() {
+MetaServerHandlerUDP::start_receive(Listener& listener) {
 
-	m_Socket.async_receive_from(
-			boost::asio::buffer(m_recvBuffer), m_remoteEndpoint,
-			[this](const boost::system::error_code& error, std::size_t bytes_recvd) {
-				this->handle_receive(error, bytes_recvd);
+#ifdef __linux__
+	listener.socket.async_wait(boost::asio::ip::udp::socket::wait_read,
+			[this, &listener](const boost::system::error_code& error) {
+				this->handle_readable(listener, error);
+			}
+	);
+#else
+	listener.socket.async_receive_from(
+			boost::asio::buffer(listener.recvBuffer), listener.remoteEndpoint,
+			[this, &listener](const boost::system::error_code& error, std::size_t bytes_recvd) {
+				this->handle_receive(listener, error, bytes_recvd);
 			}
 	);
+#endif
 
 }
 
 void
-MetaServerHandlerUDP::handle_receive(const boost::system::error_code& error,
+MetaServerHandlerUDP::handle_receive(Listener& listener,
+									 const boost::system::error_code& error,
 									 std::size_t bytes_recvd) {
+	if (!error || error == boost::asio::error::message_size) {
+
+		auto rsp = process_packet(listener.recvBuffer, bytes_recvd, listener.remoteEndpoint);
+		if (rsp) {
+			send_async(listener, Response{rsp, listener.remoteEndpoint});
+		}
+
+		/**
+		 *	Back to async read
+		 */
+		start_receive(listener);
+
+	} else {
+		spdlog::warn("ERROR:{}", error.message());
+	}
+
+}
+
+#ifdef __linux__
+
+void
+MetaServerHandlerUDP::handle_readable(Listener& listener, const boost::system::error_code& error) {
+	if (error) {
+		spdlog::warn("ERROR:{}", error.message());
+		return;
+	}
+
+	/*
+	 * Keep reading as long as full batches are waiting, so that a burst is drained with as few wakeups as possible.
+	 */
+	for (unsigned int round = 0; round < MAX_BATCHES_PER_WAKEUP; ++round) {
+		auto received = receive_batch(listener);
+		for (std::size_t i = 0; i < received; ++i) {
+			auto& message = listener.batchMessages[i];
+			boost::asio::ip::udp::endpoint remoteEndpoint;
+			std::memcpy(remoteEndpoint.data(), &listener.batchAddresses[i], message.msg_hdr.msg_namelen);
+			remoteEndpoint.resize(message.msg_hdr.msg_namelen);
+
+			auto rsp = process_packet(listener.batchBuffers[i], message.msg_len, remoteEndpoint);
+			if (rsp) {
+				listener.responses.push_back(Response{std::move(rsp), remoteEndpoint});
+			}
+		}
+		send_batch(listener);
+
+		if (received < BATCH_SIZE) {
+			break;
+		}
+	}
+
+	start_receive(listener);
+}
+
+std::size_t
+MetaServerHandlerUDP::receive_batch(Listener& listener) {
+	for (std::size_t i = 0; i < BATCH_SIZE; ++i) {
+		listener.batchVectors[i] = {listener.batchBuffers[i].data(), listener.batchBuffers[i].size()};
+		auto& header = listener.batchMessages[i].msg_hdr;
+		header = {};
+		header.msg_name = &listener.batchAddresses[i];
+		header.msg_namelen = sizeof(sockaddr_storage);
+		header.msg_iov = &listener.batchVectors[i];
+		header.msg_iovlen = 1;
+	}
+
+	int received;
+	do {
+		received = ::recvmmsg(listener.socket.native_handle(), listener.batchMessages.data(), BATCH_SIZE, MSG_DONTWAIT, nullptr);
+	} while (received < 0 && errno == EINTR);
+
+	if (received < 0) {
+		if (errno != EAGAIN && errno != EWOULDBLOCK) {
+			spdlog::warn("UDP: recvmmsg failed: {}", std::strerror(errno));
+		}
+		return 0;
+	}
+	return static_cast<std::size_t>(received);
+}
+
+void
+MetaServerHandlerUDP::send_batch(Listener& listener) {
+	auto& responses = listener.responses;
+	std::size_t sent = 0;
+	while (sent < responses.size()) {
+		auto count = responses.size() - sent;
+		for (std::size_t i = 0; i < count; ++i) {
+			auto& response = responses[sent + i];
+			listener.batchVectors[i] = {const_cast<char*>(response.packet->getBuffer().data()), response.packet->getSize()};
+			auto& header = listener.batchMessages[i].msg_hdr;
+			header = {};
+			header.msg_name = response.endpoint.data();
+			header.msg_namelen = static_cast<socklen_t>(response.endpoint.size());
+			header.msg_iov = &listener.batchVectors[i];
+			header.msg_iovlen = 1;
+		}
+
+		int result = ::sendmmsg(listener.socket.native_handle(), listener.batchMessages.data(), static_cast<unsigned int>(count), MSG_DONTWAIT);
+		if (result < 0 && errno == EINTR) {
+			continue;
+		}
+		if (result <= 0) {
+			break;
+		}
+		sent += static_cast<std::size_t>(result);
+	}
+
+	/*
+	 * Whatever couldn't be sent right away, because the send buffer is full, is queued instead.
+	 */
+	for (; sent < responses.size(); ++sent) {
+		send_async(listener, responses[sent]);
+	}
+	responses.clear();
+}
+
+#endif
+
+std::shared_ptr<MetaServerPacket>
+MetaServerHandlerUDP::process_packet(const std::array<char, MAX_PACKET_BYTES>& buffer,
+									 std::size_t bytes_recvd,
+									 const boost::asio::ip::udp::endpoint& remoteEndpoint) {
 	try {
-		if (!error || error == boost::asio::error::message_size) {
-
-			/**
-			 *  Create a MSP from the incoming buffer and add in some useful information
-			 */
-			MetaServerPacket msp(m_recvBuffer, bytes_recvd);
-
-			msp.setAddress(m_remoteEndpoint.address().to_string(), m_remoteEndpoint.address().to_v4().to_uint());
-			msp.setPort(m_remoteEndpoint.port());
-
-			spdlog::info("UDP: Incoming Packet [{}][{}][{}]", msp.getAddress(), NMT_PRETTY[msp.getPacketType()], bytes_recvd);
-
-			/**
-			 *  Define an empty MSP ( the buffer is internally created )
-			 */
-                        auto rsp = std::make_shared<MetaServerPacket>();
-
-			/**
-			 * The logic for what happens is inside the metaserver class
-			 */
-                        m_msRef.processMetaserverPacket(msp, *rsp);
-
-                        /**
-                         * Send back response, only if it's not NULL and has some data
-                         * otherwise we let it fall to the floor. Capture the packet in
-                         * the lambda to ensure that the underlying buffer remains valid
-                         * for the duration of the async operation.
-                         */
-
-                        if (rsp->getSize() > 0 && rsp->getPacketType() != NMT_NULL) {
-                                spdlog::info("UDP: Outgoing Packet [{}][{}][{}]", rsp->getAddress(), NMT_PRETTY[rsp->getPacketType()], rsp->getSize());
-                                m_Socket.async_send_to(
-                                                boost::asio::buffer(rsp->getBuffer(), rsp->getSize()), m_remoteEndpoint,
-                                                [rsp](const boost::system::error_code& send_error, std::size_t bytes_sent) {
-                                                        handle_send(rsp, send_error, bytes_sent);
-                                                });
-                        }
-
-			/**
-			 *	Back to async read
-			 */
-			start_receive();
-
-		} else {
-			spdlog::warn("ERROR:{}", error.message());
+		/**
+		 *  Create a MSP from the incoming buffer and add in some useful information
+		 */
+		MetaServerPacket msp(buffer, std::min<std::size_t>(bytes_recvd, MAX_PACKET_BYTES));
+
+		msp.setAddress(remoteEndpoint.address().to_string(), remoteEndpoint.address().to_v4().to_uint());
+		msp.setPort(remoteEndpoint.port());
+
+		spdlog::info("UDP: Incoming Packet [{}][{}][{}]", msp.getAddress(), NMT_PRETTY[msp.getPacketType()], bytes_recvd);
+
+		/**
+		 *  Take an empty MSP from the pool ( the buffer is internally created )
+		 */
+		auto rsp = m_packetPool->acquire();
+
+		/**
+		 * The logic for what happens is inside the metaserver class
+		 */
+		m_msRef.processMetaserverPacket(msp, *rsp);
+
+		/**
+		 * Send back response, only if it's not NULL and has some data
+		 * otherwise we let it fall to the floor.
+		 */
+		if (rsp->getSize() > 0 && rsp->getPacketType() != NMT_NULL) {
+			spdlog::info("UDP: Outgoing Packet [{}][{}][{}]", rsp->getAddress(), NMT_PRETTY[rsp->getPacketType()], rsp->getSize());
+			return rsp;
 		}
 
 	} catch (const boost::exception& bex) {
@@ -128,10 +283,23 @@ MetaServerHandlerUDP::handle_receive(const boost::system::error_code& error,
 		 * This use case is to cover some unknown error we want to continue reading
 		 * anyway
 		 */
-		spdlog::error("MetaServerHandlerUDP Exception: {}", error.message());
-		start_receive();
+		spdlog::error("MetaServerHandlerUDP Exception: {}", boost::diagnostic_information(bex));
 	}
+	return nullptr;
+}
 
+void
+MetaServerHandlerUDP::send_async(Listener& listener, const Response& response) {
+	/**
+	 * Capture the packet in the lambda to ensure that the underlying buffer remains valid
+	 * for the duration of the async operation.
+	 */
+	auto rsp = response.packet;
+	listener.socket.async_send_to(
+			boost::asio::buffer(rsp->getBuffer(), rsp->getSize()), response.endpoint,
+			[rsp](const boost::system::error_code& send_error, std::size_t bytes_sent) {
+				handle_send(rsp, send_error, bytes_sent);
+			});
 }
 
 void
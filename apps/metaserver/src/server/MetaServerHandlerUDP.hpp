@@ -23,6 +23,7 @@
  * Local Includes
  */
 #include "MetaServerPacket.hpp"
+#include "PacketPool.hpp"
 
 /*
  * System Includes
@@ -30,7 +31,13 @@
 #include <boost/asio/io_context.hpp>
 #include <boost/asio/ip/udp.hpp>
 #include <boost/asio/steady_timer.hpp>
+#include <array>
 #include <memory>
+#include <vector>
+
+#ifdef __linux__
+#include <sys/socket.h>
+#endif
 
 /*
  * Forward Declarations
@@ -39,30 +46,91 @@ class MetaServer;
 
 class MetaServerPacket;
 
+/**
+ * Receives packets over UDP, has the MetaServer process them and sends back the responses.
+ *
+ * One socket is bound for each of the requested number of sockets; when there's more than one they're bound with
+ * SO_REUSEPORT, so that the kernel spreads the incoming packets between them. Each socket only ever has one
+ * operation outstanding, so the io_context can be run on as many threads as there are sockets.
+ *
+ * On Linux all datagrams waiting on a socket are read with recvmmsg() in batches, and the responses to a batch
+ * are sent with a single sendmmsg(), which greatly reduces the number of system calls during a burst of packets.
+ * The socket receive buffers are also enlarged, so that bursts are queued rather than dropped while the packets
+ * before them are processed.
+ */
 class MetaServerHandlerUDP {
 
 public:
 
-	MetaServerHandlerUDP(MetaServer& ms, boost::asio::io_context& ios, const std::string& address, unsigned int port);
+	/**
+	 * The number of datagrams read or sent with one system call.
+	 */
+	static constexpr std::size_t BATCH_SIZE = 32;
 
-	~MetaServerHandlerUDP();
+	/**
+	 * The receive buffer requested for each socket; the kernel caps it at net.core.rmem_max.
+	 */
+	static constexpr int RECEIVE_BUFFER_BYTES = 8 * 1024 * 1024;
 
-	void start_receive();
+	MetaServerHandlerUDP(MetaServer& ms, boost::asio::io_context& ios, const std::string& address, unsigned int port, unsigned int sockets = 1);
 
-	void handle_receive(const boost::system::error_code& error, std::size_t);
+	~MetaServerHandlerUDP();
+
+	static void handle_send(const std::shared_ptr<MetaServerPacket>& p, const boost::system::error_code& error, std::size_t);
 
-        static void handle_send(const std::shared_ptr<MetaServerPacket>& p, const boost::system::error_code& error, std::size_t);
+	void process_outbound(const boost::system::error_code& error);
 
-        void process_outbound(const boost::system::error_code& error);
+	unsigned long getOutboundTick() const { return m_outboundTick; }
 
-        unsigned long getOutboundTick() const { return m_outboundTick; }
+	std::size_t getSocketCount() const { return m_listeners.size(); }
 
+	const std::shared_ptr<PacketPool>& getPacketPool() const { return m_packetPool; }
 
 private:
 
-	boost::asio::ip::udp::socket m_Socket;
-	boost::asio::ip::udp::endpoint m_remoteEndpoint;
-	std::array<char, MAX_PACKET_BYTES> m_recvBuffer;
+	struct Response {
+		std::shared_ptr<MetaServerPacket> packet;
+		boost::asio::ip::udp::endpoint endpoint;
+	};
+
+	struct Listener {
+		explicit Listener(boost::asio::io_context& ios) : socket(ios) {}
+
+		boost::asio::ip::udp::socket socket;
+		boost::asio::ip::udp::endpoint remoteEndpoint;
+		std::array<char, MAX_PACKET_BYTES> recvBuffer{};
+		std::vector<Response> responses;
+#ifdef __linux__
+		std::array<std::array<char, MAX_PACKET_BYTES>, BATCH_SIZE> batchBuffers{};
+		std::array<sockaddr_storage, BATCH_SIZE> batchAddresses{};
+		std::array<iovec, BATCH_SIZE> batchVectors{};
+		std::array<mmsghdr, BATCH_SIZE> batchMessages{};
+#endif
+	};
+
+	void start_receive(Listener& listener);
+
+	void handle_receive(Listener& listener, const boost::system::error_code& error, std::size_t bytes_recvd);
+
+#ifdef __linux__
+	void handle_readable(Listener& listener, const boost::system::error_code& error);
+
+	std::size_t receive_batch(Listener& listener);
+
+	void send_batch(Listener& listener);
+#endif
+
+	/**
+	 * Has the MetaServer process an incoming packet.
+	 * @return The response, or null if there's nothing to send back.
+	 */
+	std::shared_ptr<MetaServerPacket> process_packet(const std::array<char, MAX_PACKET_BYTES>& buffer, std::size_t bytes_recvd,
+													 const boost::asio::ip::udp::endpoint& remoteEndpoint);
+
+	void send_async(Listener& listener, const Response& response);
+
+	std::vector<std::unique_ptr<Listener>> m_listeners;
+	std::shared_ptr<PacketPool> m_packetPool;
 
 	std::unique_ptr<boost::asio::steady_timer> m_outboundTimer;
 	unsigned int m_outboundMaxInterval;
@@ -0,0 +1,60 @@
+/**
+ Worldforge Next Generation MetaServer
+
+ Copyright (C) 2026 Erik Ogenvik
+
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+ */
+
+
+#include "PacketPool.hpp"
+
+PacketPool::PacketPool(std::size_t maxIdle)
+		: m_maxIdle(maxIdle) {
+	m_idle.reserve(maxIdle);
+}
+
+std::shared_ptr<MetaServerPacket>
+PacketPool::acquire() {
+	std::unique_ptr<MetaServerPacket> packet;
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		if (!m_idle.empty()) {
+			packet = std::move(m_idle.back());
+			m_idle.pop_back();
+		}
+	}
+	if (!packet) {
+		packet = std::make_unique<MetaServerPacket>();
+	}
+	return {packet.release(), [pool = shared_from_this()](MetaServerPacket* released) { pool->release(released); }};
+}
+
+std::size_t
+PacketPool::idle() const {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_idle.size();
+}
+
+void
+PacketPool::release(MetaServerPacket* packet) {
+	std::unique_ptr<MetaServerPacket> owned(packet);
+	owned->reset();
+	std::lock_guard<std::mutex> lock(m_mutex);
+	if (m_idle.size() < m_maxIdle) {
+		m_idle.push_back(std::move(owned));
+	}
+}
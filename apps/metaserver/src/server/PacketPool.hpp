@@ -0,0 +1,67 @@
+/**
+ Worldforge Next Generation MetaServer
+
+ Copyright (C) 2026 Erik Ogenvik
+
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+ */
+
+
+#ifndef PACKETPOOL_HPP_
+#define PACKETPOOL_HPP_
+
+/*
+ * Local Includes
+ */
+#include "MetaServerPacket.hpp"
+
+/*
+ * System Includes
+ */
+#include <memory>
+#include <mutex>
+#include <vector>
+
+/**
+ * Keeps packets which are no longer in use, so that they can be handed out again instead of being allocated for
+ * every response.
+ *
+ * Packets are handed out as shared pointers, which return them to the pool when the last reference is dropped. The
+ * pool must be created through std::make_shared, as each packet keeps it alive. It can be used from any thread.
+ */
+class PacketPool : public std::enable_shared_from_this<PacketPool> {
+public:
+	/**
+	 * @param maxIdle The number of unused packets to keep; any more are freed.
+	 */
+	explicit PacketPool(std::size_t maxIdle);
+
+	/**
+	 * @return An empty packet.
+	 */
+	std::shared_ptr<MetaServerPacket> acquire();
+
+	std::size_t idle() const;
+
+private:
+	void release(MetaServerPacket* packet);
+
+	mutable std::mutex m_mutex;
+	std::vector<std::unique_ptr<MetaServerPacket>> m_idle;
+	const std::size_t m_maxIdle;
+};
+
+#endif /* PACKETPOOL_HPP_ */
@@ -0,0 +1,366 @@
+/**
+ Worldforge Next Generation MetaServer
+
+ Copyright (C) 2026 Erik Ogenvik
+
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+ */
+
+#include "SessionStore.hpp"
+
+#include <algorithm>
+#include <boost/algorithm/string.hpp>
+
+namespace {
+auto keyLess = [](const std::pair<AttributeKeys::Key, std::string>& attribute, AttributeKeys::Key key) {
+	return attribute.first < key;
+};
+}
+
+AttributeKeys::Key
+AttributeKeys::intern(const std::string& name) {
+	auto I = m_keys.find(name);
+	if (I != m_keys.end()) {
+		return I->second;
+	}
+	auto key = static_cast<Key>(m_names.size());
+	m_names.push_back(name);
+	m_keys.emplace(name, key);
+	return key;
+}
+
+std::optional<AttributeKeys::Key>
+AttributeKeys::find(const std::string& name) const {
+	auto I = m_keys.find(name);
+	if (I != m_keys.end()) {
+		return I->second;
+	}
+	return std::nullopt;
+}
+
+const std::string&
+AttributeKeys::name(Key key) const {
+	return m_names[key];
+}
+
+SessionStore::SessionStore(bool indexAttributes, const std::set<std::string>& unindexedAttributes)
+		: m_expiryKey(m_keys.intern(expiryAttribute)),
+		  m_indexAttributes(indexAttributes),
+		  m_wheel(wheelSlots),
+		  m_snapshot(std::make_shared<const Snapshot>()) {
+	for (auto& name: unindexedAttributes) {
+		m_unindexedKeys.insert(m_keys.intern(name));
+	}
+}
+
+bool
+SessionStore::touch(const std::string& id, boost::posix_time::ptime now) {
+	bool created = !exists(id);
+	auto& session = obtainSession(id);
+	storeAttribute(id, session, m_expiryKey, boost::posix_time::to_iso_string(now));
+	setTouched(id, session, now);
+	return created;
+}
+
+void
+SessionStore::setAttribute(const std::string& id, const std::string& name, const std::string& value) {
+	auto key = m_keys.intern(name);
+	auto& session = obtainSession(id);
+	storeAttribute(id, session, key, value);
+	if (key == m_expiryKey) {
+		boost::posix_time::ptime touched;
+		try {
+			touched = boost::posix_time::from_iso_string(value);
+		} catch (const std::exception&) {
+		}
+		if (touched.is_special()) {
+			touched = boost::posix_time::microsec_clock::local_time();
+		}
+		setTouched(id, session, touched);
+	}
+}
+
+void
+SessionStore::removeAttribute(const std::string& id, const std::string& name) {
+	auto key = m_keys.find(name);
+	auto I = m_sessions.find(id);
+	if (!key || I == m_sessions.end()) {
+		return;
+	}
+	auto& attributes = *I->second.attributes;
+	auto J = std::lower_bound(attributes.begin(), attributes.end(), *key, keyLess);
+	if (J == attributes.end() || J->first != *key) {
+		return;
+	}
+	if (isIndexed(*key)) {
+		removeFromIndex(*key, J->second, id);
+	}
+	auto updated = std::make_shared<SessionAttributes>(attributes);
+	updated->erase(updated->begin() + (J - attributes.begin()));
+	I->second.attributes = std::move(updated);
+	if (*key != m_expiryKey) {
+		m_snapshotDirty = true;
+	}
+}
+
+const std::string*
+SessionStore::getAttribute(const std::string& id, const std::string& name) const {
+	auto key = m_keys.find(name);
+	auto I = m_sessions.find(id);
+	if (!key || I == m_sessions.end()) {
+		return nullptr;
+	}
+	return findAttribute(*I->second.attributes, *key);
+}
+
+const std::string*
+SessionStore::getAttribute(const Entry& entry, const std::string& name) const {
+	auto key = m_keys.find(name);
+	if (!key) {
+		return nullptr;
+	}
+	return findAttribute(*entry.attributes, *key);
+}
+
+std::map<std::string, std::string>
+SessionStore::getAttributes(const std::string& id) const {
+	std::map<std::string, std::string> attributes;
+	auto I = m_sessions.find(id);
+	if (I != m_sessions.end()) {
+		for (auto& attribute: *I->second.attributes) {
+			attributes.emplace(m_keys.name(attribute.first), attribute.second);
+		}
+	}
+	return attributes;
+}
+
+bool
+SessionStore::exists(const std::string& id) const {
+	return m_sessions.find(id) != m_sessions.end();
+}
+
+bool
+SessionStore::remove(const std::string& id) {
+	auto I = m_sessions.find(id);
+	if (I == m_sessions.end()) {
+		return false;
+	}
+	for (auto& attribute: *I->second.attributes) {
+		if (isIndexed(attribute.first)) {
+			removeFromIndex(attribute.first, attribute.second, id);
+		}
+	}
+	/*
+	 * Any entry in the timing wheel is dropped when its slot is visited.
+	 */
+	m_sessions.erase(I);
+	m_snapshotDirty = true;
+	return true;
+}
+
+std::vector<std::string>
+SessionStore::ids() const {
+	std::vector<std::string> ids;
+	ids.reserve(m_sessions.size());
+	for (auto& entry: m_sessions) {
+		ids.push_back(entry.first);
+	}
+	std::sort(ids.begin(), ids.end());
+	return ids;
+}
+
+std::vector<std::string>
+SessionStore::find(const std::string& name, const std::string& value) const {
+	std::vector<std::string> matched;
+	auto key = m_keys.find(name);
+	if (!key) {
+		return matched;
+	}
+	if (isIndexed(*key)) {
+		auto I = m_index.find(*key);
+		if (I != m_index.end()) {
+			auto J = I->second.find(boost::algorithm::to_lower_copy(value));
+			if (J != I->second.end()) {
+				matched.assign(J->second.begin(), J->second.end());
+			}
+		}
+	} else {
+		for (auto& entry: m_sessions) {
+			auto attribute = findAttribute(*entry.second.attributes, *key);
+			if (attribute && boost::iequals(*attribute, value)) {
+				matched.push_back(entry.first);
+			}
+		}
+	}
+	std::sort(matched.begin(), matched.end());
+	return matched;
+}
+
+std::vector<std::string>
+SessionStore::expire(boost::posix_time::ptime cutoff) {
+	std::vector<std::string> expired;
+	auto cutoffTick = toTick(cutoff);
+	auto lastTick = std::max(m_wheelCursor, cutoffTick);
+	/*
+	 * If more time than the wheel covers has passed, every slot is visited once.
+	 */
+	auto firstTick = m_wheelCursor;
+	if (m_wheelCursor == std::numeric_limits<int64_t>::min() || lastTick - m_wheelCursor >= static_cast<int64_t>(wheelSlots)) {
+		firstTick = lastTick - static_cast<int64_t>(wheelSlots) + 1;
+	}
+
+	for (auto tick = firstTick; tick <= lastTick; ++tick) {
+		auto& slot = m_wheel[static_cast<uint64_t>(tick) % wheelSlots];
+		std::erase_if(slot, [&](const WheelEntry& entry) {
+			auto I = m_sessions.find(entry.id);
+			if (I == m_sessions.end() || I->second.touchedTick != entry.tick) {
+				return true;
+			}
+			/*
+			 * The slot may hold sessions touched later in the cutoff second, or a whole turn of the wheel later.
+			 */
+			if (I->second.touched < cutoff) {
+				expired.push_back(entry.id);
+				remove(entry.id);
+				return true;
+			}
+			return false;
+		});
+	}
+	m_wheelCursor = lastTick;
+	return expired;
+}
+
+void
+SessionStore::publish() {
+	if (!m_snapshotDirty) {
+		return;
+	}
+	auto snapshot = std::make_shared<Snapshot>();
+	snapshot->reserve(m_sessions.size());
+	for (auto& entry: m_sessions) {
+		snapshot->push_back(Entry{entry.first, entry.second.attributes});
+	}
+	std::sort(snapshot->begin(), snapshot->end(), [](const Entry& lhs, const Entry& rhs) { return lhs.id < rhs.id; });
+	std::shared_ptr<const Snapshot> published = std::move(snapshot);
+	{
+		std::lock_guard lock(m_snapshotMutex);
+		//The previous snapshot is released outside the lock, as it may be the last reference.
+		m_snapshot.swap(published);
+	}
+	m_snapshotDirty = false;
+}
+
+SessionStore::Session&
+SessionStore::obtainSession(const std::string& id) {
+	auto result = m_sessions.try_emplace(id);
+	auto& session = result.first->second;
+	if (result.second) {
+		session.attributes = std::make_shared<const SessionAttributes>();
+		setTouched(id, session, boost::posix_time::microsec_clock::local_time());
+		m_snapshotDirty = true;
+	}
+	return session;
+}
+
+void
+SessionStore::storeAttribute(const std::string& id, Session& session, AttributeKeys::Key key, const std::string& value) {
+	auto& attributes = *session.attributes;
+	auto I = std::lower_bound(attributes.begin(), attributes.end(), key, keyLess);
+	bool existed = I != attributes.end() && I->first == key;
+	if (existed && I->second == value) {
+		return;
+	}
+	if (isIndexed(key)) {
+		if (existed) {
+			removeFromIndex(key, I->second, id);
+		}
+		addToIndex(key, value, id);
+	}
+	/*
+	 * Copy on write, since the current attributes might be part of a published snapshot.
+	 */
+	auto updated = std::make_shared<SessionAttributes>(attributes);
+	auto position = updated->begin() + (I - attributes.begin());
+	if (existed) {
+		position->second = value;
+	} else {
+		updated->emplace(position, key, value);
+	}
+	session.attributes = std::move(updated);
+	/*
+	 * The expiry changes whenever a session is refreshed, and isn't needed by readers of the snapshot.
+	 */
+	if (key != m_expiryKey) {
+		m_snapshotDirty = true;
+	}
+}
+
+const std::string*
+SessionStore::findAttribute(const SessionAttributes& attributes, AttributeKeys::Key key) {
+	auto I = std::lower_bound(attributes.begin(), attributes.end(), key, keyLess);
+	if (I != attributes.end() && I->first == key) {
+		return &I->second;
+	}
+	return nullptr;
+}
+
+void
+SessionStore::setTouched(const std::string& id, Session& session, boost::posix_time::ptime touched) {
+	session.touched = touched;
+	auto tick = toTick(touched);
+	if (tick == session.touchedTick) {
+		return;
+	}
+	session.touchedTick = tick;
+	/*
+	 * Slots before the cursor won't be visited again until the wheel turns, so sessions touched in the past
+	 * are placed in the slot of the cursor.
+	 */
+	auto slotTick = std::max(tick, m_wheelCursor);
+	m_wheel[static_cast<uint64_t>(slotTick) % wheelSlots].push_back(WheelEntry{id, tick});
+}
+
+bool
+SessionStore::isIndexed(AttributeKeys::Key key) const {
+	return m_indexAttributes && key != m_expiryKey && m_unindexedKeys.find(key) == m_unindexedKeys.end();
+}
+
+void
+SessionStore::addToIndex(AttributeKeys::Key key, const std::string& value, const std::string& id) {
+	m_index[key][boost::algorithm::to_lower_copy(value)].insert(id);
+}
+
+void
+SessionStore::removeFromIndex(AttributeKeys::Key key, const std::string& value, const std::string& id) {
+	auto I = m_index.find(key);
+	if (I == m_index.end()) {
+		return;
+	}
+	auto J = I->second.find(boost::algorithm::to_lower_copy(value));
+	if (J != I->second.end()) {
+		J->second.erase(id);
+		if (J->second.empty()) {
+			I->second.erase(J);
+		}
+	}
+}
+
+int64_t
+SessionStore::toTick(boost::posix_time::ptime time) {
+	static const boost::posix_time::ptime epoch(boost::gregorian::date(1970, 1, 1));
+	return (time - epoch).total_seconds();
+}
@@ -0,0 +1,226 @@
+/**
+ Worldforge Next Generation MetaServer
+
+ Copyright (C) 2026 Erik Ogenvik
+
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+ */
+
+#ifndef SESSIONSTORE_HPP_
+#define SESSIONSTORE_HPP_
+
+/*
+ * System Includes
+ */
+#include <cstdint>
+#include <deque>
+#include <limits>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+#include <boost/date_time/posix_time/posix_time.hpp>
+
+/**
+ * Interns attribute names, so that sessions can refer to them by small integers.
+ * Names are never removed, as the set of attribute names in use is small.
+ */
+class AttributeKeys {
+public:
+	using Key = uint32_t;
+
+	Key intern(const std::string& name);
+
+	std::optional<Key> find(const std::string& name) const;
+
+	const std::string& name(Key key) const;
+
+private:
+	std::unordered_map<std::string, Key> m_keys;
+	/**
+	 * A deque, so that references to names stay valid when new names are added.
+	 */
+	std::deque<std::string> m_names;
+};
+
+/**
+ * The attributes of a session, sorted by key.
+ */
+using SessionAttributes = std::vector<std::pair<AttributeKeys::Key, std::string>>;
+
+/**
+ * Stores sessions (i.e. servers or clients) and their attributes.
+ *
+ *  - Attribute names are interned.
+ *  - Attribute values are indexed case insensitively, so that sessions can be found by attribute without a scan.
+ *  - The time each session was last touched (its "expiry" attribute) is kept in a timing wheel with one slot per
+ *    second, so that expiring sessions only needs to visit the slots which have passed.
+ *  - An immutable snapshot of all sessions, sorted by id, can be published. Attributes are copied on write, so a
+ *    snapshot can be read while the store is altered.
+ *
+ * All methods except snapshot() must be called from one thread at a time. Snapshots can be read from any thread, as
+ * they are never altered; publish() replaces the current one, and readers keep theirs alive for as long as
+ * they need it.
+ */
+class SessionStore {
+public:
+	struct Entry {
+		std::string id;
+		std::shared_ptr<const SessionAttributes> attributes;
+	};
+	/**
+	 * All sessions, sorted by id.
+	 */
+	using Snapshot = std::vector<Entry>;
+
+	/**
+	 * The attribute which holds the time the session was last touched, as an ISO string.
+	 */
+	static constexpr const char* expiryAttribute = "expiry";
+
+	static constexpr size_t wheelSlots = 1024;
+
+	/**
+	 * @param indexAttributes Whether attributes should be indexed for find().
+	 * @param unindexedAttributes Attributes which shouldn't be indexed, such as those which change often and are never searched for.
+	 */
+	explicit SessionStore(bool indexAttributes, const std::set<std::string>& unindexedAttributes = {});
+
+	/**
+	 * Sets the last touched time of the session, creating it if needed.
+	 * @return True if the session was created.
+	 */
+	bool touch(const std::string& id, boost::posix_time::ptime now);
+
+	/**
+	 * Sets an attribute, creating the session if needed.
+	 * Setting the expiry attribute to a value which isn't a valid ISO time counts as touching it now.
+	 */
+	void setAttribute(const std::string& id, const std::string& name, const std::string& value);
+
+	void removeAttribute(const std::string& id, const std::string& name);
+
+	const std::string* getAttribute(const std::string& id, const std::string& name) const;
+
+	/**
+	 * Finds an attribute in a session from a snapshot.
+	 */
+	const std::string* getAttribute(const Entry& entry, const std::string& name) const;
+
+	std::map<std::string, std::string> getAttributes(const std::string& id) const;
+
+	bool exists(const std::string& id) const;
+
+	bool remove(const std::string& id);
+
+	size_t size() const {
+		return m_sessions.size();
+	}
+
+	/**
+	 * @return The ids of all sessions, sorted.
+	 */
+	std::vector<std::string> ids() const;
+
+	/**
+	 * Finds sessions with an attribute matching the value, ignoring case.
+	 * @return The ids of the sessions, sorted.
+	 */
+	std::vector<std::string> find(const std::string& name, const std::string& value) const;
+
+	/**
+	 * Removes all sessions last touched before the cutoff.
+	 * @return The ids of the removed sessions.
+	 */
+	std::vector<std::string> expire(boost::posix_time::ptime cutoff);
+
+	/**
+	 * Publishes a new snapshot, if anything but the last touched times has changed since the last one.
+	 */
+	void publish();
+
+	std::shared_ptr<const Snapshot> snapshot() const {
+		std::lock_guard lock(m_snapshotMutex);
+		return m_snapshot;
+	}
+
+private:
+	struct Session {
+		std::shared_ptr<const SessionAttributes> attributes;
+		boost::posix_time::ptime touched;
+		/**
+		 * The second in which the session was last touched; identifies the current entry in the timing wheel.
+		 */
+		int64_t touchedTick = std::numeric_limits<int64_t>::min();
+	};
+
+	struct WheelEntry {
+		std::string id;
+		int64_t tick;
+	};
+
+	AttributeKeys m_keys;
+	AttributeKeys::Key m_expiryKey;
+	bool m_indexAttributes;
+	std::unordered_set<AttributeKeys::Key> m_unindexedKeys;
+	std::unordered_map<std::string, Session> m_sessions;
+
+	/**
+	 * Lower case values to the ids of the sessions with those values, per attribute key.
+	 */
+	std::unordered_map<AttributeKeys::Key, std::unordered_map<std::string, std::unordered_set<std::string>>> m_index;
+
+	/**
+	 * Entries are placed in the slot of the second in which their session was touched. Entries for sessions which
+	 * have since been removed or touched again are left in place, and dropped when their slot is visited.
+	 */
+	std::vector<std::vector<WheelEntry>> m_wheel;
+	/**
+	 * All slots before this second have been visited.
+	 */
+	int64_t m_wheelCursor = std::numeric_limits<int64_t>::min();
+
+	/**
+	 * Only guards swapping and copying the pointer, as the snapshots themselves are never altered.
+	 */
+	mutable std::mutex m_snapshotMutex;
+	std::shared_ptr<const Snapshot> m_snapshot;
+	bool m_snapshotDirty = false;
+
+	Session& obtainSession(const std::string& id);
+
+	void storeAttribute(const std::string& id, Session& session, AttributeKeys::Key key, const std::string& value);
+
+	static const std::string* findAttribute(const SessionAttributes& attributes, AttributeKeys::Key key);
+
+	void setTouched(const std::string& id, Session& session, boost::posix_time::ptime touched);
+
+	bool isIndexed(AttributeKeys::Key key) const;
+
+	void addToIndex(AttributeKeys::Key key, const std::string& value, const std::string& id);
+
+	void removeFromIndex(AttributeKeys::Key key, const std::string& value, const std::string& id);
+
+	static int64_t toTick(boost::posix_time::ptime time);
+};
+
+#endif /* SESSIONSTORE_HPP_ */
@@ -22,6 +22,8 @@
 #include "MetaServer.hpp"
 #include <boost/asio/ip/udp.hpp>
 #include <arpa/inet.h>
+#include <chrono>
+#include <thread>
 
 namespace {
 std::string
@@ -30,6 +32,84 @@ IpNetToAscii(uint32_t address) {
 	inet_ntop(AF_INET, &address, chars.data(), INET_ADDRSTRLEN);
 	return {chars.data()};
 }
+
+/**
+ * Simulates many clients sending keepalives at once, as happens when a new release
+ * is announced, and reports how many were answered.
+ *
+ * Every client has its own socket, so that the server sees them as different peers.
+ * Replies are read in between the rounds of sending, so that the clients' own receive
+ * buffers don't overflow and get counted as lost by the server.
+ *
+ * @return True if every keepalive was answered.
+ */
+bool
+runLoadTest(boost::asio::io_context& io_service, const boost::asio::ip::udp::endpoint& server,
+			int clientCount, int packetsPerClient, int timeoutSeconds) {
+	using boost::asio::ip::udp;
+
+	std::vector<std::unique_ptr<udp::socket>> clients;
+	for (int i = 0; i < clientCount; ++i) {
+		clients.emplace_back(std::make_unique<udp::socket>(io_service, udp::endpoint(udp::v4(), 0)));
+		clients.back()->non_blocking(true);
+	}
+
+	MetaServerPacket keep;
+	keep.setPacketType(NMT_CLIENTKEEPALIVE);
+
+	std::array<char, MAX_PACKET_BYTES> recvBuffer{};
+	udp::endpoint sender_endpoint;
+	unsigned long long sent = 0;
+	unsigned long long received = 0;
+
+	auto drain = [&]() {
+		for (auto& client : clients) {
+			boost::system::error_code ec;
+			while (true) {
+				auto bytes_recvd = client->receive_from(boost::asio::buffer(recvBuffer), sender_endpoint, 0, ec);
+				if (ec) {
+					break;
+				}
+				MetaServerPacket shake(recvBuffer, bytes_recvd);
+				if (shake.getPacketType() == NMT_HANDSHAKE) {
+					++received;
+				}
+			}
+		}
+	};
+
+	auto start = std::chrono::steady_clock::now();
+	for (int round = 0; round < packetsPerClient; ++round) {
+		for (auto& client : clients) {
+			boost::system::error_code ec;
+			client->send_to(boost::asio::buffer(keep.getBuffer(), keep.getSize()), server, 0, ec);
+			if (!ec) {
+				++sent;
+			}
+		}
+		drain();
+	}
+	auto sendDone = std::chrono::steady_clock::now();
+
+	auto deadline = sendDone + std::chrono::seconds(timeoutSeconds);
+	while (received < sent && std::chrono::steady_clock::now() < deadline) {
+		drain();
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+	auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	auto sendSeconds = std::chrono::duration<double>(sendDone - start).count();
+
+	std::cout << "Clients      : " << clientCount << std::endl;
+	std::cout << "Sent         : " << sent << " keepalives in " << sendSeconds << "s";
+	if (sendSeconds > 0) {
+		std::cout << " (" << static_cast<unsigned long long>(sent / sendSeconds) << "/s)";
+	}
+	std::cout << std::endl;
+	std::cout << "Answered     : " << received << " in " << elapsed << "s" << std::endl;
+	std::cout << "Lost         : " << (sent - std::min(sent, received)) << std::endl;
+
+	return received >= sent;
+}
 }
 
 
@@ -59,7 +139,9 @@ int main(int argc, char** argv) {
 			("port", boost::program_options::value<int>()->default_value(8453), "MetaServer port. \nDefault:8453")
 			("attribute", boost::program_options::value<attribute_list>(), "Set client attribute.\nDefault: none")
 			("filter", boost::program_options::value<attribute_list>(), "Set client filters.\nDefault: none")
-			("keepalives", boost::program_options::value<int>()->default_value(3), "Number of Keepalives. \nDefault:3");
+			("keepalives", boost::program_options::value<int>()->default_value(3), "Number of Keepalives. \nDefault:3")
+			("load-clients", boost::program_options::value<int>(), "Run a load test instead, with this many simulated clients sending keepalives at once.\nDefault: none")
+			("load-timeout", boost::program_options::value<int>()->default_value(5), "Seconds to wait for the last answers in a load test. \nDefault:5");
 
 	try {
 		boost::program_options::store(
@@ -98,7 +180,15 @@ int main(int argc, char** argv) {
 		boost::asio::ip::udp::resolver resolver(io_service);
 		auto resolver_result = resolver.resolve(boost::asio::ip::udp::v4(), vm["server"].as<std::string>(), std::to_string(vm["port"].as<int>()));
 
-		if (!resolver_result.empty()) {
+		if (!resolver_result.empty() && vm.count("load-clients")) {
+			/**
+			 *  Load test : every client sends as many keepalives as asked for
+			 */
+			auto resolved = *resolver_result.begin();
+			bool answered = runLoadTest(io_service, resolved, std::max(vm["load-clients"].as<int>(), 1),
+										vm["keepalives"].as<int>(), vm["load-timeout"].as<int>());
+			return answered ? 0 : 1;
+		} else if (!resolver_result.empty()) {
 			/**
 			 *  Step 1 : keepalive x3 w/ sleep
 			 */
@@ -31,14 +31,54 @@
  * System Includes
  */
 #include <unistd.h> /* daemon(), getpid() */
+#include <algorithm>
 #include <csignal>
 #include <cstdlib> /* getenv() because boost po env parsing sucks */
 #include <fstream>
 #include <filesystem>
+#include <thread>
+#include <vector>
 #include <MetaServerVersion.hpp>
 #include <boost/exception/all.hpp>
 #include <spdlog/spdlog.h>
 
+/*
+	The async loop, run by every thread. Handlers may run on any of them, so each
+	thread must recover the timers if a handler throws.
+*/
+static void runAsyncLoop(boost::asio::io_context& io_service, MetaServer& ms) {
+	while (!ms.isShutdown()) {
+		spdlog::info("Enter ASYNC loop");
+		try {
+			/*
+			 * We run and complete normally
+			 */
+			io_service.run();
+			break;
+		}
+		catch (const boost::exception& bex) {
+			std::cerr << "Boost Exception :" << std::endl;
+			std::cerr << boost::diagnostic_information(bex) << std::endl;
+			spdlog::error("Boost Exception :");
+			spdlog::error(boost::diagnostic_information(bex));
+			spdlog::error("Calling reinitialisation of the timers");
+			ms.initTimers(io_service);
+		}
+		catch (const ShutdownException& ex) {
+			std::cout << "Shutdown sequence initiated : " << ex.what() << std::endl;
+			spdlog::info("Shutdown sequence initiated : {}", ex.what());
+		}
+		catch (const std::exception& ex) {
+			std::cerr << "IOService Loop Exception:" << ex.what() << std::endl;
+			std::cerr << boost::diagnostic_information(ex) << std::endl;
+			spdlog::error("IOService Loop Exception: {}", ex.what());
+			spdlog::error(boost::diagnostic_information(ex));
+			spdlog::error("Calling reinitialisation of the timers");
+			ms.initTimers(io_service);
+		}
+	}
+}
+
 /*
 	Entry point
 */
@@ -49,6 +89,7 @@ int main(int argc, char** argv) {
 
 	int port = 8453;
 	std::string ip = "0.0.0.0";
+	int threads = 1;
 
 	/**
 	 * Argument Wrangling
@@ -65,6 +106,7 @@ int main(int argc, char** argv) {
 			("help,h", "Display help message")
 			("server.port,p", boost::program_options::value<int>(), "Server bind port. \nDefault:8543")
 			("server.ip", boost::program_options::value<std::string>(), "Server bind IP. \nDefault:0.0.0.0")
+			("server.threads", boost::program_options::value<int>(), "Number of threads handling packets, each with its own socket [1-64].\nDefault: 1")
 			("server.daemon", boost::program_options::value<std::string>(), "Daemonize after startup [true|false].\nDefault: true")
 			("server.logfile", boost::program_options::value<std::string>(), "Server logfile location.\nDefault: logdir/metaserver-ng.log")
 			("server.pidfile", boost::program_options::value<std::string>(), "Server pidfile location.\nDefault: rundir/metaserver-ng.pid")
@@ -235,6 +277,9 @@ int main(int argc, char** argv) {
 		if (vm.count("server.ip"))
 			ip = vm["server.ip"].as<std::string>();
 
+		if (vm.count("server.threads"))
+			threads = std::clamp(vm["server.threads"].as<int>(), 1, 64);
+
 		/**
 		 * Register the configuration.
 		 */
@@ -334,7 +379,7 @@ int main(int argc, char** argv) {
 		 */
 		//MetaServerHandlerUDP tcp(ms, io_service, ip, port);
 		spdlog::trace("Start UPD Handler");
-		MetaServerHandlerUDP udp(ms, io_service, ip, port);
+		MetaServerHandlerUDP udp(ms, io_service, ip, port, static_cast<unsigned int>(threads));
 
 		/*
 		 * Register Timers
@@ -343,37 +388,21 @@ int main(int argc, char** argv) {
 		ms.initTimers(io_service);
 
 		/**
-		 * This is the async loop
+		 * Additional threads share the async loop; the sockets of the UDP handler
+		 * give them something to do each.
 		 */
-		while (!ms.isShutdown()) {
-			spdlog::info("Enter ASYNC loop");
-			try {
-				/*
-				 * We run and complete normally
-				 */
-				io_service.run();
-				break;
-			}
-			catch (const boost::exception& bex) {
-				std::cerr << "Boost Exception :" << std::endl;
-				std::cerr << boost::diagnostic_information(bex) << std::endl;
-				spdlog::error("Boost Exception :");
-				spdlog::error(boost::diagnostic_information(bex));
-				spdlog::error("Calling reinitialisation of the timers");
-				ms.initTimers(io_service);
-			}
-                        catch (const ShutdownException& ex) {
-                                std::cout << "Shutdown sequence initiated : " << ex.what() << std::endl;
-                                spdlog::info("Shutdown sequence initiated : {}", ex.what());
-                        }
-                        catch (const std::exception& ex) {
-                                std::cerr << "IOService Loop Exception:" << ex.what() << std::endl;
-                                std::cerr << boost::diagnostic_information(ex) << std::endl;
-                                spdlog::error("IOService Loop Exception: {}", ex.what());
-                                spdlog::error(boost::diagnostic_information(ex));
-                                spdlog::error("Calling reinitialisation of the timers");
-                                ms.initTimers(io_service);
-                        }
+		std::vector<std::thread> workers;
+		for (int i = 1; i < threads; ++i) {
+			workers.emplace_back([&io_service, &ms]() {
+				runAsyncLoop(io_service, ms);
+			});
+		}
+
+		runAsyncLoop(io_service, ms);
+
+                io_service.stop();
+                for (auto& worker : workers) {
+                        worker.join();
                 }
                 spdlog::info("Shutting Down Metaserver");
 
@@ -51,6 +51,7 @@ CPPUNIT_TEST_SUITE(DataObject_unittest);
                 CPPUNIT_TEST(test_ServerSessionSorting);
                CPPUNIT_TEST(test_ServerSessionFilteringAndSorting);
                 CPPUNIT_TEST(test_MalformedExpiry);
+                CPPUNIT_TEST(test_ServerSessionPage);
 
 
         CPPUNIT_TEST_SUITE_END();
@@ -382,6 +383,33 @@ public:
                 CPPUNIT_ASSERT(msdo->getServerAttribute(sid, "expiry") == et);
         }
 
+        void test_ServerSessionPage() {
+                msdo->addServerSession("server1");
+                msdo->addServerAttribute("server1", "ip_int", "1");
+                msdo->addServerSession("server2");
+                msdo->addServerAttribute("server2", "ip_int", "2");
+                msdo->addServerSession("server3");
+
+                ServerSessionPage first = msdo->getServerSessionPage(0, 2);
+                CPPUNIT_ASSERT(first.entries.size() == 2);
+                CPPUNIT_ASSERT(first.entries[0].id == "server1");
+                CPPUNIT_ASSERT(msdo->getServerAttribute(first.entries[1], "ip_int") == "2");
+
+                ServerSessionPage second = msdo->getServerSessionPage(2, 2);
+                CPPUNIT_ASSERT(second.entries.size() == 1);
+                CPPUNIT_ASSERT(second.entries[0].id == "server3");
+                CPPUNIT_ASSERT(msdo->getServerSessionPage(3, 2).entries.empty());
+
+                // Without filters the list is shared rather than copied, until a server changes.
+                msdo->addServerSession("server1");
+                CPPUNIT_ASSERT(msdo->getServerSessionPage(0, 2).list == first.list);
+                msdo->addServerAttribute("server1", "ip_int", "3");
+                CPPUNIT_ASSERT(msdo->getServerSessionPage(0, 2).list != first.list);
+
+                // The earlier page is unaffected.
+                CPPUNIT_ASSERT(msdo->getServerAttribute(first.entries[0], "ip_int") == "1");
+        }
+
 };
 
 
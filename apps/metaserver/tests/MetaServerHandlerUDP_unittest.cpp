@@ -48,6 +48,9 @@ class MetaServerHandlerUDP_unittest : public CppUnit::TestCase {
 CPPUNIT_TEST_SUITE(MetaServerHandlerUDP_unittest);
                 CPPUNIT_TEST(testConstructor);
                 CPPUNIT_TEST(testResponseLifetime);
+                CPPUNIT_TEST(testBurst);
+                CPPUNIT_TEST(testMultipleSockets);
+                CPPUNIT_TEST(testPacketPool);
                 CPPUNIT_TEST(testProcessOutboundAbort);
                 CPPUNIT_TEST(testProcessOutboundRetry);
         CPPUNIT_TEST_SUITE_END();
@@ -98,6 +101,93 @@ public:
                 CPPUNIT_ASSERT_EQUAL(NMT_HANDSHAKE, rsp.getPacketType());
         }
 
+        void testBurst() {
+                using boost::asio::ip::udp;
+                udp::socket client(io, udp::endpoint(udp::v4(), 0));
+                udp::endpoint server(boost::asio::ip::make_address(host), 50000);
+
+                /*
+                 * More than fits in one batch, all sent before the handler gets to run.
+                 */
+                const size_t count = MetaServerHandlerUDP::BATCH_SIZE * 3 + 5;
+                MetaServerPacket req;
+                req.setPacketType(NMT_SERVERKEEPALIVE);
+                for (size_t i = 0; i < count; ++i) {
+                        client.send_to(boost::asio::buffer(req.getBuffer(), req.getSize()), server);
+                }
+                io.poll();
+
+                std::array<char, MAX_PACKET_BYTES> reply{};
+                udp::endpoint sender;
+                for (size_t i = 0; i < count; ++i) {
+                        auto len = client.receive_from(boost::asio::buffer(reply), sender);
+                        MetaServerPacket rsp(reply, len);
+                        CPPUNIT_ASSERT_EQUAL(NMT_HANDSHAKE, rsp.getPacketType());
+                }
+                CPPUNIT_ASSERT_EQUAL(size_t(0), client.available());
+        }
+
+        void testMultipleSockets() {
+                using boost::asio::ip::udp;
+                MetaServerHandlerUDP multi(*ms, io, host, 50001, 4);
+#ifdef __linux__
+                CPPUNIT_ASSERT_EQUAL(size_t(4), multi.getSocketCount());
+#else
+                CPPUNIT_ASSERT_EQUAL(size_t(1), multi.getSocketCount());
+#endif
+
+                /*
+                 * Packets from different clients may end up on different sockets, but all must be answered.
+                 */
+                std::vector<std::unique_ptr<udp::socket>> clients;
+                udp::endpoint server(boost::asio::ip::make_address(host), 50001);
+                MetaServerPacket req;
+                req.setPacketType(NMT_SERVERKEEPALIVE);
+                for (int i = 0; i < 8; ++i) {
+                        clients.emplace_back(std::make_unique<udp::socket>(io, udp::endpoint(udp::v4(), 0)));
+                        clients.back()->send_to(boost::asio::buffer(req.getBuffer(), req.getSize()), server);
+                }
+                io.poll();
+
+                for (auto& client: clients) {
+                        std::array<char, MAX_PACKET_BYTES> reply{};
+                        udp::endpoint sender;
+                        auto len = client->receive_from(boost::asio::buffer(reply), sender);
+                        MetaServerPacket rsp(reply, len);
+                        CPPUNIT_ASSERT_EQUAL(NMT_HANDSHAKE, rsp.getPacketType());
+                        CPPUNIT_ASSERT_EQUAL(50001, static_cast<int>(sender.port()));
+                }
+        }
+
+        void testPacketPool() {
+                auto pool = std::make_shared<PacketPool>(1);
+                MetaServerPacket* first;
+                {
+                        auto packet = pool->acquire();
+                        first = packet.get();
+                        packet->setPacketType(NMT_HANDSHAKE);
+                        packet->addPacketData(12);
+                        CPPUNIT_ASSERT_EQUAL(size_t(0), pool->idle());
+                }
+                CPPUNIT_ASSERT_EQUAL(size_t(1), pool->idle());
+
+                /*
+                 * A returned packet is reused, and is empty again.
+                 */
+                auto reused = pool->acquire();
+                CPPUNIT_ASSERT(reused.get() == first);
+                CPPUNIT_ASSERT_EQUAL(size_t(0), reused->getSize());
+                CPPUNIT_ASSERT_EQUAL(NMT_NULL, reused->getPacketType());
+
+                /*
+                 * Only as many as asked for are kept.
+                 */
+                auto other = pool->acquire();
+                reused.reset();
+                other.reset();
+                CPPUNIT_ASSERT_EQUAL(size_t(1), pool->idle());
+        }
+
         void testProcessOutboundAbort() {
                 CPPUNIT_ASSERT_EQUAL(0UL, ms_udp->getOutboundTick());
                 boost::system::error_code ec = boost::asio::error::operation_aborted;
@@ -167,7 +257,9 @@ void MetaServer::processMetaserverPacket(MetaServerPacket&, MetaServerPacket& rs
         rsp.addPacketData(0);
 }
 
-DataObject::DataObject() {
+DataObject::DataObject()
+		: m_servers(true),
+		  m_clients(false) {
 
 }
 
@@ -0,0 +1,169 @@
+/**
+ Worldforge Next Generation MetaServer
+
+ Copyright (C) 2026 Erik Ogenvik
+
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+ */
+
+#include "SessionStore.hpp"
+
+#include <cppunit/TestCase.h>
+#include <cppunit/TestRunner.h>
+#include <cppunit/TextTestRunner.h>
+#include <cppunit/extensions/HelperMacros.h>
+#include <cppunit/extensions/TestFactoryRegistry.h>
+
+#include <algorithm>
+
+class SessionStore_unittest : public CppUnit::TestFixture {
+CPPUNIT_TEST_SUITE(SessionStore_unittest);
+		CPPUNIT_TEST(test_Attributes);
+		CPPUNIT_TEST(test_Find);
+		CPPUNIT_TEST(test_Expire);
+		CPPUNIT_TEST(test_ExpireAfterWheelTurn);
+		CPPUNIT_TEST(test_Snapshot);
+	CPPUNIT_TEST_SUITE_END();
+
+	boost::posix_time::ptime start = boost::posix_time::from_iso_string("20260101T120000");
+
+public:
+
+	void test_Attributes() {
+		SessionStore store(true);
+		CPPUNIT_ASSERT(store.touch("a", start) == true);
+		CPPUNIT_ASSERT(store.touch("a", start) == false);
+		store.setAttribute("a", "name", "first");
+		CPPUNIT_ASSERT(*store.getAttribute("a", "name") == "first");
+		CPPUNIT_ASSERT(*store.getAttribute("a", "expiry") == "20260101T120000");
+		CPPUNIT_ASSERT(store.getAttribute("a", "missing") == nullptr);
+		CPPUNIT_ASSERT(store.getAttribute("b", "name") == nullptr);
+
+		auto attributes = store.getAttributes("a");
+		CPPUNIT_ASSERT(attributes.size() == 2);
+		CPPUNIT_ASSERT(attributes["name"] == "first");
+
+		store.removeAttribute("a", "name");
+		CPPUNIT_ASSERT(store.getAttribute("a", "name") == nullptr);
+
+		CPPUNIT_ASSERT(store.remove("a") == true);
+		CPPUNIT_ASSERT(store.remove("a") == false);
+		CPPUNIT_ASSERT(store.size() == 0);
+	}
+
+	void test_Find() {
+		SessionStore indexed(true, {"latency"});
+		SessionStore unindexed(false);
+		for (auto store: {&indexed, &unindexed}) {
+			store->setAttribute("a", "name", "Server");
+			store->setAttribute("b", "name", "server");
+			store->setAttribute("c", "name", "other");
+			store->setAttribute("c", "latency", "10");
+
+			CPPUNIT_ASSERT(store->find("name", "SERVER") == std::vector<std::string>({"a", "b"}));
+			CPPUNIT_ASSERT(store->find("latency", "10") == std::vector<std::string>({"c"}));
+			CPPUNIT_ASSERT(store->find("missing", "10").empty());
+
+			store->setAttribute("b", "name", "renamed");
+			CPPUNIT_ASSERT(store->find("name", "server") == std::vector<std::string>({"a"}));
+			store->remove("a");
+			CPPUNIT_ASSERT(store->find("name", "server").empty());
+		}
+	}
+
+	void test_Expire() {
+		SessionStore store(false);
+		store.touch("a", start);
+		store.touch("b", start + boost::posix_time::seconds(10));
+		store.touch("c", start + boost::posix_time::seconds(20));
+
+		CPPUNIT_ASSERT(store.expire(start).empty());
+
+		auto expired = store.expire(start + boost::posix_time::seconds(15));
+		std::sort(expired.begin(), expired.end());
+		CPPUNIT_ASSERT(expired == std::vector<std::string>({"a", "b"}));
+		CPPUNIT_ASSERT(store.exists("c"));
+
+		// Touching it again should move it forward, leaving the old entry behind.
+		store.touch("c", start + boost::posix_time::seconds(100));
+		CPPUNIT_ASSERT(store.expire(start + boost::posix_time::seconds(50)).empty());
+
+		// A session touched in the past should still be found.
+		store.setAttribute("d", "expiry", "20260101T115000");
+		CPPUNIT_ASSERT(store.expire(start + boost::posix_time::seconds(51)) == std::vector<std::string>({"d"}));
+
+		// An invalid expiry counts as being touched now.
+		store.setAttribute("e", "expiry", "not-a-date");
+		CPPUNIT_ASSERT(store.expire(start + boost::posix_time::seconds(52)).empty());
+
+		CPPUNIT_ASSERT(store.expire(start + boost::posix_time::seconds(101)) == std::vector<std::string>({"c"}));
+	}
+
+	void test_ExpireAfterWheelTurn() {
+		SessionStore store(false);
+		auto wheelTurn = boost::posix_time::seconds(SessionStore::wheelSlots);
+		store.touch("a", start);
+		store.touch("b", start + wheelTurn);
+		CPPUNIT_ASSERT(store.expire(start).empty());
+
+		// Both sessions share a slot, but only the first has expired.
+		CPPUNIT_ASSERT(store.expire(start + boost::posix_time::seconds(1)) == std::vector<std::string>({"a"}));
+		CPPUNIT_ASSERT(store.expire(start + wheelTurn * 3) == std::vector<std::string>({"b"}));
+	}
+
+	void test_Snapshot() {
+		SessionStore store(true);
+		store.setAttribute("b", "name", "second");
+		store.setAttribute("a", "name", "first");
+		CPPUNIT_ASSERT(store.snapshot()->empty());
+
+		store.publish();
+		auto snapshot = store.snapshot();
+		CPPUNIT_ASSERT(snapshot->size() == 2);
+		CPPUNIT_ASSERT(snapshot->front().id == "a");
+		CPPUNIT_ASSERT(*store.getAttribute(snapshot->front(), "name") == "first");
+
+		// Touching doesn't require a new snapshot.
+		store.touch("a", start);
+		store.publish();
+		CPPUNIT_ASSERT(store.snapshot() == snapshot);
+
+		// The published snapshot isn't affected by changes.
+		store.setAttribute("a", "name", "altered");
+		store.remove("b");
+		CPPUNIT_ASSERT(*store.getAttribute(snapshot->front(), "name") == "first");
+		CPPUNIT_ASSERT(snapshot->size() == 2);
+
+		store.publish();
+		CPPUNIT_ASSERT(store.snapshot()->size() == 1);
+		CPPUNIT_ASSERT(*store.getAttribute(store.snapshot()->front(), "name") == "altered");
+	}
+
+};
+
+
+CPPUNIT_TEST_SUITE_REGISTRATION(SessionStore_unittest);
+
+
+int main() {
+	CppUnit::TextTestRunner runner;
+	runner.addTest(CppUnit::TestFactoryRegistry::getRegistry().makeTest());
+	if (runner.run()) {
+		return 0;
+	} else {
+		return 1;
+	}
+}
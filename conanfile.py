@@ -81,6 +81,7 @@ class Worldforge(ConanFile):
 
         self.requires("zlib/[>=1.3.1 <2.0]")
         self.requires("bzip2/[>=1.0.8 <2.0]")
+        self.requires("zstd/[>=1.5.5 <2.0]")
 
         if self.options.with_client or self.options.with_server:
             self.requires("bullet3/[>=2.89 <3.0]")
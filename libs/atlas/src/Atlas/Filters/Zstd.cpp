@@ -0,0 +1,108 @@
+// This file may be redistributed and modified only under the terms of
+// the GNU Lesser General Public License (See COPYING for details).
+// Copyright (C) 2025 Erik Ogenvik
+
+#if defined(HAVE_ZSTD_H)
+
+#include <Atlas/Filters/Zstd.h>
+#include <stdexcept>
+
+using Atlas::Filters::Zstd;
+
+/**
+ * Limit the window so that each connection doesn't require too much memory.
+ */
+constexpr auto WINDOW_LOG = 17;
+
+Zstd::Zstd(int compressionLevel) : outgoing(nullptr), incoming(nullptr), level(compressionLevel), outgoingBuf{}, incomingBuf{} {
+}
+
+Zstd::~Zstd() {
+	end();
+}
+
+void Zstd::begin() {
+	end();
+	outgoing = ZSTD_createCCtx();
+	incoming = ZSTD_createDCtx();
+	if (!outgoing || !incoming) {
+		end();
+		throw std::runtime_error("Could not create zstd contexts");
+	}
+
+	ZSTD_CCtx_setParameter(outgoing, ZSTD_c_compressionLevel, level);
+	ZSTD_CCtx_setParameter(outgoing, ZSTD_c_windowLog, WINDOW_LOG);
+	ZSTD_CCtx_loadDictionary(outgoing, dictionary().data(), dictionary().size());
+	ZSTD_DCtx_loadDictionary(incoming, dictionary().data(), dictionary().size());
+}
+
+void Zstd::end() {
+	ZSTD_freeCCtx(outgoing);
+	outgoing = nullptr;
+	ZSTD_freeDCtx(incoming);
+	incoming = nullptr;
+}
+
+std::string Zstd::encode(const std::string& data) {
+	if (!outgoing) {
+		throw std::runtime_error("Zstd filter not started");
+	}
+	std::string out_string;
+
+	ZSTD_inBuffer input{data.data(), data.size(), 0};
+	size_t remaining;
+	do {
+		ZSTD_outBuffer output{outgoingBuf.data(), outgoingBuf.size(), 0};
+		//Flush at the end of each call, so that the other end can decode everything we've got so far.
+		remaining = ZSTD_compressStream2(outgoing, &output, &input, ZSTD_e_flush);
+		if (ZSTD_isError(remaining)) {
+			throw std::runtime_error(std::string("ZSTD_compressStream2 failed: ") + ZSTD_getErrorName(remaining));
+		}
+		out_string.append(outgoingBuf.data(), output.pos);
+	} while (remaining != 0);
+
+	return out_string;
+}
+
+std::string Zstd::decode(const std::string& data) {
+	if (!incoming) {
+		throw std::runtime_error("Zstd filter not started");
+	}
+	std::string out_string;
+
+	ZSTD_inBuffer input{data.data(), data.size(), 0};
+	bool outputFull;
+	do {
+		ZSTD_outBuffer output{incomingBuf.data(), incomingBuf.size(), 0};
+		auto result = ZSTD_decompressStream(incoming, &output, &input);
+		if (ZSTD_isError(result)) {
+			throw std::runtime_error(std::string("ZSTD_decompressStream failed: ") + ZSTD_getErrorName(result));
+		}
+		out_string.append(incomingBuf.data(), output.pos);
+		//If the output buffer was filled there might be more data buffered inside the context.
+		outputFull = output.pos == output.size;
+	} while (input.pos < input.size || outputFull);
+
+	return out_string;
+}
+
+const std::string& Zstd::dictionary() {
+	//Fragments are ordered from least to most common, since zstd favours matches closer to the end of the dictionary.
+	static const std::string dictionary = [] {
+		std::string content;
+		for (auto fragment: {"$name=", "(contains=(", "#mass=", "#scale=(", "$mode=",
+							 "[$name=", "#future_seconds=", "$parent=imaginary", "$parent=talk", "$parent=sound",
+							 "$parent=appearance", "$parent=disappearance", "$parent=delete", "$parent=create",
+							 "$parent=unseen", "$parent=look", "$parent=tick", "$parent=info", "$parent=error",
+							 "$parent=thing", "$parent=set", "(orientation=#", "(velocity=#", "(angular=#",
+							 "#stamp=", "$loc=", "(pos=#", "$parent=move", "$parent=sight",
+							 "@refno=", "@serialno=", "$objtype=obj", "$id=", "$to=", "$from=",
+							 "#seconds=", "(args=[", "[$objtype=op"}) {
+			content += fragment;
+		}
+		return content;
+	}();
+	return dictionary;
+}
+
+#endif // HAVE_ZSTD_H
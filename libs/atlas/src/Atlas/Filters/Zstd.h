@@ -0,0 +1,69 @@
+// This file may be redistributed and modified only under the terms of
+// the GNU Lesser General Public License (See COPYING for details).
+// Copyright (C) 2025 Erik Ogenvik
+
+#ifndef ATLAS_FILTERS_ZSTD_H
+#define ATLAS_FILTERS_ZSTD_H
+
+#include <Atlas/Filter.h>
+
+#include <zstd.h>
+#include <array>
+
+
+namespace Atlas::Filters {
+
+/**
+ * A fast streaming compression filter, suitable for live connections.
+ *
+ * Each call to "encode" flushes the compressed stream, so that all data passed in so far
+ * can be decoded by the other end. It's therefore best to call it once per sent frame
+ * rather than once per op.
+ *
+ * Both ends are primed with a dictionary containing common Atlas attribute names, which
+ * makes compression of small ops much more effective.
+ */
+class Zstd : public Filter {
+	ZSTD_CCtx* outgoing;
+	ZSTD_DCtx* incoming;
+	int level;
+	/**
+	 * Separate buffers for each direction, since encoding and decoding may happen on different threads.
+	 */
+	std::array<char, 4096> outgoingBuf;
+	std::array<char, 4096> incomingBuf;
+
+public:
+
+	/**
+	 * The name used when negotiating this filter. If the dictionary is ever changed the name must be changed too.
+	 */
+	static constexpr auto NAME = "Zstd";
+
+	/**
+	 * @param compressionLevel The zstd compression level. Lower values are faster.
+	 */
+	explicit Zstd(int compressionLevel = 1);
+
+	~Zstd() override;
+
+	void begin() override;
+
+	void end() override;
+
+	std::string encode(const std::string&) override;
+
+	std::string decode(const std::string&) override;
+
+	/**
+	 * Gets the dictionary used to prime both ends of the stream.
+	 *
+	 * This is built from fragments of ops as encoded by the Packed codec.
+	 */
+	static const std::string& dictionary();
+};
+
+}
+// namespace Atlas::Filters
+
+#endif // ATLAS_FILTERS_ZSTD_H
@@ -15,6 +15,8 @@ class Bridge;
 
 class Codec;
 
+class Filter;
+
 /** Negotiation of codecs and filters for an Atlas connection
 
 non blocking negotiation of Codecs and Filters
@@ -40,6 +42,17 @@ public:
 
 	virtual std::unique_ptr<Codec> getCodec(Bridge&) = 0;
 
+	/**
+	 * Gets the filter which was negotiated, if any.
+	 *
+	 * Any filter must be applied to all data following the negotiation, and sit between the codec and the socket.
+	 * The caller is responsible for calling "begin" on it.
+	 * @return A filter, or null if none was negotiated.
+	 */
+	virtual std::unique_ptr<Filter> getFilter() {
+		return nullptr;
+	}
+
 	virtual void poll() = 0;
 };
 
@@ -10,6 +10,10 @@
 #include <Atlas/Codecs/Packed.h>
 #include <Atlas/Codecs/Bach.h>
 
+#if defined(HAVE_ZSTD_H)
+#include <Atlas/Filters/Zstd.h>
+#endif
+
 #include <iostream>
 #include <memory>
 
@@ -34,6 +38,19 @@ static inline std::string get_line(std::string& s1, char ch, std::string& s2) {
 	return s2;
 }
 
+/**
+ * Reads from the stream until the end of the negotiation (an empty line) has been found.
+ * Anything after that belongs to the codec, or the filter, and must be left in the stream.
+ */
+static void read_negotiation(std::istream& stream, std::string& buf, bool& inputComplete, char& lastChar) {
+	while (!inputComplete && stream.rdbuf()->in_avail() > 0) {
+		auto c = (char) stream.rdbuf()->sbumpc();
+		buf += c;
+		inputComplete = c == '\n' && lastChar == '\n';
+		lastChar = c;
+	}
+}
+
 namespace Atlas::Net {
 
 NegotiateHelper::NegotiateHelper(std::list<std::string>& names) :
@@ -62,7 +79,7 @@ bool NegotiateHelper::get(std::string& buf, const std::string& header) const {
 	return false;
 }
 
-void NegotiateHelper::put(std::string& buf, const std::string& header) {
+void NegotiateHelper::put(std::string& buf, const std::string& header, bool withFilters) {
 	buf.erase();
 
 	buf += header;
@@ -74,11 +91,20 @@ void NegotiateHelper::put(std::string& buf, const std::string& header) {
 	buf += header;
 	buf += " Bach\n";
 
-	buf += header;
-	buf += " Gzip\n";
+	if (withFilters) {
+		buf += header;
+		buf += " Gzip\n";
 
-	buf += header;
-	buf += " Bzip2\n";
+		buf += header;
+		buf += " Bzip2\n";
+
+#if defined(HAVE_ZSTD_H)
+		buf += header;
+		buf += " ";
+		buf += Atlas::Filters::Zstd::NAME;
+		buf += "\n";
+#endif
+	}
 
 	buf += "\n";
 }
@@ -86,18 +112,14 @@ void NegotiateHelper::put(std::string& buf, const std::string& header) {
 StreamConnect::StreamConnect(std::string name, std::istream& inStream, std::ostream& outStream) :
 		m_state(SERVER_GREETING), m_outName(std::move(name)), m_inStream(inStream), m_outStream(outStream),
 		m_codecHelper(m_inCodecs), m_filterHelper(m_inFilters),
-		m_canPacked(true), m_canXML(true), m_canBach(true), m_canGzip(true), m_canBzip2(true) {
+		m_canPacked(true), m_canXML(true), m_canBach(true), m_canGzip(true), m_canBzip2(true),
+		m_filtersEnabled(true), m_useZstd(false), m_inputComplete(false), m_lastChar(0) {
 }
 
 void StreamConnect::poll() {
 	Debug(std::cout << "** Client(" << m_state << ") : " << m_inStream.rdbuf()->in_avail() << std::endl;)
 
-	std::streamsize count;
-	while ((count = m_inStream.rdbuf()->in_avail()) > 0) {
-		for (int i = 0; i < count; ++i) {
-			m_buf += (char) m_inStream.rdbuf()->sbumpc();
-		}
-	}
+	read_negotiation(m_inStream, m_buf, m_inputComplete, m_lastChar);
 
 	if (m_state == SERVER_GREETING) {
 		// get server greeting
@@ -118,7 +140,7 @@ void StreamConnect::poll() {
 	if (m_state == CLIENT_CODECS) {
 		std::string out;
 		//processClientCodecs();
-		m_codecHelper.put(out, "ICAN");
+		m_codecHelper.put(out, "ICAN", m_filtersEnabled);
 		m_outStream << out << std::flush;
 		m_state = SERVER_CODECS;
 	}
@@ -168,11 +190,22 @@ std::unique_ptr<Atlas::Codec> StreamConnect::getCodec(Atlas::Bridge& bridge) {
 	return {};
 }
 
+std::unique_ptr<Atlas::Filter> StreamConnect::getFilter() {
+#if defined(HAVE_ZSTD_H)
+	if (m_useZstd) { return std::make_unique<Atlas::Filters::Zstd>(); }
+#endif
+	return nullptr;
+}
+
 void StreamConnect::processServerCodecs() {
 	for (auto& codec: m_inCodecs) {
 		if (codec == "XML") { m_canXML = true; }
 		if (codec == "Packed") { m_canPacked = true; }
 		if (codec == "Bach") { m_canBach = true; }
+		//The server tells us about any filter to use in the same list as the codec.
+#if defined(HAVE_ZSTD_H)
+		if (codec == Atlas::Filters::Zstd::NAME && m_filtersEnabled) { m_useZstd = true; }
+#endif
 	}
 }
 
@@ -217,7 +250,11 @@ StreamAccept::StreamAccept(std::string name, std::istream& inStream, std::ostrea
 		m_canXML(false),
 		m_canBach(false),
 		m_canGzip(false),
-		m_canBzip2(false) {
+		m_canBzip2(false),
+		m_canZstd(false),
+		m_filtersEnabled(true),
+		m_inputComplete(false),
+		m_lastChar(0) {
 }
 
 void StreamAccept::poll() {
@@ -231,12 +268,7 @@ void StreamAccept::poll() {
 		Debug(std::cout << "server now in state " << m_state << std::endl;)
 	}
 
-	std::streamsize count;
-	while ((count = m_inStream.rdbuf()->in_avail()) > 0) {
-		for (int i = 0; i < count; ++i) {
-			m_buf += (char) m_inStream.rdbuf()->sbumpc();
-		}
-	}
+	read_negotiation(m_inStream, m_buf, m_inputComplete, m_lastChar);
 
 	if (m_state == CLIENT_GREETING) {
 		// get client greeting
@@ -258,6 +290,10 @@ void StreamAccept::poll() {
 		if (m_canPacked) { m_outStream << "IWILL Packed\n"; }
 		else if (m_canXML) { m_outStream << "IWILL XML\n"; }
 		else if (m_canBach) { m_outStream << "IWILL Bach\n"; }
+		//Old clients ignore any filter names, but will only have offered filters they support.
+#if defined(HAVE_ZSTD_H)
+		if (m_canZstd) { m_outStream << "IWILL " << Atlas::Filters::Zstd::NAME << "\n"; }
+#endif
 		m_outStream << std::endl;
 
 		m_state = DONE;
@@ -312,6 +348,13 @@ std::unique_ptr<Atlas::Codec> StreamAccept::getCodec(Atlas::Bridge& bridge) {
 	return nullptr;
 }
 
+std::unique_ptr<Atlas::Filter> StreamAccept::getFilter() {
+#if defined(HAVE_ZSTD_H)
+	if (m_canZstd) { return std::make_unique<Atlas::Filters::Zstd>(); }
+#endif
+	return nullptr;
+}
+
 #if 0
 void StreamAccept::processServerCodecs()
 {
@@ -358,6 +401,10 @@ void StreamAccept::processClientCodecs() {
 		if (codec == "XML") { m_canXML = true; }
 		if (codec == "Packed") { m_canPacked = true; }
 		if (codec == "Bach") { m_canBach = true; }
+		//Filters are offered in the same list as the codecs.
+#if defined(HAVE_ZSTD_H)
+		if (codec == Atlas::Filters::Zstd::NAME && m_filtersEnabled) { m_canZstd = true; }
+#endif
 	}
 }
 
@@ -41,7 +41,7 @@ public:
 
 	bool get(std::string& buf, const std::string& header) const;
 
-	void put(std::string& buf, const std::string& header);
+	void put(std::string& buf, const std::string& header, bool withFilters = true);
 
 private:
 
@@ -69,6 +69,17 @@ public:
 
 	std::unique_ptr<Atlas::Codec> getCodec(Atlas::Bridge&) override;
 
+	std::unique_ptr<Atlas::Filter> getFilter() override;
+
+	/**
+	 * Sets whether any filters should be offered to the server. This is enabled by default.
+	 * It makes sense to disable this for local connections, where compression only wastes cycles.
+	 * Must be called before negotiation starts.
+	 */
+	void setFiltersEnabled(bool enabled) {
+		m_filtersEnabled = enabled;
+	}
+
 private:
 
 	enum {
@@ -107,6 +118,13 @@ private:
 
 	bool m_canGzip;
 	bool m_canBzip2;
+
+	bool m_filtersEnabled;
+	/// True if the server has told us that it will use the Zstd filter.
+	bool m_useZstd;
+	/// Set when the end of the negotiation has been read, after which no more data should be consumed.
+	bool m_inputComplete;
+	char m_lastChar;
 };
 
 /// Negotiation of servers accepting a connection from a remote system.
@@ -130,6 +148,16 @@ public:
 
 	std::unique_ptr<Atlas::Codec> getCodec(Atlas::Bridge&) override;
 
+	std::unique_ptr<Atlas::Filter> getFilter() override;
+
+	/**
+	 * Sets whether any filters offered by the client should be accepted. This is enabled by default.
+	 * Must be called before negotiation starts.
+	 */
+	void setFiltersEnabled(bool enabled) {
+		m_filtersEnabled = enabled;
+	}
+
 private:
 
 	enum {
@@ -168,6 +196,12 @@ private:
 
 	bool m_canGzip;
 	bool m_canBzip2;
+	bool m_canZstd;
+
+	bool m_filtersEnabled;
+	/// Set when the end of the negotiation has been read, after which no more data should be consumed.
+	bool m_inputComplete;
+	char m_lastChar;
 };
 
 }
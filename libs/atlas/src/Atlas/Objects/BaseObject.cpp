@@ -23,6 +23,25 @@ BaseObjectData::BaseObjectData(BaseObjectData* defaults) :
 	}
 }
 
+BaseObjectData::BaseObjectData(const BaseObjectData& rhs) :
+		m_class_no(rhs.m_class_no),
+		m_refCount(0),
+		m_defaults(rhs.m_defaults),
+		m_next(nullptr),
+		m_attributes(rhs.m_attributes),
+		m_attrFlags(rhs.m_attrFlags) {
+}
+
+BaseObjectData& BaseObjectData::operator=(const BaseObjectData& rhs) {
+	if (this != &rhs) {
+		m_class_no = rhs.m_class_no;
+		m_defaults = rhs.m_defaults;
+		m_attributes = rhs.m_attributes;
+		m_attrFlags = rhs.m_attrFlags;
+	}
+	return *this;
+}
+
 BaseObjectData::~BaseObjectData() {
 	assert(m_refCount == 0);
 }
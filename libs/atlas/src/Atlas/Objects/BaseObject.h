@@ -18,6 +18,7 @@
 
 #include <cassert>
 #include <mutex>
+#include <atomic>
 #include <utility>
 
 
@@ -252,6 +253,12 @@ public:
 	/// must pass in a pointer to their class specific reference object.
 	explicit BaseObjectData(BaseObjectData* defaults);
 
+	/// Copies all attributes, but not the reference count.
+	BaseObjectData(const BaseObjectData& rhs);
+
+	/// Copies all attributes, but not the reference count.
+	BaseObjectData& operator=(const BaseObjectData& rhs);
+
 	virtual ~BaseObjectData();
 
 	/// Get class number:
@@ -339,7 +346,11 @@ protected:
 							 const Atlas::Objects::Factories* factories);
 
 	int m_class_no; //each class has different enum
-	int m_refCount; //how many instances
+	/**
+	 * How many instances. This is atomic so that objects which no longer are altered (such as ops
+	 * which have been sent) can be shared between threads.
+	 */
+	std::atomic<int> m_refCount;
 
 	/**
 	 * The default instance, acting as a prototype for all other instances.
@@ -356,17 +367,17 @@ protected:
 };
 
 inline void BaseObjectData::incRef() {
-	m_refCount++;
+	m_refCount.fetch_add(1, std::memory_order_relaxed);
 }
 
 inline void BaseObjectData::decRef() {
 	//why zero based refCount? avoids one m_refCount-- ;-)
-	assert(m_refCount >= 0);
-	if (!m_refCount) {
+	auto previous = m_refCount.fetch_sub(1, std::memory_order_acq_rel);
+	assert(previous >= 0);
+	if (previous == 0) {
+		m_refCount.store(0, std::memory_order_relaxed);
 		free();
-		return;
 	}
-	m_refCount--;
 }
 
 template<typename T>
@@ -0,0 +1,127 @@
+#if defined(HAVE_ZSTD_H)
+#include <Atlas/Filters/Zstd.h>
+#include <cassert>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using Atlas::Filters::Zstd;
+
+void testRoundTrip() {
+	Zstd encoder;
+	Zstd decoder;
+	encoder.begin();
+	decoder.begin();
+
+	std::string first = "[$objtype=op$parent=sight(args=[$objtype=op$parent=move$from=1(args=[$id=1(pos=#1.0#2.0#3.0)])])]";
+	std::string second = "[$objtype=op$parent=sight(args=[$objtype=op$parent=move$from=2(args=[$id=2(pos=#4.0#5.0#6.0)])])]";
+
+	//Each encoded chunk should be possible to decode by itself, since the stream is flushed.
+	auto encodedFirst = encoder.encode(first);
+	assert(decoder.decode(encodedFirst) == first);
+	auto encodedSecond = encoder.encode(second);
+	assert(decoder.decode(encodedSecond) == second);
+
+	//The dictionary should make even the first small op compress well.
+	assert(encodedFirst.size() < first.size());
+
+	encoder.end();
+	decoder.end();
+}
+
+void testLargeData() {
+	Zstd encoder;
+	Zstd decoder;
+	encoder.begin();
+	decoder.begin();
+
+	std::string data;
+	for (int i = 0; i < 10000; ++i) {
+		data += "$id=" + std::to_string(i);
+	}
+	auto encoded = encoder.encode(data);
+	//Feed the data in small pieces to make sure partial input is handled.
+	std::string decoded;
+	for (size_t i = 0; i < encoded.size(); i += 100) {
+		decoded += decoder.decode(encoded.substr(i, 100));
+	}
+	assert(decoded == data);
+}
+
+void testDecodeMalformed() {
+	Zstd filter;
+	filter.begin();
+	bool threw = false;
+	try {
+		filter.decode("not a zstd stream");
+	} catch (const std::runtime_error&) {
+		threw = true;
+	}
+	assert(threw);
+}
+
+void testEncodeAfterEnd() {
+	Zstd filter;
+	filter.begin();
+	filter.end();
+	bool threw = false;
+	try {
+		filter.encode("data");
+	} catch (const std::runtime_error&) {
+		threw = true;
+	}
+	assert(threw);
+}
+
+void testConcurrentDirections() {
+	//Each end encodes on one thread while decoding what the other end sent on another.
+	Zstd first;
+	Zstd second;
+	first.begin();
+	second.begin();
+
+	std::string data;
+	for (int i = 0; i < 2000; ++i) {
+		data += "$id=" + std::to_string(i);
+	}
+	std::vector<std::string> toSecond, toFirst;
+	for (int i = 0; i < 50; ++i) {
+		toSecond.push_back(first.encode(data));
+	}
+
+	bool decodedAll = true;
+	std::thread encoder([&]() {
+		for (int i = 0; i < 50; ++i) {
+			toFirst.push_back(second.encode(data));
+		}
+	});
+	for (auto& chunk: toSecond) {
+		decodedAll = decodedAll && second.decode(chunk) == data;
+	}
+	encoder.join();
+	assert(decodedAll);
+
+	std::thread decoder([&]() {
+		for (auto& chunk: toFirst) {
+			decodedAll = decodedAll && first.decode(chunk) == data;
+		}
+	});
+	for (int i = 0; i < 50; ++i) {
+		toSecond[i] = first.encode(data);
+	}
+	decoder.join();
+	assert(decodedAll);
+}
+
+int main() {
+	testRoundTrip();
+	testLargeData();
+	testDecodeMalformed();
+	testEncodeAfterEnd();
+	testConcurrentDirections();
+	return 0;
+}
+#else
+int main() { return 0; }
+#endif
@@ -0,0 +1,72 @@
+#include <Atlas/Net/Stream.h>
+#include <Atlas/Codec.h>
+#include <Atlas/Filter.h>
+#include <Atlas/Message/DecoderBase.h>
+#include <Atlas/Message/Element.h>
+
+#include <cassert>
+#include <sstream>
+
+class TestDecoder : public Atlas::Message::DecoderBase {
+protected:
+	void messageArrived(Atlas::Message::MapType) override {
+	}
+};
+
+/**
+ * Runs a full negotiation between a client and a server, and returns the data left in the client's input stream.
+ */
+template<typename CheckFn>
+void negotiate(bool clientFilters, bool serverFilters, CheckFn checkFn) {
+	std::stringstream toServer;
+	std::stringstream toClient;
+
+	Atlas::Net::StreamConnect client("client", toClient, toServer);
+	Atlas::Net::StreamAccept server("server", toServer, toClient);
+	client.setFiltersEnabled(clientFilters);
+	server.setFiltersEnabled(serverFilters);
+
+	for (int i = 0; i < 10 && (client.getState() == Atlas::Negotiate::IN_PROGRESS || server.getState() == Atlas::Negotiate::IN_PROGRESS); ++i) {
+		server.poll();
+		if (server.getState() == Atlas::Negotiate::SUCCEEDED) {
+			//Anything the server sends directly after negotiation belongs to the codec, and must not be consumed by the client negotiator.
+			toClient << "codec data";
+		}
+		client.poll();
+	}
+
+	assert(client.getState() == Atlas::Negotiate::SUCCEEDED);
+	assert(server.getState() == Atlas::Negotiate::SUCCEEDED);
+
+	TestDecoder decoder;
+	assert(client.getCodec(decoder));
+	assert(server.getCodec(decoder));
+
+	checkFn(client, server, toClient);
+}
+
+int main() {
+	negotiate(true, true, [](Atlas::Net::StreamConnect& client, Atlas::Net::StreamAccept& server, std::stringstream& toClient) {
+		std::string remaining(std::istreambuf_iterator<char>(toClient), {});
+		assert(remaining.starts_with("codec data"));
+#if defined(HAVE_ZSTD_H)
+		assert(client.getFilter());
+		assert(server.getFilter());
+#else
+		assert(!client.getFilter());
+		assert(!server.getFilter());
+#endif
+	});
+
+	negotiate(false, true, [](Atlas::Net::StreamConnect& client, Atlas::Net::StreamAccept& server, std::stringstream&) {
+		assert(!client.getFilter());
+		assert(!server.getFilter());
+	});
+
+	negotiate(true, false, [](Atlas::Net::StreamConnect& client, Atlas::Net::StreamAccept& server, std::stringstream&) {
+		assert(!client.getFilter());
+		assert(!server.getFilter());
+	});
+
+	return 0;
+}
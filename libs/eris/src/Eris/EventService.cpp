@@ -1,5 +1,5 @@
 #include "EventService.h"
-#include "WaitFreeQueue.h"
+#include "MpscQueue.h"
 #include "ActiveMarker.h"
 
 #include <cassert>
@@ -24,7 +24,7 @@ TimedEvent::~TimedEvent() = default;
 EventService::EventService(boost::asio::io_context& io_service) :
 		m_io_service(io_service),
 		m_work(boost::asio::make_work_guard(io_service)),
-		m_background_handlers_queue(new WaitFreeQueue<std::function<void()>>()) {
+		m_background_handlers_queue(new MpscQueue<std::function<void()>, 128>()) {
 }
 
 EventService::~EventService() {
@@ -75,16 +75,9 @@ size_t EventService::processAllHandlers() {
 }
 
 size_t EventService::collectHandlersQueue() {
-	size_t count = 0;
-	WaitFreeQueue<std::function<void()>>::node* x = m_background_handlers_queue->pop_all();
-	while (x) {
-		WaitFreeQueue<std::function<void()>>::node* tmp = x;
-		x = x->next;
-		m_handlers.push_back(std::move(tmp->data));
-		delete tmp;
-		count++;
-	}
-	return count;
+	return m_background_handlers_queue->consume_all([this](std::function<void()>&& handler) {
+		m_handlers.push_back(std::move(handler));
+	});
 }
 
 size_t EventService::processOneHandler() {
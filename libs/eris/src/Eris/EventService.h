@@ -28,8 +28,8 @@ private:
 	std::unique_ptr<boost::asio::steady_timer> m_timer;
 };
 
-template<typename T>
-class WaitFreeQueue;
+template<typename T, std::size_t SegmentSize>
+class MpscQueue;
 
 /**
  * @brief Handles polling of the IO system as well as making sure that registered handlers are run on the main thread.
@@ -111,7 +111,7 @@ private:
 	 * These values are then popped through the collectHandlersQueue() method
 	 * and put onto the m_handlers queue.
 	 */
-	std::unique_ptr<WaitFreeQueue<std::function<void()>>> m_background_handlers_queue;
+	std::unique_ptr<MpscQueue<std::function<void()>, 128>> m_background_handlers_queue;
 
 	/**
 	 * @brief Creates a timer, mainly used by TimedEvent
@@ -0,0 +1,228 @@
+/*
+ Copyright (C) 2025 Erik Ogenvik
+
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software Foundation,
+ Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef ERIS_MPSCQUEUE_H_
+#define ERIS_MPSCQUEUE_H_
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+#include <new>
+#include <utility>
+#include <vector>
+
+namespace Eris {
+
+/**
+ * @brief An unbounded multi producer, single consumer queue built from pooled segments.
+ *
+ * Producers claim slots in the current tail segment with a single atomic increment, so no
+ * allocation happens per push. A new segment is only linked in once every SegmentSize pushes,
+ * and segments are taken from an internal pool which the consumer refills with the segments
+ * it has drained. Items are handed to the consumer in FIFO order (per producer) in batches
+ * through consume_all(), without the list reversal needed by WaitFreeQueue.
+ *
+ * Drained segments are only recycled once no producer is inside push(), since a producer
+ * might still hold a pointer to a segment it read as the tail before it was filled up.
+ *
+ * Any number of threads may call push(). Only one thread at a time may call consume_all().
+ */
+template<typename T, std::size_t SegmentSize = 128>
+class MpscQueue {
+public:
+	static_assert(SegmentSize > 0, "Segments must have room for at least one item.");
+
+	MpscQueue() :
+			m_tail(nullptr),
+			m_activeProducers(0),
+			m_head(new Segment()),
+			m_headIndex(0) {
+		m_tail.store(m_head, std::memory_order_relaxed);
+	}
+
+	~MpscQueue() {
+		//Destroy any items that haven't been consumed.
+		consume_all([](T&&) {});
+		auto segment = m_head;
+		while (segment) {
+			auto next = segment->next.load(std::memory_order_relaxed);
+			delete segment;
+			segment = next;
+		}
+		for (auto retired: m_retired) {
+			delete retired;
+		}
+		for (auto pooled: m_pool) {
+			delete pooled;
+		}
+	}
+
+	MpscQueue(const MpscQueue&) = delete;
+
+	MpscQueue& operator=(const MpscQueue&) = delete;
+
+	void push(const T& data) {
+		emplace(data);
+	}
+
+	void push(T&& data) {
+		emplace(std::move(data));
+	}
+
+	template<typename... Args>
+	void emplace(Args&& ... args) {
+		m_activeProducers.fetch_add(1, std::memory_order_seq_cst);
+		auto segment = m_tail.load(std::memory_order_seq_cst);
+		while (true) {
+			auto index = segment->claimed.fetch_add(1, std::memory_order_relaxed);
+			if (index < SegmentSize) {
+				auto& slot = segment->slots[index];
+				new(slot.storage) T(std::forward<Args>(args)...);
+				slot.ready.store(true, std::memory_order_release);
+				break;
+			}
+			//The segment is full; make sure there's a next one and move the tail to it.
+			auto next = segment->next.load(std::memory_order_acquire);
+			if (!next) {
+				auto fresh = obtainSegment();
+				if (segment->next.compare_exchange_strong(next, fresh, std::memory_order_acq_rel, std::memory_order_acquire)) {
+					next = fresh;
+				} else {
+					recycleSegment(fresh);
+				}
+			}
+			m_tail.compare_exchange_strong(segment, next, std::memory_order_seq_cst);
+			segment = m_tail.load(std::memory_order_seq_cst);
+		}
+		m_activeProducers.fetch_sub(1, std::memory_order_seq_cst);
+	}
+
+	/**
+	 * @brief Moves all items currently available to the supplied function, in order.
+	 *
+	 * Must only be called from the consumer thread.
+	 * @param consumer A callable accepting a T&&.
+	 * @return The number of items consumed.
+	 */
+	template<typename F>
+	std::size_t consume_all(F&& consumer) {
+		std::size_t count = 0;
+		while (true) {
+			if (m_headIndex == SegmentSize) {
+				auto next = m_head->next.load(std::memory_order_acquire);
+				if (!next) {
+					break;
+				}
+				m_retired.push_back(m_head);
+				m_head = next;
+				m_headIndex = 0;
+			}
+			auto& slot = m_head->slots[m_headIndex];
+			if (!slot.ready.load(std::memory_order_acquire)) {
+				break;
+			}
+			auto item = std::launder(reinterpret_cast<T*>(slot.storage));
+			consumer(std::move(*item));
+			item->~T();
+			slot.ready.store(false, std::memory_order_relaxed);
+			++m_headIndex;
+			++count;
+		}
+		reclaimRetired();
+		return count;
+	}
+
+	/**
+	 * @brief Checks if there are no items available to the consumer.
+	 *
+	 * Must only be called from the consumer thread.
+	 */
+	bool empty() const {
+		if (m_headIndex == SegmentSize) {
+			auto next = m_head->next.load(std::memory_order_acquire);
+			return !next || !next->slots[0].ready.load(std::memory_order_acquire);
+		}
+		return !m_head->slots[m_headIndex].ready.load(std::memory_order_acquire);
+	}
+
+private:
+	struct Slot {
+		std::atomic<bool> ready{false};
+		alignas(T) unsigned char storage[sizeof(T)];
+	};
+
+	struct Segment {
+		/**
+		 * The number of slots claimed by producers. Can go beyond SegmentSize when producers race for the last slot.
+		 */
+		std::atomic<std::size_t> claimed{0};
+		std::atomic<Segment*> next{nullptr};
+		std::array<Slot, SegmentSize> slots;
+	};
+
+	/**
+	 * Keep the producer side and the consumer side on separate cache lines.
+	 */
+	alignas(64) std::atomic<Segment*> m_tail;
+	std::atomic<std::size_t> m_activeProducers;
+
+	alignas(64) Segment* m_head;
+	std::size_t m_headIndex;
+	/**
+	 * Segments which have been drained but might still be referenced by producers.
+	 */
+	std::vector<Segment*> m_retired;
+
+	std::mutex m_poolMutex;
+	std::vector<Segment*> m_pool;
+
+	Segment* obtainSegment() {
+		{
+			std::lock_guard<std::mutex> lock(m_poolMutex);
+			if (!m_pool.empty()) {
+				auto segment = m_pool.back();
+				m_pool.pop_back();
+				return segment;
+			}
+		}
+		return new Segment();
+	}
+
+	void recycleSegment(Segment* segment) {
+		segment->claimed.store(0, std::memory_order_relaxed);
+		segment->next.store(nullptr, std::memory_order_relaxed);
+		std::lock_guard<std::mutex> lock(m_poolMutex);
+		m_pool.push_back(segment);
+	}
+
+	void reclaimRetired() {
+		//When no producer is active the tail has moved past all retired segments, and any new producer
+		//will only see the current tail.
+		if (!m_retired.empty() && m_activeProducers.load(std::memory_order_seq_cst) == 0) {
+			for (auto segment: m_retired) {
+				recycleSegment(segment);
+			}
+			m_retired.clear();
+		}
+	}
+};
+
+}
+
+#endif /* ERIS_MPSCQUEUE_H_ */
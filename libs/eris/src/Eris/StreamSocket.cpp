@@ -20,6 +20,7 @@
 #include "Log.h"
 
 #include <Atlas/Codec.h>
+#include <Atlas/Filter.h>
 #include <Atlas/Net/Stream.h>
 #include <Atlas/Objects/Encoder.h>
 
@@ -45,6 +46,7 @@ StreamSocket::StreamSocket(io_context& io_service,
 		_negotiateTimer(io_service),
 		_connectTimer(io_service),
 		m_codec(nullptr),
+		m_filter(nullptr),
 		m_encoder(nullptr),
 		m_is_connected(false) {
 }
@@ -96,6 +98,7 @@ Atlas::Negotiate::State StreamSocket::negotiate() {
 
 	// Get the codec that negotiation established
 	m_codec = _sc->getCodec(_bridge);
+	m_filter = _sc->getFilter();
 
 	// Acceptor is now finished with
 	_sc.reset();
@@ -104,6 +107,21 @@ Atlas::Negotiate::State StreamSocket::negotiate() {
 		logger->error("Could not create codec during negotiation.");
 		return Atlas::Negotiate::FAILED;
 	}
+
+	if (m_filter) {
+		try {
+			m_filter->begin();
+			//From now on the codec reads and writes plain data, which is passed through the filter.
+			mInStream.rdbuf(&mPlainReadBuffer);
+			mOutStream.rdbuf(&mPlainWriteBuffer);
+			//Any data already received after the negotiation is filtered.
+			filterIncoming();
+		} catch (const std::exception& e) {
+			logger->error("Could not set up filter during negotiation: {}", e.what());
+			return Atlas::Negotiate::FAILED;
+		}
+		logger->debug("Using filter for connection.");
+	}
 	// Create a new encoder to send high level objects to the codec
 	m_encoder = std::make_unique<Atlas::Objects::ObjectsEncoder>(*m_codec);
 
@@ -115,6 +133,25 @@ Atlas::Negotiate::State StreamSocket::negotiate() {
 	return Atlas::Negotiate::SUCCEEDED;
 }
 
+void StreamSocket::filterIncoming() {
+	if (mReadBuffer.size() != 0) {
+		auto data = mReadBuffer.data();
+		auto decoded = m_filter->decode(std::string(buffers_begin(data), buffers_end(data)));
+		mReadBuffer.consume(mReadBuffer.size());
+		mPlainReadBuffer.commit(buffer_copy(mPlainReadBuffer.prepare(decoded.size()), buffer(decoded)));
+	}
+}
+
+void StreamSocket::filterOutgoing() {
+	if (mPlainWriteBuffer.size() != 0) {
+		//Everything written since last write is encoded in one go, which also flushes the filter.
+		auto data = mPlainWriteBuffer.data();
+		auto encoded = m_filter->encode(std::string(buffers_begin(data), buffers_end(data)));
+		mPlainWriteBuffer.consume(mPlainWriteBuffer.size());
+		mWriteBuffer->commit(buffer_copy(mWriteBuffer->prepare(encoded.size()), buffer(encoded)));
+	}
+}
+
 Atlas::Codec& StreamSocket::getCodec() {
 	assert(m_codec);
 	return *m_codec;
@@ -32,6 +32,8 @@ namespace Atlas {
 class Bridge;
 
 class Codec;
+
+class Filter;
 namespace Net {
 class StreamConnect;
 }
@@ -137,6 +139,16 @@ protected:
 	 */
 	boost::asio::streambuf mReadBuffer;
 
+	/**
+	 * If a filter has been negotiated, received data is decoded into this buffer before being read by the codec.
+	 */
+	boost::asio::streambuf mPlainReadBuffer;
+
+	/**
+	 * If a filter has been negotiated, the codec writes to this buffer, which is encoded into mWriteBuffer when writing.
+	 */
+	boost::asio::streambuf mPlainWriteBuffer;
+
 	/**
 	 * Stream for data being received.
 	 */
@@ -161,6 +173,7 @@ protected:
 	boost::asio::steady_timer _negotiateTimer;
 	boost::asio::steady_timer _connectTimer;
 	std::unique_ptr<Atlas::Codec> m_codec;
+	std::unique_ptr<Atlas::Filter> m_filter; ///< optional filter (such as compression), sitting between the codec and the socket
 	std::unique_ptr<Atlas::Objects::ObjectsEncoder> m_encoder;
 	bool m_is_connected;
 
@@ -172,6 +185,16 @@ protected:
 
 	Atlas::Negotiate::State negotiate();
 
+	/**
+	 * @brief Decodes all received data through the filter.
+	 */
+	void filterIncoming();
+
+	/**
+	 * @brief Encodes all written data through the filter.
+	 */
+	void filterOutgoing();
+
 };
 
 /**
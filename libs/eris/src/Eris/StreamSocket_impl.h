@@ -22,6 +22,8 @@
 #include "StreamSocket.h"
 
 #include <Atlas/Codec.h>
+#include <Atlas/Filter.h>
+#include <Atlas/Net/Stream.h>
 
 static const int CONNECT_TIMEOUT_SECONDS = 5;
 template<>
@@ -36,6 +38,10 @@ AsioStreamSocket<ProtocolT>::AsioStreamSocket(
 		Atlas::Bridge& bridge, StreamSocket::Callbacks callbacks) :
 		StreamSocket(io_service, client_name, bridge, std::move(callbacks)),
 		m_socket(io_service) {
+	//There's no point in compressing data sent over local sockets.
+	if constexpr (std::is_same_v<ProtocolT, boost::asio::local::stream_protocol>) {
+		_sc->setFiltersEnabled(false);
+	}
 }
 
 template<typename ProtocolT>
@@ -160,6 +166,15 @@ void AsioStreamSocket<ProtocolT>::do_read() {
 								 if (_callbacks.stateChanged) {
 									 if (!ec) {
 										 mReadBuffer.commit(length);
+										 if (m_filter) {
+											 try {
+												 this->filterIncoming();
+											 } catch (const std::exception& e) {
+												 logger->error("Could not decode data from socket: {}", e.what());
+												 _callbacks.stateChanged(CONNECTION_FAILED);
+												 return;
+											 }
+										 }
 										 m_codec->poll();
 										 _callbacks.dispatch();
 										 this->do_read();
@@ -176,6 +191,9 @@ void AsioStreamSocket<ProtocolT>::do_read() {
 
 template<typename ProtocolT>
 void AsioStreamSocket<ProtocolT>::write() {
+	if (m_filter) {
+		this->filterOutgoing();
+	}
 	if (mWriteBuffer->size() != 0) {
 		if (mIsSending) {
 			//We're already sending in the background.
@@ -190,7 +208,10 @@ void AsioStreamSocket<ProtocolT>::write() {
 		auto self(this->shared_from_this());
 		//Swap places between writing buffer and sending buffer, and attach new write buffer to the out stream.
 		std::swap(mWriteBuffer, mSendBuffer);
-		mOutStream.rdbuf(mWriteBuffer.get());
+		//If there's a filter the codec instead writes to the plain buffer.
+		if (!m_filter) {
+			mOutStream.rdbuf(mWriteBuffer.get());
+		}
 		mIsSending = true;
 
 		async_write(m_socket, mSendBuffer->data(),
@@ -29,7 +29,7 @@
 #include <Eris/Exceptions.h>
 #include <Eris/EventService.h>
 #include <Eris/View.h>
-#include <Eris/WaitFreeQueue.h>
+#include <Eris/MpscQueue.h>
 
 
 
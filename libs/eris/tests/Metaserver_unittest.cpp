@@ -26,7 +26,7 @@
 
 #include <Eris/Metaserver.h>
 #include <Eris/EventService.h>
-#include <Eris/WaitFreeQueue.h>
+#include <Eris/MpscQueue.h>
 
 #include <Atlas/Objects/Factories.h>
 #include <iostream>
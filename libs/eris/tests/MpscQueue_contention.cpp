@@ -0,0 +1,104 @@
+/*
+ Copyright (C) 2025 Erik Ogenvik
+
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software Foundation,
+ Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include "Eris/MpscQueue.h"
+#include "Eris/WaitFreeQueue.h"
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+/**
+ * Measures how the queues behave when several background threads post handlers while
+ * the main thread collects them, as is done through EventService::runOnMainThread.
+ */
+namespace {
+const int ITEMS_PER_PRODUCER = 200000;
+
+template<typename PushFn, typename CollectFn>
+void run(const std::string& name, int producerCount, PushFn push, CollectFn collect) {
+	std::atomic<bool> start(false);
+	std::vector<std::thread> producers;
+	for (int producer = 0; producer < producerCount; ++producer) {
+		producers.emplace_back([&]() {
+			while (!start.load()) {
+				std::this_thread::yield();
+			}
+			int counter = 0;
+			for (int i = 0; i < ITEMS_PER_PRODUCER; ++i) {
+				push([&counter]() { counter++; });
+			}
+		});
+	}
+
+	auto total = (std::size_t) producerCount * ITEMS_PER_PRODUCER;
+	std::size_t received = 0;
+	auto startTime = std::chrono::steady_clock::now();
+	start = true;
+	while (received < total) {
+		received += collect();
+	}
+	auto duration = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - startTime);
+	for (auto& thread: producers) {
+		thread.join();
+	}
+
+	std::cout << name << " producers=" << producerCount << " items=" << total
+			  << " time=" << duration.count() << "us"
+			  << " items/s=" << (std::size_t) (total / (duration.count() / 1000000.0)) << std::endl;
+}
+}
+
+int main() {
+	for (int producerCount: {1, 2, 4, 8}) {
+		{
+			Eris::WaitFreeQueue<std::function<void()>> queue;
+			std::vector<std::function<void()>> handlers;
+			run("WaitFreeQueue", producerCount,
+				[&](std::function<void()> handler) { queue.push(handler); },
+				[&]() {
+					std::size_t count = 0;
+					auto x = queue.pop_all();
+					while (x) {
+						auto tmp = x;
+						x = x->next;
+						handlers.push_back(std::move(tmp->data));
+						delete tmp;
+						count++;
+					}
+					handlers.clear();
+					return count;
+				});
+		}
+		{
+			Eris::MpscQueue<std::function<void()>, 128> queue;
+			std::vector<std::function<void()>> handlers;
+			run("MpscQueue", producerCount,
+				[&](std::function<void()> handler) { queue.push(std::move(handler)); },
+				[&]() {
+					auto count = queue.consume_all([&](std::function<void()>&& handler) { handlers.push_back(std::move(handler)); });
+					handlers.clear();
+					return count;
+				});
+		}
+	}
+	return 0;
+}
@@ -0,0 +1,114 @@
+/*
+ Copyright (C) 2025 Erik Ogenvik
+
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software Foundation,
+ Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifdef NDEBUG
+#undef NDEBUG
+#endif
+#ifndef DEBUG
+#define DEBUG
+#endif
+
+#include "Eris/MpscQueue.h"
+
+#include <cassert>
+#include <memory>
+#include <thread>
+#include <vector>
+
+using namespace Eris;
+
+int main() {
+	{
+		MpscQueue<int, 4> queue;
+		assert(queue.empty());
+		std::vector<int> result;
+		assert(queue.consume_all([&](int&& value) { result.push_back(value); }) == 0);
+		assert(result.empty());
+	}
+
+	//Items should come out in order, also when spanning multiple segments.
+	{
+		MpscQueue<int, 4> queue;
+		for (int i = 0; i < 10; ++i) {
+			queue.push(i);
+		}
+		assert(!queue.empty());
+		std::vector<int> result;
+		assert(queue.consume_all([&](int&& value) { result.push_back(value); }) == 10);
+		assert(queue.empty());
+		for (int i = 0; i < 10; ++i) {
+			assert(result[i] == i);
+		}
+
+		//Drained segments should be reused.
+		for (int i = 10; i < 30; ++i) {
+			queue.push(i);
+		}
+		result.clear();
+		assert(queue.consume_all([&](int&& value) { result.push_back(value); }) == 20);
+		for (int i = 0; i < 20; ++i) {
+			assert(result[i] == i + 10);
+		}
+	}
+
+	//Items not consumed should be destroyed with the queue.
+	{
+		auto shared = std::make_shared<int>(1);
+		{
+			MpscQueue<std::shared_ptr<int>, 4> queue;
+			for (int i = 0; i < 6; ++i) {
+				queue.push(shared);
+			}
+			assert(shared.use_count() == 7);
+		}
+		assert(shared.use_count() == 1);
+	}
+
+	//Multiple producers should have all their items delivered, with the order of each producer preserved.
+	{
+		const int producerCount = 4;
+		const int itemsPerProducer = 20000;
+		MpscQueue<std::pair<int, int>, 16> queue;
+		std::vector<std::thread> producers;
+		for (int producer = 0; producer < producerCount; ++producer) {
+			producers.emplace_back([&queue, producer]() {
+				for (int i = 0; i < itemsPerProducer; ++i) {
+					queue.push(std::make_pair(producer, i));
+				}
+			});
+		}
+
+		std::vector<int> lastSeen(producerCount, -1);
+		int received = 0;
+		while (received < producerCount * itemsPerProducer) {
+			received += (int) queue.consume_all([&](std::pair<int, int>&& item) {
+				assert(item.second == lastSeen[item.first] + 1);
+				lastSeen[item.first] = item.second;
+			});
+		}
+		for (auto& thread: producers) {
+			thread.join();
+		}
+		assert(queue.empty());
+		for (int producer = 0; producer < producerCount; ++producer) {
+			assert(lastSeen[producer] == itemsPerProducer - 1);
+		}
+	}
+
+	return 0;
+}
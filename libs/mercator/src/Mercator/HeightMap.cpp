@@ -116,6 +116,14 @@ void HeightMap::checkMaxMin(float h) {
 	}
 }
 
+/// \brief Copy the height data, and the max and min values, from another
+/// height map with the same resolution.
+void HeightMap::copyFrom(const HeightMap& other) {
+	m_data = other.m_data;
+	m_max = other.m_max;
+	m_min = other.m_min;
+}
+
 // generate a rand num between -0.5...0.5
 inline float randHalf(WFMath::MTRand& rng) {
 	//return (float) rand() / RAND_MAX - 0.5f;
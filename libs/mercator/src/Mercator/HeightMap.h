@@ -58,6 +58,8 @@ public:
 
 	void checkMaxMin(float h);
 
+	void copyFrom(const HeightMap& other);
+
 private:
 
 	void fill1d(const BasePoint& l, const BasePoint& h, float* array) const;
@@ -63,6 +63,19 @@ void Segment::populateHeightMap(HeightMap& heightMap) {
 					 m_controlPoints(1, 1), m_controlPoints(0, 1));
 }
 
+/// \brief Use the height data of another Segment instead of populating it.
+///
+/// This allows the height data to be generated elsewhere, for example in a
+/// copy of the Segment, with the same base points and mods, which is
+/// populated in a different thread. The other Segment must have the same
+/// resolution.
+void Segment::copyHeightMap(const Segment& other) {
+	assert(other.m_res == m_res);
+	m_heightMap.copyFrom(other.m_heightMap);
+	//Same as when populating, the normals and surfaces are no longer valid.
+	invalidate(false);
+}
+
 
 /// \brief Mark the contents of this Segment as stale.
 ///
@@ -195,6 +195,8 @@ public:
 
 	void populateHeightMap(HeightMap& heightMap);
 
+	void copyHeightMap(const Segment& other);
+
 	/// \brief Accessor for the maximum height value in this Segment.
 	float getMax() const { return m_heightMap.getMax(); }
 
@@ -7,6 +7,12 @@
 #include <wfmath/point.h>
 #include <wfmath/axisbox.h>
 
+#ifdef NDEBUG
+#undef NDEBUG
+#endif
+
+#include <cassert>
+
 int main() {
 	Mercator::Segment s(0, 0, 64);
 
@@ -28,6 +34,22 @@ int main() {
 	int lx, ly, hx, hy;
 	s.clipToSegment(WFMath::AxisBox<2>(WFMath::Point<2>(50, 50), WFMath::Point<2>(100, 100)), lx, hx, ly, hy);
 
+	{
+		Mercator::Segment copy(0, 0, 64);
+		copy.setCornerPoint(0, 0, Mercator::BasePoint(10));
+		copy.setCornerPoint(1, 0, Mercator::BasePoint(12));
+		copy.setCornerPoint(0, 1, Mercator::BasePoint(14));
+		copy.setCornerPoint(1, 1, Mercator::BasePoint(16));
+		copy.populate();
+
+		s.invalidate();
+		s.copyHeightMap(copy);
+		assert(s.isValid());
+		assert(s.getMax() == copy.getMax());
+		assert(s.getMin() == copy.getMin());
+		assert(s.get(32, 32) == copy.get(32, 32));
+	}
+
 	return 0;
 }
 
@@ -20,6 +20,7 @@
 #include "squall/core/Repository.h"
 #include "squall/core/Generator.h"
 #include "squall/core/Resolver.h"
+#include "squall/core/AsyncProvider.h"
 #include "squall/curl/CurlProvider.h"
 #include "squall/core/Realizer.h"
 #include "squall/core/Log.h"
@@ -30,6 +31,7 @@
 #include <CLI/Config.hpp>
 #include <spdlog/spdlog.h>
 #include "bytesize/bytesize.hh"
+#include <thread>
 
 using namespace Squall;
 
@@ -134,7 +136,7 @@ int main(int argc, char** argv) {
 
 			logger->info("Downloading from '{}', starting at manifest '{}'.", *remotePath, signatureInstance.str_view());
 			Resolver resolver(repository,
-							  std::make_unique<CurlProvider>(*remotePath),
+							  std::make_unique<AsyncProvider>(std::make_unique<CurlProvider>(*remotePath)),
 							  signatureInstance);
 			ResolveResult result{};
 			std::vector<ResolveEntry> downloadedFiles;
@@ -143,6 +145,10 @@ int main(int argc, char** argv) {
 				for (auto& entry: result.completedRequests) {
 					downloadedFiles.emplace_back(entry);
 				}
+				//Fetches happen in the background, so there's no need to spin while waiting for them.
+				if (result.status == Squall::ResolveStatus::ONGOING && result.completedRequests.empty()) {
+					std::this_thread::sleep_for(std::chrono::milliseconds(1));
+				}
 			} while (result.status == Squall::ResolveStatus::ONGOING);
 
 			if (result.status == Squall::ResolveStatus::HAD_ERROR) {
@@ -258,10 +264,37 @@ int main(int argc, char** argv) {
 					}
 				}
 				logger->info("Deleted {} files, for a total of {} bytes.", abandonedFiles.size(), bytesize::bytesize(totalSize));
+
+				if (!repository.getPacks().empty()) {
+					auto packResult = Pruner::compactPacks(repository);
+					if (packResult.status == StoreStatus::SUCCESS) {
+						logger->info("Compacted packs, removing {} entries and keeping {}.", packResult.removedEntries, packResult.packedEntries);
+					} else {
+						logger->error("Could not compact packs.");
+					}
+				}
 			}
 
 		});
 	}
+
+	{
+		auto pack = app.add_subcommand("pack", "Move all loose data into a pack, which is faster to serve and uses fewer files.");
+
+		pack->final_callback([&repositoryPath]() {
+			Repository repository(repositoryPath);
+			auto packResult = repository.packLooseData();
+			if (packResult.status == StoreStatus::SUCCESS) {
+				if (packResult.packedEntries == 0) {
+					logger->info("There was no loose data to pack.");
+				} else {
+					logger->info("Packed {} entries into '{}'.", packResult.packedEntries, packResult.localPath.generic_string());
+				}
+			} else {
+				logger->error("Could not pack data.");
+			}
+		});
+	}
 	CLI11_PARSE(app, argc, argv)
 	return 0;
 }
\ No newline at end of file
@@ -29,4 +29,10 @@ std::future<ProviderResult> Squall::AsyncProvider::fetch(Squall::Signature signa
 	});
 }
 
+std::future<ProviderResult> Squall::AsyncProvider::fetchDelta(Squall::Signature base, Squall::Signature target, std::filesystem::path destination) {
+	return std::async([=, this]() -> ProviderResult {
+		return mProvider->fetchDelta(base, target, destination).get();
+	});
+}
+
 }
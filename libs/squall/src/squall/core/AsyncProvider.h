@@ -32,6 +32,10 @@ public:
 	std::future<ProviderResult> fetch(Signature signature,
 									  std::filesystem::path destination) override;
 
+	std::future<ProviderResult> fetchDelta(Signature base,
+										   Signature target,
+										   std::filesystem::path destination) override;
+
 private:
 	std::unique_ptr<Provider> mProvider;
 };
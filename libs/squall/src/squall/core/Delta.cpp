@@ -0,0 +1,276 @@
+/*
+ Copyright (C) 2026 Erik Ogenvik
+
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#include "Delta.h"
+#include "Log.h"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+namespace Squall {
+
+namespace {
+constexpr std::array<char, 4> deltaMagic{'S', 'Q', 'D', '1'};
+constexpr char copyOperation = 1;
+constexpr char insertOperation = 2;
+/**
+ * Limits the work done for blocks which occur many times, such as blocks of zeroes.
+ */
+constexpr size_t maxCandidatesPerChecksum = 8;
+
+/**
+ * The weak checksum used by rsync, which can be rolled forward one byte at a time.
+ */
+struct RollingChecksum {
+	std::uint32_t a = 0;
+	std::uint32_t b = 0;
+	size_t length = 0;
+
+	explicit RollingChecksum(std::span<const char> block) : length(block.size()) {
+		for (size_t i = 0; i < block.size(); ++i) {
+			auto value = static_cast<unsigned char>(block[i]);
+			a += value;
+			b += static_cast<std::uint32_t>((block.size() - i) * value);
+		}
+	}
+
+	void roll(char outgoing, char incoming) {
+		auto outgoingValue = static_cast<unsigned char>(outgoing);
+		a = a - outgoingValue + static_cast<unsigned char>(incoming);
+		b = b - static_cast<std::uint32_t>(length * outgoingValue) + a;
+	}
+
+	std::uint32_t value() const {
+		return (a & 0xFFFF) | (b << 16);
+	}
+};
+
+struct DeltaWriter {
+	std::vector<char> data;
+	std::optional<std::pair<std::uint64_t, std::uint64_t>> pendingCopy;
+
+	void writeNumber(std::uint64_t value) {
+		//LEB128, since most numbers are small.
+		do {
+			auto byte = static_cast<char>(value & 0x7F);
+			value >>= 7;
+			if (value != 0) {
+				byte = static_cast<char>(byte | 0x80);
+			}
+			data.push_back(byte);
+		} while (value != 0);
+	}
+
+	void flushCopy() {
+		if (pendingCopy) {
+			data.push_back(copyOperation);
+			writeNumber(pendingCopy->first);
+			writeNumber(pendingCopy->second);
+			pendingCopy.reset();
+		}
+	}
+
+	void copy(std::uint64_t offset, std::uint64_t length) {
+		if (pendingCopy && pendingCopy->first + pendingCopy->second == offset) {
+			pendingCopy->second += length;
+		} else {
+			flushCopy();
+			pendingCopy = {offset, length};
+		}
+	}
+
+	void insert(std::span<const char> literal) {
+		if (!literal.empty()) {
+			flushCopy();
+			data.push_back(insertOperation);
+			writeNumber(literal.size());
+			data.insert(data.end(), literal.begin(), literal.end());
+		}
+	}
+};
+
+struct DeltaReader {
+	std::span<const char> data;
+	size_t position = 0;
+
+	std::optional<std::uint64_t> readNumber() {
+		std::uint64_t value = 0;
+		for (unsigned shift = 0; shift < 64 && position < data.size(); shift += 7) {
+			auto byte = static_cast<unsigned char>(data[position++]);
+			value |= static_cast<std::uint64_t>(byte & 0x7F) << shift;
+			if ((byte & 0x80) == 0) {
+				return value;
+			}
+		}
+		return std::nullopt;
+	}
+};
+}
+
+std::vector<char> Delta::create(std::span<const char> base, std::span<const char> target, size_t blockSize) {
+	DeltaWriter writer;
+	writer.data.insert(writer.data.end(), deltaMagic.begin(), deltaMagic.end());
+	writer.writeNumber(base.size());
+	writer.writeNumber(target.size());
+
+	if (blockSize == 0 || base.size() < blockSize || target.size() < blockSize) {
+		writer.insert(target);
+		return std::move(writer.data);
+	}
+
+	//Checksums of all whole blocks in the base, sorted so that they can be searched.
+	std::vector<std::pair<std::uint32_t, std::uint64_t>> blocks;
+	blocks.reserve(base.size() / blockSize);
+	for (size_t offset = 0; offset + blockSize <= base.size(); offset += blockSize) {
+		blocks.emplace_back(RollingChecksum(base.subspan(offset, blockSize)).value(), offset);
+	}
+	std::stable_sort(blocks.begin(), blocks.end(), [](const auto& lhs, const auto& rhs) { return lhs.first < rhs.first; });
+
+	auto findMatch = [&](std::uint32_t checksum, std::span<const char> block) -> std::optional<std::uint64_t> {
+		auto range = std::equal_range(blocks.begin(), blocks.end(), std::make_pair(checksum, std::uint64_t{0}),
+									  [](const auto& lhs, const auto& rhs) { return lhs.first < rhs.first; });
+		size_t candidates = 0;
+		for (auto I = range.first; I != range.second && candidates < maxCandidatesPerChecksum; ++I, ++candidates) {
+			if (std::memcmp(base.data() + I->second, block.data(), blockSize) == 0) {
+				return I->second;
+			}
+		}
+		return std::nullopt;
+	};
+
+	size_t literalStart = 0;
+	size_t position = 0;
+	RollingChecksum checksum(target.subspan(0, blockSize));
+	while (position + blockSize <= target.size()) {
+		auto match = findMatch(checksum.value(), target.subspan(position, blockSize));
+		if (match) {
+			auto baseOffset = *match;
+			//Extend the match as far as possible in both directions.
+			size_t length = blockSize;
+			while (position + length < target.size() && baseOffset + length < base.size() && target[position + length] == base[baseOffset + length]) {
+				++length;
+			}
+			size_t extendedBackwards = 0;
+			while (position - extendedBackwards > literalStart && baseOffset - extendedBackwards > 0 &&
+				   target[position - extendedBackwards - 1] == base[baseOffset - extendedBackwards - 1]) {
+				++extendedBackwards;
+			}
+			writer.insert(target.subspan(literalStart, position - extendedBackwards - literalStart));
+			writer.copy(baseOffset - extendedBackwards, length + extendedBackwards);
+			position += length;
+			literalStart = position;
+			if (position + blockSize <= target.size()) {
+				checksum = RollingChecksum(target.subspan(position, blockSize));
+			}
+		} else {
+			if (position + blockSize < target.size()) {
+				checksum.roll(target[position], target[position + blockSize]);
+			}
+			++position;
+		}
+	}
+	writer.insert(target.subspan(literalStart));
+	writer.flushCopy();
+	return std::move(writer.data);
+}
+
+std::optional<std::vector<char>> Delta::apply(std::span<const char> base, std::span<const char> delta) {
+	if (delta.size() < deltaMagic.size() || !std::equal(deltaMagic.begin(), deltaMagic.end(), delta.begin())) {
+		return std::nullopt;
+	}
+	DeltaReader reader{.data = delta, .position = deltaMagic.size()};
+	auto baseSize = reader.readNumber();
+	auto targetSize = reader.readNumber();
+	if (!baseSize || !targetSize || *baseSize != base.size()) {
+		return std::nullopt;
+	}
+
+	std::vector<char> target;
+	//The size is read from the delta, so it can't be trusted to allocate for. A valid target is seldom larger than this.
+	target.reserve(std::min<std::uint64_t>(*targetSize, base.size() + delta.size()));
+	while (reader.position < delta.size()) {
+		auto operation = delta[reader.position++];
+		if (operation == copyOperation) {
+			auto offset = reader.readNumber();
+			auto length = reader.readNumber();
+			if (!offset || !length || *offset > base.size() || *length > base.size() - *offset || *length > *targetSize - target.size()) {
+				return std::nullopt;
+			}
+			target.insert(target.end(), base.begin() + static_cast<std::ptrdiff_t>(*offset), base.begin() + static_cast<std::ptrdiff_t>(*offset + *length));
+		} else if (operation == insertOperation) {
+			auto length = reader.readNumber();
+			if (!length || *length > delta.size() - reader.position || *length > *targetSize - target.size()) {
+				return std::nullopt;
+			}
+			auto start = delta.begin() + static_cast<std::ptrdiff_t>(reader.position);
+			target.insert(target.end(), start, start + static_cast<std::ptrdiff_t>(*length));
+			reader.position += *length;
+		} else {
+			return std::nullopt;
+		}
+	}
+	if (target.size() != *targetSize) {
+		return std::nullopt;
+	}
+	return target;
+}
+
+DeltaGenerationResult Delta::generate(Repository& repository, const ChangeSummary& changes, const DeltaConfig& config) {
+	DeltaGenerationResult result{.createdDeltas = 0, .savedBytes = 0};
+	for (auto& alteredEntry: changes.alteredEntries) {
+		//Directories are stored with a trailing "/", and are only fetched whole.
+		if (!alteredEntry.change.path.has_filename()) {
+			continue;
+		}
+		auto& baseSignature = alteredEntry.previousSignature;
+		auto& targetSignature = alteredEntry.change.signature;
+		if (repository.fetchDelta(baseSignature, targetSignature).status == FetchStatus::SUCCESS) {
+			continue;
+		}
+		auto baseFetchResult = repository.fetch(baseSignature);
+		auto targetFetchResult = repository.fetch(targetSignature);
+		if (baseFetchResult.status != FetchStatus::SUCCESS || targetFetchResult.status != FetchStatus::SUCCESS) {
+			continue;
+		}
+		auto targetSize = targetFetchResult.size();
+		if (targetSize < config.minimumSize || targetSize > config.maximumSize || baseFetchResult.size() > config.maximumSize) {
+			continue;
+		}
+		auto base = repository.readData(baseSignature);
+		auto target = repository.readData(targetSignature);
+		if (!base || !target) {
+			continue;
+		}
+		auto delta = create(*base, *target);
+		if (static_cast<double>(delta.size()) > static_cast<double>(target->size()) * config.maximumRatio) {
+			logger->debug("Delta for {} was {} bytes, compared to {} bytes for the whole file; not storing it.", alteredEntry.change.path.generic_string(), delta.size(),
+						  target->size());
+			continue;
+		}
+		if (repository.storeDelta(baseSignature, targetSignature, delta).status == StoreStatus::SUCCESS) {
+			logger->debug("Stored delta for {}, of {} bytes compared to {} bytes for the whole file.", alteredEntry.change.path.generic_string(), delta.size(),
+						  target->size());
+			result.createdDeltas++;
+			result.savedBytes += target->size() - delta.size();
+		}
+	}
+	return result;
+}
+
+}
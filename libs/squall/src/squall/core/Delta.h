@@ -0,0 +1,86 @@
+/*
+ Copyright (C) 2026 Erik Ogenvik
+
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#ifndef SQUALL_DELTA_H
+#define SQUALL_DELTA_H
+
+#include "Difference.h"
+#include "Repository.h"
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <vector>
+
+namespace Squall {
+
+struct DeltaConfig {
+	/**
+	 * Smaller files are cheap enough to fetch in full.
+	 */
+	std::uint64_t minimumSize = 64 * 1024;
+	/**
+	 * Both versions are kept in memory when creating a delta, so very large files are skipped.
+	 */
+	std::uint64_t maximumSize = 256 * 1024 * 1024;
+	/**
+	 * A delta is only stored if it's at most this large, relative to the new version.
+	 */
+	double maximumRatio = 0.75;
+};
+
+struct DeltaGenerationResult {
+	size_t createdDeltas;
+	/**
+	 * The sum of the sizes of the new versions, minus the sizes of the deltas.
+	 */
+	std::uint64_t savedBytes;
+};
+
+/**
+ * Binary deltas, which allow a new version of a file to be created from an older version, without transferring it in full.
+ *
+ * The delta is created by splitting the old version into blocks, and then looking for those blocks at any offset in
+ * the new version using a rolling checksum, much like rsync does. The delta then consists of instructions to either copy
+ * a range from the old version or insert literal data.
+ *
+ * Deltas are addressed by the signatures of both versions, see Repository::storeDelta().
+ */
+struct Delta {
+	static constexpr size_t defaultBlockSize = 1024;
+
+	/**
+	 * Creates a delta, which turns the base into the target.
+	 */
+	static std::vector<char> create(std::span<const char> base, std::span<const char> target, size_t blockSize = defaultBlockSize);
+
+	/**
+	 * Applies a delta to the base.
+	 * @return The target, or nothing if the delta isn't valid for the base.
+	 */
+	static std::optional<std::vector<char>> apply(std::span<const char> base, std::span<const char> delta);
+
+	/**
+	 * Creates deltas for all entries which have been altered, and stores them in the repository.
+	 * Both versions of each entry must be available in the repository.
+	 */
+	static DeltaGenerationResult generate(Repository& repository, const ChangeSummary& changes, const DeltaConfig& config = {});
+};
+
+}
+
+#endif //SQUALL_DELTA_H
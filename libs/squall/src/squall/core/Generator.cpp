@@ -25,19 +25,92 @@
 #include <fstream>
 #include <iostream>
 #include <sstream>
+#include <deque>
+#include <thread>
 
 namespace Squall {
 
+namespace {
+/**
+ * Reading in large blocks allows Blake3 to hash many chunks at once with SIMD instructions.
+ */
+constexpr size_t readBufferSize = 256 * 1024;
+}
+
+struct Generator::WorkerPool {
+	explicit WorkerPool(size_t threadCount) {
+		for (size_t i = 0; i < threadCount; ++i) {
+			threads.emplace_back([this]() { run(); });
+		}
+	}
+
+	~WorkerPool() {
+		{
+			std::lock_guard lock(mutex);
+			stopped = true;
+		}
+		condition.notify_all();
+		for (auto& thread: threads) {
+			thread.join();
+		}
+	}
+
+	std::future<GenerateEntry> post(std::function<GenerateEntry()> function) {
+		std::packaged_task<GenerateEntry()> task(std::move(function));
+		auto future = task.get_future();
+		{
+			std::lock_guard lock(mutex);
+			tasks.emplace_back(std::move(task));
+		}
+		condition.notify_one();
+		return future;
+	}
+
+	void run() {
+		while (true) {
+			std::packaged_task<GenerateEntry()> task;
+			{
+				std::unique_lock lock(mutex);
+				condition.wait(lock, [this]() { return stopped || !tasks.empty(); });
+				//Any remaining tasks are abandoned when stopped, which is only when the Generator is destroyed.
+				if (stopped) {
+					return;
+				}
+				task = std::move(tasks.front());
+				tasks.pop_front();
+			}
+			task();
+		}
+	}
+
+	std::mutex mutex;
+	std::condition_variable condition;
+	std::deque<std::packaged_task<GenerateEntry()>> tasks;
+	bool stopped = false;
+	std::vector<std::thread> threads;
+};
+
 Generator::Generator(Repository& repository, std::filesystem::path sourceDirectory, Config config)
 		: mRepository(repository),
 		  mSourceDirectory(std::move(sourceDirectory)),
 		  mConfig(std::move(config)) {
+	auto threads = mConfig.threads;
+	if (threads == 0) {
+		threads = std::max(1u, std::thread::hardware_concurrency());
+	}
+	mWorkerPool = std::make_unique<WorkerPool>(threads);
+
 	std::filesystem::directory_iterator topIterator{mSourceDirectory};
 	if (topIterator != std::filesystem::directory_iterator()) {
 		mIterators.emplace_back(DirectoryIterator{.iterator = std::move(topIterator)});
 	}
 }
 
+Generator::~Generator() {
+	//Stop the workers before anything they use is destroyed.
+	mWorkerPool.reset();
+}
+
 GenerateResult Generator::process(size_t filesToProcess) {
 	GenerateResult result;
 
@@ -49,6 +122,14 @@ GenerateResult Generator::process(size_t filesToProcess) {
 			//We've completed a directory, generate a manifest and store it.
 
 			auto lastEntries = std::move(lastIteratorEntry.entries);
+			//Wait for any files which are still being processed in the background.
+			for (auto& pendingEntry: lastIteratorEntry.pendingEntries) {
+				auto processedEntry = pendingEntry.get();
+				mGeneratedEntries.emplace_back(processedEntry);
+				result.processedFiles.emplace_back(processedEntry);
+				lastEntries.emplace_back(std::move(processedEntry));
+			}
+			auto relativePath = std::move(lastIteratorEntry.relativePath);
 			mIterators.pop_back();
 
 			std::sort(lastEntries.begin(), lastEntries.end(), [](const GenerateEntry& lhs, const GenerateEntry& rhs) { return lhs.fileEntry.fileName < rhs.fileEntry.fileName; });
@@ -71,7 +152,7 @@ GenerateResult Generator::process(size_t filesToProcess) {
 			}
 
 
-			auto processedEntry = processDirectory(currentDirectoryPath, manifest, containedNewData);
+			auto processedEntry = processDirectory(currentDirectoryPath, relativePath, manifest, containedNewData);
 			mGeneratedEntries.emplace_back(processedEntry);
 			result.processedFiles.emplace_back(processedEntry);
 
@@ -82,16 +163,18 @@ GenerateResult Generator::process(size_t filesToProcess) {
 		} else if (lastIterator->is_directory()) {
 			if (shouldProcessPath(*lastIterator)) {
 				std::filesystem::directory_iterator subdirectoryIterator{*lastIterator};
-				mIterators.emplace_back(DirectoryIterator{.iterator= std::move(subdirectoryIterator)});
+				auto relativePath = lastIteratorEntry.relativePath / lastIterator->path().filename();
+				mIterators.emplace_back(DirectoryIterator{.iterator= std::move(subdirectoryIterator), .relativePath = std::move(relativePath)});
 			} else {
 				lastIterator++;
 			}
 		} else {
 			if (shouldProcessPath(*lastIterator)) {
-				auto processedEntry = processFile(*lastIterator);
-				mGeneratedEntries.emplace_back(processedEntry);
-				result.processedFiles.emplace_back(processedEntry);
-				lastIteratorEntry.entries.emplace_back(processedEntry);
+				auto filePath = lastIterator->path();
+				auto relativePath = lastIteratorEntry.relativePath / filePath.filename();
+				lastIteratorEntry.pendingEntries.emplace_back(mWorkerPool->post([this, filePath = std::move(filePath), relativePath = std::move(relativePath)]() {
+					return processFile(filePath, relativePath);
+				}));
 			}
 			lastIterator++;
 		}
@@ -102,20 +185,22 @@ GenerateResult Generator::process(size_t filesToProcess) {
 	return result;
 }
 
-GenerateEntry Generator::processFile(const std::filesystem::path& filePath) {
+GenerateEntry Generator::processFile(const std::filesystem::path& filePath, const std::filesystem::path& relativePath) {
+	const ExistingEntry* existingEntry = nullptr;
 	if (!mConfig.existingEntries.empty()) {
-		auto relativePath = std::filesystem::relative(filePath, mSourceDirectory);
 		auto existingI = mConfig.existingEntries.find(relativePath);
 		if (existingI != mConfig.existingEntries.end()) {
+			existingEntry = &existingI->second;
 			auto fileLastWriteTime = std::filesystem::last_write_time(filePath);
-			if (existingI->second.lastWriteTime == fileLastWriteTime) {
+			auto fileSize = static_cast<std::int64_t>(std::filesystem::file_size(filePath));
+			if (existingEntry->lastWriteTime == fileLastWriteTime && existingEntry->fileEntry.size == fileSize) {
 				logger->trace("Last write time for file '{}' was the same ({}), marking as unchanged.", filePath.string(),
 							  fileLastWriteTime.time_since_epoch().count());
-				return {.fileEntry = existingI->second.fileEntry, .sourcePath=filePath, .repositoryPath=existingI->second.repositoryPath, .status = GenerateFileStatus::Existed};
+				return {.fileEntry = existingEntry->fileEntry, .sourcePath=filePath, .repositoryPath=existingEntry->repositoryPath, .status = GenerateFileStatus::Existed};
 			} else {
 				logger->trace("Last write time for file '{}' ({}) differed from what was stored in the repo ({}), marking as changed.", filePath.string(),
 							  fileLastWriteTime.time_since_epoch().count(),
-							  existingI->second.lastWriteTime.time_since_epoch().count());
+							  existingEntry->lastWriteTime.time_since_epoch().count());
 			}
 		}
 	}
@@ -123,15 +208,21 @@ GenerateEntry Generator::processFile(const std::filesystem::path& filePath) {
 	auto signatureResult = generateSignature(filePath);
 	logger->debug("Signature is {} for file {}", signatureResult.signature.str_view(), filePath.generic_string());
 	auto localPath = linkFile(filePath, signatureResult.signature);
+	if (existingEntry && existingEntry->fileEntry.signature == signatureResult.signature) {
+		//Only the last write time was changed, as happens when files are checked out anew. Since linking updates the last
+		//write time in the repository the file will be found unchanged the next time.
+		logger->trace("File '{}' has the same content as what was stored in the repo, marking as unchanged.", filePath.string());
+		return {.fileEntry = existingEntry->fileEntry, .sourcePath=filePath, .repositoryPath=localPath, .status = GenerateFileStatus::Existed};
+	}
 	FileEntry fileEntry{.fileName=filePath.filename().generic_string(), .signature = signatureResult.signature, .type=FileEntryType::FILE, .size = signatureResult.size};
 	return {.fileEntry = fileEntry, .sourcePath=filePath, .repositoryPath=localPath, .status = GenerateFileStatus::Copied};
 }
 
-GenerateEntry Generator::processDirectory(const std::filesystem::path& filePath, const Manifest& manifest, bool containedNewData) {
+GenerateEntry Generator::processDirectory(const std::filesystem::path& filePath, const std::filesystem::path& relativePath, const Manifest& manifest, bool containedNewData) {
 	//We'll only check in our map of existing entries if we know that the directly didn't contain any changed entries.
 	if (!containedNewData && !mConfig.existingEntries.empty()) {
-		auto relativePath = std::filesystem::relative(filePath, mSourceDirectory) / "";
-		auto existingI = mConfig.existingEntries.find(relativePath);
+		//The source directory itself is stored as "./".
+		auto existingI = mConfig.existingEntries.find(relativePath.empty() ? std::filesystem::path("./") : relativePath / "");
 		if (existingI != mConfig.existingEntries.end()) {
 			auto fileLastWriteTime = std::filesystem::last_write_time(filePath);
 			if (existingI->second.lastWriteTime == fileLastWriteTime) {
@@ -149,7 +240,7 @@ GenerateEntry Generator::processDirectory(const std::filesystem::path& filePath,
 	auto signature = generateSignature(manifest);
 	logger->debug("Signature is {} for manifest {}", signature.str_view(), filePath.generic_string());
 	auto storeEntry = mRepository.store(signature, manifest);
-	if (storeEntry.status == StoreStatus::SUCCESS && !mConfig.skipLastWriteTime) {
+	if (storeEntry.status == StoreStatus::SUCCESS && !storeEntry.packLocation && !mConfig.skipLastWriteTime) {
 		std::filesystem::last_write_time(storeEntry.localPath, std::filesystem::last_write_time(filePath));
 	}
 	std::int64_t combinedSize = 0;
@@ -165,27 +256,19 @@ SignatureResult Generator::generateSignature(std::istream& stream) {
 	blake3_hasher hasher;
 	blake3_hasher_init(&hasher);
 	std::int64_t size = 0;
+	std::vector<char> buffer(readBufferSize);
 	while (stream) {
-		std::array<char, 4096> buffer{};
-		stream.read(buffer.data(), buffer.size());
+		stream.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
 		auto dataRead = stream.gcount();
 		size += dataRead;
 		auto ptr = reinterpret_cast<const uint8_t*>(buffer.data());
 		blake3_hasher_update(&hasher, ptr, dataRead);
 	}
-	std::array<uint8_t, BLAKE3_OUT_LEN> output{};
-	blake3_hasher_finalize(&hasher, output.data(), BLAKE3_OUT_LEN);
-
-	std::stringstream ss;
-	for (size_t i = 0; i < BLAKE3_OUT_LEN; ++i) {
-		unsigned int c = output[i];
-		ss << std::hex << c;
-	}
-	return {.signature = Signature{ss.str()}, .size = size};
+	return {.signature = toSignature(hasher), .size = size};
 }
 
 SignatureResult Generator::generateSignature(const std::filesystem::path& filePath) {
-	std::ifstream file(filePath);
+	std::ifstream file(filePath, std::ios::binary);
 	if (file.is_open()) {
 		return generateSignature(file);
 	} else {
@@ -196,7 +279,11 @@ SignatureResult Generator::generateSignature(const std::filesystem::path& filePa
 Signature Generator::generateSignature(const Manifest& manifest) {
 	std::stringstream ss;
 	ss << manifest;
-	return generateSignature(ss).signature;
+	auto data = ss.str();
+	blake3_hasher hasher;
+	blake3_hasher_init(&hasher);
+	blake3_hasher_update(&hasher, data.data(), data.size());
+	return toSignature(hasher);
 }
 
 std::optional<SignatureResult> Generator::generateSignature(SignatureGenerationContext& context, size_t maxIterations) {
@@ -213,22 +300,53 @@ std::optional<SignatureResult> Generator::generateSignature(SignatureGenerationC
 		}
 		iterations++;
 	}
+	return {{.signature = toSignature(context.hasher), .size = context.size}};
+
+}
+
+
+Signature Generator::toSignature(blake3_hasher& hasher) {
+	static constexpr char hexDigits[] = "0123456789abcdef";
 	std::array<uint8_t, BLAKE3_OUT_LEN> output{};
-	blake3_hasher_finalize(&context.hasher, output.data(), BLAKE3_OUT_LEN);
+	blake3_hasher_finalize(&hasher, output.data(), BLAKE3_OUT_LEN);
 
-	std::stringstream ss;
-	for (size_t i = 0; i < BLAKE3_OUT_LEN; ++i) {
-		unsigned int c = output[i];
-		ss << std::hex << c;
+	//Note that each byte is written without padding, so a value below 0x10 only results in one character.
+	//This is how signatures always have been generated, so it must be kept.
+	std::array<char, Signature::maxDigestLength> digest{};
+	size_t length = 0;
+	for (auto c: output) {
+		if (c >= 0x10) {
+			digest[length++] = hexDigits[c >> 4];
+		}
+		digest[length++] = hexDigits[c & 0xf];
 	}
-	return {{.signature = Signature{ss.str()}, .size = context.size}};
-
+	return Signature{digest, length};
 }
 
-
 std::filesystem::path Generator::linkFile(const std::filesystem::path& filePath, const Signature& signature) {
+	//Files with the same content might be processed at the same time, so make sure only one of them is copied at a time.
+	std::string key(signature.str_view());
+	{
+		std::unique_lock lock(mLinkMutex);
+		mLinkCondition.wait(lock, [&]() { return !mSignaturesBeingLinked.contains(key); });
+		mSignaturesBeingLinked.insert(key);
+	}
+	struct LinkGuard {
+		Generator& generator;
+		const std::string& key;
+
+		~LinkGuard() {
+			{
+				std::lock_guard lock(generator.mLinkMutex);
+				generator.mSignaturesBeingLinked.erase(key);
+			}
+			generator.mLinkCondition.notify_all();
+		}
+	} linkGuard{*this, key};
+
 	auto result = mRepository.store(signature, filePath);
-	if (result.status == StoreStatus::SUCCESS && !mConfig.skipLastWriteTime) {
+	//Entries in packs have no write time of their own.
+	if (result.status == StoreStatus::SUCCESS && !result.packLocation && !mConfig.skipLastWriteTime) {
 		auto lastWriteTime = std::filesystem::last_write_time(filePath);
 		logger->trace("Setting last write time of file '{}' to {}.", filePath.string(), lastWriteTime.time_since_epoch().count());
 		std::filesystem::last_write_time(result.localPath, lastWriteTime);
@@ -268,18 +386,24 @@ std::map<std::filesystem::path, Generator::ExistingEntry> Generator::readExistin
 			combinedSize += entry.size;
 		}
 
-		entries.emplace("./",
-						ExistingEntry{.fileEntry= FileEntry{
-								.fileName="",
-								.signature=rootDirectorySignature,
-								.type=FileEntryType::DIRECTORY,
-								.size=combinedSize
-						},
-								.lastWriteTime=std::filesystem::last_write_time(fetchRootResult.fetchResult.localPath),
-								.repositoryPath=fetchRootResult.fetchResult.localPath});
+		//Entries in packs have no write time of their own, so they can't be used to detect unchanged files and are left out.
+		if (!fetchRootResult.fetchResult.packLocation) {
+			entries.emplace("./",
+							ExistingEntry{.fileEntry= FileEntry{
+									.fileName="",
+									.signature=rootDirectorySignature,
+									.type=FileEntryType::DIRECTORY,
+									.size=combinedSize
+							},
+									.lastWriteTime=std::filesystem::last_write_time(fetchRootResult.fetchResult.localPath),
+									.repositoryPath=fetchRootResult.fetchResult.localPath});
+		}
 		for (Squall::Iterator i(repository, *fetchRootResult.manifest); i != Squall::Iterator{}; ++i) {
 			auto entry = *i;
 			auto pathToFileInRepository = repository.resolvePathForSignature(entry.fileEntry.signature);
+			if (!exists(pathToFileInRepository)) {
+				continue;
+			}
 			auto lastWriteTime = std::filesystem::last_write_time(pathToFileInRepository);
 			logger->trace("Reading existing entry '{}' with last write time of {}.", pathToFileInRepository.string(), lastWriteTime.time_since_epoch().count());
 			entries.emplace(entry.path, ExistingEntry{.fileEntry = entry.fileEntry, .lastWriteTime=lastWriteTime, .repositoryPath=pathToFileInRepository});
@@ -21,7 +21,11 @@
 
 #include <regex>
 #include <fstream>
+#include <future>
+#include <mutex>
+#include <condition_variable>
 #include <unordered_map>
+#include <unordered_set>
 #include "Repository.h"
 #include "Manifest.h"
 #include "blake3.h"
@@ -58,6 +62,14 @@ struct GenerateResult {
 struct DirectoryIterator {
 	std::filesystem::directory_iterator iterator;
 	std::vector<GenerateEntry> entries;
+	/**
+	 * Files which are being processed in the background. These must all be done before the directory is complete.
+	 */
+	std::vector<std::future<GenerateEntry>> pendingEntries;
+	/**
+	 * The path relative to the source directory.
+	 */
+	std::filesystem::path relativePath;
 };
 
 struct SignatureResult {
@@ -124,10 +136,16 @@ public:
 		 * which means that the repository data will be regenerated each time we ask the Generator to process it.
 		 */
 		bool skipLastWriteTime;
+		/**
+		 * The number of threads used for hashing and copying files. If set to 0 the number of hardware threads will be used.
+		 */
+		size_t threads;
 	};
 
 	Generator(Repository& repository, std::filesystem::path sourceDirectory, Config config = {});
 
+	~Generator();
+
 	GenerateResult process(size_t filesToProcess);
 
 	static SignatureResult generateSignature(const std::filesystem::path& filePath);
@@ -138,6 +156,11 @@ public:
 
 	static std::optional<SignatureResult> generateSignature(SignatureGenerationContext& context, size_t maxIterations);
 
+	/**
+	 * Finalizes a hasher into a signature.
+	 */
+	static Signature toSignature(blake3_hasher& hasher);
+
 	/**
 	 * Generates a map of entries from an existing repository. This is then used with Config::existingEntries to allow the Generator to skip entries that are unchanged.
 	 * @param repository
@@ -155,9 +178,22 @@ protected:
 
 	std::vector<GenerateEntry> mGeneratedEntries;
 
-	GenerateEntry processFile(const std::filesystem::path& filePath);
+	struct WorkerPool;
+	/**
+	 * Files are hashed and copied in the background, while the directories are being walked.
+	 */
+	std::unique_ptr<WorkerPool> mWorkerPool;
+
+	/**
+	 * Guards against files with the same content being copied into the repository at the same time.
+	 */
+	std::mutex mLinkMutex;
+	std::condition_variable mLinkCondition;
+	std::unordered_set<std::string> mSignaturesBeingLinked;
+
+	GenerateEntry processFile(const std::filesystem::path& filePath, const std::filesystem::path& relativePath);
 
-	GenerateEntry processDirectory(const std::filesystem::path& filePath, const Manifest& manifest, bool containedNewData);
+	GenerateEntry processDirectory(const std::filesystem::path& filePath, const std::filesystem::path& relativePath, const Manifest& manifest, bool containedNewData);
 
 	std::filesystem::path linkFile(const std::filesystem::path& filePath, const Signature& signature);
 
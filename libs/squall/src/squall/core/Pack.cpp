@@ -0,0 +1,226 @@
+/*
+ Copyright (C) 2026 Erik Ogenvik
+
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#include "Pack.h"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <stdexcept>
+
+#ifndef _WIN32
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#endif
+
+namespace Squall {
+
+namespace {
+constexpr std::array<char, 4> indexMagic{'S', 'Q', 'P', 'I'};
+constexpr std::uint32_t indexVersion = 1;
+constexpr size_t headerSize = 16;
+constexpr size_t entrySize = Signature::maxDigestLength + 16;
+constexpr size_t copyBufferSize = 256 * 1024;
+
+std::uint64_t readUint(const char* data, size_t bytes) {
+	std::uint64_t value = 0;
+	for (size_t i = 0; i < bytes; ++i) {
+		value |= static_cast<std::uint64_t>(static_cast<unsigned char>(data[i])) << (i * 8);
+	}
+	return value;
+}
+
+void writeUint(std::ostream& stream, std::uint64_t value, size_t bytes) {
+	for (size_t i = 0; i < bytes; ++i) {
+		stream.put(static_cast<char>((value >> (i * 8)) & 0xFF));
+	}
+}
+
+std::string_view signatureOfEntry(const char* entry) {
+	return {entry, strnlen(entry, Signature::maxDigestLength)};
+}
+}
+
+std::filesystem::path Pack::indexPathFor(const std::filesystem::path& dataPath) {
+	auto indexPath = dataPath;
+	indexPath.replace_extension(indexExtension);
+	return indexPath;
+}
+
+Pack::Pack(std::filesystem::path dataPath)
+		: mDataPath(std::move(dataPath)) {
+	auto indexPath = indexPathFor(mDataPath);
+#ifndef _WIN32
+	auto fd = ::open(indexPath.c_str(), O_RDONLY);
+	if (fd != -1) {
+		struct stat statResult{};
+		if (::fstat(fd, &statResult) == 0 && statResult.st_size > 0) {
+			auto mapping = ::mmap(nullptr, static_cast<size_t>(statResult.st_size), PROT_READ, MAP_SHARED, fd, 0);
+			if (mapping != MAP_FAILED) {
+				mIndex = static_cast<const char*>(mapping);
+				mIndexSize = static_cast<size_t>(statResult.st_size);
+				mIsMapped = true;
+			}
+		}
+		::close(fd);
+	}
+#endif
+	if (!mIsMapped) {
+		std::ifstream stream(indexPath, std::ios::binary);
+		if (!stream) {
+			throw std::runtime_error("Could not open pack index " + indexPath.generic_string());
+		}
+		mIndexBuffer.assign(std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>());
+		mIndex = mIndexBuffer.data();
+		mIndexSize = mIndexBuffer.size();
+	}
+
+	if (mIndexSize < headerSize || std::memcmp(mIndex, indexMagic.data(), indexMagic.size()) != 0) {
+		throw std::runtime_error("Pack index " + indexPath.generic_string() + " is not valid.");
+	}
+	if (readUint(mIndex + 4, 4) != indexVersion) {
+		throw std::runtime_error("Pack index " + indexPath.generic_string() + " has an unsupported version.");
+	}
+	mEntryCount = readUint(mIndex + 8, 8);
+	if ((mIndexSize - headerSize) / entrySize < mEntryCount) {
+		throw std::runtime_error("Pack index " + indexPath.generic_string() + " is truncated.");
+	}
+}
+
+Pack::~Pack() {
+#ifndef _WIN32
+	if (mIsMapped) {
+		::munmap(const_cast<char*>(mIndex), mIndexSize);
+	}
+#endif
+}
+
+const char* Pack::entryAt(size_t index) const {
+	return mIndex + headerSize + (index * entrySize);
+}
+
+std::optional<PackLocation> Pack::find(const Signature& signature) const {
+	auto digest = signature.str_view();
+	size_t low = 0;
+	size_t high = mEntryCount;
+	while (low < high) {
+		auto middle = low + ((high - low) / 2);
+		auto comparison = signatureOfEntry(entryAt(middle)).compare(digest);
+		if (comparison == 0) {
+			return locationAt(middle);
+		} else if (comparison < 0) {
+			low = middle + 1;
+		} else {
+			high = middle;
+		}
+	}
+	return std::nullopt;
+}
+
+Signature Pack::signatureAt(size_t index) const {
+	return {signatureOfEntry(entryAt(index))};
+}
+
+PackLocation Pack::locationAt(size_t index) const {
+	auto entry = entryAt(index);
+	return {.offset = readUint(entry + Signature::maxDigestLength, 8), .size = readUint(entry + Signature::maxDigestLength + 8, 8)};
+}
+
+PackWriter::PackWriter(std::filesystem::path dataPath)
+		: mDataPath(std::move(dataPath)) {
+	std::filesystem::create_directories(mDataPath.parent_path());
+	mDataStream.open(mDataPath, std::ios::out | std::ios::binary | std::ios::trunc);
+	if (!mDataStream) {
+		throw std::runtime_error("Could not create pack " + mDataPath.generic_string());
+	}
+}
+
+bool PackWriter::add(const Signature& signature, std::istream& stream, std::uint64_t size) {
+	std::vector<char> buffer(std::min<std::uint64_t>(size, copyBufferSize));
+	auto remaining = size;
+	while (remaining > 0) {
+		auto chunk = static_cast<std::streamsize>(std::min<std::uint64_t>(remaining, buffer.size()));
+		stream.read(buffer.data(), chunk);
+		if (stream.gcount() != chunk) {
+			return false;
+		}
+		mDataStream.write(buffer.data(), chunk);
+		remaining -= static_cast<std::uint64_t>(chunk);
+	}
+	if (!mDataStream) {
+		return false;
+	}
+	mEntries.emplace_back(Entry{.signature = signature, .location = {.offset = mOffset, .size = size}});
+	mOffset += size;
+	return true;
+}
+
+bool PackWriter::add(const Signature& signature, const std::filesystem::path& path) {
+	std::ifstream stream(path, std::ios::binary);
+	std::error_code ec;
+	auto size = std::filesystem::file_size(path, ec);
+	if (!stream || ec) {
+		return false;
+	}
+	return add(signature, stream, size);
+}
+
+bool PackWriter::finish() {
+	mDataStream.close();
+	if (!mDataStream) {
+		return false;
+	}
+	std::sort(mEntries.begin(), mEntries.end(), [](const Entry& lhs, const Entry& rhs) {
+		return lhs.signature.str_view() < rhs.signature.str_view();
+	});
+	//Lookups would only ever find one of any duplicates, so there's no need to keep them.
+	mEntries.erase(std::unique(mEntries.begin(), mEntries.end(), [](const Entry& lhs, const Entry& rhs) {
+		return lhs.signature == rhs.signature;
+	}), mEntries.end());
+
+	auto indexPath = Pack::indexPathFor(mDataPath);
+	auto temporaryIndexPath = indexPath;
+	temporaryIndexPath += ".tmp";
+	{
+		std::ofstream indexStream(temporaryIndexPath, std::ios::out | std::ios::binary | std::ios::trunc);
+		indexStream.write(indexMagic.data(), indexMagic.size());
+		writeUint(indexStream, indexVersion, 4);
+		writeUint(indexStream, mEntries.size(), 8);
+		std::array<char, Signature::maxDigestLength> paddedSignature{};
+		for (auto& entry: mEntries) {
+			paddedSignature.fill(0);
+			std::copy_n(entry.signature.digest.begin(), entry.signature.digestLength, paddedSignature.begin());
+			indexStream.write(paddedSignature.data(), paddedSignature.size());
+			writeUint(indexStream, entry.location.offset, 8);
+			writeUint(indexStream, entry.location.size, 8);
+		}
+		indexStream.close();
+		if (!indexStream) {
+			return false;
+		}
+	}
+	std::error_code ec;
+	std::filesystem::rename(temporaryIndexPath, indexPath, ec);
+	return !ec;
+}
+
+}
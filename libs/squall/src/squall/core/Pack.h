@@ -0,0 +1,150 @@
+/*
+ Copyright (C) 2026 Erik Ogenvik
+
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#ifndef SQUALL_PACK_H
+#define SQUALL_PACK_H
+
+#include "Signature.h"
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace Squall {
+
+/**
+ * Where the data for a signature is found inside a pack data file.
+ */
+struct PackLocation {
+	std::uint64_t offset;
+	std::uint64_t size;
+};
+
+/**
+ * A read only pack, in which the data for many signatures is stored in one file.
+ *
+ * A pack consists of two files: a data file (with the extension ".pack") into which the data of all entries is
+ * appended, and an index file (with the extension ".idx") with the signatures sorted, so that they can be looked up
+ * with a binary search. The index is memory mapped where supported.
+ *
+ * The index starts with a header of the magic "SQPI", a version and the number of entries. Each entry is then
+ * the signature (padded with zeroes to Signature::maxDigestLength), the offset into the data file and the size.
+ * All numbers are stored as little endian.
+ *
+ * Packs are never altered once written; instead they are replaced by new packs when compacted.
+ */
+class Pack {
+public:
+	static constexpr std::string_view dataExtension = ".pack";
+	static constexpr std::string_view indexExtension = ".idx";
+
+	/**
+	 * Opens an existing pack.
+	 * @param dataPath The path to the data file. The index file is expected to be next to it.
+	 * @throws std::runtime_error If the index can't be read or isn't valid.
+	 */
+	explicit Pack(std::filesystem::path dataPath);
+
+	~Pack();
+
+	Pack(const Pack&) = delete;
+
+	Pack& operator=(const Pack&) = delete;
+
+	std::optional<PackLocation> find(const Signature& signature) const;
+
+	/**
+	 * @return The number of entries.
+	 */
+	size_t size() const {
+		return mEntryCount;
+	}
+
+	/**
+	 * @return The signature of the entry at the index, in sorted order.
+	 */
+	Signature signatureAt(size_t index) const;
+
+	PackLocation locationAt(size_t index) const;
+
+	const std::filesystem::path& getDataPath() const {
+		return mDataPath;
+	}
+
+	static std::filesystem::path indexPathFor(const std::filesystem::path& dataPath);
+
+private:
+	std::filesystem::path mDataPath;
+	const char* mIndex = nullptr;
+	size_t mIndexSize = 0;
+	size_t mEntryCount = 0;
+	/**
+	 * Used when the index can't be memory mapped.
+	 */
+	std::vector<char> mIndexBuffer;
+	bool mIsMapped = false;
+
+	const char* entryAt(size_t index) const;
+};
+
+/**
+ * Writes a new pack. Entries are appended to the data file as they are added, and the index is written when finished.
+ *
+ * The index is first written to a temporary file and then renamed, so that an index only ever exists for complete packs.
+ */
+class PackWriter {
+public:
+	/**
+	 * @throws std::runtime_error If the data file can't be created.
+	 */
+	explicit PackWriter(std::filesystem::path dataPath);
+
+	/**
+	 * Appends the data for a signature, read from the stream.
+	 * @return False if the data could not be read or written.
+	 */
+	bool add(const Signature& signature, std::istream& stream, std::uint64_t size);
+
+	bool add(const Signature& signature, const std::filesystem::path& path);
+
+	size_t size() const {
+		return mEntries.size();
+	}
+
+	/**
+	 * Writes the index, after which the pack can be opened.
+	 * @return False if it could not be written.
+	 */
+	bool finish();
+
+private:
+	struct Entry {
+		Signature signature;
+		PackLocation location;
+	};
+	std::filesystem::path mDataPath;
+	std::ofstream mDataStream;
+	std::uint64_t mOffset = 0;
+	std::vector<Entry> mEntries;
+};
+
+}
+
+#endif //SQUALL_PACK_H
@@ -19,13 +19,17 @@
 #include "Provider.h"
 
 namespace Squall {
+std::future<ProviderResult> Provider::fetchDelta(Signature, Signature, std::filesystem::path) {
+	std::promise<ProviderResult> promise;
+	promise.set_value(ProviderResult{.status=ProviderResultStatus::FAILURE});
+	return promise.get_future();
+}
+
 std::future<ProviderResult> RepositoryProvider::fetch(Squall::Signature signature, std::filesystem::path destination) {
-	auto fetchResult = mRepo.fetch(signature);
+	auto fetchResult = mRepo.extract(signature, destination);
 	if (fetchResult.status == FetchStatus::SUCCESS) {
-		std::filesystem::create_directories(destination.parent_path());
-		std::filesystem::copy_file(fetchResult.localPath, destination, std::filesystem::copy_options::skip_existing);
 		std::promise<ProviderResult> promise;
-		promise.set_value(ProviderResult{.status=ProviderResultStatus::SUCCESS, .bytesCopied=std::filesystem::file_size(fetchResult.localPath)});
+		promise.set_value(ProviderResult{.status=ProviderResultStatus::SUCCESS, .bytesCopied=std::filesystem::file_size(destination)});
 		return promise.get_future();
 	} else {
 		std::promise<ProviderResult> promise;
@@ -33,4 +37,17 @@ std::future<ProviderResult> RepositoryProvider::fetch(Squall::Signature signatur
 		return promise.get_future();
 	}
 }
+
+std::future<ProviderResult> RepositoryProvider::fetchDelta(Signature base, Signature target, std::filesystem::path destination) {
+	auto fetchResult = mRepo.fetchDelta(base, target);
+	std::promise<ProviderResult> promise;
+	if (fetchResult.status == FetchStatus::SUCCESS) {
+		std::filesystem::create_directories(destination.parent_path());
+		std::filesystem::copy_file(fetchResult.localPath, destination, std::filesystem::copy_options::overwrite_existing);
+		promise.set_value(ProviderResult{.status=ProviderResultStatus::SUCCESS, .bytesCopied=std::filesystem::file_size(destination)});
+	} else {
+		promise.set_value(ProviderResult{.status=ProviderResultStatus::FAILURE});
+	}
+	return promise.get_future();
+}
 }
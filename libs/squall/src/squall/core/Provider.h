@@ -23,6 +23,7 @@
 #include "Repository.h"
 #include <future>
 #include <filesystem>
+#include <optional>
 
 namespace Squall {
 enum class ProviderResultStatus {
@@ -32,6 +33,11 @@ enum class ProviderResultStatus {
 struct ProviderResult {
 	ProviderResultStatus status;
 	size_t bytesCopied;
+	/**
+	 * The signature of the data, if the provider calculated it while writing the data.
+	 * If not set, it will instead be calculated from the written file.
+	 */
+	std::optional<Signature> signature;
 };
 
 /**
@@ -50,6 +56,19 @@ struct Provider {
 	 */
 	virtual std::future<ProviderResult> fetch(Signature signature,
 											  std::filesystem::path destination) = 0;
+
+	/**
+	 * Fetches a delta (see Delta) which turns the data of the base signature into the data of the target signature.
+	 * Not all providers support this, and deltas only exist for some pairs of signatures, so callers must be prepared
+	 * to instead fetch the target in full.
+	 * @param base
+	 * @param target
+	 * @param destination A local path where we want the delta to be written.
+	 * @return
+	 */
+	virtual std::future<ProviderResult> fetchDelta(Signature base,
+												   Signature target,
+												   std::filesystem::path destination);
 };
 
 /**
@@ -64,6 +83,10 @@ struct RepositoryProvider : public Provider {
 	std::future<ProviderResult> fetch(Signature signature,
 									  std::filesystem::path destination) override;
 
+	std::future<ProviderResult> fetchDelta(Signature base,
+										   Signature target,
+										   std::filesystem::path destination) override;
+
 };
 }
 
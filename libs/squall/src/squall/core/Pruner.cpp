@@ -18,7 +18,6 @@
 
 #include "Pruner.h"
 #include "Iterator.h"
-#include <set>
 
 namespace Squall {
 std::vector<std::filesystem::path> Pruner::findAbandonedFiles(const Squall::Repository& repository) {
@@ -58,4 +57,30 @@ std::vector<std::filesystem::path> Pruner::findAbandonedFiles(const Squall::Repo
 
 }
 
-}
\ No newline at end of file
+std::set<std::string> Pruner::findReachableSignatures(const Squall::Repository& repository) {
+	std::set<std::string> signatures;
+	for (const auto& root: repository.listRoots()) {
+		auto manifestResult = repository.fetchManifest(root.second.signature);
+		if (manifestResult.manifest) {
+			signatures.emplace(root.second.signature.str());
+			Squall::Iterator i(repository, *manifestResult.manifest);
+			for (; i != Squall::Iterator{}; ++i) {
+				if (i) {
+					signatures.emplace((*i).fileEntry.signature.str());
+				} else {
+					break;
+				}
+			}
+		}
+	}
+	return signatures;
+}
+
+PackResult Pruner::compactPacks(Squall::Repository& repository) {
+	auto reachableSignatures = findReachableSignatures(repository);
+	return repository.repack([&](const Signature& signature) {
+		return reachableSignatures.contains(signature.str());
+	});
+}
+
+}
@@ -20,6 +20,7 @@
 #define WORLDFORGE_PRUNER_H
 
 #include "Repository.h"
+#include <set>
 
 namespace Squall {
 
@@ -34,6 +35,16 @@ struct Pruner {
 	 */
 	static std::vector<std::filesystem::path> findAbandonedFiles(const Squall::Repository& repository);
 
+	/**
+	 * Rewrites all packs into one, leaving out any entries that aren't reachable by any roots.
+	 * @param repository
+	 * @return
+	 */
+	static PackResult compactPacks(Squall::Repository& repository);
+
+private:
+	static std::set<std::string> findReachableSignatures(const Squall::Repository& repository);
+
 };
 }
 
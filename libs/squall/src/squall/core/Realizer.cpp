@@ -48,9 +48,17 @@ RealizeResult Realizer::poll() {
 			std::filesystem::create_directories(entryDestinationPath);
 			return {.status = RealizeStatus::INPROGRESS};
 		} else {
-			auto repositoryPath = mRepository.resolvePathForSignature(entry.fileEntry.signature);
+			auto fetchResult = mRepository.fetch(entry.fileEntry.signature);
+			auto repositoryPath = fetchResult.status == FetchStatus::SUCCESS ? fetchResult.localPath : mRepository.resolvePathForSignature(entry.fileEntry.signature);
 			std::filesystem::create_directories(entryDestinationPath.parent_path());
-			if (mConfig.method == RealizeMethod::SYMLINK) {
+			if (fetchResult.packLocation) {
+				//Data in packs can't be linked to, so it's always copied.
+				logger->debug("Copying from pack {} to {}", repositoryPath.generic_string(), entryDestinationPath.generic_string());
+				if (exists(entryDestinationPath)) {
+					remove(entryDestinationPath);
+				}
+				mRepository.extract(entry.fileEntry.signature, entryDestinationPath);
+			} else if (mConfig.method == RealizeMethod::SYMLINK) {
 				if (exists(entryDestinationPath)) {
 					logger->debug("Removing existing file {}", entryDestinationPath.generic_string());
 					remove(entryDestinationPath);
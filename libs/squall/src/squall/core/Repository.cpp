@@ -17,14 +17,56 @@
  */
 
 #include "Repository.h"
+#include "Log.h"
 
 #include <utility>
 #include <filesystem>
 #include <fstream>
+#include <sstream>
 #include <algorithm>
+#include <chrono>
 
 namespace Squall {
 
+namespace {
+bool copyRange(std::istream& in, std::ostream& out, std::uint64_t size) {
+	std::vector<char> buffer(std::min<std::uint64_t>(size, 256 * 1024));
+	while (size > 0) {
+		auto chunk = static_cast<std::streamsize>(std::min<std::uint64_t>(size, buffer.size()));
+		in.read(buffer.data(), chunk);
+		if (in.gcount() != chunk) {
+			return false;
+		}
+		out.write(buffer.data(), chunk);
+		size -= static_cast<std::uint64_t>(chunk);
+	}
+	return out.good();
+}
+
+void removeWithEmptyParent(const std::filesystem::path& path) {
+	std::error_code ec;
+	remove(path, ec);
+	if (ec) {
+		logger->warn("Error when trying to delete file {}: {}", path.generic_string(), ec.message());
+	} else if (std::filesystem::is_directory(path.parent_path(), ec) && std::filesystem::is_empty(path.parent_path(), ec)) {
+		remove(path.parent_path(), ec);
+	}
+}
+
+std::filesystem::file_time_type packsModified(const std::filesystem::path& packsPath) {
+	std::error_code ec;
+	auto modified = std::filesystem::last_write_time(packsPath, ec);
+	return ec ? std::filesystem::file_time_type::min() : modified;
+}
+}
+
+std::uint64_t FetchResult::size() const {
+	if (packLocation) {
+		return packLocation->size;
+	}
+	return std::filesystem::file_size(localPath);
+}
+
 void setupEncodings() {
 	/**
 	 * In order for us to read file names the same on all platforms we need to use the UTF-8 encoding.
@@ -37,11 +79,68 @@ void setupEncodings() {
 
 
 Repository::Repository(const std::filesystem::path& repositoryPath)
-		: mRepositoryPath(std::filesystem::absolute(repositoryPath)) {
+		: mRepositoryPath(std::filesystem::absolute(repositoryPath)),
+		  mPackSet(std::make_shared<PackSet>()) {
 	std::filesystem::create_directories(mRepositoryPath);
+	loadPacks();
+}
+
+void Repository::loadPacks() const {
+	//Taken before listing the packs, so that any pack written meanwhile causes another reload.
+	auto modified = packsModified(mRepositoryPath / "packs");
+	auto packs = std::make_shared<PackList>();
+	std::error_code ec;
+	std::vector<std::filesystem::path> dataPaths;
+	for (std::filesystem::directory_iterator I(mRepositoryPath / "packs", ec); !ec && I != std::filesystem::directory_iterator(); I.increment(ec)) {
+		//Packs without an index haven't been completely written.
+		if (I->path().extension() == Pack::dataExtension && exists(Pack::indexPathFor(I->path()))) {
+			dataPaths.emplace_back(I->path());
+		}
+	}
+	std::sort(dataPaths.begin(), dataPaths.end());
+	for (auto& dataPath: dataPaths) {
+		try {
+			packs->emplace_back(std::make_shared<Pack>(dataPath));
+		} catch (const std::exception& ex) {
+			logger->error("Could not load pack: {}", ex.what());
+		}
+	}
+	//Only lock to swap the packs, so that fetches aren't held up by a reload.
+	std::lock_guard lock(mPackSet->mutex);
+	mPackSet->modified = modified;
+	mPackSet->packs = std::move(packs);
+}
+
+std::shared_ptr<const Repository::PackList> Repository::currentPacks() const {
+	//Stat outside of the lock, as this is done on every lookup.
+	auto modified = packsModified(mRepositoryPath / "packs");
+	{
+		std::lock_guard lock(mPackSet->mutex);
+		if (modified == mPackSet->modified) {
+			return mPackSet->packs;
+		}
+	}
+	//The directory changed, for example by "squall pack" or "squall prune" being run against the repository.
+	loadPacks();
+	std::lock_guard lock(mPackSet->mutex);
+	return mPackSet->packs;
+}
+
+std::optional<FetchResult> Repository::fetchPacked(const Signature& signature) const {
+	auto packs = currentPacks();
+	for (auto& pack: *packs) {
+		auto location = pack->find(signature);
+		if (location) {
+			return FetchResult{.status=FetchStatus::SUCCESS, .localPath = pack->getDataPath(), .packLocation = location};
+		}
+	}
+	return std::nullopt;
 }
 
 StoreResult Repository::store(const Signature& signature, const std::vector<char>& data) {
+	if (auto packed = fetchPacked(signature)) {
+		return {.status = StoreStatus::SUCCESS, .localPath = packed->localPath, .packLocation = packed->packLocation};
+	}
 	auto fullPath = resolvePathForSignature(signature);
 	std::filesystem::create_directories(fullPath.parent_path());
 	std::ofstream fileStream(fullPath, std::ios::out | std::ios::binary);
@@ -54,6 +153,9 @@ StoreResult Repository::store(const Signature& signature, const std::vector<char
 }
 
 StoreResult Repository::store(const Signature& signature, const std::filesystem::path& path) {
+	if (auto packed = fetchPacked(signature)) {
+		return {.status = StoreStatus::SUCCESS, .localPath = packed->localPath, .packLocation = packed->packLocation};
+	}
 	auto fullPath = resolvePathForSignature(signature);
 	if (!exists(fullPath)) {
 		std::filesystem::create_directories(fullPath.parent_path());
@@ -63,6 +165,9 @@ StoreResult Repository::store(const Signature& signature, const std::filesystem:
 }
 
 StoreResult Repository::store(const Signature& signature, const Manifest& manifest) {
+	if (auto packed = fetchPacked(signature)) {
+		return {.status = StoreStatus::SUCCESS, .localPath = packed->localPath, .packLocation = packed->packLocation};
+	}
 	auto fullPath = resolvePathForSignature(signature);
 	std::filesystem::create_directories(fullPath.parent_path());
 	std::ofstream fileStream(fullPath, std::ios::out | std::ios::binary);
@@ -75,6 +180,10 @@ StoreResult Repository::store(const Signature& signature, const Manifest& manife
 }
 
 FetchResult Repository::fetch(const Signature& signature) const {
+	//Packed data is looked for first, which costs a check of the "packs" directory to see if the packs need to be reloaded.
+	if (auto packed = fetchPacked(signature)) {
+		return *packed;
+	}
 	auto fullPath = resolvePathForSignature(signature);
 	if (exists(fullPath)) {
 		return {.status=FetchStatus::SUCCESS, .localPath = fullPath};
@@ -89,6 +198,9 @@ std::filesystem::path Repository::resolvePathForSignature(const Signature& signa
 }
 
 bool Repository::contains(const Signature& signature) const {
+	if (fetchPacked(signature)) {
+		return true;
+	}
 	auto path = resolvePathForSignature(signature);
 	return exists(path);
 }
@@ -97,16 +209,223 @@ FetchManifestResult Repository::fetchManifest(const Signature& signature) const
 	auto fetchResult = fetch(signature);
 	FetchManifestResult fetchManifestResult{.fetchResult=fetchResult};
 	if (fetchResult.status == FetchStatus::SUCCESS) {
-		std::ifstream stream(fetchResult.localPath);
-		if (stream.is_open()) {
-			Manifest manifest;
-			manifest << stream;
-			fetchManifestResult.manifest = std::move(manifest);
+		if (fetchResult.packLocation) {
+			std::ifstream stream(fetchResult.localPath, std::ios::binary);
+			if (stream.is_open()) {
+				std::string content(fetchResult.packLocation->size, '\0');
+				stream.seekg(static_cast<std::streamoff>(fetchResult.packLocation->offset));
+				stream.read(content.data(), static_cast<std::streamsize>(content.size()));
+				if (static_cast<std::uint64_t>(stream.gcount()) == content.size()) {
+					std::istringstream contentStream(std::move(content));
+					Manifest manifest;
+					manifest << contentStream;
+					fetchManifestResult.manifest = std::move(manifest);
+				}
+			}
+		} else {
+			std::ifstream stream(fetchResult.localPath);
+			if (stream.is_open()) {
+				Manifest manifest;
+				manifest << stream;
+				fetchManifestResult.manifest = std::move(manifest);
+			}
 		}
 	}
 	return fetchManifestResult;
 }
 
+std::optional<std::vector<char>> Repository::readData(const Signature& signature) const {
+	auto fetchResult = fetch(signature);
+	if (fetchResult.status != FetchStatus::SUCCESS) {
+		return std::nullopt;
+	}
+	std::ifstream stream(fetchResult.localPath, std::ios::binary);
+	if (!stream) {
+		return std::nullopt;
+	}
+	if (fetchResult.packLocation) {
+		stream.seekg(static_cast<std::streamoff>(fetchResult.packLocation->offset));
+	}
+	std::vector<char> data(fetchResult.size());
+	stream.read(data.data(), static_cast<std::streamsize>(data.size()));
+	if (static_cast<std::uint64_t>(stream.gcount()) != data.size()) {
+		return std::nullopt;
+	}
+	return data;
+}
+
+std::filesystem::path Repository::resolvePathForDelta(const Signature& base, const Signature& target) const {
+	return mRepositoryPath / "deltas" / base.str_view() / target.str_view();
+}
+
+StoreResult Repository::storeDelta(const Signature& base, const Signature& target, const std::vector<char>& data) {
+	auto fullPath = resolvePathForDelta(base, target);
+	std::filesystem::create_directories(fullPath.parent_path());
+	std::ofstream fileStream(fullPath, std::ios::out | std::ios::binary);
+	if (fileStream.good()) {
+		fileStream.write(data.data(), static_cast<std::streamsize>(data.size()));
+		return {.status = StoreStatus::SUCCESS, .localPath = fullPath};
+	} else {
+		return {.status = StoreStatus::FAILURE};
+	}
+}
+
+FetchResult Repository::fetchDelta(const Signature& base, const Signature& target) const {
+	auto fullPath = resolvePathForDelta(base, target);
+	if (exists(fullPath)) {
+		return {.status=FetchStatus::SUCCESS, .localPath = fullPath};
+	} else {
+		return {.status=FetchStatus::FAILURE};
+	}
+}
+
+FetchResult Repository::extract(const Signature& signature, const std::filesystem::path& destination) const {
+	auto fetchResult = fetch(signature);
+	if (fetchResult.status != FetchStatus::SUCCESS) {
+		return fetchResult;
+	}
+	if (!destination.parent_path().empty()) {
+		std::filesystem::create_directories(destination.parent_path());
+	}
+	if (!fetchResult.packLocation) {
+		std::filesystem::copy_file(fetchResult.localPath, destination, std::filesystem::copy_options::skip_existing);
+	} else if (!exists(destination)) {
+		std::ifstream in(fetchResult.localPath, std::ios::binary);
+		in.seekg(static_cast<std::streamoff>(fetchResult.packLocation->offset));
+		std::ofstream out(destination, std::ios::out | std::ios::binary);
+		if (!in || !out || !copyRange(in, out, fetchResult.packLocation->size)) {
+			out.close();
+			std::error_code ec;
+			remove(destination, ec);
+			return {.status=FetchStatus::FAILURE};
+		}
+	}
+	return {.status=FetchStatus::SUCCESS, .localPath = destination};
+}
+
+std::filesystem::path Repository::newPackPath() const {
+	auto packsPath = mRepositoryPath / "packs";
+	auto timestamp = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+	for (int i = 0;; ++i) {
+		auto path = packsPath / ("pack-" + std::to_string(timestamp) + "-" + std::to_string(i) + std::string(Pack::dataExtension));
+		if (!exists(path)) {
+			return path;
+		}
+	}
+}
+
+PackResult Repository::packLooseData() {
+	std::vector<std::pair<Signature, std::filesystem::path>> looseFiles;
+	auto dataPath = mRepositoryPath / "data";
+	if (exists(dataPath)) {
+		for (std::filesystem::recursive_directory_iterator I(dataPath); I != std::filesystem::recursive_directory_iterator{}; ++I) {
+			if (I->is_regular_file()) {
+				//Files are stored as "<first two characters>/<remaining characters>".
+				Signature signature(I->path().parent_path().filename().generic_string() + I->path().filename().generic_string());
+				if (signature.isValid()) {
+					looseFiles.emplace_back(signature, I->path());
+				}
+			}
+		}
+	}
+	if (looseFiles.empty()) {
+		return {.status=StoreStatus::SUCCESS, .packedEntries = 0, .removedEntries = 0};
+	}
+
+	auto packPath = newPackPath();
+	{
+		PackWriter writer(packPath);
+		for (auto& entry: looseFiles) {
+			if (!writer.add(entry.first, entry.second)) {
+				logger->error("Could not add {} to pack {}.", entry.second.generic_string(), packPath.generic_string());
+				std::error_code ec;
+				remove(packPath, ec);
+				return {.status=StoreStatus::FAILURE};
+			}
+		}
+		if (!writer.finish()) {
+			logger->error("Could not write index for pack {}.", packPath.generic_string());
+			std::error_code ec;
+			remove(packPath, ec);
+			return {.status=StoreStatus::FAILURE};
+		}
+	}
+	loadPacks();
+
+	//Only remove the loose files once the pack is complete.
+	for (auto& entry: looseFiles) {
+		removeWithEmptyParent(entry.second);
+	}
+	return {.status=StoreStatus::SUCCESS, .localPath = packPath, .packedEntries = looseFiles.size(), .removedEntries = 0};
+}
+
+PackResult Repository::repack(const std::function<bool(const Signature&)>& keep) {
+	auto oldPacks = *currentPacks();
+	if (oldPacks.empty()) {
+		return {.status=StoreStatus::SUCCESS, .packedEntries = 0, .removedEntries = 0};
+	}
+
+	auto packPath = newPackPath();
+	size_t packedEntries = 0;
+	size_t removedEntries = 0;
+	{
+		PackWriter writer(packPath);
+		for (auto& pack: oldPacks) {
+			std::ifstream stream(pack->getDataPath(), std::ios::binary);
+			for (size_t i = 0; i < pack->size(); ++i) {
+				auto signature = pack->signatureAt(i);
+				if (!keep(signature)) {
+					removedEntries++;
+					continue;
+				}
+				auto location = pack->locationAt(i);
+				stream.seekg(static_cast<std::streamoff>(location.offset));
+				if (!writer.add(signature, stream, location.size)) {
+					logger->error("Could not copy {} from pack {}.", signature.str_view(), pack->getDataPath().generic_string());
+					std::error_code ec;
+					remove(packPath, ec);
+					return {.status=StoreStatus::FAILURE};
+				}
+			}
+		}
+		if (!writer.finish()) {
+			logger->error("Could not write index for pack {}.", packPath.generic_string());
+			std::error_code ec;
+			remove(packPath, ec);
+			return {.status=StoreStatus::FAILURE};
+		}
+		packedEntries = writer.size();
+	}
+
+	std::vector<std::filesystem::path> oldDataPaths;
+	for (auto& pack: oldPacks) {
+		oldDataPaths.emplace_back(pack->getDataPath());
+	}
+	//Release our mappings before removing the files, which is needed on some platforms.
+	oldPacks.clear();
+	{
+		std::lock_guard lock(mPackSet->mutex);
+		mPackSet->packs = std::make_shared<PackList>();
+		mPackSet->modified = std::filesystem::file_time_type::min();
+	}
+	for (auto& oldDataPath: oldDataPaths) {
+		std::error_code ec;
+		remove(Pack::indexPathFor(oldDataPath), ec);
+		remove(oldDataPath, ec);
+		if (ec) {
+			logger->warn("Error when trying to delete pack {}: {}", oldDataPath.generic_string(), ec.message());
+		}
+	}
+	if (packedEntries == 0) {
+		std::error_code ec;
+		remove(Pack::indexPathFor(packPath), ec);
+		remove(packPath, ec);
+		packPath.clear();
+	}
+	loadPacks();
+	return {.status=StoreStatus::SUCCESS, .localPath = packPath, .packedEntries = packedEntries, .removedEntries = removedEntries};
+}
+
 std::map<std::string, Root> Repository::listRoots() const {
 	auto rootsPath = mRepositoryPath / "roots";
 	std::filesystem::directory_iterator iterator(rootsPath);
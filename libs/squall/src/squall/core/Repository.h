@@ -21,10 +21,14 @@
 
 #include "Manifest.h"
 #include "Root.h"
+#include "Pack.h"
 #include <filesystem>
+#include <functional>
 #include <future>
 #include <optional>
 #include <map>
+#include <memory>
+#include <mutex>
 
 namespace Squall {
 
@@ -43,6 +47,10 @@ enum class StoreStatus {
 struct StoreResult {
 	StoreStatus status;
 	std::filesystem::path localPath;
+	/**
+	 * Set if the data already was stored in a pack, in which case localPath is the pack data file.
+	 */
+	std::optional<PackLocation> packLocation;
 };
 
 enum class FetchStatus {
@@ -53,6 +61,26 @@ enum class FetchStatus {
 struct FetchResult {
 	FetchStatus status;
 	std::filesystem::path localPath;
+	/**
+	 * Set if the data is stored in a pack, in which case localPath is the pack data file and the data is found at this location in it.
+	 * If not set the data is the whole of the file at localPath.
+	 */
+	std::optional<PackLocation> packLocation;
+
+	/**
+	 * @return The size of the data.
+	 */
+	std::uint64_t size() const;
+};
+
+struct PackResult {
+	StoreStatus status;
+	/**
+	 * The data file of the new pack, if any was written.
+	 */
+	std::filesystem::path localPath;
+	size_t packedEntries;
+	size_t removedEntries;
 };
 
 struct FetchManifestResult {
@@ -62,6 +90,11 @@ struct FetchManifestResult {
 
 /**
  * Represents a repository on disk, where all assets and roots are stored.
+ *
+ * Data is either stored as loose files, one for each signature, or in packs (see Pack) in the "packs" directory.
+ * Packs are read transparently. They are loaded when the repository is created, and reloaded whenever the "packs"
+ * directory changes, so that packs written or removed by other processes are picked up.
+ * New data is always stored as loose files, which can then be moved into a pack through packLooseData().
  */
 class Repository {
 public:
@@ -87,8 +120,44 @@ public:
 
 	FetchManifestResult fetchManifest(const Signature& signature) const;
 
+	/**
+	 * Copies the data for the signature to a file, regardless of whether it's stored loose or in a pack.
+	 * Any existing file is kept.
+	 * @return The result, where localPath is the destination.
+	 */
+	FetchResult extract(const Signature& signature, const std::filesystem::path& destination) const;
+
 	bool contains(const Signature& signature) const;
 
+	/**
+	 * Reads the data for the signature into memory, regardless of whether it's stored loose or in a pack.
+	 */
+	std::optional<std::vector<char>> readData(const Signature& signature) const;
+
+	/**
+	 * Stores a delta (see Delta) which turns the data of one signature into the data of another.
+	 * Deltas are stored as "deltas/<base signature>/<target signature>".
+	 */
+	StoreResult storeDelta(const Signature& base, const Signature& target, const std::vector<char>& data);
+
+	FetchResult fetchDelta(const Signature& base, const Signature& target) const;
+
+	std::filesystem::path resolvePathForDelta(const Signature& base, const Signature& target) const;
+
+	/**
+	 * Moves all loose data into a new pack.
+	 */
+	PackResult packLooseData();
+
+	/**
+	 * Rewrites all packs into a single new pack, keeping only the entries for which the predicate returns true.
+	 */
+	PackResult repack(const std::function<bool(const Signature&)>& keep);
+
+	std::vector<std::shared_ptr<const Pack>> getPacks() const {
+		return *currentPacks();
+	}
+
 	std::filesystem::path resolvePathForSignature(const Signature& signature) const;
 
 	/**
@@ -108,6 +177,32 @@ private:
 
 	std::filesystem::path mRepositoryPath;
 
+	using PackList = std::vector<std::shared_ptr<const Pack>>;
+
+	struct PackSet {
+		std::mutex mutex;
+		std::shared_ptr<const PackList> packs;
+		/**
+		 * When the "packs" directory was last changed as of loading the packs.
+		 */
+		std::filesystem::file_time_type modified;
+	};
+
+	/**
+	 * Shared between copies, so that a reload is seen by all of them.
+	 */
+	std::shared_ptr<PackSet> mPackSet;
+
+	void loadPacks() const;
+
+	/**
+	 * @return The packs, reloaded first if the "packs" directory has changed since they were loaded.
+	 */
+	std::shared_ptr<const PackList> currentPacks() const;
+
+	std::filesystem::path newPackPath() const;
+
+	std::optional<FetchResult> fetchPacked(const Signature& signature) const;
 
 };
 
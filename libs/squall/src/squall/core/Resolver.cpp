@@ -18,189 +18,291 @@
 
 #include "Resolver.h"
 #include "Generator.h"
+#include "Delta.h"
 #include "Log.h"
 
 #include <utility>
+#include <algorithm>
+#include <fstream>
+#include <future>
 
 namespace Squall {
-Resolver::Resolver(Repository destinationRepository, std::unique_ptr<Provider> provider, Signature rootSignature) :
+
+namespace {
+/**
+ * Limits how many entries which already exist locally are handled in each poll, to keep each poll short.
+ */
+constexpr size_t maxEntriesCheckedPerPoll = 100;
+}
+
+Resolver::Resolver(Repository destinationRepository, std::unique_ptr<Provider> provider, Signature rootSignature, size_t maxConcurrentFetches) :
 		mDestinationRepository(std::move(destinationRepository)),
 		mProvider(std::move(provider)),
-		mRootSignature(rootSignature) {
+		mRootSignature(rootSignature),
+		mMaxConcurrentFetches(std::max<size_t>(1, maxConcurrentFetches)) {
 	if (!mRootSignature.isValid()) {
 		throw std::runtime_error("Signature is not valid; can't proceed with resolver.");
 	}
+	mDirectories.emplace_back(Iterator::TraverseEntry{.fileEntry = FileEntry{.signature = mRootSignature, .type = FileEntryType::DIRECTORY}});
+}
+
+bool Resolver::isBeingFetched(const Signature& signature) const {
+	return std::any_of(mPendingFetches.begin(), mPendingFetches.end(), [&](const PendingFetch& pending) { return pending.expectedSignature == signature; });
+}
+
+void Resolver::setPreviousRoot(const Signature& previousRootSignature) {
+	mPreviousFiles.clear();
+	auto manifestResult = mDestinationRepository.fetchManifest(previousRootSignature);
+	if (manifestResult.manifest) {
+		for (auto iterator = Iterator(mDestinationRepository, *manifestResult.manifest, true); iterator && iterator != Iterator(); iterator++) {
+			auto traverseEntry = *iterator;
+			if (traverseEntry.fileEntry.type == FileEntryType::FILE) {
+				mPreviousFiles.emplace(traverseEntry.path.generic_string(), traverseEntry.fileEntry.signature);
+			}
+		}
+	}
+}
+
+std::optional<Signature> Resolver::findDeltaBase(const Iterator::TraverseEntry& entry) const {
+	if (entry.fileEntry.type != FileEntryType::FILE || entry.fileEntry.size < static_cast<std::int64_t>(DeltaConfig{}.minimumSize)) {
+		return std::nullopt;
+	}
+	auto I = mPreviousFiles.find(entry.path.generic_string());
+	if (I == mPreviousFiles.end() || I->second == entry.fileEntry.signature || !mDestinationRepository.contains(I->second)) {
+		return std::nullopt;
+	}
+	return I->second;
 }
 
-Resolver::FetchResult Resolver::fetch(Signature signature) {
-	if (mDestinationRepository.contains(signature)) {
-		return FetchResult::EXISTS_IN_REPO_ALREADY;
+void Resolver::startFetch(Iterator::TraverseEntry entry) {
+	auto& signature = entry.fileEntry.signature;
+	auto filename = buildTemporaryPath(signature);
+	auto deltaBase = findDeltaBase(entry);
+	std::future<ProviderResult> resultFuture;
+	if (deltaBase) {
+		logger->debug("Fetching delta from signature '{}' to '{}'.", deltaBase->str_view(), signature.str_view());
+		auto deltaPath = buildDeltaPath(signature);
+		//Applying the delta means reading and hashing the whole target, so it's done in the background rather than when polled.
+		resultFuture = std::async(std::launch::async,
+								  [repository = mDestinationRepository, deltaFuture = mProvider->fetchDelta(*deltaBase, signature, deltaPath), base = *deltaBase, signature, deltaPath, filename]() mutable {
+									  return applyDelta(repository, deltaFuture.get(), base, signature, deltaPath, filename);
+								  });
 	} else {
-		//Just put a new request for the next file
-		auto filename = buildTemporaryPath(signature);
 		logger->debug("Fetching signature '{}' and temporarily storing it in '{}'", signature.str_view(), filename.generic_string());
-		auto resultFuture = mProvider->fetch(signature, filename);
-		mPendingFetches.emplace_back(
-				PendingFetch{
-						.expectedSignature = signature,
-						.temporaryPath = filename,
-						.providerResultFuture = std::move(resultFuture)
-				}
-		);
-		return Squall::Resolver::FetchResult::IS_FETCHED_FROM_REMOTE;
+		resultFuture = mProvider->fetch(signature, filename);
 	}
+	mPendingFetches.emplace_back(
+			PendingFetch{
+					.expectedSignature = signature,
+					.temporaryPath = filename,
+					.repositoryPath = std::move(entry.path),
+					.type = entry.fileEntry.type,
+					.deltaBase = deltaBase,
+					.providerResultFuture = std::move(resultFuture)
+			}
+	);
 }
 
-ResolveResult Resolver::pollRootSignature() {
-	if (mPendingFetches.empty()) {
-		auto fetchResult = fetch(mRootSignature);
-		if (fetchResult == FetchResult::EXISTS_IN_REPO_ALREADY) {
-			mRootManifest = mDestinationRepository.fetchManifest(mRootSignature).manifest;
-			mIterator = Iterator(mDestinationRepository, *mRootManifest);
-			return {.status = ResolveStatus::ONGOING, .pendingRequests = mPendingFetches.size(), .completedRequests = {
-					{.signature=mRootSignature, .status=ResolveEntryStatus::ALREADY_EXISTS, .bytesCopied=0}}};
+ProviderResult Resolver::applyDelta(const Repository& repository,
+									ProviderResult deltaResult,
+									const Signature& base,
+									const Signature& target,
+									const std::filesystem::path& deltaPath,
+									const std::filesystem::path& targetPath) {
+	struct DeltaFileRemover {
+		const std::filesystem::path& path;
+
+		~DeltaFileRemover() {
+			std::error_code ec;
+			std::filesystem::remove(path, ec);
 		}
+	} deltaFileRemover{deltaPath};
+
+	if (deltaResult.status != ProviderResultStatus::SUCCESS) {
+		return deltaResult;
+	}
+	auto baseData = repository.readData(base);
+	std::ifstream deltaStream(deltaPath, std::ios::binary);
+	if (!baseData || !deltaStream) {
+		return {.status = ProviderResultStatus::FAILURE};
+	}
+	std::vector<char> delta{std::istreambuf_iterator<char>(deltaStream), std::istreambuf_iterator<char>()};
+	auto targetData = Delta::apply(*baseData, delta);
+	if (!targetData) {
+		logger->warn("Delta from signature {} to {} was invalid.", base.str_view(), target.str_view());
+		return {.status = ProviderResultStatus::FAILURE};
+	}
+
+	blake3_hasher hasher;
+	blake3_hasher_init(&hasher);
+	blake3_hasher_update(&hasher, targetData->data(), targetData->size());
+	auto signature = Generator::toSignature(hasher);
+	if (signature != target) {
+		logger->warn("Applying delta from signature {} resulted in signature {}, instead of the expected {}.", base.str_view(), signature.str_view(), target.str_view());
+		return {.status = ProviderResultStatus::FAILURE};
+	}
+
+	std::filesystem::create_directories(targetPath.parent_path());
+	std::ofstream targetStream(targetPath, std::ios::out | std::ios::binary | std::ios::trunc);
+	targetStream.write(targetData->data(), static_cast<std::streamsize>(targetData->size()));
+	targetStream.close();
+	if (!targetStream) {
+		return {.status = ProviderResultStatus::FAILURE};
 	}
-	auto& lastProviderResultFuture = mPendingFetches.back().providerResultFuture;
-	if (lastProviderResultFuture.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
-		auto lastPending = std::move(mPendingFetches.back());
-		auto result = lastPending.providerResultFuture.get();
-		mPendingFetches.pop_back();
-		if (result.status == ProviderResultStatus::SUCCESS) {
-			mDestinationRepository.store(lastPending.expectedSignature, lastPending.temporaryPath);
-			mRootManifest = mDestinationRepository.fetchManifest(mRootSignature).manifest;
-			mIterator = Iterator(mDestinationRepository, *mRootManifest);
-			{
-				std::error_code ec;
-				remove(lastPending.temporaryPath, ec);
-				if (ec) {
-					logger->warn("Error when trying to remove temporary file '{}'. This is not fatal, but means that there's probably a left over file. Error: {}",
-								 lastPending.temporaryPath.string(), ec.message());
-				}
+	//Report the size of the delta, since that's what was transferred.
+	return {.status = ProviderResultStatus::SUCCESS, .bytesCopied = delta.size(), .signature = signature};
+}
+
+void Resolver::expandDirectory(const std::filesystem::path& path, const Signature& signature) {
+	auto manifestResult = mDestinationRepository.fetchManifest(signature);
+	if (!manifestResult.manifest) {
+		throw std::runtime_error("Could not read manifest " + signature.str() + ".");
+	}
+	for (auto& fileEntry: manifestResult.manifest->entries) {
+		auto& queue = fileEntry.type == FileEntryType::DIRECTORY ? mDirectories : mFiles;
+		queue.emplace_back(Iterator::TraverseEntry{.path = path / fileEntry.fileName, .fileEntry = fileEntry});
+	}
+}
+
+void Resolver::queueFetches(std::vector<ResolveEntry>& completedRequests) {
+	size_t entriesToCheck = maxEntriesCheckedPerPoll;
+	while (entriesToCheck > 0 && mPendingFetches.size() < mMaxConcurrentFetches) {
+		//Directories go first, since they add more entries.
+		auto& queue = mDirectories.empty() ? mFiles : mDirectories;
+		if (queue.empty()) {
+			break;
+		}
+		entriesToCheck--;
+		auto entry = std::move(queue.front());
+		queue.pop_front();
+
+		if (mDestinationRepository.contains(entry.fileEntry.signature)) {
+			completedRequests.emplace_back(
+					ResolveEntry{.signature = entry.fileEntry.signature, .status = ResolveEntryStatus::ALREADY_EXISTS, .bytesCopied = 0, .path = entry.path});
+			if (entry.fileEntry.type == FileEntryType::DIRECTORY) {
+				expandDirectory(entry.path, entry.fileEntry.signature);
 			}
-			return {.status = ResolveStatus::ONGOING, .pendingRequests = mPendingFetches.size(), .completedRequests = {
-					{.signature=mRootSignature, .status=ResolveEntryStatus::COPIED, .bytesCopied=result.bytesCopied}}};
+		} else if (isBeingFetched(entry.fileEntry.signature)) {
+			mDuplicates.emplace_back(std::move(entry));
 		} else {
-			logger->error("Provider could not fetch {}.", lastPending.temporaryPath.generic_string());
-			return {.status = ResolveStatus::HAD_ERROR};
+			startFetch(std::move(entry));
 		}
 	}
-	return {.status = ResolveStatus::ONGOING, .pendingRequests = mPendingFetches.size(), .completedRequests = {}};
 }
 
-std::optional<ResolveResult> Resolver::processPendingFetched(size_t maxSignatureGenerationIterations, std::vector<ResolveEntry> completedRequests) {
-	for (auto I = mPendingFetches.begin(); I != mPendingFetches.end(); I++) {
+bool Resolver::processPendingFetches(size_t maxSignatureGenerationIterations, std::vector<ResolveEntry>& completedRequests) {
+	bool anyCompleted = false;
+	//Only one file is hashed in each poll, to keep to the limit of iterations.
+	bool hasHashed = false;
+	for (auto I = mPendingFetches.begin(); I != mPendingFetches.end();) {
 		auto& pending = *I;
 
 		if (pending.providerResultFuture.valid() && pending.providerResultFuture.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
 			pending.providerResult = pending.providerResultFuture.get();
 		}
 
-		if (pending.providerResult) {
-			auto& providerResult = *pending.providerResult;
-			if (pending.signatureGeneratorContext || providerResult.status == ProviderResultStatus::SUCCESS) {
-				if (!pending.signatureGeneratorContext) {
-					pending.signatureGeneratorContext = SignatureGenerationContext{std::ifstream{pending.temporaryPath}};
-				}
-
-				//Make sure that the signature really matches what's in the file
-				auto signatureResult = Generator::generateSignature(*pending.signatureGeneratorContext, maxSignatureGenerationIterations);
-				if (signatureResult) {
-					if (!signatureResult->signature.isValid()) {
-						logger->error("Could not generate signature for file {}, with expected signature {}.", pending.temporaryPath.generic_string(), pending.expectedSignature.str_view());
-						remove(pending.temporaryPath);
-						completedRequests.emplace_back(
-								ResolveEntry{.signature=signatureResult->signature, .status=ResolveEntryStatus::COPIED, .bytesCopied=providerResult.bytesCopied, .path=pending.repositoryPath});
-						mPendingFetches.erase(I);
-						return {{.status = ResolveStatus::HAD_ERROR, .pendingRequests = mPendingFetches.size(), .completedRequests = completedRequests}};
-					}
-					if (signatureResult->signature != pending.expectedSignature) {
-						logger->error("File {} had a different signature than expected. Expected signature: {}, actual signature: {}.", pending.temporaryPath.generic_string(),
-									  pending.expectedSignature.str_view(), signatureResult->signature.str_view());
-						remove(pending.temporaryPath);
-						completedRequests.emplace_back(
-								ResolveEntry{.signature=signatureResult->signature, .status=ResolveEntryStatus::COPIED, .bytesCopied=providerResult.bytesCopied, .path=pending.repositoryPath});
-						mPendingFetches.erase(I);
-						return {{.status = ResolveStatus::HAD_ERROR, .pendingRequests = mPendingFetches.size(), .completedRequests = completedRequests}};
-					}
-
-					logger->debug("Successfully fetched signature {} into temporary path {}, will now store in repository. This data can be accessed as {}.", signatureResult->signature.str_view(),
-								  pending.temporaryPath.generic_string(), pending.repositoryPath.string());
-					mDestinationRepository.store(signatureResult->signature, pending.temporaryPath);
-					{
-						std::error_code ec;
-						remove(pending.temporaryPath, ec);
-						if (ec) {
-							logger->warn("Error when trying to remove temporary file '{}'. This is not fatal, but means that there's probably a left over file. Error: {}",
-										 pending.temporaryPath.string(), ec.message());
-						}
-					}
-					completedRequests.emplace_back(
-							ResolveEntry{.signature=signatureResult->signature, .status=ResolveEntryStatus::COPIED, .bytesCopied=providerResult.bytesCopied, .path=pending.repositoryPath});
-					mPendingFetches.erase(I);
-				}
-				return {{.status = ResolveStatus::ONGOING, .pendingRequests = mPendingFetches.size(), .completedRequests = completedRequests}};
+		if (!pending.providerResult) {
+			++I;
+			continue;
+		}
+
+		if (pending.deltaBase) {
+			//The delta has already been applied and verified in the background, see startFetch().
+			pending.deltaBase.reset();
+			if (pending.providerResult->status != ProviderResultStatus::SUCCESS) {
+				logger->debug("Could not use delta for {}, fetching it in full instead.", pending.repositoryPath.generic_string());
+				pending.providerResult.reset();
+				pending.providerResultFuture = mProvider->fetch(pending.expectedSignature, pending.temporaryPath);
+				++I;
+				continue;
+			}
+		}
+		auto& providerResult = *pending.providerResult;
+		if (providerResult.status != ProviderResultStatus::SUCCESS) {
+			logger->error("Provider could not fetch {}.", pending.temporaryPath.generic_string());
+			return false;
+		}
+
+		std::optional<SignatureResult> signatureResult;
+		if (providerResult.signature) {
+			//The provider calculated the signature while writing the data, so there's no need to read it again.
+			signatureResult = SignatureResult{.signature = *providerResult.signature, .size = static_cast<std::int64_t>(providerResult.bytesCopied)};
+		} else {
+			if (hasHashed) {
+				++I;
+				continue;
+			}
+			hasHashed = true;
+			if (!pending.signatureGeneratorContext) {
+				pending.signatureGeneratorContext = SignatureGenerationContext{std::ifstream{pending.temporaryPath, std::ios::binary}};
+			}
+			signatureResult = Generator::generateSignature(*pending.signatureGeneratorContext, maxSignatureGenerationIterations);
+			if (!signatureResult) {
+				++I;
+				continue;
+			}
+		}
+
+		//Make sure that the signature really matches what's in the file
+		if (!signatureResult->signature.isValid() || signatureResult->signature != pending.expectedSignature) {
+			if (!signatureResult->signature.isValid()) {
+				logger->error("Could not generate signature for file {}, with expected signature {}.", pending.temporaryPath.generic_string(), pending.expectedSignature.str_view());
 			} else {
-				return {{.status = ResolveStatus::HAD_ERROR, .pendingRequests = mPendingFetches.size(), .completedRequests = completedRequests}};
+				logger->error("File {} had a different signature than expected. Expected signature: {}, actual signature: {}.", pending.temporaryPath.generic_string(),
+							  pending.expectedSignature.str_view(), signatureResult->signature.str_view());
+			}
+			std::error_code ec;
+			remove(pending.temporaryPath, ec);
+			completedRequests.emplace_back(
+					ResolveEntry{.signature=signatureResult->signature, .status=ResolveEntryStatus::COPIED, .bytesCopied=providerResult.bytesCopied, .path=pending.repositoryPath});
+			mPendingFetches.erase(I);
+			return false;
+		}
+
+		logger->debug("Successfully fetched signature {} into temporary path {}, will now store in repository. This data can be accessed as {}.", signatureResult->signature.str_view(),
+					  pending.temporaryPath.generic_string(), pending.repositoryPath.string());
+		mDestinationRepository.store(signatureResult->signature, pending.temporaryPath);
+		{
+			std::error_code ec;
+			remove(pending.temporaryPath, ec);
+			if (ec) {
+				logger->warn("Error when trying to remove temporary file '{}'. This is not fatal, but means that there's probably a left over file. Error: {}",
+							 pending.temporaryPath.string(), ec.message());
 			}
 		}
+		completedRequests.emplace_back(
+				ResolveEntry{.signature=signatureResult->signature, .status=ResolveEntryStatus::COPIED, .bytesCopied=providerResult.bytesCopied, .path=pending.repositoryPath});
+		if (pending.type == FileEntryType::DIRECTORY) {
+			expandDirectory(pending.repositoryPath, pending.expectedSignature);
+		}
+		I = mPendingFetches.erase(I);
+		anyCompleted = true;
 	}
-	return {};
-}
 
+	if (anyCompleted && !mDuplicates.empty()) {
+		//These will now either be found in the repository, or fetched if the fetch with the same signature failed.
+		for (auto& entry: mDuplicates) {
+			auto& queue = entry.fileEntry.type == FileEntryType::DIRECTORY ? mDirectories : mFiles;
+			queue.emplace_front(std::move(entry));
+		}
+		mDuplicates.clear();
+	}
+	return true;
+}
 
 ResolveResult Resolver::poll(size_t maxSignatureGenerationIterations) {
 	try {
-		//If we haven't gotten our root manifest we should start with that. That requires slightly different logic.
-		if (!mRootManifest) {
-			return pollRootSignature();
-		} else {
-			std::vector<ResolveEntry> completedRequests;
-			if (mIterator == Iterator()) {
-				return {.status = ResolveStatus::COMPLETE};
-			} else {
-				//Check if the Iterator points at an entry that already exists in the local repository.
-				if (mIterator) {
-					completedRequests.emplace_back(
-							ResolveEntry{.signature = (*mIterator).fileEntry.signature, .status = ResolveEntryStatus::ALREADY_EXISTS, .bytesCopied = 0, .path = (*mIterator).path});
-					++mIterator;
-				} else if (mPendingFetches.empty()) {
-					auto traverseEntry = *mIterator;
-					if (traverseEntry.fileEntry.type == FileEntryType::FILE) {
-						//Just put a new request for the next file
-						auto filename = buildTemporaryPath(traverseEntry.fileEntry.signature);
-						auto result = mProvider->fetch(traverseEntry.fileEntry.signature, filename);
-						mPendingFetches.emplace_back(
-								PendingFetch{
-										.expectedSignature = traverseEntry.fileEntry.signature,
-										.temporaryPath = filename,
-										.repositoryPath = traverseEntry.path,
-										.providerResultFuture = std::move(result)
-								}
-						);
-					} else {
-						//Check if we're already looking for the directory entry. If so we will just keep on waiting.
-						if (mPendingFetches.empty() || mPendingFetches.back().expectedSignature != traverseEntry.fileEntry.signature) {
-							auto filename = buildTemporaryPath(traverseEntry.fileEntry.signature);
-							auto result = mProvider->fetch(traverseEntry.fileEntry.signature, filename);
-							mPendingFetches.emplace_back(
-									PendingFetch{
-											.expectedSignature = traverseEntry.fileEntry.signature,
-											.temporaryPath = filename,
-											.repositoryPath = traverseEntry.path,
-											.providerResultFuture = std::move(result),
-									}
-							);
-						}
-					}
-				}
-			}
-			auto processResult = processPendingFetched(maxSignatureGenerationIterations, std::move(completedRequests));
-			if (processResult) {
-				return *processResult;
-			}
+		std::vector<ResolveEntry> completedRequests;
+		//Handle finished fetches first, since any fetched manifests will add more entries.
+		if (!processPendingFetches(maxSignatureGenerationIterations, completedRequests)) {
+			return {.status = ResolveStatus::HAD_ERROR, .pendingRequests = mPendingFetches.size(), .completedRequests = std::move(completedRequests)};
+		}
+		queueFetches(completedRequests);
+
+		if (completedRequests.empty() && mPendingFetches.empty() && mDirectories.empty() && mFiles.empty() && mDuplicates.empty()) {
+			return {.status = ResolveStatus::COMPLETE};
 		}
-		return {.status = ResolveStatus::ONGOING, .pendingRequests = mPendingFetches.size(), .completedRequests = {}};
+		return {.status = ResolveStatus::ONGOING, .pendingRequests = mPendingFetches.size(), .completedRequests = std::move(completedRequests)};
 	} catch (const std::exception& ex) {
 		logger->error("Error when polling in resolver: {}", ex.what());
 		return {.status = ResolveStatus::HAD_ERROR, .pendingRequests = mPendingFetches.size(), .completedRequests = {}};
@@ -211,4 +313,10 @@ ResolveResult Resolver::poll(size_t maxSignatureGenerationIterations) {
 std::filesystem::path Resolver::buildTemporaryPath(const Signature& signature) {
 	return mDestinationRepository.getPath() / "temp" / signature.str_view();
 }
-}
\ No newline at end of file
+
+std::filesystem::path Resolver::buildDeltaPath(const Signature& signature) {
+	auto path = buildTemporaryPath(signature);
+	path += ".delta";
+	return path;
+}
+}
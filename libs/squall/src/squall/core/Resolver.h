@@ -25,6 +25,10 @@
 #include "Iterator.h"
 #include "Generator.h"
 
+#include <deque>
+#include <list>
+#include <map>
+
 namespace Squall {
 
 enum class ResolveStatus {
@@ -85,6 +89,14 @@ struct PendingFetch {
 	 * The path within the Squall repository. This is kept mainly to allow for other component to keep track of the progress.
 	 */
 	std::filesystem::path repositoryPath;
+	/**
+	 * Directories will be expanded once their manifests have been fetched.
+	 */
+	FileEntryType type;
+	/**
+	 * Set if a delta from this signature is being fetched and applied, rather than the whole data.
+	 */
+	std::optional<Signature> deltaBase;
 
 	std::future<ProviderResult> providerResultFuture;
 	std::optional<ProviderResult> providerResult;
@@ -95,38 +107,82 @@ struct PendingFetch {
  * Used to make sure that a remote signature is fully contained in a local repository.
  *
  * This involves polling the resolver until all data has been transferred into the local repository.
+ *
+ * Multiple fetches are kept in flight at once, up to a limit. Manifests are always fetched before any files, so that
+ * the directory tree is expanded ahead of the files and there always are files ready to be fetched.
  */
 class Resolver {
 public:
+	static constexpr size_t defaultMaxConcurrentFetches = 8;
+
 	Resolver(Repository destinationRepository,
 			 std::unique_ptr<Provider> provider,
-			 Signature rootSignature);
+			 Signature rootSignature,
+			 size_t maxConcurrentFetches = defaultMaxConcurrentFetches);
 
 	ResolveResult poll(size_t maxSignatureGenerationIterations);
 
+	/**
+	 * Enables fetching deltas (see Delta) for files which have changed since the previous root, instead of fetching them in full.
+	 * The previous root must be in the repository. If a delta can't be fetched or applied the file is fetched in full.
+	 * This must be called before the first poll.
+	 */
+	void setPreviousRoot(const Signature& previousRootSignature);
+
 private:
-	enum class FetchResult {
-		EXISTS_IN_REPO_ALREADY,
-		IS_FETCHED_FROM_REMOTE
-	};
 
 	Repository mDestinationRepository;
 	std::unique_ptr<Provider> mProvider;
 	Signature mRootSignature;
+	size_t mMaxConcurrentFetches;
 
-	Iterator mIterator;
-	std::vector<PendingFetch> mPendingFetches;
-	std::optional<Manifest> mRootManifest;
+	/**
+	 * Directories which either should be fetched, or which are already in the repository and should be expanded.
+	 */
+	std::deque<Iterator::TraverseEntry> mDirectories;
+	std::deque<Iterator::TraverseEntry> mFiles;
+	/**
+	 * Entries with the same signature as an ongoing fetch. These are checked again when a fetch has completed.
+	 */
+	std::vector<Iterator::TraverseEntry> mDuplicates;
+
+	std::list<PendingFetch> mPendingFetches;
+
+	/**
+	 * Signatures of the files in the previous root, keyed by their paths.
+	 */
+	std::map<std::string, Signature> mPreviousFiles;
+
+	std::optional<Signature> findDeltaBase(const Iterator::TraverseEntry& entry) const;
 
-	FetchResult fetch(Signature signature);
+	/**
+	 * Applies a fetched delta, writing the result to the target path. This is done in a background thread.
+	 * @param deltaResult The result of fetching the delta.
+	 * @return A failure if the delta couldn't be fetched or applied, or didn't result in the expected data.
+	 */
+	static ProviderResult applyDelta(const Repository& repository,
+									 ProviderResult deltaResult,
+									 const Signature& base,
+									 const Signature& target,
+									 const std::filesystem::path& deltaPath,
+									 const std::filesystem::path& targetPath);
 
 	std::filesystem::path buildTemporaryPath(const Signature& signature);
 
-	ResolveResult pollRootSignature();
+	std::filesystem::path buildDeltaPath(const Signature& signature);
+
+	bool isBeingFetched(const Signature& signature) const;
 
-	std::optional<ResolveResult> processPendingFetched(size_t maxSignatureGenerationIterations, std::vector<ResolveEntry> completedRequests);
+	void startFetch(Iterator::TraverseEntry entry);
 
+	void expandDirectory(const std::filesystem::path& path, const Signature& signature);
 
+	void queueFetches(std::vector<ResolveEntry>& completedRequests);
+
+	/**
+	 * @return False if a fetch failed.
+	 */
+	bool processPendingFetches(size_t maxSignatureGenerationIterations, std::vector<ResolveEntry>& completedRequests);
 };
 
 }
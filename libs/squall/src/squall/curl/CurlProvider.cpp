@@ -18,6 +18,7 @@
 
 #include "CurlProvider.h"
 #include "squall/core/Log.h"
+#include "squall/core/Generator.h"
 #include <curl/curl.h>
 
 #include <utility>
@@ -30,11 +31,37 @@ CurlProvider::CurlProvider(std::string baseUrl)
 	curl_global_init(CURL_GLOBAL_ALL);
 }
 
+CurlProvider::~CurlProvider() {
+	for (auto handle: mIdleHandles) {
+		curl_easy_cleanup(handle);
+	}
+}
+
+void* CurlProvider::takeHandle() {
+	{
+		std::lock_guard lock(mHandlesMutex);
+		if (!mIdleHandles.empty()) {
+			auto handle = mIdleHandles.back();
+			mIdleHandles.pop_back();
+			return handle;
+		}
+	}
+	return curl_easy_init();
+}
+
+void CurlProvider::returnHandle(void* handle) {
+	//Resetting keeps any open connections, so they can be reused by the next fetch.
+	curl_easy_reset(handle);
+	std::lock_guard lock(mHandlesMutex);
+	mIdleHandles.push_back(handle);
+}
+
 struct CurlFileEntry {
 	CURL* easy;
 	std::fstream& file;
 	size_t bytesCopied;
 	bool hasProcessedHeaders;
+	blake3_hasher hasher;
 };
 
 static size_t curlCallback(void* data, size_t, size_t numberOfBytes, void* userData) {
@@ -49,13 +76,14 @@ static size_t curlCallback(void* data, size_t, size_t numberOfBytes, void* userD
 		curlFileEntry->hasProcessedHeaders = true;
 	}
 	curlFileEntry->file.write(static_cast<const char*>(data), static_cast<std::streamsize>(numberOfBytes));
+	blake3_hasher_update(&curlFileEntry->hasher, data, numberOfBytes);
 	curlFileEntry->bytesCopied += numberOfBytes;
 	return numberOfBytes;
 }
 
 
-std::future<ProviderResult> CurlProvider::fetch(Signature signature, std::filesystem::path destination) {
-	auto curl = curl_easy_init();
+ProviderResult CurlProvider::download(const std::string& url, const std::filesystem::path& destination, bool isOptional) {
+	auto curl = takeHandle();
 
 	if (curl) {
 		auto destinationPartialPath = destination;
@@ -63,43 +91,63 @@ std::future<ProviderResult> CurlProvider::fetch(Signature signature, std::filesy
 		create_directories(destinationPartialPath.parent_path());
 		std::fstream outputFile(destinationPartialPath, std::ios::out | std::ios::binary);
 		if (!outputFile.good()) {
-			std::promise<ProviderResult> promise;
-			promise.set_value(ProviderResult{.status=ProviderResultStatus::FAILURE});
-			return promise.get_future();
+			returnHandle(curl);
+			return ProviderResult{.status=ProviderResultStatus::FAILURE};
 		}
 
-		CurlFileEntry curlFileEntry{.easy = curl, .file = outputFile, .bytesCopied=0, .hasProcessedHeaders=false};
-
+		CurlFileEntry curlFileEntry{.easy = curl, .file = outputFile, .bytesCopied=0, .hasProcessedHeaders=false, .hasher={}};
+		blake3_hasher_init(&curlFileEntry.hasher);
 
-		auto first = signature.str_view().substr(0, 2);
-		auto second = signature.str_view().substr(2);
-
-		//Note: the "operator+" is (sillily) missing for std::string and std::string_view. Perhaps will be added in C++26?
-		auto sourceFile = mBaseUrl + "/" + std::string(first) + "/" + std::string(second);
-		curl_easy_setopt(curl, CURLOPT_URL, sourceFile.c_str());
+		curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
 		curl_easy_setopt(curl, CURLOPT_WRITEDATA, &curlFileEntry);
 		curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, curlCallback);
 
 		auto res = curl_easy_perform(curl);
 
-		curl_easy_cleanup(curl);
+		returnHandle(curl);
 		outputFile.close();
 		// something failed
 		if (res != CURLE_OK) {
-			logger->error("Curl download of file '{}' failed with error message: {}.", sourceFile, curl_easy_strerror(res));
-			std::promise<ProviderResult> promise;
-			promise.set_value(ProviderResult{.status=ProviderResultStatus::FAILURE});
-			return promise.get_future();
+			if (isOptional) {
+				logger->debug("Curl download of optional file '{}' failed with error message: {}.", url, curl_easy_strerror(res));
+			} else {
+				logger->error("Curl download of file '{}' failed with error message: {}.", url, curl_easy_strerror(res));
+			}
+			std::error_code ec;
+			std::filesystem::remove(destinationPartialPath, ec);
+			return ProviderResult{.status=ProviderResultStatus::FAILURE};
+		} else if (!outputFile) {
+			//The signature is calculated from what was received, so we must make sure it was also written.
+			logger->error("Could not write downloaded file '{}' to '{}'.", url, destinationPartialPath.generic_string());
+			return ProviderResult{.status=ProviderResultStatus::FAILURE};
 		} else {
 			std::filesystem::rename(destinationPartialPath, destination);
-			std::promise<ProviderResult> promise;
-			promise.set_value(ProviderResult{.status=ProviderResultStatus::SUCCESS, .bytesCopied=curlFileEntry.bytesCopied});
-			return promise.get_future();
+			return ProviderResult{.status=ProviderResultStatus::SUCCESS, .bytesCopied=curlFileEntry.bytesCopied, .signature=Generator::toSignature(curlFileEntry.hasher)};
 		}
 	}
+	return ProviderResult{.status=ProviderResultStatus::FAILURE};
+}
+
+std::future<ProviderResult> CurlProvider::fetch(Signature signature, std::filesystem::path destination) {
+	auto first = signature.str_view().substr(0, 2);
+	auto second = signature.str_view().substr(2);
+
+	//Note: the "operator+" is (sillily) missing for std::string and std::string_view. Perhaps will be added in C++26?
+	auto sourceFile = mBaseUrl + "/" + std::string(first) + "/" + std::string(second);
 	std::promise<ProviderResult> promise;
-	promise.set_value(ProviderResult{.status=ProviderResultStatus::FAILURE});
+	promise.set_value(download(sourceFile, destination, false));
 	return promise.get_future();
 }
 
-}
\ No newline at end of file
+std::future<ProviderResult> CurlProvider::fetchDelta(Signature base, Signature target, std::filesystem::path destination) {
+	auto sourceFile = mBaseUrl + "/deltas/" + base.str() + "/" + target.str();
+	//Deltas only exist for some files, so a missing one is expected.
+	auto result = download(sourceFile, destination, true);
+	//The signature would be that of the delta, rather than of the target.
+	result.signature.reset();
+	std::promise<ProviderResult> promise;
+	promise.set_value(result);
+	return promise.get_future();
+}
+
+}
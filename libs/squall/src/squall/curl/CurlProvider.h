@@ -21,16 +21,47 @@
 
 #include "squall/core/Provider.h"
 
+#include <mutex>
+#include <vector>
+
 namespace Squall {
+/**
+ * Fetches data through Curl.
+ *
+ * Fetching is blocking, but the provider can be used from multiple threads at once (for example through an AsyncProvider).
+ * Curl handles are reused between fetches, which allows connections to be kept alive.
+ * The signature of the data is calculated while it's being written.
+ */
 class CurlProvider : public Provider {
 public:
 	explicit CurlProvider(std::string baseUrl);
 
+	~CurlProvider() override;
+
 	std::future<ProviderResult> fetch(Signature signature,
 									  std::filesystem::path destination) override;
 
+	std::future<ProviderResult> fetchDelta(Signature base,
+										   Signature target,
+										   std::filesystem::path destination) override;
+
 protected:
 	std::string mBaseUrl;
+
+	std::mutex mHandlesMutex;
+	/**
+	 * Handles which aren't currently used by any fetch.
+	 */
+	std::vector<void*> mIdleHandles;
+
+	void* takeHandle();
+
+	void returnHandle(void* handle);
+
+	/**
+	 * @param isOptional If true, a failure is expected and only logged at debug level.
+	 */
+	ProviderResult download(const std::string& url, const std::filesystem::path& destination, bool isOptional);
 };
 }
 
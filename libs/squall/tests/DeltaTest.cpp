@@ -0,0 +1,152 @@
+/*
+ Copyright (C) 2026 Erik Ogenvik
+
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+#include "squall/core/Delta.h"
+#include "squall/core/Generator.h"
+#include <catch2/catch_test_macros.hpp>
+#include <fstream>
+#include <random>
+
+using namespace Squall;
+
+namespace {
+std::vector<char> randomData(size_t size, unsigned int seed) {
+	std::mt19937 generator(seed);
+	std::vector<char> data(size);
+	for (auto& byte: data) {
+		byte = static_cast<char>(generator() & 0xFF);
+	}
+	return data;
+}
+
+void writeFile(const std::filesystem::path& path, const std::vector<char>& data) {
+	std::filesystem::create_directories(path.parent_path());
+	std::ofstream stream(path, std::ios::binary | std::ios::trunc);
+	stream.write(data.data(), static_cast<std::streamsize>(data.size()));
+}
+
+Signature generateRoot(Repository& repository, const std::filesystem::path& sourceDirectory) {
+	Generator generator(repository, sourceDirectory);
+	while (true) {
+		auto results = generator.process(10);
+		if (results.complete) {
+			return results.processedFiles.back().fileEntry.signature;
+		}
+	}
+}
+}
+
+TEST_CASE("Delta recreates the target", "[delta]") {
+	auto base = randomData(100000, 1);
+
+	SECTION("with inserted data") {
+		auto target = base;
+		auto inserted = randomData(500, 2);
+		target.insert(target.begin() + 40000, inserted.begin(), inserted.end());
+		auto delta = Delta::create(base, target);
+		REQUIRE(delta.size() < 2000);
+		REQUIRE(Delta::apply(base, delta) == target);
+	}
+
+	SECTION("with removed and altered data") {
+		auto target = base;
+		target.erase(target.begin() + 10000, target.begin() + 12345);
+		target[70000] = static_cast<char>(target[70000] + 1);
+		auto delta = Delta::create(base, target);
+		REQUIRE(delta.size() < 3000);
+		REQUIRE(Delta::apply(base, delta) == target);
+	}
+
+	SECTION("with data moved around") {
+		std::vector<char> target(base.begin() + 50000, base.end());
+		target.insert(target.end(), base.begin(), base.begin() + 50000);
+		auto delta = Delta::create(base, target);
+		REQUIRE(delta.size() < 100);
+		REQUIRE(Delta::apply(base, delta) == target);
+	}
+
+	SECTION("with unrelated data") {
+		auto target = randomData(20000, 3);
+		auto delta = Delta::create(base, target);
+		REQUIRE(delta.size() > target.size());
+		REQUIRE(Delta::apply(base, delta) == target);
+	}
+
+	SECTION("with an empty base") {
+		auto target = randomData(5000, 4);
+		auto delta = Delta::create({}, target);
+		REQUIRE(Delta::apply({}, delta) == target);
+	}
+}
+
+TEST_CASE("Delta rejects invalid deltas", "[delta]") {
+	auto base = randomData(10000, 1);
+	auto target = base;
+	target[5000] = static_cast<char>(target[5000] + 1);
+	auto delta = Delta::create(base, target);
+
+	REQUIRE_FALSE(Delta::apply(randomData(9000, 2), delta));
+	REQUIRE_FALSE(Delta::apply(base, std::vector<char>(delta.begin(), delta.begin() + static_cast<std::ptrdiff_t>(delta.size() / 2))));
+	REQUIRE_FALSE(Delta::apply(base, std::vector<char>{'n', 'o', 'p', 'e'}));
+
+	//A header claiming a huge target shouldn't be allocated for.
+	std::vector<char> hugeTarget{'S', 'Q', 'D', '1', static_cast<char>(0x90), 0x4E};
+	hugeTarget.insert(hugeTarget.end(), 8, static_cast<char>(0x80));
+	hugeTarget.push_back(0x40);
+	REQUIRE_FALSE(Delta::apply(base, hugeTarget));
+}
+
+TEST_CASE("Delta generates deltas for altered files", "[delta]") {
+	setupEncodings();
+
+	std::filesystem::path testPath = "DeltaTestDirectory";
+	std::filesystem::remove_all(testPath);
+	Repository repository(testPath / "repo");
+
+	auto large = randomData(200000, 1);
+	writeFile(testPath / "source/large.bin", large);
+	writeFile(testPath / "source/small.bin", randomData(100, 2));
+	auto oldRoot = generateRoot(repository, testPath / "source");
+
+	large[1000] = static_cast<char>(large[1000] + 1);
+	writeFile(testPath / "source/large.bin", large);
+	writeFile(testPath / "source/small.bin", randomData(100, 3));
+	auto newRoot = generateRoot(repository, testPath / "source");
+
+	auto summary = resolveDifferences(repository, {.oldManifest = *repository.fetchManifest(oldRoot).manifest,
+			.newManifest = *repository.fetchManifest(newRoot).manifest});
+	REQUIRE(summary.alteredEntries.size() == 2);
+
+	auto result = Delta::generate(repository, summary);
+	//The small file, as well as the root directory, should be skipped.
+	REQUIRE(result.createdDeltas == 1);
+	REQUIRE(result.savedBytes > 190000);
+
+	auto alteredLarge = std::find_if(summary.alteredEntries.begin(), summary.alteredEntries.end(), [](const AlteredEntry& entry) {
+		return entry.change.path == "large.bin";
+	});
+	REQUIRE(alteredLarge != summary.alteredEntries.end());
+	auto fetchResult = repository.fetchDelta(alteredLarge->previousSignature, alteredLarge->change.signature);
+	REQUIRE(fetchResult.status == FetchStatus::SUCCESS);
+
+	std::ifstream deltaStream(fetchResult.localPath, std::ios::binary);
+	std::vector<char> delta{std::istreambuf_iterator<char>(deltaStream), std::istreambuf_iterator<char>()};
+	REQUIRE(Delta::apply(*repository.readData(alteredLarge->previousSignature), delta) == large);
+
+	//Existing deltas aren't created again.
+	REQUIRE(Delta::generate(repository, summary).createdDeltas == 0);
+}
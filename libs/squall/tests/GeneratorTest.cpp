@@ -35,6 +35,7 @@ std::ostream& operator<<(std::ostream& os, std::pair<std::string, Squall::Genera
 #include <catch2/matchers/catch_matchers_vector.hpp>
 #include <utility>
 #include <algorithm>
+#include <chrono>
 #include <spdlog/spdlog.h>
 
 using namespace Squall;
@@ -267,3 +268,82 @@ TEST_CASE("Generator ignores existing entries if specified, but updates with new
 	);
 
 }
+
+TEST_CASE("Generator reuses existing entries when only the last write time has changed", "[generator]") {
+	setupEncodings();
+
+	std::filesystem::path tempDir("GeneratorTouchedTestDirectory");
+	std::filesystem::remove_all(tempDir);
+	std::filesystem::create_directories(tempDir);
+	std::filesystem::copy(TESTDATADIR "/raw", tempDir, std::filesystem::copy_options::recursive | std::filesystem::copy_options::overwrite_existing);
+
+	Repository repository("GeneratorTouchedRepoDirectory");
+	Signature rootSignature;
+	{
+		Generator generator(repository, tempDir);
+		auto results = generator.process(10);
+		REQUIRE(results.complete == true);
+		rootSignature = results.processedFiles.back().fileEntry.signature;
+	}
+
+	//Alter the last write time of all files, without changing their content.
+	auto newLastWriteTime = std::filesystem::last_write_time(tempDir / "foo.txt") + std::chrono::hours(1);
+	for (auto& entry: std::filesystem::recursive_directory_iterator(tempDir)) {
+		if (entry.is_regular_file()) {
+			std::filesystem::last_write_time(entry.path(), newLastWriteTime);
+		}
+	}
+
+	auto existingEntries = Generator::readExistingEntries(repository, rootSignature);
+	{
+		Generator generator(repository, tempDir, {.existingEntries=existingEntries});
+		auto results = generator.process(10);
+		REQUIRE(results.complete == true);
+		REQUIRE(results.processedFiles.size() == 7);
+		REQUIRE(results.processedFiles.back().fileEntry.signature == rootSignature);
+		for (auto& entry: results.processedFiles) {
+			REQUIRE(entry.status == GenerateFileStatus::Existed);
+		}
+	}
+
+	//The last write times in the repository should now have been updated, so that the files are found unchanged without having to be hashed.
+	auto foo = repository.resolvePathForSignature("4e0bb39f3b1a3feb89f536c93be15055482df748674b0d26e5a7577772e9");
+	REQUIRE(std::filesystem::last_write_time(foo) == newLastWriteTime);
+}
+
+TEST_CASE("Generator gives the same result regardless of threads", "[generator]") {
+	setupEncodings();
+
+	std::filesystem::path tempDir("GeneratorThreadsTestDirectory");
+	std::filesystem::remove_all(tempDir);
+	for (int i = 0; i < 10; ++i) {
+		auto directory = tempDir / std::to_string(i);
+		std::filesystem::create_directories(directory);
+		for (int j = 0; j < 20; ++j) {
+			std::ofstream file(directory / std::to_string(j));
+			//Some files will have the same content.
+			file << std::string(static_cast<size_t>(j * 1000), static_cast<char>('a' + (i + j) % 5));
+		}
+	}
+
+	Signature singleThreadSignature;
+	{
+		Repository repository("GeneratorThreadsSingleRepoDirectory");
+		Generator generator(repository, tempDir, {.threads = 1});
+		auto results = generator.process(10);
+		REQUIRE(results.complete == true);
+		REQUIRE(results.processedFiles.size() == 211);
+		singleThreadSignature = results.processedFiles.back().fileEntry.signature;
+	}
+	{
+		Repository repository("GeneratorThreadsMultiRepoDirectory");
+		Generator generator(repository, tempDir, {.threads = 8});
+		auto results = generator.process(10);
+		REQUIRE(results.complete == true);
+		REQUIRE(results.processedFiles.size() == 211);
+		REQUIRE(results.processedFiles.back().fileEntry.signature == singleThreadSignature);
+		for (auto& entry: results.processedFiles) {
+			REQUIRE(std::filesystem::exists(entry.repositoryPath));
+		}
+	}
+}
@@ -63,4 +63,37 @@ TEST_CASE("Pruner finds abandoned files", "[pruner]") {
 	}
 
 
-}
\ No newline at end of file
+}
+
+TEST_CASE("Pruner compacts packs", "[pruner]") {
+	setupEncodings();
+
+	std::filesystem::path tempDir("PrunerTestDirectoryPacked");
+	std::filesystem::remove_all(tempDir);
+	std::filesystem::create_directories(tempDir);
+	std::filesystem::copy(TESTDATADIR "/repo", tempDir, std::filesystem::copy_options::recursive);
+
+	Repository repository(tempDir);
+	REQUIRE(repository.packLooseData().packedEntries == 8);
+
+	auto rootSignature = repository.readRoot("main")->signature;
+	auto manifest = *repository.fetchManifest(rootSignature).manifest;
+	auto lastEntry = manifest.entries.back();
+	manifest.entries.pop_back();
+	auto newSignature = Generator::generateSignature(manifest);
+	repository.store(newSignature, manifest);
+	repository.storeRoot("main", {.signature=newSignature});
+
+	auto packResult = Pruner::compactPacks(repository);
+	REQUIRE(packResult.status == StoreStatus::SUCCESS);
+	REQUIRE(packResult.removedEntries == 2);
+	REQUIRE(packResult.packedEntries == 6);
+	REQUIRE(repository.getPacks().size() == 1);
+	REQUIRE(!repository.contains(rootSignature));
+	REQUIRE(!repository.contains(lastEntry.signature));
+	REQUIRE(repository.contains(newSignature));
+	REQUIRE(repository.fetchManifest(newSignature).manifest->entries.size() == 5);
+
+	//Everything should still be reachable.
+	REQUIRE(Pruner::compactPacks(repository).removedEntries == 0);
+}
@@ -21,6 +21,7 @@
 #include <catch2/matchers/catch_matchers_vector.hpp>
 #include <utility>
 #include <algorithm>
+#include <fstream>
 #include <spdlog/spdlog.h>
 
 using namespace Squall;
@@ -116,4 +117,74 @@ TEST_CASE("Repository finds files", "[repository]") {
 		REQUIRE(fetchResult.localPath == (repoPath / "data" / "96" / "24faa79d245cea9c345474fdb1a863b75921a8dd7aff3d84b22c65d1fc847").string());
 
 	}
-}
\ No newline at end of file
+}
+
+TEST_CASE("Repository reads packed data", "[repository]") {
+	setupEncodings();
+
+	std::filesystem::path repoPath("RepositoryTestDirectoryPacked");
+	std::filesystem::remove_all(repoPath);
+	std::filesystem::create_directories(repoPath);
+	std::filesystem::copy(TESTDATADIR "/repo", repoPath, std::filesystem::copy_options::recursive);
+
+	Repository repository(repoPath);
+	//Another instance, as a running server would have, which must pick up changes made by "repository".
+	Repository liveRepository(repoPath);
+	auto packResult = repository.packLooseData();
+	REQUIRE(packResult.status == StoreStatus::SUCCESS);
+	REQUIRE(packResult.packedEntries == 8);
+	REQUIRE(repository.getPacks().size() == 1);
+	REQUIRE(!exists(repository.resolvePathForSignature("4e0bb39f3b1a3feb89f536c93be15055482df748674b0d26e5a7577772e9")));
+
+	//A new instance should load the pack from disk.
+	Repository reloadedRepository(repoPath);
+	for (auto* instance: {&repository, &reloadedRepository}) {
+		auto fooResult = instance->fetch("4e0bb39f3b1a3feb89f536c93be15055482df748674b0d26e5a7577772e9");
+		REQUIRE(fooResult.status == FetchStatus::SUCCESS);
+		REQUIRE(fooResult.packLocation.has_value());
+		REQUIRE(fooResult.size() == 3);
+		REQUIRE(instance->contains("4e0bb39f3b1a3feb89f536c93be15055482df748674b0d26e5a7577772e9"));
+		REQUIRE(!instance->contains("1111111111111111111111111111111111111111111111111111111111111111"));
+
+		auto digestResult = instance->fetchManifest("e34c28f74227a7213ede2d254a8e98b3379add41e69a5538525b8ba8dde538");
+		REQUIRE(digestResult.fetchResult.status == FetchStatus::SUCCESS);
+		REQUIRE((*digestResult.manifest).entries.size() == 6);
+		REQUIRE((*digestResult.manifest).entries[5].fileName == "foo.txt");
+	}
+
+	SECTION("extracting data should work") {
+		auto destination = repoPath / "extracted" / "foo.txt";
+		auto extractResult = repository.extract("4e0bb39f3b1a3feb89f536c93be15055482df748674b0d26e5a7577772e9", destination);
+		REQUIRE(extractResult.status == FetchStatus::SUCCESS);
+		std::ifstream stream(destination);
+		std::string content;
+		std::getline(stream, content);
+		REQUIRE(content == "foo");
+	}
+
+	SECTION("storing data that's already packed should not create loose files") {
+		auto storeResult = repository.store("4e0bb39f3b1a3feb89f536c93be15055482df748674b0d26e5a7577772e9", std::vector<char>{'f', 'o', 'o'});
+		REQUIRE(storeResult.status == StoreStatus::SUCCESS);
+		REQUIRE(storeResult.packLocation.has_value());
+		REQUIRE(!exists(repository.resolvePathForSignature("4e0bb39f3b1a3feb89f536c93be15055482df748674b0d26e5a7577772e9")));
+	}
+
+	SECTION("packs written by another instance should be found") {
+		auto fooResult = liveRepository.fetch("4e0bb39f3b1a3feb89f536c93be15055482df748674b0d26e5a7577772e9");
+		REQUIRE(fooResult.status == FetchStatus::SUCCESS);
+		REQUIRE(fooResult.packLocation.has_value());
+	}
+
+	SECTION("packs replaced by another instance should be reloaded") {
+		auto repackResult = repository.repack([](const Signature&) { return true; });
+		REQUIRE(repackResult.status == StoreStatus::SUCCESS);
+		REQUIRE(repackResult.packedEntries == 8);
+
+		auto fooResult = liveRepository.fetch("4e0bb39f3b1a3feb89f536c93be15055482df748674b0d26e5a7577772e9");
+		REQUIRE(fooResult.status == FetchStatus::SUCCESS);
+		REQUIRE(fooResult.localPath == repackResult.localPath);
+		auto data = liveRepository.readData("4e0bb39f3b1a3feb89f536c93be15055482df748674b0d26e5a7577772e9");
+		REQUIRE(data.has_value());
+		REQUIRE(std::string(data->begin(), data->end()) == "foo");
+	}
+}
@@ -20,10 +20,13 @@
 #include "squall/core/Repository.h"
 #include "squall/core/Provider.h"
 #include "squall/core/Resolver.h"
+#include "squall/core/Delta.h"
 #include <catch2/catch_test_macros.hpp>
 #include <catch2/matchers/catch_matchers_vector.hpp>
 #include <utility>
 #include <algorithm>
+#include <fstream>
+#include <thread>
 #include <spdlog/spdlog.h>
 #include <spdlog/common.h>
 
@@ -83,4 +86,175 @@ TEST_CASE("Resolver skips already existing files", "[resolver]") {
 	}
 
 
-}
\ No newline at end of file
+}
+namespace {
+/**
+ * Only completes fetches when told to, so that the fetches in flight can be inspected.
+ */
+struct DeferredProvider : public Provider {
+	struct Request {
+		Signature signature;
+		std::filesystem::path destination;
+		std::promise<ProviderResult> promise;
+	};
+
+	RepositoryProvider source;
+	std::vector<Request> requests;
+	std::vector<Signature> fetchedSignatures;
+	size_t maxInFlight = 0;
+	std::optional<Signature> reportedSignature;
+
+	explicit DeferredProvider(const Repository& repository) : source(repository) {}
+
+	std::future<ProviderResult> fetch(Signature signature, std::filesystem::path destination) override {
+		fetchedSignatures.emplace_back(signature);
+		requests.emplace_back(Request{.signature = signature, .destination = std::move(destination)});
+		maxInFlight = std::max(maxInFlight, requests.size());
+		return requests.back().promise.get_future();
+	}
+
+	void completeAll() {
+		for (auto& request: requests) {
+			auto result = source.fetch(request.signature, request.destination).get();
+			if (reportedSignature) {
+				result.signature = reportedSignature;
+			}
+			request.promise.set_value(result);
+		}
+		requests.clear();
+	}
+};
+}
+
+TEST_CASE("Resolver fetches concurrently, with manifests first", "[resolver]") {
+	setupEncodings();
+
+	Repository repositorySource(TESTDATADIR "/repo");
+	std::filesystem::path testPath = "ResolverTestDirectoryConcurrent";
+	remove_all(testPath);
+	Repository repositoryDestination(testPath);
+	auto provider = std::make_unique<DeferredProvider>(repositorySource);
+	auto& deferredProvider = *provider;
+	Resolver resolver(repositoryDestination, std::move(provider), "e34c28f74227a7213ede2d254a8e98b3379add41e69a5538525b8ba8dde538", 3);
+
+	std::vector<ResolveEntry> completedEntries;
+	int i = 0;
+	while (true) {
+		auto pollResult = resolver.poll(10);
+		REQUIRE(pollResult.status != Squall::ResolveStatus::HAD_ERROR);
+		REQUIRE(i++ < 20);
+		completedEntries.insert(completedEntries.end(), pollResult.completedRequests.begin(), pollResult.completedRequests.end());
+		if (pollResult.status == Squall::ResolveStatus::COMPLETE) {
+			break;
+		}
+		REQUIRE(deferredProvider.requests.size() <= 3);
+		deferredProvider.completeAll();
+	}
+
+	REQUIRE(deferredProvider.maxInFlight == 3);
+	//The root manifest is fetched first, and then the manifests of the two subdirectories.
+	REQUIRE(deferredProvider.fetchedSignatures.size() == 8);
+	REQUIRE(deferredProvider.fetchedSignatures[0] == Signature("e34c28f74227a7213ede2d254a8e98b3379add41e69a5538525b8ba8dde538"));
+	std::vector<Signature> manifests{deferredProvider.fetchedSignatures[1], deferredProvider.fetchedSignatures[2]};
+	REQUIRE_THAT(manifests, Catch::Matchers::UnorderedEquals(std::vector<Signature>{"bd539dd09fbba4435b6508ede49cc5f5e4283ee59d3bf9b82134c3a1d88b1d8",
+																					  "50cc112b1c612e6962547aacdcef9a40d4416ef8dd9388e885991853c40c9"}));
+
+	REQUIRE(completedEntries.size() == 8);
+	for (auto& entry: completedEntries) {
+		REQUIRE(entry.status == ResolveEntryStatus::COPIED);
+		REQUIRE(repositoryDestination.contains(entry.signature));
+	}
+}
+
+TEST_CASE("Resolver rejects data with the wrong signature", "[resolver]") {
+	setupEncodings();
+
+	Repository repositorySource(TESTDATADIR "/repo");
+	std::filesystem::path testPath = "ResolverTestDirectoryWrongSignature";
+	remove_all(testPath);
+	Repository repositoryDestination(testPath);
+	auto provider = std::make_unique<DeferredProvider>(repositorySource);
+	provider->reportedSignature = Signature("abcdef");
+	auto& deferredProvider = *provider;
+	Resolver resolver(repositoryDestination, std::move(provider), "e34c28f74227a7213ede2d254a8e98b3379add41e69a5538525b8ba8dde538");
+
+	REQUIRE(resolver.poll(10).status == Squall::ResolveStatus::ONGOING);
+	deferredProvider.completeAll();
+	REQUIRE(resolver.poll(10).status == Squall::ResolveStatus::HAD_ERROR);
+	REQUIRE(!repositoryDestination.contains("e34c28f74227a7213ede2d254a8e98b3379add41e69a5538525b8ba8dde538"));
+}
+
+TEST_CASE("Resolver fetches deltas for altered files", "[resolver]") {
+	setupEncodings();
+
+	std::filesystem::path testPath = "ResolverTestDirectoryDelta";
+	remove_all(testPath);
+	Repository repositorySource(testPath / "source");
+
+	std::vector<char> data(200000);
+	for (size_t i = 0; i < data.size(); ++i) {
+		data[i] = static_cast<char>((i * 7919) % 251);
+	}
+	auto writeData = [&]() {
+		std::filesystem::create_directories(testPath / "files");
+		std::ofstream stream(testPath / "files" / "large.bin", std::ios::binary | std::ios::trunc);
+		stream.write(data.data(), static_cast<std::streamsize>(data.size()));
+	};
+	auto generateRoot = [&]() {
+		Generator generator(repositorySource, testPath / "files");
+		while (true) {
+			auto results = generator.process(10);
+			if (results.complete) {
+				return results.processedFiles.back().fileEntry.signature;
+			}
+		}
+	};
+
+	writeData();
+	auto oldRoot = generateRoot();
+	//The destination already has the old version.
+	std::filesystem::copy(testPath / "source", testPath / "destination", std::filesystem::copy_options::recursive);
+	Repository repositoryDestination(testPath / "destination");
+
+	data[100000] = 'a';
+	writeData();
+	auto newRoot = generateRoot();
+	auto summary = resolveDifferences(repositorySource, {.oldManifest = *repositorySource.fetchManifest(oldRoot).manifest,
+			.newManifest = *repositorySource.fetchManifest(newRoot).manifest});
+	REQUIRE(Delta::generate(repositorySource, summary).createdDeltas == 1);
+	auto newSignature = Generator::generateSignature(testPath / "files" / "large.bin").signature;
+
+	auto resolve = [&]() {
+		Resolver resolver(repositoryDestination, std::make_unique<RepositoryProvider>(repositorySource), newRoot);
+		resolver.setPreviousRoot(oldRoot);
+		size_t bytesCopied = 0;
+		//Deltas are applied in the background, so keep polling until that's done.
+		for (int i = 0; i < 1000; ++i) {
+			auto pollResult = resolver.poll(10);
+			REQUIRE(pollResult.status != Squall::ResolveStatus::HAD_ERROR);
+			for (auto& entry: pollResult.completedRequests) {
+				if (entry.path == "large.bin") {
+					bytesCopied = entry.bytesCopied;
+				}
+			}
+			if (pollResult.status == Squall::ResolveStatus::COMPLETE) {
+				break;
+			}
+			std::this_thread::sleep_for(std::chrono::milliseconds(5));
+		}
+		REQUIRE(repositoryDestination.contains(newRoot));
+		REQUIRE(repositoryDestination.readData(newSignature) == data);
+		return bytesCopied;
+	};
+
+	SECTION("should use the delta") {
+		auto bytesCopied = resolve();
+		REQUIRE(bytesCopied > 0);
+		REQUIRE(bytesCopied < 1000);
+	}
+
+	SECTION("should fetch in full without a delta") {
+		remove_all(testPath / "source" / "deltas");
+		REQUIRE(resolve() == data.size());
+	}
+}
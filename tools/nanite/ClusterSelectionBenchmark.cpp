@@ -0,0 +1,249 @@
+#include "apps/ember/src/components/ogre/lod/ClusterTraversal.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <vector>
+
+/**
+ * Compares selecting clusters by testing every cluster against its parent with walking
+ * the graph down from the roots, on synthetic cluster graphs of a flat terrain seen by
+ * a camera flying over it. Runs without a renderer, using its own camera maths.
+ *
+ * Usage: ClusterSelectionBenchmark [--quick]
+ */
+
+namespace {
+
+using namespace Ember::OgreView::Lod;
+
+using Clock = std::chrono::steady_clock;
+
+struct Vec3 {
+    float x = 0, y = 0, z = 0;
+
+    Vec3 operator+(const Vec3& o) const { return {x + o.x, y + o.y, z + o.z}; }
+    Vec3 operator-(const Vec3& o) const { return {x - o.x, y - o.y, z - o.z}; }
+    Vec3 operator*(float s) const { return {x * s, y * s, z * s}; }
+    float dot(const Vec3& o) const { return x * o.x + y * o.y + z * o.z; }
+    float length() const { return std::sqrt(dot(*this)); }
+    Vec3 normalized() const { return *this * (1.0f / length()); }
+};
+
+struct Sphere {
+    Vec3 center;
+    float radius = 0;
+};
+
+/// Mirrors the parts of NaniteLodDefinition::Cluster which selection uses.
+struct Cluster {
+    Sphere lodBounds;
+    float error = 0;
+    Sphere parentLodBounds;
+    float parentError = NaniteFormat::RootParentError;
+    std::vector<uint32_t> children;
+};
+
+/**
+ * Builds a graph like the preprocessor does for a flat grid of size * size clusters:
+ * each level groups 2x2 cells of the level below, and simplifies each group into two
+ * clusters which share the group's clusters as children.
+ */
+std::vector<Cluster> buildGraph(int size) {
+    std::vector<Cluster> clusters;
+    std::vector<std::vector<uint32_t>> cells(size * size);
+    for (int y = 0; y < size; ++y) {
+        for (int x = 0; x < size; ++x) {
+            Cluster cluster;
+            cluster.lodBounds = {{x + 0.5f, 0, y + 0.5f}, 0.75f};
+            cells[y * size + x].push_back(static_cast<uint32_t>(clusters.size()));
+            clusters.push_back(cluster);
+        }
+    }
+
+    float error = 0.02f;
+    for (int cellsPerSide = size / 2; cellsPerSide >= 1; cellsPerSide /= 2) {
+        std::vector<std::vector<uint32_t>> parentCells(cellsPerSide * cellsPerSide);
+        for (int y = 0; y < cellsPerSide; ++y) {
+            for (int x = 0; x < cellsPerSide; ++x) {
+                std::vector<uint32_t> group;
+                for (int j = 0; j < 2; ++j) {
+                    for (int i = 0; i < 2; ++i) {
+                        const auto& cell = cells[(y * 2 + j) * cellsPerSide * 2 + x * 2 + i];
+                        group.insert(group.end(), cell.begin(), cell.end());
+                    }
+                }
+
+                Sphere bounds;
+                for (auto member : group) {
+                    bounds.center = bounds.center + clusters[member].lodBounds.center;
+                }
+                bounds.center = bounds.center * (1.0f / static_cast<float>(group.size()));
+                for (auto member : group) {
+                    const auto& memberBounds = clusters[member].lodBounds;
+                    bounds.radius = std::max(bounds.radius, (memberBounds.center - bounds.center).length() + memberBounds.radius);
+                }
+                for (auto member : group) {
+                    clusters[member].parentLodBounds = bounds;
+                    clusters[member].parentError = error;
+                }
+                for (int k = 0; k < 2; ++k) {
+                    Cluster parent;
+                    parent.lodBounds = bounds;
+                    parent.error = error;
+                    parent.children = group;
+                    parentCells[y * cellsPerSide + x].push_back(static_cast<uint32_t>(clusters.size()));
+                    clusters.push_back(std::move(parent));
+                }
+            }
+        }
+        cells = std::move(parentCells);
+        error *= 2;
+    }
+    return clusters;
+}
+
+/// A perspective camera, with the same error projection as ClusterLodStrategy.
+struct View {
+    Vec3 position;
+    float nearDistance = 0.1f;
+    float pixelsPerUnit = 0;
+    /// Inward normals of the near plane and the four side planes, all through the position.
+    Vec3 planes[5];
+
+    View(Vec3 position_, Vec3 forward, float fovY, float aspect, float viewportHeight) : position(position_) {
+        forward = forward.normalized();
+        Vec3 right = Vec3{forward.z, 0, -forward.x}.normalized();
+        Vec3 up{right.y * forward.z - right.z * forward.y,
+                right.z * forward.x - right.x * forward.z,
+                right.x * forward.y - right.y * forward.x};
+        float tanY = std::tan(fovY * 0.5f);
+        float tanX = tanY * aspect;
+        pixelsPerUnit = viewportHeight * 0.5f / tanY;
+        planes[0] = forward;
+        planes[1] = (forward * tanX - right).normalized();
+        planes[2] = (forward * tanX + right).normalized();
+        planes[3] = (forward * tanY - up).normalized();
+        planes[4] = (forward * tanY + up).normalized();
+    }
+
+    float project(const Sphere& bounds, float error) const {
+        if (error >= NaniteFormat::RootParentError) {
+            return std::numeric_limits<float>::max();
+        }
+        float distance = std::max((bounds.center - position).length() - bounds.radius, nearDistance);
+        return error * pixelsPerUnit / distance;
+    }
+
+    bool isVisible(const Sphere& bounds) const {
+        Vec3 offset = bounds.center - position;
+        if (offset.dot(planes[0]) < nearDistance - bounds.radius) {
+            return false;
+        }
+        for (int i = 1; i < 5; ++i) {
+            if (offset.dot(planes[i]) < -bounds.radius) {
+                return false;
+            }
+        }
+        return true;
+    }
+};
+
+/// Tests every cluster against its parent, as selection did before the traversal.
+void selectLinear(const std::vector<Cluster>& clusters, const View& view, float threshold, std::vector<size_t>& out) {
+    for (size_t i = 0; i < clusters.size(); ++i) {
+        const auto& cluster = clusters[i];
+        if (view.isVisible(cluster.lodBounds) &&
+            view.project(cluster.lodBounds, cluster.error) <= threshold &&
+            view.project(cluster.parentLodBounds, cluster.parentError) > threshold) {
+            out.push_back(i);
+        }
+    }
+}
+
+struct Result {
+    double linearMicroseconds = 0;
+    double traversalMicroseconds = 0;
+    size_t selected = 0;
+    size_t visited = 0;
+    bool matches = true;
+};
+
+Result run(const std::vector<Cluster>& clusters, int size, int frames) {
+    const float threshold = 1.0f;
+    auto roots = ClusterTraversal::findRoots(clusters);
+    ClusterTraversal::Scratch scratch;
+    std::vector<size_t> linear;
+    std::vector<size_t> traversed;
+    Result result;
+
+    for (int frame = 0; frame < frames; ++frame) {
+        // Fly diagonally over the terrain, looking ahead and slightly down.
+        float t = static_cast<float>(frame) / static_cast<float>(std::max(frames - 1, 1));
+        float yaw = t * 6.2831853f;
+        Vec3 position{size * (0.1f + 0.8f * t), 3.0f, size * (0.1f + 0.8f * t)};
+        Vec3 forward{std::cos(yaw), -0.35f, std::sin(yaw)};
+        View view(position, forward, 1.0471976f, 16.0f / 9.0f, 1080.0f);
+
+        linear.clear();
+        auto start = Clock::now();
+        selectLinear(clusters, view, threshold, linear);
+        auto middle = Clock::now();
+
+        traversed.clear();
+        size_t visited = 0;
+        ClusterTraversal::traverse(clusters,
+                                   roots,
+                                   threshold,
+                                   scratch,
+                                   [&](const Cluster& c) {
+                                       visited++;
+                                       return view.project(c.lodBounds, c.error);
+                                   },
+                                   [&](const Cluster& c) { return view.isVisible(c.lodBounds); },
+                                   traversed);
+        auto end = Clock::now();
+
+        result.linearMicroseconds += std::chrono::duration<double, std::micro>(middle - start).count();
+        result.traversalMicroseconds += std::chrono::duration<double, std::micro>(end - middle).count();
+        result.selected += traversed.size();
+        result.visited += visited;
+
+        std::sort(traversed.begin(), traversed.end());
+        if (traversed != linear) {
+            std::cerr << "Selections differ for frame " << frame << " of size " << size << ": "
+                      << linear.size() << " against " << traversed.size() << std::endl;
+            result.matches = false;
+        }
+    }
+    result.linearMicroseconds /= frames;
+    result.traversalMicroseconds /= frames;
+    result.selected /= frames;
+    result.visited /= frames;
+    return result;
+}
+
+}
+
+int main(int argc, char** argv) {
+    bool quick = argc > 1 && std::strcmp(argv[1], "--quick") == 0;
+    std::vector<int> sizes = quick ? std::vector<int>{16, 64} : std::vector<int>{64, 128, 256, 512};
+    int frames = quick ? 16 : 64;
+
+    std::cout << std::setw(8) << "grid" << std::setw(10) << "clusters" << std::setw(10) << "selected"
+              << std::setw(10) << "visited" << std::setw(14) << "linear us" << std::setw(14) << "traverse us" << std::endl;
+    bool matches = true;
+    for (int size : sizes) {
+        auto clusters = buildGraph(size);
+        auto result = run(clusters, size, frames);
+        matches = matches && result.matches;
+        std::cout << std::setw(8) << size << std::setw(10) << clusters.size() << std::setw(10) << result.selected
+                  << std::setw(10) << result.visited << std::fixed << std::setprecision(1)
+                  << std::setw(14) << result.linearMicroseconds << std::setw(14) << result.traversalMicroseconds << std::endl;
+    }
+    return matches ? EXIT_SUCCESS : EXIT_FAILURE;
+}
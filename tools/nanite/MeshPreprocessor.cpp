@@ -1,84 +1,583 @@
-#include "apps/ember/src/components/ogre/lod/NaniteLodDefinition.h"
-#include <OgreVector3.h>
+#include "apps/ember/src/components/ogre/lod/NaniteFormat.h"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
 #include <fstream>
 #include <iostream>
+#include <iterator>
+#include <queue>
 #include <sstream>
+#include <thread>
+#include <unordered_map>
 #include <vector>
 
+/**
+ * Builds a cluster graph from an OBJ mesh, for use by NaniteLodDefinition.
+ *
+ * The triangles are first cut into spatially coherent clusters. Then, level by level,
+ * neighbouring clusters are grouped, each group is simplified to half its triangles
+ * with the group's outer edges locked (so that it still fits against its neighbours,
+ * whichever level they're drawn at) and the result is cut into new clusters. This
+ * repeats until only one cluster is left or nothing can be simplified any further.
+ *
+ * Groups are simplified on worker threads.
+ */
+namespace {
+
 using namespace Ember::OgreView::Lod;
 
+constexpr size_t MaxClusterTriangles = 128;
+constexpr size_t MaxGroupClusters = 4;
+/// A group which can't be reduced to this fraction of its triangles isn't replaced.
+constexpr float MinSimplificationRatio = 0.85f;
+/// No vertex is moved further than this, relative to the radius of its group.
+constexpr float MaxRelativeError = 0.02f;
+
+struct Vec3 {
+    float x = 0, y = 0, z = 0;
+
+    Vec3 operator+(const Vec3& o) const { return {x + o.x, y + o.y, z + o.z}; }
+    Vec3 operator-(const Vec3& o) const { return {x - o.x, y - o.y, z - o.z}; }
+    Vec3 operator*(float s) const { return {x * s, y * s, z * s}; }
+    float operator[](size_t axis) const { return axis == 0 ? x : axis == 1 ? y : z; }
+    float dot(const Vec3& o) const { return x * o.x + y * o.y + z * o.z; }
+    Vec3 cross(const Vec3& o) const { return {y * o.z - z * o.y, z * o.x - x * o.z, x * o.y - y * o.x}; }
+    float length() const { return std::sqrt(dot(*this)); }
+};
+
+struct Box {
+    Vec3 min{std::numeric_limits<float>::max(), std::numeric_limits<float>::max(), std::numeric_limits<float>::max()};
+    Vec3 max{std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest()};
+
+    void merge(const Vec3& v) {
+        min = {std::min(min.x, v.x), std::min(min.y, v.y), std::min(min.z, v.z)};
+        max = {std::max(max.x, v.x), std::max(max.y, v.y), std::max(max.z, v.z)};
+    }
+
+    size_t longestAxis() const {
+        Vec3 size = max - min;
+        return size.x >= size.y && size.x >= size.z ? 0 : size.y >= size.z ? 1 : 2;
+    }
+};
+
+struct Sphere {
+    Vec3 center;
+    float radius = 0;
+
+    /// Grows the sphere to also enclose the other one.
+    void merge(const Sphere& other) {
+        Vec3 offset = other.center - center;
+        float distance = offset.length();
+        if (distance + other.radius <= radius) {
+            return;
+        }
+        if (distance + radius <= other.radius) {
+            *this = other;
+            return;
+        }
+        float newRadius = (distance + radius + other.radius) * 0.5f;
+        center = center + offset * ((newRadius - radius) / distance);
+        radius = newRadius;
+    }
+};
+
 struct ObjMesh {
-    std::vector<Ogre::Vector3> vertices;
-    std::vector<unsigned int> indices;
+    std::vector<Vec3> vertices;
+    std::vector<uint32_t> indices;
+};
+
+struct Cluster {
+    std::vector<uint32_t> indices;
+    Box bounds;
+    Sphere lodSphere;
+    float error = 0;
+    Sphere parentLodSphere;
+    float parentError = NaniteFormat::RootParentError;
+    uint32_t level = 0;
+    std::vector<uint32_t> children;
 };
 
-static ObjMesh loadObj(const std::string& path) {
+using Clock = std::chrono::steady_clock;
+
+long long millisecondsSince(Clock::time_point start) {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - start).count();
+}
+
+ObjMesh loadObj(const std::string& path) {
     ObjMesh mesh;
     std::ifstream file(path);
     std::string line;
+    std::vector<uint32_t> face;
     while (std::getline(file, line)) {
         std::istringstream iss(line);
         std::string tag;
         if (!(iss >> tag)) continue;
         if (tag == "v") {
             float x, y, z; iss >> x >> y >> z;
-            mesh.vertices.emplace_back(x, y, z);
+            mesh.vertices.push_back({x, y, z});
         } else if (tag == "f") {
-            unsigned int a, b, c;
-            if (iss >> a >> b >> c) {
-                // OBJ indices are 1-based
-                mesh.indices.push_back(a - 1);
-                mesh.indices.push_back(b - 1);
-                mesh.indices.push_back(c - 1);
+            // Corners are "v", "v/vt", "v//vn" or "v/vt/vn"; only the position is used.
+            face.clear();
+            std::string corner;
+            while (iss >> corner) {
+                long index = std::strtol(corner.c_str(), nullptr, 10);
+                // OBJ indices are 1-based, or relative to the end if negative
+                index = index < 0 ? static_cast<long>(mesh.vertices.size()) + index : index - 1;
+                if (index < 0 || index >= static_cast<long>(mesh.vertices.size())) {
+                    face.clear();
+                    break;
+                }
+                face.push_back(static_cast<uint32_t>(index));
+            }
+            for (size_t i = 2; i < face.size(); ++i) {
+                mesh.indices.insert(mesh.indices.end(), {face[0], face[i - 1], face[i]});
             }
         }
     }
     return mesh;
 }
 
+/**
+ * Runs the function for every index in [0, count) on up to the given number of threads.
+ */
+template<typename Function>
+void parallelFor(size_t count, unsigned int threads, const Function& function) {
+    std::atomic<size_t> next{0};
+    auto worker = [&]() {
+        for (size_t i = next++; i < count; i = next++) {
+            function(i);
+        }
+    };
+    std::vector<std::thread> pool;
+    for (unsigned int i = 1; i < std::min<size_t>(threads, count); ++i) {
+        pool.emplace_back(worker);
+    }
+    worker();
+    for (auto& thread : pool) {
+        thread.join();
+    }
+}
+
+/**
+ * Recursively splits the items along the longest axis of their centroids, until each
+ * range holds at most maxItems. The ranges are filled as evenly as possible.
+ */
+void partition(std::vector<uint32_t>& items, size_t begin, size_t end, const std::vector<Vec3>& centroids,
+               size_t maxItems, std::vector<std::pair<size_t, size_t>>& ranges) {
+    size_t count = end - begin;
+    if (count <= maxItems) {
+        ranges.emplace_back(begin, end);
+        return;
+    }
+    Box box;
+    for (size_t i = begin; i < end; ++i) {
+        box.merge(centroids[items[i]]);
+    }
+    auto axis = box.longestAxis();
+    size_t parts = (count + maxItems - 1) / maxItems;
+    size_t middle = begin + (parts / 2) * (count / parts);
+    std::nth_element(items.begin() + static_cast<std::ptrdiff_t>(begin), items.begin() + static_cast<std::ptrdiff_t>(middle),
+                     items.begin() + static_cast<std::ptrdiff_t>(end),
+                     [&](uint32_t lhs, uint32_t rhs) { return centroids[lhs][axis] < centroids[rhs][axis]; });
+    partition(items, begin, middle, centroids, maxItems, ranges);
+    partition(items, middle, end, centroids, maxItems, ranges);
+}
+
+/**
+ * Cuts a triangle list into spatially coherent clusters.
+ */
+std::vector<Cluster> makeClusters(const std::vector<Vec3>& vertices, const std::vector<uint32_t>& indices) {
+    size_t triangleCount = indices.size() / 3;
+    std::vector<Vec3> centroids(triangleCount);
+    std::vector<uint32_t> triangles(triangleCount);
+    for (size_t i = 0; i < triangleCount; ++i) {
+        centroids[i] = (vertices[indices[i * 3]] + vertices[indices[i * 3 + 1]] + vertices[indices[i * 3 + 2]]) * (1.0f / 3.0f);
+        triangles[i] = static_cast<uint32_t>(i);
+    }
+    std::vector<std::pair<size_t, size_t>> ranges;
+    partition(triangles, 0, triangleCount, centroids, MaxClusterTriangles, ranges);
+
+    std::vector<Cluster> clusters(ranges.size());
+    for (size_t i = 0; i < ranges.size(); ++i) {
+        auto& cluster = clusters[i];
+        for (size_t t = ranges[i].first; t < ranges[i].second; ++t) {
+            for (size_t corner = 0; corner < 3; ++corner) {
+                auto index = indices[triangles[t] * 3 + corner];
+                cluster.indices.push_back(index);
+                cluster.bounds.merge(vertices[index]);
+            }
+        }
+    }
+    return clusters;
+}
+
+/**
+ * Symmetric 4x4 matrix measuring the summed squared distance to a set of planes.
+ */
+struct Quadric {
+    double a00 = 0, a01 = 0, a02 = 0, a11 = 0, a12 = 0, a22 = 0, b0 = 0, b1 = 0, b2 = 0, c = 0;
+
+    static Quadric fromPlane(double nx, double ny, double nz, double d) {
+        return {nx * nx, nx * ny, nx * nz, ny * ny, ny * nz, nz * nz, nx * d, ny * d, nz * d, d * d};
+    }
+
+    Quadric& operator+=(const Quadric& o) {
+        a00 += o.a00; a01 += o.a01; a02 += o.a02; a11 += o.a11; a12 += o.a12; a22 += o.a22;
+        b0 += o.b0; b1 += o.b1; b2 += o.b2; c += o.c;
+        return *this;
+    }
+
+    double evaluate(const Vec3& v) const {
+        double x = v.x, y = v.y, z = v.z;
+        return std::max(0.0, a00 * x * x + 2 * a01 * x * y + 2 * a02 * x * z + a11 * y * y + 2 * a12 * y * z + a22 * z * z +
+                             2 * (b0 * x + b1 * y + b2 * z) + c);
+    }
+};
+
+struct SimplifyResult {
+    std::vector<uint32_t> indices;
+    /// The largest distance the surface was moved, estimated from the quadrics.
+    float error = 0;
+};
+
+/**
+ * Simplifies the triangles with quadric error metrics, by collapsing vertices onto their
+ * neighbours until the target is reached or the next collapse would exceed the maximum
+ * error. Vertices on edges used by only one triangle are never moved. As vertices only
+ * ever move onto existing ones the result refers to the same vertices as the input.
+ */
+SimplifyResult simplify(const std::vector<Vec3>& vertices, const std::vector<uint32_t>& indices, size_t targetTriangles, float maxError) {
+    std::unordered_map<uint32_t, uint32_t> localIndices;
+    std::vector<uint32_t> globalIndices;
+    std::vector<std::array<uint32_t, 3>> triangles(indices.size() / 3);
+    for (size_t i = 0; i < indices.size(); ++i) {
+        auto [entry, inserted] = localIndices.emplace(indices[i], static_cast<uint32_t>(globalIndices.size()));
+        if (inserted) {
+            globalIndices.push_back(indices[i]);
+        }
+        triangles[i / 3][i % 3] = entry->second;
+    }
+    size_t vertexCount = globalIndices.size();
+    auto position = [&](uint32_t local) -> const Vec3& { return vertices[globalIndices[local]]; };
+
+    std::vector<Quadric> quadrics(vertexCount);
+    std::vector<std::vector<uint32_t>> vertexTriangles(vertexCount);
+    std::unordered_map<uint64_t, int> edgeUses;
+    auto edgeKey = [](uint32_t a, uint32_t b) { return (static_cast<uint64_t>(std::min(a, b)) << 32) | std::max(a, b); };
+    for (uint32_t t = 0; t < triangles.size(); ++t) {
+        const auto& tri = triangles[t];
+        Vec3 normal = (position(tri[1]) - position(tri[0])).cross(position(tri[2]) - position(tri[0]));
+        float length = normal.length();
+        if (length > 0) {
+            normal = normal * (1.0f / length);
+            auto plane = Quadric::fromPlane(normal.x, normal.y, normal.z, -normal.dot(position(tri[0])));
+            for (auto v : tri) {
+                quadrics[v] += plane;
+            }
+        }
+        for (size_t corner = 0; corner < 3; ++corner) {
+            vertexTriangles[tri[corner]].push_back(t);
+            edgeUses[edgeKey(tri[corner], tri[(corner + 1) % 3])]++;
+        }
+    }
+    std::vector<bool> locked(vertexCount, false);
+    for (const auto& [key, uses] : edgeUses) {
+        if (uses == 1) {
+            locked[static_cast<uint32_t>(key >> 32)] = true;
+            locked[static_cast<uint32_t>(key)] = true;
+        }
+    }
+
+    struct Candidate {
+        double cost;
+        uint32_t from, to, fromVersion, toVersion;
+        bool operator>(const Candidate& o) const { return cost > o.cost; }
+    };
+    std::priority_queue<Candidate, std::vector<Candidate>, std::greater<>> candidates;
+    std::vector<uint32_t> versions(vertexCount, 0);
+    std::vector<bool> alive(triangles.size(), true);
+    std::vector<bool> removed(vertexCount, false);
+    auto push = [&](uint32_t from, uint32_t to) {
+        if (!locked[from]) {
+            Quadric combined = quadrics[from];
+            combined += quadrics[to];
+            candidates.push({combined.evaluate(position(to)), from, to, versions[from], versions[to]});
+        }
+    };
+    for (const auto& tri : triangles) {
+        for (size_t corner = 0; corner < 3; ++corner) {
+            push(tri[corner], tri[(corner + 1) % 3]);
+            push(tri[(corner + 1) % 3], tri[corner]);
+        }
+    }
+
+    size_t liveTriangles = triangles.size();
+    double maxCost = 0;
+    double costLimit = static_cast<double>(maxError) * maxError;
+    while (liveTriangles > targetTriangles && !candidates.empty()) {
+        auto candidate = candidates.top();
+        if (candidate.cost > costLimit) {
+            break;
+        }
+        candidates.pop();
+        auto from = candidate.from;
+        auto to = candidate.to;
+        if (removed[from] || removed[to] || versions[from] != candidate.fromVersion || versions[to] != candidate.toVersion) {
+            continue;
+        }
+
+        // Reject collapses which would flip or degenerate any of the triangles that remain.
+        bool connected = false;
+        bool valid = true;
+        for (auto t : vertexTriangles[from]) {
+            if (!alive[t]) continue;
+            auto tri = triangles[t];
+            if (std::find(tri.begin(), tri.end(), to) != tri.end()) {
+                connected = true;
+                continue;
+            }
+            Vec3 before = (position(tri[1]) - position(tri[0])).cross(position(tri[2]) - position(tri[0]));
+            std::replace(tri.begin(), tri.end(), from, to);
+            Vec3 after = (position(tri[1]) - position(tri[0])).cross(position(tri[2]) - position(tri[0]));
+            if (after.dot(before) <= 0.25f * before.length() * after.length()) {
+                valid = false;
+                break;
+            }
+        }
+        if (!connected || !valid) {
+            continue;
+        }
+
+        for (auto t : vertexTriangles[from]) {
+            if (!alive[t]) continue;
+            auto& tri = triangles[t];
+            if (std::find(tri.begin(), tri.end(), to) != tri.end()) {
+                alive[t] = false;
+                liveTriangles--;
+            } else {
+                std::replace(tri.begin(), tri.end(), from, to);
+                vertexTriangles[to].push_back(t);
+            }
+        }
+        removed[from] = true;
+        quadrics[to] += quadrics[from];
+        versions[to]++;
+        maxCost = std::max(maxCost, candidate.cost);
+
+        for (auto t : vertexTriangles[to]) {
+            if (!alive[t]) continue;
+            for (auto other : triangles[t]) {
+                if (other != to) {
+                    push(other, to);
+                    push(to, other);
+                }
+            }
+        }
+    }
+
+    SimplifyResult result;
+    result.error = static_cast<float>(std::sqrt(maxCost));
+    for (size_t t = 0; t < triangles.size(); ++t) {
+        if (alive[t]) {
+            for (auto v : triangles[t]) {
+                result.indices.push_back(globalIndices[v]);
+            }
+        }
+    }
+    return result;
+}
+
+Sphere boundingSphere(const std::vector<Vec3>& vertices, const std::vector<uint32_t>& indices) {
+    Box box;
+    for (auto index : indices) {
+        box.merge(vertices[index]);
+    }
+    Sphere sphere{(box.min + box.max) * 0.5f, 0};
+    for (auto index : indices) {
+        sphere.radius = std::max(sphere.radius, (vertices[index] - sphere.center).length());
+    }
+    return sphere;
+}
+
+/**
+ * Groups the clusters of one level and simplifies each group into new clusters.
+ * @return The new clusters, which the caller appends; their children are indices into all clusters.
+ */
+std::vector<Cluster> buildParentLevel(const std::vector<Vec3>& vertices, std::vector<Cluster>& clusters,
+                                      size_t levelBegin, uint32_t level, unsigned int threads) {
+    std::vector<uint32_t> levelClusters;
+    std::vector<Vec3> centers(clusters.size());
+    for (size_t i = levelBegin; i < clusters.size(); ++i) {
+        levelClusters.push_back(static_cast<uint32_t>(i));
+        // Not the lod sphere, as all clusters simplified from the same group share that.
+        centers[i] = (clusters[i].bounds.min + clusters[i].bounds.max) * 0.5f;
+    }
+    std::vector<std::pair<size_t, size_t>> groups;
+    partition(levelClusters, 0, levelClusters.size(), centers, MaxGroupClusters, groups);
+
+    std::vector<std::vector<Cluster>> groupResults(groups.size());
+    parallelFor(groups.size(), threads, [&](size_t g) {
+        std::vector<uint32_t> members(levelClusters.begin() + static_cast<std::ptrdiff_t>(groups[g].first),
+                                      levelClusters.begin() + static_cast<std::ptrdiff_t>(groups[g].second));
+        std::vector<uint32_t> merged;
+        Sphere groupSphere = clusters[members.front()].lodSphere;
+        float childError = 0;
+        for (auto member : members) {
+            const auto& cluster = clusters[member];
+            merged.insert(merged.end(), cluster.indices.begin(), cluster.indices.end());
+            groupSphere.merge(cluster.lodSphere);
+            childError = std::max(childError, cluster.error);
+        }
+
+        size_t triangleCount = merged.size() / 3;
+        auto simplified = simplify(vertices, merged, triangleCount / 2, groupSphere.radius * MaxRelativeError);
+        if (simplified.indices.size() / 3 > static_cast<size_t>(static_cast<float>(triangleCount) * MinSimplificationRatio)) {
+            // Nothing gained; the members stay roots.
+            return;
+        }
+
+        // Errors must never shrink going up the graph, or the selected clusters could overlap.
+        float groupError = std::max(simplified.error, childError);
+        auto& results = groupResults[g];
+        results = makeClusters(vertices, simplified.indices);
+        for (auto& result : results) {
+            result.lodSphere = groupSphere;
+            result.error = groupError;
+            result.level = level;
+            result.children = members;
+        }
+        // Each member belongs to exactly one group, so no other thread touches these.
+        for (auto member : members) {
+            clusters[member].parentLodSphere = groupSphere;
+            clusters[member].parentError = groupError;
+        }
+    });
+
+    std::vector<Cluster> parents;
+    for (auto& results : groupResults) {
+        std::move(results.begin(), results.end(), std::back_inserter(parents));
+    }
+    return parents;
+}
+
+bool writeClusters(const std::string& path, const std::vector<Vec3>& vertices, const std::vector<Cluster>& clusters, uint32_t levelCount) {
+    NaniteFormat::FileHeader header{};
+    std::memcpy(header.magic, NaniteFormat::Magic, sizeof(header.magic));
+    header.version = NaniteFormat::Version;
+    header.clusterCount = static_cast<uint32_t>(clusters.size());
+    header.levelCount = levelCount;
+    header.vertexCount = static_cast<uint32_t>(vertices.size());
+
+    std::vector<NaniteFormat::ClusterRecord> records;
+    std::vector<uint32_t> indices;
+    std::vector<uint32_t> children;
+    for (const auto& cluster : clusters) {
+        NaniteFormat::ClusterRecord record{};
+        for (size_t axis = 0; axis < 3; ++axis) {
+            record.boundsMin[axis] = cluster.bounds.min[axis];
+            record.boundsMax[axis] = cluster.bounds.max[axis];
+            record.lodCenter[axis] = cluster.lodSphere.center[axis];
+            record.parentLodCenter[axis] = cluster.parentLodSphere.center[axis];
+        }
+        record.lodRadius = cluster.lodSphere.radius;
+        record.error = cluster.error;
+        record.parentLodRadius = cluster.parentLodSphere.radius;
+        record.parentError = cluster.parentError;
+        record.level = cluster.level;
+        record.indexOffset = static_cast<uint32_t>(indices.size());
+        record.indexCount = static_cast<uint32_t>(cluster.indices.size());
+        record.childOffset = static_cast<uint32_t>(children.size());
+        record.childCount = static_cast<uint32_t>(cluster.children.size());
+        indices.insert(indices.end(), cluster.indices.begin(), cluster.indices.end());
+        children.insert(children.end(), cluster.children.begin(), cluster.children.end());
+        records.push_back(record);
+    }
+    header.indexCount = static_cast<uint32_t>(indices.size());
+    header.childCount = static_cast<uint32_t>(children.size());
+    header.clustersOffset = NaniteFormat::alignSection(sizeof(header));
+    header.verticesOffset = NaniteFormat::alignSection(header.clustersOffset + records.size() * sizeof(NaniteFormat::ClusterRecord));
+    header.indicesOffset = NaniteFormat::alignSection(header.verticesOffset + vertices.size() * sizeof(float) * 3);
+    header.childrenOffset = NaniteFormat::alignSection(header.indicesOffset + indices.size() * sizeof(uint32_t));
+
+    std::ofstream out(path, std::ios::binary);
+    auto writeSection = [&](uint64_t offset, const void* data, size_t bytes) {
+        auto padding = offset - static_cast<uint64_t>(out.tellp());
+        for (uint64_t i = 0; i < padding; ++i) out.put(0);
+        out.write(static_cast<const char*>(data), static_cast<std::streamsize>(bytes));
+    };
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    writeSection(header.clustersOffset, records.data(), records.size() * sizeof(NaniteFormat::ClusterRecord));
+    std::vector<float> positions;
+    positions.reserve(vertices.size() * 3);
+    for (const auto& v : vertices) {
+        positions.insert(positions.end(), {v.x, v.y, v.z});
+    }
+    writeSection(header.verticesOffset, positions.data(), positions.size() * sizeof(float));
+    writeSection(header.indicesOffset, indices.data(), indices.size() * sizeof(uint32_t));
+    writeSection(header.childrenOffset, children.data(), children.size() * sizeof(uint32_t));
+    return static_cast<bool>(out);
+}
+
+}
+
 int main(int argc, char** argv) {
     if (argc < 3) {
-        std::cerr << "Usage: " << argv[0] << " input.obj output.nanite" << std::endl;
+        std::cerr << "Usage: " << argv[0] << " input.obj output.nanite [threads]" << std::endl;
         return 1;
     }
+    unsigned int threads = argc > 3 ? static_cast<unsigned int>(std::max(1, std::atoi(argv[3])))
+                                    : std::max(1U, std::thread::hardware_concurrency());
 
+    auto start = Clock::now();
+    auto phaseStart = start;
     ObjMesh mesh = loadObj(argv[1]);
-    NaniteLodDefinition def(nullptr, argv[2], 0, "General");
-
-    const size_t clusterTris = 64; // simple fixed cluster size
-    for (size_t i = 0; i < mesh.indices.size(); i += clusterTris * 3) {
-        NaniteLodDefinition::Cluster c;
-        for (size_t j = i; j < std::min(mesh.indices.size(), i + clusterTris * 3); j += 3) {
-            unsigned int ia = mesh.indices[j];
-            unsigned int ib = mesh.indices[j + 1];
-            unsigned int ic = mesh.indices[j + 2];
-            c.indices.push_back(ia);
-            c.indices.push_back(ib);
-            c.indices.push_back(ic);
-            c.bounds.merge(mesh.vertices[ia]);
-            c.bounds.merge(mesh.vertices[ib]);
-            c.bounds.merge(mesh.vertices[ic]);
-        }
-        def.addCluster(std::move(c));
-    }
-
-    std::ofstream out(argv[2], std::ios::binary);
-    const auto& clusters = def.getClusters();
-    uint32_t count = static_cast<uint32_t>(clusters.size());
-    out.write(reinterpret_cast<const char*>(&count), sizeof(count));
-    for (const auto& c : clusters) {
-        Ogre::Vector3 min = c.bounds.getMinimum();
-        Ogre::Vector3 max = c.bounds.getMaximum();
-        out.write(reinterpret_cast<const char*>(&min), sizeof(min));
-        out.write(reinterpret_cast<const char*>(&max), sizeof(max));
-        uint32_t icount = static_cast<uint32_t>(c.indices.size());
-        out.write(reinterpret_cast<const char*>(&icount), sizeof(icount));
-        out.write(reinterpret_cast<const char*>(c.indices.data()), icount * sizeof(unsigned int));
-        uint32_t childCount = static_cast<uint32_t>(c.children.size());
-        out.write(reinterpret_cast<const char*>(&childCount), sizeof(childCount));
-        if (childCount)
-            out.write(reinterpret_cast<const char*>(c.children.data()), childCount * sizeof(size_t));
+    if (mesh.indices.empty()) {
+        std::cerr << "No triangles found in " << argv[1] << std::endl;
+        return 1;
+    }
+    std::cout << "Loaded " << mesh.vertices.size() << " vertices and " << mesh.indices.size() / 3 << " triangles in "
+              << millisecondsSince(phaseStart) << " ms" << std::endl;
+
+    phaseStart = Clock::now();
+    auto clusters = makeClusters(mesh.vertices, mesh.indices);
+    for (auto& cluster : clusters) {
+        cluster.lodSphere = boundingSphere(mesh.vertices, cluster.indices);
+        cluster.parentLodSphere = cluster.lodSphere;
+    }
+    std::cout << "Level 0: " << clusters.size() << " clusters in " << millisecondsSince(phaseStart) << " ms" << std::endl;
+
+    uint32_t levelCount = 1;
+    size_t levelBegin = 0;
+    while (clusters.size() - levelBegin > 1) {
+        phaseStart = Clock::now();
+        auto parents = buildParentLevel(mesh.vertices, clusters, levelBegin, levelCount, threads);
+        if (parents.empty()) {
+            break;
+        }
+        size_t triangles = 0;
+        float maxError = 0;
+        for (auto& parent : parents) {
+            parent.parentLodSphere = parent.lodSphere;
+            triangles += parent.indices.size() / 3;
+            maxError = std::max(maxError, parent.error);
+        }
+        std::cout << "Level " << levelCount << ": " << parents.size() << " clusters, " << triangles << " triangles, max error "
+                  << maxError << " in " << millisecondsSince(phaseStart) << " ms" << std::endl;
+        levelBegin = clusters.size();
+        std::move(parents.begin(), parents.end(), std::back_inserter(clusters));
+        levelCount++;
     }
+
+    phaseStart = Clock::now();
+    if (!writeClusters(argv[2], mesh.vertices, clusters, levelCount)) {
+        std::cerr << "Could not write " << argv[2] << std::endl;
+        return 1;
+    }
+    std::cout << "Wrote " << clusters.size() << " clusters in " << levelCount << " levels in " << millisecondsSince(phaseStart)
+              << " ms, " << millisecondsSince(start) << " ms in total using " << threads << " threads" << std::endl;
     return 0;
 }
-
@@ -1,5 +1,6 @@
 #include <cassert>
 #include <fstream>
+#include <iterator>
 #include <vector>
 #include <cstdlib>
 
@@ -7,7 +8,27 @@
 #include "../MeshPreprocessor.cpp"
 #undef main
 
-int main() {
+namespace {
+
+std::vector<char> readFile(const char* path) {
+    std::ifstream in(path, std::ios::binary);
+    assert(in.good());
+    return {std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>()};
+}
+
+int preprocess(const char* objPath, const char* outPath) {
+    char* argv[] = {(char*)"MeshPreprocessor", (char*)objPath, (char*)outPath, (char*)"4"};
+    return mesh_preprocessor_main(4, argv);
+}
+
+bool sphereContains(const float* outerCenter, float outerRadius, const float* innerCenter, float innerRadius) {
+    float dx = outerCenter[0] - innerCenter[0];
+    float dy = outerCenter[1] - innerCenter[1];
+    float dz = outerCenter[2] - innerCenter[2];
+    return std::sqrt(dx * dx + dy * dy + dz * dz) + innerRadius <= outerRadius * 1.0001f + 1e-5f;
+}
+
+void testQuad() {
     const char* objPath = "test.obj";
     const char* outPath = "out.nanite";
     {
@@ -17,31 +38,96 @@ int main() {
             << "v 1 1 0\n"
             << "v 0 1 0\n"
             << "f 1 2 3\n"
-            << "f 1 3 4\n";
+            << "f 1/1 3/3 4/4\n";
     }
-    char* argv[] = {(char*)"MeshPreprocessor", (char*)objPath, (char*)outPath};
-    int ret = mesh_preprocessor_main(3, argv);
-    assert(ret == 0);
+    assert(preprocess(objPath, outPath) == 0);
 
-    std::ifstream in(outPath, std::ios::binary);
-    assert(in.good());
-    uint32_t clusterCount;
-    in.read(reinterpret_cast<char*>(&clusterCount), sizeof(clusterCount));
-    assert(clusterCount == 1);
-    Ogre::Vector3 min, max;
-    in.read(reinterpret_cast<char*>(&min), sizeof(min));
-    in.read(reinterpret_cast<char*>(&max), sizeof(max));
-    assert(min == Ogre::Vector3(0,0,0));
-    assert(max == Ogre::Vector3(1,1,0));
-    uint32_t icount;
-    in.read(reinterpret_cast<char*>(&icount), sizeof(icount));
-    assert(icount == 6);
-    std::vector<unsigned int> indices(icount);
-    in.read(reinterpret_cast<char*>(indices.data()), icount * sizeof(unsigned int));
-    std::vector<unsigned int> expected{0,1,2,0,2,3};
-    assert(indices == expected);
-    uint32_t childCount;
-    in.read(reinterpret_cast<char*>(&childCount), sizeof(childCount));
-    assert(childCount == 0);
+    auto data = readFile(outPath);
+    auto header = NaniteFormat::validate(data.data(), data.size());
+    assert(header);
+    assert(header->clusterCount == 1);
+    assert(header->levelCount == 1);
+    assert(header->vertexCount == 4);
+
+    const auto& cluster = NaniteFormat::section<NaniteFormat::ClusterRecord>(data.data(), header->clustersOffset)[0];
+    assert(cluster.boundsMin[0] == 0 && cluster.boundsMin[1] == 0 && cluster.boundsMin[2] == 0);
+    assert(cluster.boundsMax[0] == 1 && cluster.boundsMax[1] == 1 && cluster.boundsMax[2] == 0);
+    assert(cluster.level == 0);
+    assert(cluster.error == 0);
+    assert(cluster.parentError == NaniteFormat::RootParentError);
+    assert(cluster.childCount == 0);
+
+    auto indices = NaniteFormat::section<uint32_t>(data.data(), header->indicesOffset);
+    std::vector<uint32_t> clusterIndices(indices + cluster.indexOffset, indices + cluster.indexOffset + cluster.indexCount);
+    std::sort(clusterIndices.begin(), clusterIndices.end());
+    std::vector<uint32_t> expected{0, 0, 1, 2, 2, 3};
+    assert(clusterIndices == expected);
+}
+
+void testGrid() {
+    const char* objPath = "grid.obj";
+    const char* outPath = "grid.nanite";
+    const int size = 64;
+    {
+        std::ofstream obj(objPath);
+        for (int y = 0; y <= size; ++y) {
+            for (int x = 0; x <= size; ++x) {
+                // A gentle wave, so that simplification has an error to measure.
+                obj << "v " << x << " " << y << " " << std::sin(x * 0.2f) * 2.0f << "\n";
+            }
+        }
+        for (int y = 0; y < size; ++y) {
+            for (int x = 0; x < size; ++x) {
+                int a = y * (size + 1) + x + 1;
+                int b = a + 1;
+                int c = a + size + 1;
+                int d = c + 1;
+                obj << "f " << a << " " << b << " " << d << "\n";
+                obj << "f " << a << " " << d << " " << c << "\n";
+            }
+        }
+    }
+    assert(preprocess(objPath, outPath) == 0);
+
+    auto data = readFile(outPath);
+    auto header = NaniteFormat::validate(data.data(), data.size());
+    assert(header);
+    assert(header->levelCount > 2);
+
+    auto clusters = NaniteFormat::section<NaniteFormat::ClusterRecord>(data.data(), header->clustersOffset);
+    auto children = NaniteFormat::section<uint32_t>(data.data(), header->childrenOffset);
+    size_t leafTriangles = 0;
+    size_t roots = 0;
+    for (uint32_t i = 0; i < header->clusterCount; ++i) {
+        const auto& cluster = clusters[i];
+        assert(cluster.indexCount / 3 <= MaxClusterTriangles);
+        if (cluster.level == 0) {
+            assert(cluster.childCount == 0);
+            leafTriangles += cluster.indexCount / 3;
+        } else {
+            assert(cluster.childCount > 0);
+        }
+        if (cluster.parentError == NaniteFormat::RootParentError) {
+            roots++;
+        }
+        for (uint32_t j = 0; j < cluster.childCount; ++j) {
+            const auto& child = clusters[children[cluster.childOffset + j]];
+            assert(child.level < cluster.level);
+            // Errors only grow going up, and the parent's sphere encloses the child's.
+            assert(child.parentError == cluster.error);
+            assert(child.error <= cluster.error);
+            assert(sphereContains(child.parentLodCenter, child.parentLodRadius, child.lodCenter, child.lodRadius));
+            assert(child.parentLodRadius == cluster.lodRadius);
+        }
+    }
+    assert(leafTriangles == size * size * 2);
+    assert(roots > 0 && roots < header->clusterCount / 4);
+}
+
+}
+
+int main() {
+    testQuad();
+    testGrid();
     return 0;
 }
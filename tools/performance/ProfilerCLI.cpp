@@ -1,7 +1,128 @@
-#include "apps/ember/src/framework/Profiler.h"
+#include "apps/ember/src/framework/ProfileCapture.h"
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
 #include <iostream>
+#include <map>
+#include <optional>
+#include <sstream>
+#include <string>
 
-int main() {
-    std::cout << "terrainUpdate_ms " << Ember::Profiler::getMilliseconds("terrainUpdate") << std::endl;
-    return 0;
+/**
+ * Reads profiler captures written by Ember, i.e. Chrome trace files.
+ *
+ * Usage:
+ *   ProfilerCLI summary <capture.json>
+ *   ProfilerCLI diff <before.json> <after.json>
+ *
+ * The summary prints the time spent per frame in each scope, by thread and nesting. The
+ * diff prints the same for both captures side by side, for the scopes in either.
+ */
+
+namespace {
+
+using Ember::ProfileCapture;
+
+std::optional<ProfileCapture> load(const char* path) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        std::cerr << "Could not open " << path << std::endl;
+        return std::nullopt;
+    }
+    auto capture = ProfileCapture::readChromeTrace(in);
+    if (!capture) {
+        std::cerr << "Could not read a trace from " << path << std::endl;
+    } else if (capture->droppedEvents) {
+        std::cerr << path << ": " << capture->droppedEvents << " events were dropped while recording" << std::endl;
+    }
+    return capture;
+}
+
+/// Indents the last name of the path by its depth.
+std::string label(const std::string& path) {
+    std::string indent;
+    size_t last = 0;
+    for (size_t i = 0; i < path.size(); ++i) {
+        if (path[i] == ';') {
+            indent += "  ";
+            last = i + 1;
+        }
+    }
+    return indent + path.substr(last);
+}
+
+int summary(const char* path) {
+    auto capture = load(path);
+    if (!capture) {
+        return EXIT_FAILURE;
+    }
+    std::cout << std::left << std::setw(16) << "thread" << std::setw(40) << "scope" << std::right
+              << std::setw(10) << "calls" << std::setw(10) << "mean" << std::setw(10) << "p50"
+              << std::setw(10) << "p95" << std::setw(10) << "p99" << std::setw(10) << "max" << std::endl;
+    std::cout << std::fixed << std::setprecision(3);
+    for (auto& entry: capture->getStatistics()) {
+        std::cout << std::left << std::setw(16) << entry.thread << std::setw(40) << label(entry.path) << std::right
+                  << std::setw(10) << entry.calls << std::setw(10) << entry.mean << std::setw(10) << entry.p50
+                  << std::setw(10) << entry.p95 << std::setw(10) << entry.p99 << std::setw(10) << entry.max << std::endl;
+    }
+    return EXIT_SUCCESS;
+}
+
+int diff(const char* beforePath, const char* afterPath) {
+    auto before = load(beforePath);
+    auto after = load(afterPath);
+    if (!before || !after) {
+        return EXIT_FAILURE;
+    }
+    // Separate the names with a character sorting before any name, so that scopes follow their parents.
+    auto sortKey = [](const ProfileCapture::Statistics& entry) {
+        auto path = entry.path;
+        std::replace(path.begin(), path.end(), ';', '\x01');
+        return std::pair{entry.thread, path};
+    };
+    std::map<std::pair<std::string, std::string>, std::pair<ProfileCapture::Statistics, ProfileCapture::Statistics>> entries;
+    for (auto& entry: before->getStatistics()) {
+        entries[sortKey(entry)].first = entry;
+    }
+    for (auto& entry: after->getStatistics()) {
+        entries[sortKey(entry)].second = entry;
+    }
+
+    auto change = [](double from, double to) {
+        std::ostringstream stream;
+        if (from > 0) {
+            stream << std::showpos << std::fixed << std::setprecision(1) << (to - from) / from * 100.0 << "%";
+        } else {
+            stream << (to > 0 ? "new" : "-");
+        }
+        return stream.str();
+    };
+
+    std::cout << std::left << std::setw(16) << "thread" << std::setw(40) << "scope" << std::right
+              << std::setw(10) << "mean" << std::setw(10) << "mean'" << std::setw(10) << "change"
+              << std::setw(10) << "p95" << std::setw(10) << "p95'" << std::setw(10) << "change" << std::endl;
+    std::cout << std::fixed << std::setprecision(3);
+    for (auto& [key, pair]: entries) {
+        auto& [from, to] = pair;
+        auto& path = from.path.empty() ? to.path : from.path;
+        std::cout << std::left << std::setw(16) << key.first << std::setw(40) << label(path) << std::right
+                  << std::setw(10) << from.mean << std::setw(10) << to.mean << std::setw(10) << change(from.mean, to.mean)
+                  << std::setw(10) << from.p95 << std::setw(10) << to.p95 << std::setw(10) << change(from.p95, to.p95) << std::endl;
+    }
+    return EXIT_SUCCESS;
+}
+
+}
+
+int main(int argc, char** argv) {
+    if (argc == 3 && std::string(argv[1]) == "summary") {
+        return summary(argv[2]);
+    }
+    if (argc == 4 && std::string(argv[1]) == "diff") {
+        return diff(argv[2], argv[3]);
+    }
+    std::cerr << "Usage: " << argv[0] << " summary <capture.json>" << std::endl
+              << "       " << argv[0] << " diff <before.json> <after.json>" << std::endl;
+    return EXIT_FAILURE;
 }
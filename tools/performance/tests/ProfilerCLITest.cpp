@@ -1,33 +1,111 @@
 #include <cassert>
 #include <fstream>
+#include <sstream>
 #include <cstdlib>
 #include <string>
 #include <thread>
 #include <chrono>
 #include "../../../apps/ember/src/framework/Profiler.h"
 
-int main() {
-    using namespace Ember;
-    Profiler::start("terrainUpdate");
-    std::this_thread::sleep_for(std::chrono::milliseconds(1));
-    Profiler::stop("terrainUpdate");
-
-    std::system("./ProfilerCLI > out1.txt");
-    {
-        std::ifstream in("out1.txt");
-        std::string label; double val;
-        in >> label >> val;
-        assert(label == "terrainUpdate_ms");
-        assert(val > 0.0);
+namespace {
+
+using namespace Ember;
+
+const ProfileCapture::Statistics* find(const std::vector<ProfileCapture::Statistics>& statistics, const std::string& thread, const std::string& path) {
+    for (auto& entry : statistics) {
+        if (entry.thread == thread && entry.path == path) {
+            return &entry;
+        }
+    }
+    return nullptr;
+}
+
+void runFrames(int frames, std::chrono::microseconds innerDuration) {
+    for (int frame = 0; frame < frames; ++frame) {
+        {
+            EMBER_PROFILE_SCOPE("outer");
+            EMBER_PROFILE_SCOPE("inner");
+            std::this_thread::sleep_for(innerDuration);
+        }
+        Profiler::endFrame();
     }
+}
+
+std::string readFile(const char* path) {
+    std::ifstream in(path);
+    std::stringstream ss;
+    ss << in.rdbuf();
+    return ss.str();
+}
+
+void writeCapture(const char* path) {
+    std::ofstream out(path);
+    Profiler::capture().writeChromeTrace(out);
+}
 
-    std::system("./ProfilerCLI extra > out2.txt");
-    {
-        std::ifstream in("out2.txt");
-        std::string label; double val;
-        in >> label >> val;
-        assert(label == "terrainUpdate_ms");
-        assert(val > 0.0);
+}
+
+int main() {
+    Profiler::setThreadName("main");
+    Profiler::setEnabled(true);
+    Profiler::clear();
+
+    // Scopes from other threads are collected when the frame ends.
+    std::thread worker([]() {
+        Profiler::setThreadName("worker");
+        EMBER_PROFILE_SCOPE("work");
+    });
+    worker.join();
+    auto queued = std::chrono::steady_clock::now();
+    Profiler::record(Profiler::registerScope("queued"), queued - std::chrono::milliseconds(5), queued);
+    runFrames(10, std::chrono::microseconds(200));
+
+    auto capture = Profiler::capture();
+    auto statistics = capture.getStatistics();
+    auto frame = find(statistics, "main", "frame");
+    auto outer = find(statistics, "main", "frame;outer");
+    auto inner = find(statistics, "main", "frame;outer;inner");
+    assert(frame && frame->calls == 10);
+    assert(outer && outer->calls == 10);
+    assert(inner && inner->calls == 10);
+    assert(inner->p50 >= 0.2 && inner->p50 <= outer->p50 && outer->p50 <= frame->max);
+    assert(inner->p50 <= inner->p95 && inner->p95 <= inner->p99 && inner->p99 <= inner->max);
+    assert(find(statistics, "worker", "work"));
+    auto span = find(statistics, "spans", "queued");
+    assert(span && span->max >= 5.0);
+
+    // A trace should read back to the same statistics.
+    std::stringstream trace;
+    capture.writeChromeTrace(trace);
+    auto read = ProfileCapture::readChromeTrace(trace);
+    assert(read);
+    auto readStatistics = read->getStatistics();
+    assert(readStatistics.size() == statistics.size());
+    for (size_t i = 0; i < statistics.size(); ++i) {
+        assert(readStatistics[i].thread == statistics[i].thread);
+        assert(readStatistics[i].path == statistics[i].path);
+        assert(readStatistics[i].calls == statistics[i].calls);
     }
+
+    writeCapture("before.json");
+    Profiler::clear();
+    runFrames(10, std::chrono::microseconds(2000));
+    writeCapture("after.json");
+
+    assert(std::system("./ProfilerCLI summary before.json > summary.txt") == 0);
+    auto summary = readFile("summary.txt");
+    assert(summary.find("    inner") != std::string::npos);
+    assert(summary.find("worker") != std::string::npos);
+
+    assert(std::system("./ProfilerCLI diff before.json after.json > diff.txt") == 0);
+    auto diff = readFile("diff.txt");
+    assert(diff.find("    inner") != std::string::npos);
+    assert(diff.find("+") != std::string::npos);
+
+    assert(std::system("./ProfilerCLI summary missing.json > /dev/null 2>&1") != 0);
+
+    // Only the most recent frames are kept.
+    Profiler::setHistoryFrames(3);
+    assert(find(Profiler::capture().getStatistics(), "main", "frame")->calls == 3);
     return 0;
 }